@@ -0,0 +1,58 @@
+;; Modular arithmetic benchmark: times modular-expt with a full size
+;; exponent, modular-inverse, a probable-prime? check and RSA key
+;; generation for a modulus of the given size in bits, reporting the
+;; average time per operation.  Each operation is repeated for at
+;; least the given number of seconds.
+;;
+;;   chibi-scheme benchmarks/bignum/modular.scm [bits [seconds]]
+
+(import (scheme base) (scheme write) (scheme time)
+        (scheme process-context) (chibi math prime) (chibi crypto rsa))
+
+(define args (command-line))
+
+(define bits
+  (if (> (length args) 1) (string->number (cadr args)) 2048))
+
+(define seconds
+  (if (> (length args) 2) (string->number (car (cddr args))) 1))
+
+;; random integers from a fixed LCG, built 30 bits at a time
+(define seed 12345)
+(define (random-bits k)
+  (let lp ((k k) (res 1))
+    (if (<= k 0)
+        res
+        (begin
+          (set! seed (modulo (+ (* seed 1103515245) 12345) 2147483648))
+          (lp (- k 30) (+ (* res 1073741824) (quotient seed 2)))))))
+
+(define m (+ (* 2 (random-bits (- bits 2))) 1))
+(define a (random-bits (- bits 2)))
+(define e (random-bits (- bits 2)))
+(define p (prime-above (random-bits (- (quotient bits 2) 1))))
+
+(define (time-per-op name thunk)
+  (let ((start (current-jiffy))
+        (limit (* seconds (jiffies-per-second))))
+    (let lp ((reps 1))
+      (thunk)
+      (let ((elapsed (- (current-jiffy) start)))
+        (cond
+         ((< elapsed limit)
+          (lp (+ reps 1)))
+         (else
+          (display name)
+          (display ": ")
+          (display (round (/ (* 1e6 elapsed) (jiffies-per-second) reps)))
+          (display " us")
+          (newline)))))))
+
+(display bits)
+(display " bits")
+(newline)
+(time-per-op "modular-expt" (lambda () (modular-expt a e m)))
+(time-per-op "modular-expt even modulus" (lambda () (modular-expt a e (+ m 1))))
+(time-per-op "modular-inverse" (lambda () (modular-inverse a m)))
+(time-per-op "probable-prime? (half size)" (lambda () (probable-prime? p)))
+(time-per-op "rsa-key-gen" (lambda () (rsa-key-gen bits)))
@@ -0,0 +1,62 @@
+;; Bignum arithmetic micro-benchmark: times multiplication, division,
+;; gcd, ratio addition, expt and exact-integer-sqrt on random operands
+;; of the given size in bits (the divisor and gcd operands are half
+;; that), reporting the average time per operation.  Each operation
+;; is repeated for at least the given number of seconds.
+;;
+;;   chibi-scheme benchmarks/bignum/ops.scm [bits [seconds]]
+
+(import (scheme base) (scheme write) (scheme time)
+        (scheme process-context) (chibi))
+
+(define args (command-line))
+
+(define bits
+  (if (> (length args) 1) (string->number (cadr args)) 100000))
+
+(define seconds
+  (if (> (length args) 2) (string->number (car (cddr args))) 1))
+
+;; random integers from a fixed LCG, built 30 bits at a time
+(define seed 12345)
+(define (random-bits k)
+  (let lp ((k k) (res 1))
+    (if (<= k 0)
+        res
+        (begin
+          (set! seed (modulo (+ (* seed 1103515245) 12345) 2147483648))
+          (lp (- k 30) (+ (* res 1073741824) (quotient seed 2)))))))
+
+(define a (random-bits bits))
+(define b (random-bits bits))
+(define c (random-bits (quotient bits 2)))
+(define d (random-bits (quotient bits 2)))
+(define ab (* a b))
+
+(define (time-per-op name thunk)
+  (let ((start (current-jiffy))
+        (limit (* seconds (jiffies-per-second))))
+    (let lp ((reps 1))
+      (thunk)
+      (let ((elapsed (- (current-jiffy) start)))
+        (cond
+         ((< elapsed limit)
+          (lp (+ reps 1)))
+         (else
+          (display name)
+          (display ": ")
+          (display (round (/ (* 1e6 elapsed) (jiffies-per-second) reps)))
+          (display " us")
+          (newline)))))))
+
+(display bits)
+(display " bits")
+(newline)
+(time-per-op "multiply" (lambda () (* a b)))
+(time-per-op "square" (lambda () (* a a)))
+(time-per-op "quotient 2n/n" (lambda () (quotient ab b)))
+(time-per-op "remainder n/(n/2)" (lambda () (remainder a c)))
+(time-per-op "gcd" (lambda () (gcd (* c d) (* c a))))
+(time-per-op "ratio add" (lambda () (+ (/ a c) (/ b d))))
+(time-per-op "expt" (lambda () (expt 7 (quotient bits 3))))
+(time-per-op "exact-integer-sqrt" (lambda () (exact-integer-sqrt ab)))
@@ -0,0 +1,67 @@
+;; Digest and base64 throughput benchmark: hashes and encodes a random
+;; bytevector of the given size in megabytes, both directly and
+;; streamed from a binary input port, reporting the throughput of
+;; each in MB/s.  Each operation is repeated for at least the given
+;; number of seconds.
+;;
+;;   chibi-scheme benchmarks/crypto/digest.scm [megabytes [seconds]]
+
+(import (scheme base) (scheme write) (scheme time)
+        (scheme process-context) (chibi base64)
+        (chibi crypto md5) (chibi crypto sha2))
+
+(define args (command-line))
+
+(define megabytes
+  (if (> (length args) 1) (string->number (cadr args)) 16))
+
+(define seconds
+  (if (> (length args) 2) (string->number (car (cddr args))) 1))
+
+;; random bytes from a fixed LCG
+(define data
+  (let ((res (make-bytevector (* megabytes 1024 1024))))
+    (let lp ((i 0) (seed 12345))
+      (if (>= i (bytevector-length res))
+          res
+          (let ((seed (modulo (+ (* seed 1103515245) 12345) 2147483648)))
+            (bytevector-u8-set! res i (quotient seed 8388608))
+            (lp (+ i 1) seed))))))
+
+(define encoded (base64-encode-bytevector data))
+
+(define (throughput name thunk)
+  (let ((start (current-jiffy))
+        (limit (* seconds (jiffies-per-second))))
+    (let lp ((reps 1))
+      (thunk)
+      (let ((elapsed (- (current-jiffy) start)))
+        (cond
+         ((< elapsed limit)
+          (lp (+ reps 1)))
+         (else
+          (display name)
+          (display ": ")
+          (display (round (/ (* megabytes reps (jiffies-per-second))
+                             elapsed 1.)))
+          (display " MB/s")
+          (newline)))))))
+
+(define (sink-port)
+  (open-output-bytevector))
+
+(display megabytes)
+(display " MB")
+(newline)
+(throughput "sha-256" (lambda () (sha-256 data)))
+(throughput "sha-256 port" (lambda () (sha-256 (open-input-bytevector data))))
+(throughput "md5" (lambda () (md5 data)))
+(throughput "md5 port" (lambda () (md5 (open-input-bytevector data))))
+(throughput "base64 encode" (lambda () (base64-encode-bytevector data)))
+(throughput "base64 decode" (lambda () (base64-decode-bytevector encoded)))
+(throughput "base64 encode port"
+            (lambda ()
+              (base64-encode (open-input-bytevector data) (sink-port))))
+(throughput "base64 decode port"
+            (lambda ()
+              (base64-decode (open-input-bytevector encoded) (sink-port))))
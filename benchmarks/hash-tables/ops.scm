@@ -0,0 +1,90 @@
+;; Hash table micro-benchmark: inserts n keys in random order into
+;; an initially empty table, looks them all up, then deletes them,
+;; reporting the time per operation.  Lookups are timed both in the
+;; order the keys were inserted and in another order, since the former
+;; favors tables which allocate entries in insertion order.  The keys are fixnums for eqv
+;; tables (the default), strings for "string" and "equal", and
+;; 200-character strings for "long", and the table is compared by
+;; eq? for "eq", string=? for "string" and "long", and equal? for
+;; "equal".
+;;
+;;   chibi-scheme benchmarks/hash-tables/ops.scm [n [eqv|eq|string|equal|long]]
+
+(import (chibi) (srfi 69) (scheme time) (scheme process-context))
+
+(define args (command-line))
+
+(define n
+  (if (> (length args) 1) (string->number (cadr args)) 1000000))
+
+(define kind
+  (if (> (length args) 2) (string->symbol (car (cddr args))) 'eqv))
+
+(define keys
+  (let ((vec (make-vector n)))
+    (do ((i 0 (+ i 1))) ((= i n) vec)
+      (vector-set! vec i
+                   (case kind
+                     ((string equal) (number->string i))
+                     ((long) (string-append (make-string 190 #\x) (number->string i)))
+                     (else i))))))
+
+;; shuffle the keys with a fixed LCG, since consecutive integers would
+;; also be consecutive in memory for some tables
+(define (shuffle-keys! seed)
+  (let lp ((i (- n 1)) (seed seed))
+    (cond
+     ((> i 0)
+      (let* ((seed (modulo (+ (* seed 1103515245) 12345) 2147483648))
+             (j (modulo seed (+ i 1)))
+             (tmp (vector-ref keys i)))
+        (vector-set! keys i (vector-ref keys j))
+        (vector-set! keys j tmp)
+        (lp (- i 1) seed))))))
+
+(shuffle-keys! 12345)
+
+(define table
+  (case kind
+    ((eq) (make-hash-table eq?))
+    ((string long) (make-hash-table string=? string-hash))
+    ((equal) (make-hash-table equal?))
+    (else (make-hash-table))))
+
+(define (time-per-op thunk)
+  (let ((start (current-jiffy)))
+    (thunk)
+    (/ (* 1e9 (- (current-jiffy) start)) (jiffies-per-second) n)))
+
+(define (for-each-key proc)
+  (do ((i 0 (+ i 1))) ((= i n))
+    (proc (vector-ref keys i))))
+
+(let* ((insert-ns
+        (time-per-op
+         (lambda () (for-each-key (lambda (k) (hash-table-set! table k k))))))
+       (lookup-ns
+        (time-per-op
+         (lambda () (for-each-key (lambda (k) (hash-table-ref/default table k #f))))))
+       (reordered-ns
+        (begin
+          (shuffle-keys! 54321)
+          (time-per-op
+           (lambda () (for-each-key (lambda (k) (hash-table-ref/default table k #f)))))))
+       (delete-ns
+        (time-per-op
+         (lambda () (for-each-key (lambda (k) (hash-table-delete! table k)))))))
+  (display n)
+  (display " ")
+  (display kind)
+  (display ": insert ")
+  (display (round insert-ns))
+  (display " ns, lookup ")
+  (display (round lookup-ns))
+  (display " ns (")
+  (display (round reordered-ns))
+  (display " ns reordered)")
+  (display ", delete ")
+  (display (round delete-ns))
+  (display " ns per key")
+  (newline))
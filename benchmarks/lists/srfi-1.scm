@@ -0,0 +1,55 @@
+;; SRFI-1 deletion and lset micro-benchmark: runs each operation on
+;; lists of n random fixnums drawn from [0, n), or their string forms
+;; for "string", reporting the time per element.  The equivalence is
+;; eqv? for fixnums and equal? for strings.
+;;
+;;   chibi-scheme benchmarks/lists/srfi-1.scm [n [fixnum|string]]
+
+(import (chibi) (srfi 1) (scheme time) (scheme process-context))
+
+(define args (command-line))
+
+(define n
+  (if (> (length args) 1) (string->number (cadr args)) 100000))
+
+(define kind
+  (if (> (length args) 2) (string->symbol (car (cddr args))) 'fixnum))
+
+(define eq (if (eq? kind 'string) equal? eqv?))
+
+;; random elements from a fixed LCG
+(define (random-list seed)
+  (let lp ((i 0) (seed seed) (res '()))
+    (if (= i n)
+        res
+        (let ((seed (modulo (+ (* seed 1103515245) 12345) 2147483648)))
+          (lp (+ i 1)
+              seed
+              (cons (if (eq? kind 'string)
+                        (number->string (modulo seed n))
+                        (modulo seed n))
+                    res))))))
+
+(define a (random-list 12345))
+(define b (random-list 54321))
+
+(define (report name thunk)
+  (let ((start (current-jiffy)))
+    (thunk)
+    (display name)
+    (display ": ")
+    (display (round (/ (* 1e9 (- (current-jiffy) start)) (jiffies-per-second) n)))
+    (display " ns per element")
+    (newline)))
+
+(display n)
+(display " ")
+(display kind)
+(newline)
+(report "delete" (lambda () (delete (car a) a eq)))
+(report "delete-duplicates" (lambda () (delete-duplicates a eq)))
+(report "lset-adjoin" (lambda () (lset-adjoin eq a (car b) (cadr b))))
+(report "lset-union" (lambda () (lset-union eq a b)))
+(report "lset-intersection" (lambda () (lset-intersection eq a b)))
+(report "lset-difference" (lambda () (lset-difference eq a b)))
+(report "lset-xor" (lambda () (lset-xor eq a b)))
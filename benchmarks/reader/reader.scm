@@ -0,0 +1,93 @@
+;; Reader micro-benchmarks: generates a few data shapes, writes them
+;; to a string and reports the throughput of read over a string port
+;; in MB/s.
+;;
+;;   chibi-scheme benchmarks/reader/reader.scm [size-in-kb [iterations]]
+
+;; (chibi) provides the native read and write, (scheme read) and
+;; (scheme write) are the slower srfi 38 versions
+(import (chibi) (scheme time) (scheme process-context) (srfi 27))
+
+(define args (command-line))
+
+(define target-size
+  (* 1024 (if (> (length args) 1) (string->number (cadr args)) 1024)))
+
+(define iterations
+  (if (> (length args) 2) (string->number (car (cddr args))) 3))
+
+(define (random-chars len chars)
+  (let ((res (make-string len)))
+    (do ((i 0 (+ i 1)))
+        ((= i len) res)
+      (string-set! res i (string-ref chars (random-integer (string-length chars)))))))
+
+(define (random-symbol)
+  (string->symbol
+   (random-chars (+ 3 (random-integer 12)) "abcdefghijklmnopqrstuvwxyz-?!*")))
+
+(define (random-string)
+  (random-chars (random-integer 40) "abc def ghi jkl mno pqr stu vwx yz\n\""))
+
+(define (random-tree depth)
+  (if (or (zero? depth) (< (random-integer 4) 1))
+      (random-integer 1000)
+      (let lp ((i (random-integer 5)) (res '()))
+        (if (negative? i)
+            res
+            (lp (- i 1) (cons (random-tree (- depth 1)) res))))))
+
+(define (random-record)
+  (list (random-symbol)
+        (random-integer 1000000)
+        (random-string)
+        (list 'score (/ (random-integer 100000) 100.))
+        (vector (random-symbol) (- (random-integer 100)))))
+
+(define shapes
+  (list (cons "symbols" random-symbol)
+        (cons "fixnums" (lambda () (- (random-integer 2000000) 1000000)))
+        (cons "flonums" (lambda () (/ (random-integer 100000000) 1000.)))
+        (cons "strings" random-string)
+        (cons "nested lists" (lambda () (random-tree 6)))
+        (cons "mixed records" random-record)))
+
+;; Writes data from thunk, one datum per line with an occasional
+;; comment, until the text reaches the target size.
+(define (generate thunk)
+  (let lp ((i 0) (size 0) (chunks '()))
+    (if (>= size target-size)
+        (apply string-append (reverse chunks))
+        (let ((out (open-output-string)))
+          (do ((j 0 (+ j 1))) ((= j 1000))
+            (if (zero? (modulo (+ i j) 50)) (display "; comment\n" out))
+            (write (thunk) out)
+            (newline out))
+          (let ((chunk (get-output-string out)))
+            (lp (+ i 1000)
+                (+ size (string-length chunk))
+                (cons chunk chunks)))))))
+
+(define (read-all str)
+  (let ((in (open-input-string str)))
+    (let lp ((n 0))
+      (if (eof-object? (read in)) n (lp (+ n 1))))))
+
+(define (run-shape name thunk)
+  (let* ((str (generate thunk))
+         (mb (/ (string-length str) 1048576.)))
+    (let lp ((i 0) (best #f))
+      (if (< i iterations)
+          (let* ((start (current-jiffy))
+                 (count (read-all str))
+                 (secs (/ (- (current-jiffy) start)
+                          (exact->inexact (jiffies-per-second)))))
+            (lp (+ i 1) (if (and best (< best secs)) best secs)))
+          (begin
+            (display name)
+            (display ": ")
+            (write (/ (round (* 100 (/ mb (max best 1e-6)))) 100))
+            (display " MB/s")
+            (newline))))))
+
+(for-each (lambda (shape) (run-shape (car shape) (cdr shape))) shapes)
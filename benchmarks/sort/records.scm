@@ -0,0 +1,52 @@
+;; Sorting micro-benchmark: sorts a vector of n records in random
+;; order by a numeric field, reporting the time per record.  The field
+;; holds fixnums, or flonums for "flonum", and is compared with <, or
+;; with a closure for "closure".
+;;
+;;   chibi-scheme benchmarks/sort/records.scm [n [fixnum|flonum|closure]]
+
+(import (chibi) (srfi 9) (srfi 95) (scheme time) (scheme process-context))
+
+(define-record-type Point
+  (make-point id weight)
+  point?
+  (id point-id)
+  (weight point-weight))
+
+(define args (command-line))
+
+(define n
+  (if (> (length args) 1) (string->number (cadr args)) 1000000))
+
+(define kind
+  (if (> (length args) 2) (string->symbol (car (cddr args))) 'fixnum))
+
+;; random weights from a fixed LCG
+(define points
+  (let ((vec (make-vector n)))
+    (let lp ((i 0) (seed 12345))
+      (if (= i n)
+          vec
+          (let ((seed (modulo (+ (* seed 1103515245) 12345) 2147483648)))
+            (vector-set! vec i (make-point i (if (eq? kind 'flonum)
+                                                 (/ seed 1024.)
+                                                 seed)))
+            (lp (+ i 1) seed))))))
+
+(define (time-per-record thunk)
+  (let ((start (current-jiffy)))
+    (thunk)
+    (/ (* 1e9 (- (current-jiffy) start)) (jiffies-per-second) n)))
+
+(let* ((less (if (eq? kind 'closure) (lambda (a b) (< a b)) <))
+       (random-ns (time-per-record (lambda () (sort! points less point-weight))))
+       (sorted-ns (time-per-record (lambda () (sort! points less point-weight)))))
+  (display n)
+  (display " ")
+  (display kind)
+  (display ": random ")
+  (display (round random-ns))
+  (display " ns, sorted ")
+  (display (round sorted-ns))
+  (display " ns per record")
+  (newline))
@@ -0,0 +1,64 @@
+;; Symbol table micro-benchmark: interns n distinct symbols, then
+;; looks them all up again, reporting the time per symbol.  With
+;; "keep" the symbols are kept reachable, otherwise they're garbage
+;; as soon as they're interned and may be collected.
+;;
+;;   chibi-scheme benchmarks/symbols/intern.scm [n [keep]]
+
+(import (chibi) (scheme time) (scheme process-context))
+
+(define args (command-line))
+
+(define n
+  (if (> (length args) 1) (string->number (cadr args)) 1000000))
+
+(define keep?
+  (and (> (length args) 2) (equal? "keep" (car (cddr args)))))
+
+;; names are counted up in place in a reused buffer, so that only
+;; the symbols themselves are allocated
+(define name (make-string 12 #\0))
+
+(define (next-name!)
+  (let lp ((j 11))
+    (let ((c (string-ref name j)))
+      (cond
+       ((char=? c #\9)
+        (string-set! name j #\0)
+        (lp (- j 1)))
+       (else
+        (string-set! name j (integer->char (+ 1 (char->integer c))))))))
+  name)
+
+(define (intern-all)
+  (string-fill! name #\0)
+  (let lp ((i 0) (res '()))
+    (if (= i n)
+        res
+        (let ((sym (string->symbol (next-name!))))
+          (lp (+ i 1) (if keep? (cons sym res) res))))))
+
+(define (name-all)
+  (string-fill! name #\0)
+  (let lp ((i 0))
+    (cond ((< i n) (next-name!) (lp (+ i 1))))))
+
+(define (time-per-symbol thunk)
+  (let ((start (current-jiffy)))
+    (thunk)
+    (/ (* 1e9 (- (current-jiffy) start)) (jiffies-per-second) n)))
+
+(define kept #f)
+
+;; the time to generate the names is subtracted out
+(let* ((name-ns (time-per-symbol name-all))
+       (intern-ns (time-per-symbol (lambda () (set! kept (intern-all)))))
+       (lookup-ns (time-per-symbol intern-all)))
+  (display n)
+  (display (if keep? " kept" " dropped"))
+  (display ": intern ")
+  (display (round (- intern-ns name-ns)))
+  (display " ns, lookup ")
+  (display (round (- lookup-ns name-ns)))
+  (display " ns per symbol")
+  (newline))
@@ -8,6 +8,25 @@
 
 #define SEXP_INIT_BIGNUM_SIZE 2
 
+#define SEXP_BIGNUM_BITS (sizeof(sexp_uint_t)*8)
+
+/* operand sizes in digits above which the subquadratic algorithms */
+/* are used, the defaults were tuned on x86-64                     */
+#ifndef SEXP_KARATSUBA_THRESHOLD
+#define SEXP_KARATSUBA_THRESHOLD 24
+#endif
+#ifndef SEXP_TOOM3_THRESHOLD
+#define SEXP_TOOM3_THRESHOLD 160
+#endif
+#ifndef SEXP_BURNIKEL_ZIEGLER_THRESHOLD
+#define SEXP_BURNIKEL_ZIEGLER_THRESHOLD 48
+#endif
+#ifndef SEXP_RADIX_CONVERSION_THRESHOLD
+#define SEXP_RADIX_CONVERSION_THRESHOLD 256
+#endif
+
+sexp sexp_bignum_quot_rem (sexp ctx, sexp *rem, sexp a, sexp b);
+
 static int digit_value (int c) {
   return (((c)<='9') ? ((c) - '0') : ((sexp_toupper(c) - 'A') + 10));
 }
@@ -246,27 +265,136 @@ sexp sexp_bignum_fxrem (sexp ctx, sexp a, sexp_sint_t b) {
   return sexp_make_fixnum(sexp_bignum_sign(a) * (sexp_sint_t)n);
 }
 
+/* Combines the word-sized chunks of digits read, least significant */
+/* first, with the leading digits in hi, as hi*B^n + ... + ls[0] for */
+/* the chunk base B.  Pairs of adjacent values are combined, then */
+/* pairs of those, and so on, so that most of the work is in a few */
+/* large multiplications, which are subquadratic. */
+static sexp sexp_bignum_combine_chunks (sexp ctx, sexp hi, sexp_uint_t *ls,
+                                        sexp_uint_t n, sexp_uint_t chunk_base) {
+  sexp_uint_t i, j;
+  sexp_gc_var3(vec, pow, tmp);
+  sexp_gc_preserve3(ctx, vec, pow, tmp);
+  vec = sexp_make_vector(ctx, sexp_make_fixnum(n+1), SEXP_FALSE);
+  pow = sexp_make_bignum(ctx, 1);
+  if (sexp_exceptionp(vec) || sexp_exceptionp(pow)) {
+    tmp = sexp_exceptionp(vec) ? vec : pow;
+    goto done;
+  }
+  sexp_bignum_data(pow)[0] = chunk_base;
+  for (i=0; i<n; i++) {
+    tmp = sexp_make_unsigned_integer(ctx, ls[i]);
+    if (sexp_exceptionp(tmp)) goto done;
+    sexp_vector_set(vec, sexp_make_fixnum(i), tmp);
+  }
+  sexp_vector_set(vec, sexp_make_fixnum(n), hi);
+  /* each value but the last spans the current power of B */
+  for (n++; n > 1; n = (n+1)/2) {
+    for (i=0, j=0; i+1<n; i+=2, j++) {
+      tmp = sexp_mul(ctx, sexp_vector_ref(vec, sexp_make_fixnum(i+1)), pow);
+      if (! sexp_exceptionp(tmp))
+        tmp = sexp_add(ctx, tmp, sexp_vector_ref(vec, sexp_make_fixnum(i)));
+      if (sexp_exceptionp(tmp)) goto done;
+      sexp_vector_set(vec, sexp_make_fixnum(j), tmp);
+    }
+    if (i < n)
+      sexp_vector_set(vec, sexp_make_fixnum(j), sexp_vector_ref(vec, sexp_make_fixnum(i)));
+    if (n > 2) {
+      pow = sexp_mul(ctx, pow, pow);
+      if (sexp_exceptionp(pow)) {
+        tmp = pow;
+        goto done;
+      }
+    }
+  }
+  tmp = sexp_vector_ref(vec, SEXP_ZERO);
+  if (sexp_fixnump(tmp))
+    tmp = sexp_fixnum_to_bignum(ctx, tmp);
+ done:
+  sexp_gc_release3(ctx);
+  return tmp;
+}
+
 sexp sexp_read_bignum (sexp ctx, sexp in, sexp_uint_t init,
                        signed char sign, sexp_uint_t base) {
-  int c, digit;
+  int c, digit, n = 0, sticky = 0;
+  long exp = 0;
+  char digits[SEXP_MAX_DECIMAL_DIGITS+1];
+  sexp_uint_t chunk = 0, scale = 1, max_scale = SEXP_UINT_T_MAX / base;
+  sexp_uint_t chunks_init[64], *chunks = chunks_init;
+  sexp_uint_t *tmp, num_chunks = 0, chunks_size = 64;
+  sexp_uint_t i, tmp_chunk, chunk_base = 0;
   sexp_gc_var1(res);
   sexp_gc_preserve1(ctx, res);
   res = sexp_make_bignum(ctx, SEXP_INIT_BIGNUM_SIZE);
   sexp_bignum_sign(res) = sign;
   sexp_bignum_data(res)[0] = init;
+  /* keep the decimal digits in case a fraction or exponent follows */
+  if (base == 10) {
+    for (chunk = init; chunk > 0; chunk /= 10)
+      n++;
+    for (digit = n, chunk = init; digit > 0; chunk /= 10)
+      digits[--digit] = '0' + chunk % 10;
+  }
+  /* accumulate a word's worth of digits at a time */
   for (c=sexp_read_char(ctx, in); sexp_isxdigit(c); c=sexp_read_char(ctx, in)) {
     digit = digit_value(c);
     if ((digit < 0) || (digit >= (int)base))
       break;
-    res = sexp_bignum_fxmul(ctx, res, res, base, 0);
-    res = sexp_bignum_fxadd(ctx, res, digit);
+    if (base == 10) {
+      if (n < SEXP_MAX_DECIMAL_DIGITS) {
+        digits[n++] = c;
+      } else {
+        exp++;
+        if (c != '0') sticky = 1;
+      }
+    }
+    if (scale > max_scale) {
+      /* keep the full chunks to combine at the end */
+      if (num_chunks == chunks_size) {
+        tmp = (sexp_uint_t*) malloc(2 * chunks_size * sizeof(sexp_uint_t));
+        if (! tmp) {
+          res = sexp_global(ctx, SEXP_G_OOM_ERROR);
+          break;
+        }
+        memcpy(tmp, chunks, chunks_size * sizeof(sexp_uint_t));
+        if (chunks != chunks_init) free(chunks);
+        chunks = tmp;
+        chunks_size *= 2;
+      }
+      chunks[num_chunks++] = chunk;
+      chunk_base = scale;
+      chunk = 0;
+      scale = 1;
+    }
+    chunk = chunk * base + digit;
+    scale *= base;
+  }
+  if (num_chunks > 0 && ! sexp_exceptionp(res)) {
+    for (i=0; i < num_chunks/2; i++) {  /* least significant first */
+      tmp_chunk = chunks[i];
+      chunks[i] = chunks[num_chunks-1-i];
+      chunks[num_chunks-1-i] = tmp_chunk;
+    }
+    sexp_bignum_sign(res) = 1;
+    res = sexp_bignum_combine_chunks(ctx, res, chunks, num_chunks, chunk_base);
+    if (sexp_bignump(res)) sexp_bignum_sign(res) = sign;
+  }
+  if (chunks != chunks_init) free(chunks);
+  if (scale > 1) {
+    res = sexp_bignum_fxmul(ctx, res, res, scale, 0);
+    res = sexp_bignum_fxadd(ctx, res, chunk);
   }
   if (c=='.' || c=='e' || c=='E') {
     if (base != 10) {
       res = sexp_read_error(ctx, "found non-base 10 float", SEXP_NULL, in);
     } else {
       if (c!='.') sexp_push_char(ctx, c, in); /* push the e back */
-      res = sexp_read_float_tail(ctx, in, sexp_bignum_to_double(res), (sign==-1));
+      if (sticky) {
+        digits[n++] = '1';
+        exp--;
+      }
+      res = sexp_read_decimal_tail(ctx, in, digits, n, exp, (sign==-1));
     }
 #if SEXP_USE_RATIOS
   } else if (c=='/') {
@@ -299,30 +427,118 @@ static int log2i(int v) {
   return i;
 }
 
+/* Writes the width digits of the non-negative x, zero-padded, */
+/* ending at end in str.  Large values are split in halves by the */
+/* precomputed pows[k] = chunk_base^(2^k), where x < pows[k]^2, so */
+/* the cost is in a few large divisions, which are subquadratic. */
+static sexp sexp_write_bignum_digits (sexp ctx, sexp x, sexp pows, int k,
+                                      sexp_uint_t base, sexp_uint_t chunk_base,
+                                      int chunk_len, sexp str, int end,
+                                      int width) {
+  int i = end, j;
+  sexp_uint_t r;
+  sexp_gc_var3(q, rem, res);
+  sexp_gc_preserve3(ctx, q, rem, res);
+  if (k < 0 || sexp_fixnump(x)
+      || sexp_bignum_hi(x) < SEXP_RADIX_CONVERSION_THRESHOLD) {
+    res = q = sexp_fixnump(x) ? sexp_fixnum_to_bignum(ctx, x)
+      : sexp_copy_bignum(ctx, NULL, x, 0);
+    if (sexp_exceptionp(res)) goto done;
+    while (end - i < width && ! sexp_bignum_zerop(q)) {
+      r = sexp_bignum_fxdiv(ctx, q, chunk_base, 0);
+      for (j=0; j<chunk_len; j++, r/=base)
+        sexp_string_data(str)[--i] = hex_digit(r % base);
+    }
+    while (end - i < width)
+      sexp_string_data(str)[--i] = '0';
+    res = SEXP_VOID;
+  } else {
+    res = q = sexp_bignum_quot_rem(ctx, &rem, x,
+                                   sexp_vector_ref(pows, sexp_make_fixnum(k)));
+    if (sexp_exceptionp(res)) goto done;
+    res = sexp_write_bignum_digits(ctx, rem, pows, k-1, base, chunk_base,
+                                   chunk_len, str, end, width/2);
+    if (! sexp_exceptionp(res))
+      res = sexp_write_bignum_digits(ctx, q, pows, k-1, base, chunk_base,
+                                     chunk_len, str, end - width/2, width/2);
+  }
+ done:
+  sexp_gc_release3(ctx);
+  return res;
+}
+
 sexp sexp_write_bignum (sexp ctx, sexp a, sexp out, sexp_uint_t base) {
-  int i, str_len, lg_base = log2i(base);
+  int i, k, str_len, chunk_len, lg_base = log2i(base);
+  sexp_uint_t chunk_base, r;
   char *data;
-  sexp_gc_var2(b, str);
-  sexp_gc_preserve2(ctx, b, str);
+  sexp_gc_var3(b, str, pows);
+  sexp_gc_preserve3(ctx, b, str, pows);
   b = sexp_copy_bignum(ctx, NULL, a, 0);
   sexp_bignum_sign(b) = 1;
   if (lg_base < 1) {
     return sexp_xtype_exception(ctx, NULL, "number base too small", a);
   }
+  /* divide by the largest power of base fitting in a word, */
+  /* producing chunk_len digits per pass */
+  for (chunk_base=base, chunk_len=1; chunk_base <= SEXP_UINT_T_MAX / base;
+       chunk_base *= base)
+    chunk_len++;
   i = str_len = (sexp_bignum_length(b)*sizeof(sexp_uint_t)*8 + lg_base - 1)
-    / lg_base + 1;
-  str = sexp_make_string(ctx, sexp_make_fixnum(str_len),
-                         sexp_make_character(' '));
-  data = sexp_string_data(str);
-  while (! sexp_bignum_zerop(b))
-    data[--i] = hex_digit(sexp_bignum_fxdiv(ctx, b, base, 0));
+    / lg_base + chunk_len + 1;
+  if (sexp_bignum_hi(b) >= SEXP_RADIX_CONVERSION_THRESHOLD) {
+    /* square chunk_base until its square exceeds b, which is then */
+    /* written as chunk_len<<k zero-padded digits */
+    pows = sexp_make_vector(ctx, sexp_make_fixnum(sizeof(sexp_uint_t)*8),
+                            SEXP_FALSE);
+    str = sexp_make_bignum(ctx, 1);
+    if (sexp_exceptionp(pows) || sexp_exceptionp(str)) {
+      b = sexp_exceptionp(pows) ? pows : str;
+      goto done;
+    }
+    sexp_bignum_data(str)[0] = chunk_base;
+    for (k=0; ; k++) {
+      sexp_vector_set(pows, sexp_make_fixnum(k), str);
+      if ((sexp_bignum_hi(str) - 1) * 2 >= sexp_bignum_hi(b)) break;
+      str = sexp_mul(ctx, str, str);
+      if (sexp_exceptionp(str)) {
+        b = str;
+        goto done;
+      }
+    }
+    if ((chunk_len << (k+1)) + 2 > str_len)
+      i = str_len = (chunk_len << (k+1)) + 2;
+    str = sexp_make_string(ctx, sexp_make_fixnum(str_len),
+                           sexp_make_character(' '));
+    if (sexp_exceptionp(str)) {
+      b = str;
+      goto done;
+    }
+    b = sexp_write_bignum_digits(ctx, b, pows, k, base, chunk_base, chunk_len,
+                                 str, str_len, chunk_len << (k+1));
+    if (sexp_exceptionp(b)) goto done;
+    i = str_len - (chunk_len << (k+1));
+    data = sexp_string_data(str);
+  } else {
+    str = sexp_make_string(ctx, sexp_make_fixnum(str_len),
+                           sexp_make_character(' '));
+    data = sexp_string_data(str);
+    while (! sexp_bignum_zerop(b)) {
+      r = sexp_bignum_fxdiv(ctx, b, chunk_base, 0);
+      for (k=0; k<chunk_len; k++, r/=base)
+        data[--i] = hex_digit(r % base);
+    }
+  }
+  while (i < str_len && data[i] == '0')
+    i++;
   if (i == str_len)
     data[--i] = '0';
   else if (sexp_bignum_sign(a) == -1)
     data[--i] = '-';
   sexp_write_string(ctx, data + i, out);
-  sexp_gc_release2(ctx);
-  return SEXP_VOID;
+  b = SEXP_VOID;
+ done:
+  sexp_gc_release3(ctx);
+  return b;
 }
 
 /****************** bignum arithmetic *************************/
@@ -429,78 +645,465 @@ sexp sexp_bignum_sub (sexp ctx, sexp dst, sexp a, sexp b) {
   return res;
 }
 
-static void sexp_bignum_split (sexp ctx, sexp a, sexp_uint_t k, sexp* lo, sexp* hi) {
-  sexp_uint_t alen=sexp_bignum_hi(a), i, *adata=sexp_bignum_data(a),
-    *lodata, *hidata;
-  *lo = sexp_make_bignum(ctx, k);        /* must be gc protected by caller */
-  *hi = sexp_make_bignum(ctx, alen-k+1);
-  lodata = sexp_bignum_data(*lo);
-  hidata = sexp_bignum_data(*hi);
-  for (i=0; i<k; i++)                    /* split into a[0..k-1], a[k..] */
-    lodata[i] = adata[i];
-  for (i=k; i<alen; i++)
-    hidata[i-k] = adata[i];
+/* the non-negative bignum of the len digits of a starting at k */
+static sexp sexp_bignum_slice (sexp ctx, sexp a, sexp_uint_t k, sexp_uint_t len) {
+  sexp_uint_t alen=sexp_bignum_hi(a), i;
+  sexp res = sexp_make_bignum(ctx, len > 0 ? len : 1);
+  if (!sexp_exceptionp(res))
+    for (i=0; i<len && k+i<alen; i++)
+      sexp_bignum_data(res)[i] = sexp_bignum_data(a)[k+i];
+  return res;
 }
 
-static sexp sexp_bignum_shift (sexp ctx, sexp a, sexp_uint_t k) {
-  sexp res;
-  sexp_uint_t alen = sexp_bignum_hi(a), i;
-  res = sexp_make_bignum(ctx, alen + k + 1);
-  for (i=0; i<alen; i++)
-    sexp_bignum_data(res)[i+k] = sexp_bignum_data(a)[i];
-  return res;
+/* r[0..rlen) += s[0..slen), returning the carry out of r */
+static sexp_uint_t sexp_digits_add_to (sexp_uint_t *r, sexp_uint_t rlen,
+                                       sexp_uint_t *s, sexp_uint_t slen) {
+  sexp_uint_t i;
+  sexp_luint_t n = 0;
+  if (slen > rlen) slen = rlen;
+  for (i=0; i<slen; i++) {
+    n += (sexp_luint_t)r[i] + s[i];
+    r[i] = (sexp_uint_t)n;
+    n >>= SEXP_BIGNUM_BITS;
+  }
+  for ( ; n && i<rlen; i++) {
+    n += r[i];
+    r[i] = (sexp_uint_t)n;
+    n >>= SEXP_BIGNUM_BITS;
+  }
+  return (sexp_uint_t)n;
+}
+
+/* r[0..len) -= s[0..slen), returning the borrow out of r */
+static sexp_uint_t sexp_digits_sub_from (sexp_uint_t *r, sexp_uint_t len,
+                                         sexp_uint_t *s, sexp_uint_t slen) {
+  sexp_uint_t i, borrow=0, t;
+  for (i=0; i<slen; i++) {
+    t = r[i] - s[i] - borrow;
+    borrow = (r[i] < s[i]) || (r[i] - s[i] < borrow);
+    r[i] = t;
+  }
+  for ( ; borrow && i<len; i++)
+    borrow = (r[i]-- == 0);
+  return borrow;
+}
+
+/* r[0..k) = |a[0..k) - b[0..blen)|, blen <= k, returns the sign */
+static int sexp_digits_abs_diff (sexp_uint_t *r, sexp_uint_t *a,
+                                 sexp_uint_t *b, sexp_uint_t blen,
+                                 sexp_uint_t k) {
+  sexp_sint_t i;
+  int cmp = 0;
+  for (i=k-1; i>=(sexp_sint_t)blen && !cmp; i--)
+    if (a[i]) cmp = 1;
+  for ( ; i>=0 && !cmp; i--)
+    if (a[i] != b[i]) cmp = (a[i] > b[i]) ? 1 : -1;
+  if (cmp >= 0) {
+    memcpy(r, a, k*sizeof(sexp_uint_t));
+    sexp_digits_sub_from(r, k, b, blen);
+  } else {
+    memset(r, 0, k*sizeof(sexp_uint_t));
+    memcpy(r, b, blen*sizeof(sexp_uint_t));
+    sexp_digits_sub_from(r, k, a, k);
+  }
+  return cmp;
+}
+
+/* the scratch space needed by sexp_digits_mul for an alen digit a */
+#define sexp_digits_mul_scratch(alen) (10*(alen) + 256)
+
+static void sexp_digits_mul_toom3 (sexp_uint_t *r, sexp_uint_t *a,
+                                   sexp_uint_t alen, sexp_uint_t *b,
+                                   sexp_uint_t blen, sexp_uint_t *tmp);
+
+/* r[0..alen+blen) = a*b for alen >= blen, r not aliasing a or b */
+static void sexp_digits_mul (sexp_uint_t *r, sexp_uint_t *a, sexp_uint_t alen,
+                             sexp_uint_t *b, sexp_uint_t blen,
+                             sexp_uint_t *tmp) {
+  sexp_uint_t i, j, k, bi, *s, *m;
+  sexp_luint_t n;
+  int sign;
+  memset(r, 0, (alen+blen)*sizeof(sexp_uint_t));
+  if (blen < SEXP_KARATSUBA_THRESHOLD) {
+    for (i=0; i<blen; i++) {
+      if (! (bi = b[i])) continue;
+      for (j=0, n=0; j<alen; j++) {
+        n += (sexp_luint_t)a[j]*bi + r[i+j];
+        r[i+j] = (sexp_uint_t)n;
+        n >>= SEXP_BIGNUM_BITS;
+      }
+      r[i+alen] = (sexp_uint_t)n;
+    }
+  } else if (alen >= 2*blen || blen <= (alen+1)/2) {
+    /* unbalanced: multiply b by successive blen digit slices of a */
+    for (i=0; i<alen; i+=blen) {
+      k = (alen - i < blen) ? alen - i : blen;
+      if (k >= blen)
+        sexp_digits_mul(tmp, a+i, k, b, blen, tmp+k+blen);
+      else
+        sexp_digits_mul(tmp, b, blen, a+i, k, tmp+k+blen);
+      sexp_digits_add_to(r+i, alen+blen-i, tmp, k+blen);
+    }
+  } else if (blen >= SEXP_TOOM3_THRESHOLD && blen > 2*((alen+2)/3)) {
+    sexp_digits_mul_toom3(r, a, alen, b, blen, tmp);
+  } else {
+    /* karatsuba:                                 */
+    /*   ab = (a1B^k + a0) * (b1B^k + b0)         */
+    /*      = z2B^2k + z1B^k + z0                 */
+    /* where:                                     */
+    /*   z2 = a1b1                                */
+    /*   z0 = a0b0                                */
+    /*   z1 = a1b0 + a0b1                         */
+    /*      = z0 + z2 - (a0 - a1)(b0 - b1)        */
+    /* using the difference to avoid carries.     */
+    k = (alen + 1) / 2;
+    sign = sexp_digits_abs_diff(tmp, a, a+k, alen-k, k);
+    sign *= sexp_digits_abs_diff(tmp+k, b, b+k, blen-k, k);
+    m = tmp + 2*k;                      /* (a0 - a1)(b0 - b1) */
+    s = m + 2*k;                        /* z0 + z2 -/+ m */
+    sexp_digits_mul(m, tmp, k, tmp+k, k, s+2*k+1);
+    sexp_digits_mul(r, a, k, b, k, s+2*k+1);
+    sexp_digits_mul(r+2*k, a+k, alen-k, b+k, blen-k, s+2*k+1);
+    memcpy(s, r, 2*k*sizeof(sexp_uint_t));
+    s[2*k] = 0;
+    sexp_digits_add_to(s, 2*k+1, r+2*k, alen+blen-2*k);
+    if (sign > 0)
+      sexp_digits_sub_from(s, 2*k+1, m, 2*k);
+    else if (sign < 0)
+      sexp_digits_add_to(s, 2*k+1, m, 2*k);
+    sexp_digits_add_to(r+k, alen+blen-k, s, 2*k+1);
+  }
+}
+
+/* r[0..rlen) = xs*x + ys*y in sign-magnitude, r may alias x, */
+/* returning the sign of r                                    */
+static int sexp_digits_signed_add (sexp_uint_t *r, sexp_uint_t rlen,
+                                   sexp_uint_t *x, sexp_uint_t xlen, int xs,
+                                   sexp_uint_t *y, sexp_uint_t ylen, int ys) {
+  sexp_uint_t i;
+  if (r != x) memcpy(r, x, xlen*sizeof(sexp_uint_t));
+  memset(r+xlen, 0, (rlen-xlen)*sizeof(sexp_uint_t));
+  if (xs == ys) {
+    sexp_digits_add_to(r, rlen, y, ylen);
+  } else if (sexp_digits_sub_from(r, rlen, y, ylen)) {
+    /* y was larger, negate the two's complement difference */
+    for (i=0; i<rlen; i++)
+      r[i] = ~r[i];
+    for (i=0; i<rlen && ++r[i] == 0; i++)
+      ;
+    xs = -xs;
+  }
+  return xs;
+}
+
+/* divide r[0..len) in place by d, which must divide it exactly */
+static void sexp_digits_exact_div (sexp_uint_t *r, sexp_uint_t len,
+                                   sexp_uint_t d) {
+  sexp_luint_t n = 0;
+  sexp_uint_t i;
+  for (i=len; i-- > 0; ) {
+    n = (n << SEXP_BIGNUM_BITS) + r[i];
+    r[i] = (sexp_uint_t)(n / d);
+    n %= d;
+  }
+}
+
+/* toom-3, r[0..alen+blen) = a*b for alen >= blen > 2k:            */
+/*   a = a2B^2k + a1B^k + a0, likewise b, as polynomials evaluated  */
+/*   at 0, 1, -1, -2 and infinity, multiplied pointwise and         */
+/*   interpolated following Bodrato's sequence                      */
+static void sexp_digits_mul_toom3 (sexp_uint_t *r, sexp_uint_t *a,
+                                   sexp_uint_t alen, sexp_uint_t *b,
+                                   sexp_uint_t blen, sexp_uint_t *tmp) {
+  sexp_uint_t k=(alen+2)/3, l=k+1, w=2*k+3, rlen=alen+blen,
+    *p1=tmp, *pm1=p1+l, *pm2=pm1+l, *q1=pm2+l, *qm1=q1+l, *qm2=qm1+l,
+    *r1=qm2+l, *rm1=r1+w, *rm2=rm1+w, *rest=rm2+w,
+    *rinf=r+4*k, rinflen=rlen-4*k;
+  int s1, sm1, sm2, s2, s3;
+  /* p(1), p(-1) and p(-2), and likewise q */
+  memcpy(p1, a, k*sizeof(sexp_uint_t));
+  p1[k] = 0;
+  sexp_digits_add_to(p1, l, a+2*k, alen-2*k);
+  sm1 = sexp_digits_signed_add(pm1, l, p1, l, 1, a+k, k, -1);
+  sexp_digits_add_to(p1, l, a+k, k);
+  s2 = sexp_digits_signed_add(pm2, l, pm1, l, sm1, a+2*k, alen-2*k, 1);
+  sexp_digits_add_to(pm2, l, pm2, l);
+  sm2 = sexp_digits_signed_add(pm2, l, pm2, l, s2, a, k, -1);
+  memcpy(q1, b, k*sizeof(sexp_uint_t));
+  q1[k] = 0;
+  sexp_digits_add_to(q1, l, b+2*k, blen-2*k);
+  s1 = sexp_digits_signed_add(qm1, l, q1, l, 1, b+k, k, -1);
+  sm1 *= s1;
+  sexp_digits_add_to(q1, l, b+k, k);
+  s2 = sexp_digits_signed_add(qm2, l, qm1, l, s1, b+2*k, blen-2*k, 1);
+  sexp_digits_add_to(qm2, l, qm2, l);
+  sm2 *= sexp_digits_signed_add(qm2, l, qm2, l, s2, b, k, -1);
+  /* the pointwise products, with r(0) and r(inf) directly in place */
+  memset(r1, 0, 3*w*sizeof(sexp_uint_t));
+  sexp_digits_mul(r1, p1, l, q1, l, rest);
+  sexp_digits_mul(rm1, pm1, l, qm1, l, rest);
+  sexp_digits_mul(rm2, pm2, l, qm2, l, rest);
+  sexp_digits_mul(r, a, k, b, k, rest);
+  sexp_digits_mul(rinf, a+2*k, alen-2*k, b+2*k, blen-2*k, rest);
+  /* interpolate, the divisions are exact */
+  s3 = sexp_digits_signed_add(rm2, w, rm2, w, sm2, r1, w, -1);
+  sexp_digits_exact_div(rm2, w, 3);                       /* rm2 = r3 */
+  s1 = sexp_digits_signed_add(r1, w, r1, w, 1, rm1, w, -sm1);
+  sexp_digits_exact_div(r1, w, 2);                        /* r1 = r1 */
+  s2 = sexp_digits_signed_add(rm1, w, rm1, w, sm1, r, 2*k, -1); /* rm1 = r2 */
+  s3 = -sexp_digits_signed_add(rm2, w, rm2, w, s3, rm1, w, -s2);
+  sexp_digits_exact_div(rm2, w, 2);
+  s3 = sexp_digits_signed_add(rm2, w, rm2, w, s3, rinf, rinflen, 1);
+  s3 = sexp_digits_signed_add(rm2, w, rm2, w, s3, rinf, rinflen, 1);
+  s2 = sexp_digits_signed_add(rm1, w, rm1, w, s2, r1, w, s1);
+  s2 = sexp_digits_signed_add(rm1, w, rm1, w, s2, rinf, rinflen, -1);
+  s1 = sexp_digits_signed_add(r1, w, r1, w, s1, rm2, w, -s3);
+  /* recompose, all coefficients are now non-negative */
+  sexp_digits_add_to(r+k, rlen-k, r1, w);
+  sexp_digits_add_to(r+2*k, rlen-2*k, rm1, w);
+  sexp_digits_add_to(r+3*k, rlen-3*k, rm2, w);
 }
 
 sexp sexp_bignum_mul (sexp ctx, sexp dst, sexp a, sexp b) {
-  sexp_uint_t alen=sexp_bignum_hi(a), blen=sexp_bignum_hi(b), k,
-    *bdata=sexp_bignum_data(b);
-  sexp_gc_var7(a0, a1, b0, b1, z0, z1, z2);
+  sexp_uint_t alen=sexp_bignum_hi(a), blen=sexp_bignum_hi(b),
+    *bdata=sexp_bignum_data(b), *tmp;
+  sexp res;
   if (alen < blen) return sexp_bignum_mul(ctx, dst, b, a);
   if (blen == 1) {
-    z1 = sexp_bignum_fxmul(ctx, dst, a, bdata[0], 0);
+    res = sexp_bignum_fxmul(ctx, dst, a, bdata[0], 0);
   } else {
-    /* karatsuba:                             */
-    /*   ab = (a1B^k + a0) * (b1B^k + b0)     */
-    /*      = z2B^2k + z1B^k + z0             */
-    /* where:                                 */
-    /*   z2 = a1b1                            */
-    /*   z1 = a1b0 + a0b1                     */
-    /*   z0 = a0b0                            */
-    /* then optimize further:                 */
-    /*   z1 = (a1 + a0)(b1 + b0) - z2 - z0    */
-    sexp_gc_preserve7(ctx, a0, a1, b0, b1, z0, z1, z2);
-    k = blen / 2;
-    sexp_bignum_split(ctx, a, k, &a0, &a1);
-    sexp_bignum_split(ctx, b, k, &b0, &b1);
-    z0 = sexp_bignum_add(ctx, NULL, a1, a0);  /* temp */
-    z1 = sexp_bignum_add(ctx, NULL, b1, b0);
-    z1 = sexp_bignum_mul(ctx, NULL, z1, z0);  /* 1 */
-    z0 = sexp_bignum_mul(ctx, NULL, a0, b0);  /* 2 */
-    z2 = sexp_bignum_mul(ctx, NULL, a1, b1);  /* 3 */
-    z1 = sexp_bignum_sub(ctx, NULL, z1, z0);
-    z1 = sexp_bignum_sub(ctx, NULL, z1, z2);
-    z2 = sexp_bignum_shift(ctx, z2, 2*k);
-    z1 = sexp_bignum_shift(ctx, z1, k);
-    z1 = sexp_bignum_add(ctx, z1, z1, z0);
-    z1 = sexp_bignum_add(ctx, z1, z1, z2);
-    sexp_gc_release7(ctx);
-  }
-  sexp_bignum_sign(z1) = sexp_bignum_sign(a) * sexp_bignum_sign(b);
-  return z1;
+    res = sexp_make_bignum(ctx, alen + blen);
+    if (sexp_exceptionp(res)) return res;
+    tmp = NULL;
+    if (blen >= SEXP_KARATSUBA_THRESHOLD) {
+      tmp = (sexp_uint_t*) sexp_malloc(sexp_digits_mul_scratch(alen)*sizeof(sexp_uint_t));
+      if (! tmp) return sexp_global(ctx, SEXP_G_OOM_ERROR);
+    }
+    sexp_digits_mul(sexp_bignum_data(res), sexp_bignum_data(a), alen,
+                    bdata, blen, tmp);
+    if (tmp) sexp_free(tmp);
+  }
+  if (! sexp_exceptionp(res))
+    sexp_bignum_sign(res) = sexp_bignum_sign(a) * sexp_bignum_sign(b);
+  return res;
+}
+
+static int sexp_bignum_digit_clz (sexp_uint_t d) {
+  int n = 0;
+  if (! d) return SEXP_BIGNUM_BITS;
+  while (! (d & ((sexp_uint_t)1 << (SEXP_BIGNUM_BITS-1)))) {
+    d <<= 1;
+    n++;
+  }
+  return n;
+}
+
+/* a * 2^k as a new non-negative bignum */
+static sexp sexp_bignum_lsh (sexp ctx, sexp a, sexp_uint_t k) {
+  sexp_uint_t alen=sexp_bignum_hi(a), w=k/SEXP_BIGNUM_BITS,
+    s=k%SEXP_BIGNUM_BITS, i, *adata, *rdata;
+  sexp res = sexp_make_bignum(ctx, alen + w + 1);
+  if (sexp_exceptionp(res)) return res;
+  adata = sexp_bignum_data(a);
+  rdata = sexp_bignum_data(res);
+  for (i=0; i<alen; i++) {
+    rdata[i+w] |= adata[i] << s;
+    if (s) rdata[i+w+1] = adata[i] >> (SEXP_BIGNUM_BITS - s);
+  }
+  return res;
+}
+
+/* floor(a / 2^k) as a new non-negative bignum */
+static sexp sexp_bignum_rsh (sexp ctx, sexp a, sexp_uint_t k) {
+  sexp_uint_t alen=sexp_bignum_hi(a), w=k/SEXP_BIGNUM_BITS,
+    s=k%SEXP_BIGNUM_BITS, i, *adata, *rdata;
+  sexp res = sexp_make_bignum(ctx, alen > w ? alen - w : 1);
+  if (sexp_exceptionp(res)) return res;
+  adata = sexp_bignum_data(a);
+  rdata = sexp_bignum_data(res);
+  for (i=w; i<alen; i++) {
+    rdata[i-w] = adata[i] >> s;
+    if (s && i+1 < alen) rdata[i-w] |= adata[i+1] << (SEXP_BIGNUM_BITS - s);
+  }
+  return res;
+}
+
+/* Knuth's Algorithm D: divides the m+n+1 digits of u by the n >= 2 */
+/* digits of v, whose high bit must be set, leaving the m+1 digit   */
+/* quotient in q and the remainder in the low n digits of u         */
+static void sexp_bignum_divide_digits (sexp_uint_t *q, sexp_uint_t *u,
+                                       sexp_uint_t m, sexp_uint_t *v,
+                                       sexp_uint_t n) {
+  sexp_uint_t i, j, vh=v[n-1], vh2=v[n-2], qhat, p, t, borrow, carry;
+  sexp_luint_t num, rhat, prod;
+  for (j=m+1; j-- > 0; ) {
+    /* estimate qhat from the top two digits, off by at most 2 */
+    num = ((sexp_luint_t)u[j+n] << SEXP_BIGNUM_BITS) | u[j+n-1];
+    if (u[j+n] >= vh) {
+      qhat = SEXP_UINT_T_MAX;
+      rhat = num - (sexp_luint_t)qhat * vh;
+    } else {
+      qhat = (sexp_uint_t)(num / vh);
+      rhat = num - (sexp_luint_t)qhat * vh;
+    }
+    while ((rhat >> SEXP_BIGNUM_BITS) == 0
+           && (sexp_luint_t)qhat * vh2
+              > ((rhat << SEXP_BIGNUM_BITS) | u[j+n-2])) {
+      qhat--;
+      rhat += vh;
+    }
+    /* u[j..j+n] -= qhat * v */
+    for (i=0, carry=0, borrow=0; i<n; i++) {
+      prod = (sexp_luint_t)qhat * v[i] + carry;
+      carry = (sexp_uint_t)(prod >> SEXP_BIGNUM_BITS);
+      p = (sexp_uint_t)prod;
+      t = u[i+j] - p - borrow;
+      borrow = (u[i+j] < p) || (u[i+j] - p < borrow);
+      u[i+j] = t;
+    }
+    t = u[j+n] - carry - borrow;
+    borrow = (u[j+n] < carry) || (u[j+n] - carry < borrow);
+    u[j+n] = t;
+    /* we overshot by one, add back */
+    if (borrow) {
+      qhat--;
+      for (i=0, num=0; i<n; i++) {
+        num += (sexp_luint_t)u[i+j] + v[i];
+        u[i+j] = (sexp_uint_t)num;
+        num >>= SEXP_BIGNUM_BITS;
+      }
+      u[j+n] += (sexp_uint_t)num;
+    }
+    q[j] = qhat;
+  }
+}
+
+/* quotient and remainder of non-negative a and b, b >= 2 digits */
+static sexp sexp_bignum_divide_knuth (sexp ctx, sexp *rem, sexp a, sexp b) {
+  sexp_uint_t alen=sexp_bignum_hi(a), blen=sexp_bignum_hi(b), s;
+  sexp_gc_var3(q, u, v);
+  if (alen < blen || sexp_bignum_compare_abs(a, b) < 0) {
+    *rem = sexp_bignum_slice(ctx, a, 0, alen);
+    return sexp_make_bignum(ctx, 1);
+  }
+  sexp_gc_preserve3(ctx, q, u, v);
+  s = sexp_bignum_digit_clz(sexp_bignum_data(b)[blen-1]);
+  v = sexp_bignum_lsh(ctx, b, s);
+  u = sexp_bignum_lsh(ctx, a, s);
+  q = sexp_make_bignum(ctx, alen - blen + 1);
+  if (sexp_exceptionp(u) || sexp_exceptionp(v) || sexp_exceptionp(q)) {
+    *rem = q = sexp_exceptionp(u) ? u : sexp_exceptionp(v) ? v : q;
+  } else {
+    sexp_bignum_divide_digits(sexp_bignum_data(q), sexp_bignum_data(u),
+                              alen - blen, sexp_bignum_data(v), blen);
+    u = sexp_bignum_slice(ctx, u, 0, blen);
+    *rem = sexp_bignum_rsh(ctx, u, s);
+  }
+  sexp_gc_release3(ctx);
+  return q;
+}
+
+static void sexp_digits_div_3n2n (sexp_uint_t *q, sexp_uint_t *a,
+                                  sexp_uint_t *b, sexp_uint_t n,
+                                  sexp_uint_t *tmp);
+
+/* Burnikel-Ziegler recursive division of a[0..2n) < b*B^n by the n */
+/* digit b, whose high bit must be set, leaving the n digit quotient */
+/* in q and the remainder in a[0..n), with a[n..2n) zeroed           */
+static void sexp_digits_div_2n1n (sexp_uint_t *q, sexp_uint_t *a,
+                                  sexp_uint_t *b, sexp_uint_t n,
+                                  sexp_uint_t *tmp) {
+  sexp_uint_t h = n / 2;
+  if ((n & 1) || n < SEXP_BURNIKEL_ZIEGLER_THRESHOLD) {
+    sexp_bignum_divide_digits(q, a, n-1, b, n);
+  } else {
+    /* the high 3 half-digit blocks, then the remainder with the */
+    /* low block, which is already in place */
+    sexp_digits_div_3n2n(q+h, a+h, b, h, tmp);
+    sexp_digits_div_3n2n(q, a, b, h, tmp);
+  }
+}
+
+/* divide a[0..3n) < b*B^n by the 2n digit b, whose high bit must be */
+/* set, leaving the n digit quotient in q and the remainder in       */
+/* a[0..2n), with a[2n..3n) zeroed                                   */
+static void sexp_digits_div_3n2n (sexp_uint_t *q, sexp_uint_t *a,
+                                  sexp_uint_t *b, sexp_uint_t n,
+                                  sexp_uint_t *tmp) {
+  sexp_uint_t i, neg;
+  for (i=n; i-- > 0 && a[2*n+i] == b[n+i]; )
+    ;
+  if (i < n && a[2*n+i] < b[n+i]) {
+    sexp_digits_div_2n1n(q, a+n, b+n, n, tmp);
+  } else {
+    /* the high digits are equal: q = B^n - 1, and the remainder */
+    /* [a1 a2] - q*b1 = [a1 a2] - b1*B^n + b1 = a2 + b1          */
+    for (i=0; i<n; i++)
+      q[i] = SEXP_UINT_T_MAX;
+    memset(a+2*n, 0, n*sizeof(sexp_uint_t));
+    sexp_digits_add_to(a+n, 2*n, b+n, n);
+  }
+  /* subtract q*b2, adding back b while negative (at most twice) */
+  sexp_digits_mul(tmp, q, n, b, n, tmp+2*n);
+  neg = sexp_digits_sub_from(a, 3*n, tmp, 2*n);
+  while (neg) {
+    if (sexp_digits_add_to(a, 3*n, b, 2*n))
+      neg = 0;
+    for (i=0; q[i]-- == 0; i++)
+      ;
+  }
+}
+
+/* quotient and remainder of non-negative a and b, b >= 2 digits */
+static sexp sexp_bignum_divide_bz (sexp ctx, sexp *rem, sexp a, sexp b) {
+  sexp_uint_t blen=sexp_bignum_hi(b), m, n, s, t, i, *tmp;
+  sexp_gc_var4(q, r, an, bn);
+  sexp_gc_preserve4(ctx, q, r, an, bn);
+  /* pad b to n = j*2^k digits with the high bit set, j <= threshold */
+  for (m=1; blen/m > SEXP_BURNIKEL_ZIEGLER_THRESHOLD; m <<= 1)
+    ;
+  n = ((blen + m - 1) / m) * m;
+  s = (n - blen) * SEXP_BIGNUM_BITS
+    + sexp_bignum_digit_clz(sexp_bignum_data(b)[blen-1]);
+  bn = sexp_bignum_lsh(ctx, b, s);
+  r = sexp_bignum_lsh(ctx, a, s);
+  if (sexp_exceptionp(bn) || sexp_exceptionp(r)) {
+    *rem = q = sexp_exceptionp(bn) ? bn : r;
+    sexp_gc_release4(ctx);
+    return q;
+  }
+  /* long division by n digit blocks, the top block less than bn */
+  t = sexp_bignum_hi(r) / n + 1;
+  an = sexp_bignum_slice(ctx, r, 0, t*n);
+  q = sexp_make_bignum(ctx, (t - 1) * n);
+  tmp = (sexp_uint_t*) sexp_malloc((sexp_digits_mul_scratch(n) + 2*n)
+                                   * sizeof(sexp_uint_t));
+  if (! tmp) {
+    *rem = q = sexp_global(ctx, SEXP_G_OOM_ERROR);
+  } else if (sexp_exceptionp(an) || sexp_exceptionp(q)) {
+    *rem = q = sexp_exceptionp(an) ? an : q;
+  } else {
+    for (i=t-1; i-- > 0; )
+      sexp_digits_div_2n1n(sexp_bignum_data(q) + i*n,
+                           sexp_bignum_data(an) + i*n,
+                           sexp_bignum_data(bn), n, tmp);
+    *rem = sexp_bignum_rsh(ctx, an, s);
+  }
+  if (tmp) sexp_free(tmp);
+  sexp_gc_release4(ctx);
+  return q;
 }
 
 sexp sexp_bignum_quot_rem (sexp ctx, sexp *rem, sexp a, sexp b) {
-  sexp_luint_t d, dn, dd;
-  sexp_uint_t dlo, dhi;
-  sexp_sint_t alen, blen=sexp_bignum_hi(b), sign=1, off=0;
-  sexp_gc_var5(q, x, y, a1, b1);
+  sexp_sint_t blen=sexp_bignum_hi(b);
+  sexp_gc_var3(q, a1, b1);
   if (blen == 1 && sexp_bignum_data(b)[0] == 0)
     return sexp_xtype_exception(ctx, NULL, "divide by zero", a);
-  sexp_gc_preserve5(ctx, q, x, y, a1, b1);
-  a1 = sexp_copy_bignum(ctx, NULL, a, 0);
-  sexp_bignum_sign(a1) = 1;
+  sexp_gc_preserve3(ctx, q, a1, b1);
   /* fast path for single bigit divisor */
   if (blen == 1) {
+    a1 = sexp_copy_bignum(ctx, NULL, a, 0);
+    sexp_bignum_sign(a1) = 1;
     b1 = sexp_make_bignum(ctx, 1);
     sexp_bignum_data(b1)[0] = sexp_bignum_fxdiv(ctx, a1, sexp_bignum_data(b)[0], 0);
     *rem = sexp_bignum_normalize(b1);
@@ -510,83 +1113,25 @@ sexp sexp_bignum_quot_rem (sexp ctx, sexp *rem, sexp a, sexp b) {
     if (sexp_bignum_sign(a) < 0) {
       sexp_negate_exact(*rem);
     }
-    sexp_gc_release5(ctx);
+    sexp_gc_release3(ctx);
     return a1;
   }
   /* general case */
-  b1 = sexp_copy_bignum(ctx, NULL, b, 0);
-  sexp_bignum_sign(b1) = 1;
-  q = SEXP_ZERO;
-  x = sexp_make_bignum(ctx, sexp_bignum_length(a));
-  while (sexp_bignum_compare_abs(a1, b1) >= 0) { /* a1, b1 at least 2 bigits */
-    /* guess divisor x */
-    alen = sexp_bignum_hi(a1);
-    sexp_bignum_data(x)[off] = 0;
-    if (off > 0) sexp_bignum_data(x)[off-1] = 0;
-    off = alen - blen + 1;
-    dn = (((sexp_luint_t)sexp_bignum_data(a1)[alen-1]
-           << (sizeof(sexp_uint_t)*8))
-          + sexp_bignum_data(a1)[alen-2]);
-    dd = (((sexp_luint_t)sexp_bignum_data(b1)[blen-1]
-           << (sizeof(sexp_uint_t)*8))
-          + sexp_bignum_data(b1)[blen-2]);
-    if (alen > 2 && blen > 2 &&
-        sexp_bignum_data(a1)[alen-1] < (1uL<<(sizeof(sexp_uint_t)*4)) &&
-        sexp_bignum_data(b1)[blen-1] < (1uL<<(sizeof(sexp_uint_t)*4))) {
-      dn = (dn << (sizeof(sexp_uint_t)*4))
-        + (sexp_bignum_data(a1)[alen-3] >> (sizeof(sexp_uint_t)*4));
-      dd = (dd << (sizeof(sexp_uint_t)*4))
-        + (sexp_bignum_data(b1)[blen-3] >> (sizeof(sexp_uint_t)*4));
-    }
-    d = dn / dd;
-    if (d == 0) {
-      dn = (((sexp_luint_t)sexp_bignum_data(a1)[alen-1]
-             << (sizeof(sexp_uint_t)*8))
-            + sexp_bignum_data(a1)[alen-2]);
-      dd = sexp_bignum_data(b1)[blen-1];
-      if (sexp_bignum_data(a1)[alen-1] < (1uL<<(sizeof(sexp_uint_t)*4)) &&
-          sexp_bignum_data(b1)[blen-1] < (1uL<<(sizeof(sexp_uint_t)*4))) {
-        dn = (dn << (sizeof(sexp_uint_t)*4))
-          + (sexp_bignum_data(a1)[alen-3] >> (sizeof(sexp_uint_t)*4));
-        dd = (dd << (sizeof(sexp_uint_t)*4))
-          + (sexp_bignum_data(b1)[blen-2] >> (sizeof(sexp_uint_t)*4));
-      }
-      d = dn / dd;
-      off--;
-    }
-    dhi = d >> (sizeof(sexp_uint_t)*8);
-    dlo = d & (((sexp_luint_t)1<<(sizeof(sexp_uint_t)*8))-1);
-    sexp_bignum_data(x)[off] = dhi;
-    if (off > 0) sexp_bignum_data(x)[off-1] = dlo;
-    /* update quotient q and remainder a1 estimates */
-    y = sexp_bignum_mul(ctx, NULL, b1, x);
-    if (sign < 0) {
-      a1 = sexp_bignum_add(ctx, NULL, a1, y);
-      q = sexp_sub(ctx, q, x);
-    } else {
-      a1 = sexp_bignum_sub(ctx, NULL, a1, y);
-      q = sexp_add(ctx, q, x);
-    }
-    /* flip the sign if we overshot in our estimate */
-    if (sexp_bignum_sign(a1) != sign) {
-      sexp_bignum_sign(a1) = (char)(-sign);
-      sign *= -1;
-    }
+  if (blen < SEXP_BURNIKEL_ZIEGLER_THRESHOLD
+      || sexp_bignum_hi(a) < blen + SEXP_BURNIKEL_ZIEGLER_THRESHOLD)
+    q = sexp_bignum_divide_knuth(ctx, &a1, a, b);
+  else
+    q = sexp_bignum_divide_bz(ctx, &a1, a, b);
+  if (sexp_exceptionp(q) || sexp_exceptionp(a1)) {
+    sexp_gc_release3(ctx);
+    return *rem = sexp_exceptionp(q) ? q : a1;
   }
   /* adjust signs */
-  a1 = sexp_bignum_normalize(a1);
-  if (sign < 0 && a1 != SEXP_ZERO) {
-    q = sexp_sub(ctx, q, SEXP_ONE);
-    a1 = sexp_add(ctx, a1, b1);
-  }
-  *rem = a1;
-  if (sexp_bignum_sign(a) * sexp_bignum_sign(b) < 0) {
-    sexp_negate_exact(q);
-  }
-  if (sexp_bignum_sign(a) < 0) {
-    sexp_negate_exact(*rem);
-  }
-  sexp_gc_release5(ctx);
+  sexp_bignum_sign(q) = sexp_bignum_sign(a) * sexp_bignum_sign(b);
+  sexp_bignum_sign(a1) = sexp_bignum_sign(a);
+  *rem = sexp_bignum_normalize(a1);
+  q = sexp_bignum_normalize(q);
+  sexp_gc_release3(ctx);
   return q;
 }
 
@@ -607,15 +1152,141 @@ sexp sexp_bignum_remainder (sexp ctx, sexp a, sexp b) {
   return rem;
 }
 
+/* Lehmer's gcd: runs Euclid on the leading bits of a and b in single */
+/* precision, then applies the accumulated cofactors to the full     */
+/* numbers, falling back on a full division step when the leading    */
+/* bits alone don't determine the quotient                          */
+
+#define SEXP_LEHMER_BITS (SEXP_BIGNUM_BITS-3)
+
+static sexp_uint_t sexp_digit_gcd (sexp_uint_t a, sexp_uint_t b) {
+  sexp_uint_t t;
+  while (b) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* the SEXP_LEHMER_BITS bits of a starting at bit k */
+static sexp_uint_t sexp_bignum_bits_at (sexp a, sexp_uint_t k) {
+  sexp_uint_t alen=sexp_bignum_length(a), w=k/SEXP_BIGNUM_BITS,
+    s=k%SEXP_BIGNUM_BITS, *adata=sexp_bignum_data(a), res=0;
+  if (w < alen) res = adata[w] >> s;
+  if (s && w+1 < alen) res |= adata[w+1] << (SEXP_BIGNUM_BITS - s);
+  return res & (((sexp_uint_t)1 << SEXP_LEHMER_BITS) - 1);
+}
+
+/* a, b = ua + vb, xa + yb, the results are known to be non-negative */
+static void sexp_bignum_lehmer_update (sexp a, sexp b, sexp_uint_t len,
+                                       sexp_sint_t u, sexp_sint_t v,
+                                       sexp_sint_t x, sexp_sint_t y) {
+  sexp_uint_t *adata=sexp_bignum_data(a), *bdata=sexp_bignum_data(b), i;
+  sexp_lsint_t s=0, t=0;
+  for (i=0; i<len; i++) {
+    s += (sexp_lsint_t)u*adata[i] + (sexp_lsint_t)v*bdata[i];
+    t += (sexp_lsint_t)x*adata[i] + (sexp_lsint_t)y*bdata[i];
+    adata[i] = (sexp_uint_t)s;
+    bdata[i] = (sexp_uint_t)t;
+    s >>= SEXP_BIGNUM_BITS;
+    t >>= SEXP_BIGNUM_BITS;
+  }
+}
+
+sexp sexp_bignum_gcd (sexp ctx, sexp a, sexp b) {
+  sexp_uint_t alen, k, ah, bh, q;
+  sexp_sint_t u, v, x, y, tmp;
+  sexp_gc_var3(a1, b1, r);
+  sexp_gc_preserve3(ctx, a1, b1, r);
+  if (sexp_bignum_compare_abs(a, b) < 0) {
+    r = a; a = b; b = r;
+  }
+  a1 = sexp_copy_bignum(ctx, NULL, a, 0);
+  b1 = sexp_copy_bignum(ctx, NULL, b, sexp_bignum_length(a));
+  sexp_bignum_sign(a1) = sexp_bignum_sign(b1) = 1;
+  while (sexp_bignum_hi(b1) > 1) {
+    alen = sexp_bignum_hi(a1);
+    if (sexp_bignum_hi(b1) + 1 < alen) {
+      u = v = 0;                /* b much smaller, just divide */
+    } else {
+      k = (alen - 1) * SEXP_BIGNUM_BITS
+        + (SEXP_BIGNUM_BITS - sexp_bignum_digit_clz(sexp_bignum_data(a1)[alen-1]))
+        - SEXP_LEHMER_BITS;
+      ah = sexp_bignum_bits_at(a1, k);
+      bh = sexp_bignum_bits_at(b1, k);
+      u = 1; v = 0; x = 0; y = 1;
+      /* stop once the quotients of the extremes disagree (Knuth 4.5.2) */
+      while ((sexp_sint_t)bh + x != 0 && (sexp_sint_t)bh + y != 0) {
+        q = ((sexp_sint_t)ah + u) / ((sexp_sint_t)bh + x);
+        if (q != ((sexp_sint_t)ah + v) / ((sexp_sint_t)bh + y))
+          break;
+        tmp = u - (sexp_sint_t)q*x; u = x; x = tmp;
+        tmp = v - (sexp_sint_t)q*y; v = y; y = tmp;
+        tmp = ah - q*bh; ah = bh; bh = tmp;
+      }
+    }
+    if (v == 0) {
+      sexp_bignum_quot_rem(ctx, &r, a1, b1);
+      if (sexp_exceptionp(r)) {
+        a1 = r;
+        break;
+      }
+      a1 = b1;
+      b1 = sexp_fixnump(r) ? sexp_fixnum_to_bignum(ctx, r)
+        : sexp_copy_bignum(ctx, NULL, r, sexp_bignum_length(a1));
+    } else {
+      sexp_bignum_lehmer_update(a1, b1, alen, u, v, x, y);
+    }
+  }
+  if (! sexp_exceptionp(a1) && sexp_bignum_data(b1)[0]) {
+    /* b1 is a single digit, finish in single precision */
+    for (k=sexp_bignum_hi(a1), q=0; k-- > 0; )
+      q = (sexp_uint_t)((((sexp_luint_t)q << SEXP_BIGNUM_BITS)
+                         + sexp_bignum_data(a1)[k])
+                        % sexp_bignum_data(b1)[0]);
+    a1 = sexp_make_unsigned_integer(ctx, sexp_digit_gcd(sexp_bignum_data(b1)[0], q));
+  }
+  sexp_gc_release3(ctx);
+  return sexp_bignum_normalize(a1);
+}
+
+sexp sexp_gcd (sexp ctx, sexp a, sexp b) {
+  sexp_uint_t x, y;
+  sexp_gc_var2(a1, b1);
+  if (sexp_fixnump(a) && sexp_fixnump(b)) {
+    x = sexp_unbox_fx_abs(a);
+    y = sexp_unbox_fx_abs(b);
+    return sexp_make_unsigned_integer(ctx, sexp_digit_gcd(x, y));
+  }
+  if (! sexp_exact_integerp(a))
+    return sexp_type_exception(ctx, NULL, SEXP_FIXNUM, a);
+  if (! sexp_exact_integerp(b))
+    return sexp_type_exception(ctx, NULL, SEXP_FIXNUM, b);
+  sexp_gc_preserve2(ctx, a1, b1);
+  a1 = sexp_fixnump(a) ? sexp_fixnum_to_bignum(ctx, a) : a;
+  b1 = sexp_fixnump(b) ? sexp_fixnum_to_bignum(ctx, b) : b;
+  a1 = sexp_bignum_gcd(ctx, a1, b1);
+  sexp_gc_release2(ctx);
+  return a1;
+}
+
+/* left-to-right binary powering, so that the multiplications are */
+/* by the (usually small) base rather than the partial powers      */
 sexp sexp_bignum_expt (sexp ctx, sexp a, sexp b) {
-  sexp_sint_t e = sexp_unbox_fx_abs(b);
+  sexp_sint_t e = sexp_unbox_fx_abs(b), bit;
   sexp_gc_var2(res, acc);
+  if (e == 0) return SEXP_ONE;
   sexp_gc_preserve2(ctx, res, acc);
-  res = sexp_fixnum_to_bignum(ctx, SEXP_ONE);
   acc = sexp_copy_bignum(ctx, NULL, a, 0);
-  for (; e; e>>=1, acc=sexp_bignum_mul(ctx, NULL, acc, acc))
-    if (e & 1)
+  res = acc;
+  for (bit=1; (bit<<1) <= e; bit<<=1)
+    ;
+  for (bit>>=1; bit; bit>>=1) {
+    res = sexp_bignum_mul(ctx, NULL, res, res);
+    if (e & bit)
       res = sexp_bignum_mul(ctx, NULL, res, acc);
+  }
   sexp_gc_release2(ctx);
   return sexp_bignum_normalize(res);
 }
@@ -623,23 +1294,26 @@ sexp sexp_bignum_expt (sexp ctx, sexp a, sexp b) {
 #if SEXP_USE_MATH
 
 /*
- * a = x * 2^2n, with 0.1 <= x < 1.0 (base 2)  =>  sqrt(a) ~ 2^n
+ * a = x * 2^4k  =>  sqrt(a) ~ floor(sqrt(floor(a / 2^2k))) * 2^k
+ *
+ * The estimate is within 2^k of sqrt(a), and being computed
+ * recursively on a quarter of the bits, a single full precision
+ * Newton step is usually all that's needed to finish.
  */
 sexp sexp_bignum_sqrt_estimate (sexp ctx, sexp a) {
-  sexp_uint_t alen=sexp_bignum_hi(a), adata_hi;
-  int nbits, i;
-  sexp_gc_var1(res);
-
-  adata_hi = sexp_bignum_data(a)[alen - 1];
-  for (i = sizeof(sexp_uint_t)*8-1; i > 0; i--)
-    if (adata_hi & (1ul << i))
-      break;
-  nbits = sizeof(sexp_uint_t) * 8 * (alen - 1) + i + 1;
-
-  sexp_gc_preserve1(ctx, res);
-  res = sexp_fixnum_to_bignum(ctx, SEXP_TWO);
-  res = sexp_bignum_expt(ctx, res, sexp_make_fixnum(nbits / 2));
-  sexp_gc_release1(ctx);
+  sexp_uint_t alen=sexp_bignum_hi(a), k;
+  sexp_gc_var2(res, rem);
+  k = ((alen - 1) * SEXP_BIGNUM_BITS
+       + SEXP_BIGNUM_BITS - sexp_bignum_digit_clz(sexp_bignum_data(a)[alen-1]))
+    / 4;
+  sexp_gc_preserve2(ctx, res, rem);
+  res = sexp_bignum_rsh(ctx, a, 2*k);
+  res = sexp_bignum_sqrt(ctx, res, &rem);
+  if (sexp_fixnump(res))
+    res = sexp_fixnum_to_bignum(ctx, res);
+  if (! sexp_exceptionp(res))
+    res = sexp_bignum_lsh(ctx, res, k);
+  sexp_gc_release2(ctx);
   return res;
 }
 
@@ -660,7 +1334,7 @@ sexp sexp_bignum_sqrt (sexp ctx, sexp a, sexp* rem_out) {
   res = sexp_inexact_sqrt(ctx, NULL, 1, res);
   if (sexp_flonump(res) &&
       sexp_flonum_value(res) > SEXP_MAX_ACCURATE_FLONUM_SQRT) {
-    if (isinf(sexp_flonum_value(res)))
+    if (isinf(sexp_flonum_value(res)) || sexp_bignum_hi(a) > 4)
       res = sexp_bignum_sqrt_estimate(ctx, a);
     else
       res = sexp_double_to_bignum(ctx, sexp_flonum_value(res));
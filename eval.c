@@ -1259,15 +1259,19 @@ sexp sexp_open_binary_output_file (sexp ctx, sexp self, sexp_sint_t n, sexp path
 }
 
 sexp sexp_close_port_op (sexp ctx, sexp self, sexp_sint_t n, sexp port) {
-  sexp res = SEXP_VOID;
+  sexp_gc_var1(res);
   sexp_assert_type(ctx, sexp_portp, SEXP_OPORT, port);
   /* we can't run arbitrary scheme code in the finalizer, so we need */
   /* to flush and run the closer here */
   if (sexp_port_customp(port)) {
-    if (sexp_oportp(port)) res = sexp_flush_output(ctx, port);
-    if (sexp_exceptionp(res)) return res;
-    if (sexp_applicablep(sexp_port_closer(port)))
-      res = sexp_apply1(ctx, sexp_port_closer(port), port);
+    sexp_gc_preserve1(ctx, res);
+    res = sexp_oportp(port) ? sexp_flush_output(ctx, port) : SEXP_VOID;
+    if (!sexp_exceptionp(res) && sexp_applicablep(sexp_port_closer(port))) {
+      res = sexp_list1(ctx, port);
+      if (!sexp_exceptionp(res))
+        res = sexp_apply_callback(ctx, sexp_port_closer(port), res);
+    }
+    sexp_gc_release1(ctx);
     if (sexp_exceptionp(res)) return res;
   }
   return sexp_finalize_port(ctx, self, n, port);
@@ -1700,7 +1704,32 @@ sexp sexp_expt_op (sexp ctx, sexp self, sexp_sint_t n, sexp x, sexp e) {
 #if SEXP_USE_RATIOS
   else if (sexp_ratiop(x)) {
     if (sexp_fixnump(e)) {
-      return sexp_generic_expt(ctx, x, sexp_unbox_fixnum(e));
+      /* the numerator and denominator are coprime, and so are their */
+      /* powers, so no normalization is needed */
+      sexp_gc_var(den, s_den);
+      if (e == SEXP_ZERO) return SEXP_ONE;
+      sexp_gc_preserve1(ctx, tmp);
+      sexp_gc_preserve(ctx, den, s_den);
+      tmp = sexp_make_fixnum(sexp_unbox_fx_abs(e));
+      res = den = sexp_expt_op(ctx, self, n, sexp_ratio_denominator(x), tmp);
+      tmp = sexp_expt_op(ctx, self, n, sexp_ratio_numerator(x), tmp);
+      if (! sexp_exceptionp(tmp) && ! sexp_exceptionp(res)) {
+        if (sexp_unbox_fixnum(e) > 0) {
+          res = sexp_make_ratio(ctx, tmp, res);
+        } else if (tmp == SEXP_ONE || tmp == SEXP_NEG_ONE) {
+          if (tmp == SEXP_NEG_ONE) res = sexp_mul(ctx, res, tmp);
+        } else {
+          if (sexp_exact_negativep(tmp)) {
+            tmp = sexp_mul(ctx, tmp, SEXP_NEG_ONE);
+            res = sexp_mul(ctx, res, SEXP_NEG_ONE);
+          }
+          res = sexp_make_ratio(ctx, res, tmp);
+        }
+      } else if (sexp_exceptionp(tmp)) {
+        res = tmp;
+      }
+      sexp_gc_release1(ctx);
+      return res;
     } else {
       x1 = sexp_ratio_to_double(x);
     }
@@ -1739,6 +1768,21 @@ sexp sexp_expt_op (sexp ctx, sexp self, sexp_sint_t n, sexp x, sexp e) {
 #endif  /* !SEXP_USE_FLONUMS */
 }
 
+sexp sexp_gcd_op (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp b) {
+#if SEXP_USE_BIGNUMS
+  sexp_assert_type(ctx, sexp_exact_integerp, SEXP_FIXNUM, a);
+  sexp_assert_type(ctx, sexp_exact_integerp, SEXP_FIXNUM, b);
+  return sexp_gcd(ctx, a, b);
+#else
+  sexp_sint_t x, y, t;
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, a);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, b);
+  for (x=sexp_unbox_fixnum(a), y=sexp_unbox_fixnum(b); y; x=y, y=t)
+    t = x % y;
+  return sexp_make_fixnum(x < 0 ? -x : x);
+#endif
+}
+
 #if SEXP_USE_RATIOS
 sexp sexp_ratio_numerator_op (sexp ctx, sexp self, sexp_sint_t n, sexp rat) {
   sexp_assert_type(ctx, sexp_ratiop, SEXP_RATIO, rat);
@@ -1906,6 +1950,7 @@ void sexp_string_utf8_set (sexp ctx, sexp str, sexp index, sexp ch) {
       p = q + i;
     }
     sexp_string_size(str) += new_len - old_len;
+    sexp_string_index_invalidate(str);
   }
   sexp_utf8_encode_char(p, new_len, c);
 }
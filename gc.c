@@ -282,6 +282,172 @@ void sexp_conservative_mark (sexp ctx) {
 #endif
 
 #if SEXP_USE_WEAK_REFERENCES
+/* the extra slots following the weak ones (e.g. ephemeron values) */
+/* are only traced once a weak slot has been reached by other means */
+static int sexp_mark_ephemeron_objects (sexp ctx) {
+  int i, len, changed=0, live_p;
+  sexp_heap h;
+  sexp p, t, end, *v;
+  sexp_free_list q, r;
+  for (h = sexp_context_heap(ctx) ; h; h=h->next) {
+    p = sexp_heap_first_block(h);
+    q = h->free_list;
+    end = sexp_heap_end(h);
+    while (p < end) {
+      for (r=q->next; r && ((char*)r<(char*)p); q=r, r=r->next)
+        ;
+      if ((char*)r == (char*)p) { /* this is a free block, skip it */
+        p = (sexp) (((char*)p) + r->size);
+        continue;
+      }
+      if (sexp_valid_object_p(ctx, p) && sexp_markedp(p)) {
+        t = sexp_object_type(ctx, p);
+        if (sexp_type_weak_base(t) > 0 && sexp_type_weak_len_extra(t) > 0) {
+          v = (sexp*) ((char*)p + sexp_type_weak_base(t));
+          len = sexp_type_num_weak_slots_of_object(t, p);
+          for (i=0, live_p=0; i<len; i++)
+            if (!(v[i] && sexp_pointerp(v[i])) || sexp_markedp(v[i]))
+              live_p = 1;
+          if (live_p) {
+            for (len += sexp_type_weak_len_extra(t); i<len; i++) {
+              if (v[i] && sexp_pointerp(v[i]) && !sexp_markedp(v[i])) {
+                sexp_mark(ctx, v[i]);
+                changed = 1;
+              }
+            }
+          }
+        }
+      }
+      p = (sexp) (((char*)p)+sexp_heap_align(sexp_allocated_bytes(ctx, p)));
+    }
+  }
+  return changed;
+}
+
+/* Weak hash tables are kept in a list which, along with the tables' */
+/* entry vectors, is marked up front so that marking doesn't trace */
+/* into them.  Once the rest of the heap is marked, the strong keys */
+/* and values of the live tables are marked, and entries whose weak */
+/* references weren't reached are removed.  This only ever looks at */
+/* the weak tables, not the whole heap. */
+
+#define sexp_weak_livep(x) (!((x) && sexp_pointerp(x)) || sexp_markedp(x))
+
+static void sexp_premark_weak_tables (sexp ctx) {
+  sexp ls, ht;
+  for (ls=sexp_global(ctx, SEXP_G_WEAK_TABLES); sexp_pairp(ls); ls=sexp_cdr(ls)) {
+    sexp_markedp(ls) = 1;
+    ht = sexp_car(ls);
+    if (sexp_vectorp(sexp_hash_table_entries(ht)))
+      sexp_markedp(sexp_hash_table_entries(ht)) = 1;
+    if (sexp_vectorp(sexp_hash_table_old_entries(ht)))
+      sexp_markedp(sexp_hash_table_old_entries(ht)) = 1;
+  }
+}
+
+static int sexp_mark_weak_entries (sexp ctx, sexp vec, int weakness) {
+  sexp_uint_t i, len;
+  sexp *data;
+  int changed = 0;
+  if (! sexp_vectorp(vec))
+    return 0;
+  len = sexp_vector_length(vec);
+  data = sexp_vector_data(vec);
+  for (i=0; i+2<len; i+=3) {
+    if (! sexp_fixnump(data[i]))
+      continue;
+    if (! (weakness & (SEXP_WEAK_KEYS|SEXP_EPHEMERAL_KEYS))
+        && ! sexp_weak_livep(data[i+1])) {
+      sexp_mark(ctx, data[i+1]);
+      changed = 1;
+    }
+    if (! (weakness & SEXP_WEAK_VALUES)
+        && ! sexp_weak_livep(data[i+2])
+        && (! (weakness & SEXP_EPHEMERAL_KEYS) || sexp_weak_livep(data[i+1]))) {
+      sexp_mark(ctx, data[i+2]);
+      changed = 1;
+    }
+  }
+  return changed;
+}
+
+static int sexp_mark_weak_tables (sexp ctx) {
+  sexp ls, ht;
+  int changed = 0, weakness;
+  for (ls=sexp_global(ctx, SEXP_G_WEAK_TABLES); sexp_pairp(ls); ls=sexp_cdr(ls)) {
+    ht = sexp_car(ls);
+    if (sexp_markedp(ht)) {
+      weakness = sexp_unbox_fixnum(sexp_hash_table_weakness(ht));
+      changed |= sexp_mark_weak_entries(ctx, sexp_hash_table_entries(ht), weakness);
+      changed |= sexp_mark_weak_entries(ctx, sexp_hash_table_old_entries(ht), weakness);
+    }
+  }
+  return changed;
+}
+
+static sexp_sint_t sexp_reset_weak_entries (sexp vec, int weakness) {
+  sexp_uint_t i, len;
+  sexp_sint_t removed = 0;
+  sexp *data;
+  if (! sexp_vectorp(vec))
+    return 0;
+  len = sexp_vector_length(vec);
+  data = sexp_vector_data(vec);
+  for (i=0; i+2<len; i+=3) {
+    if (sexp_fixnump(data[i])
+        && (((weakness & (SEXP_WEAK_KEYS|SEXP_EPHEMERAL_KEYS))
+             && ! sexp_weak_livep(data[i+1]))
+            || ((weakness & SEXP_WEAK_VALUES) && ! sexp_weak_livep(data[i+2])))) {
+      data[i] = SEXP_TRUE;
+      data[i+1] = data[i+2] = SEXP_FALSE;
+      removed++;
+    }
+  }
+  return removed;
+}
+
+static void sexp_reset_weak_tables (sexp ctx) {
+  sexp ls, next, prev=NULL, ht;
+  sexp_sint_t removed;
+  int weakness;
+  for (ls=sexp_global(ctx, SEXP_G_WEAK_TABLES); sexp_pairp(ls); ls=next) {
+    next = sexp_cdr(ls);
+    ht = sexp_car(ls);
+    if (! sexp_markedp(ht)) {
+      /* the table itself is garbage, so let it and its entries go */
+      if (sexp_vectorp(sexp_hash_table_entries(ht)))
+        sexp_markedp(sexp_hash_table_entries(ht)) = 0;
+      if (sexp_vectorp(sexp_hash_table_old_entries(ht)))
+        sexp_markedp(sexp_hash_table_old_entries(ht)) = 0;
+      sexp_markedp(ls) = 0;
+      if (prev)
+        sexp_cdr(prev) = next;
+      else
+        sexp_global(ctx, SEXP_G_WEAK_TABLES) = next;
+      continue;
+    }
+    weakness = sexp_unbox_fixnum(sexp_hash_table_weakness(ht));
+    removed = sexp_reset_weak_entries(sexp_hash_table_entries(ht), weakness);
+    sexp_hash_table_deleted(ht)
+      = sexp_make_fixnum(sexp_unbox_fixnum(sexp_hash_table_deleted(ht)) + removed);
+    removed += sexp_reset_weak_entries(sexp_hash_table_old_entries(ht), weakness);
+    sexp_hash_table_size(ht)
+      = sexp_make_fixnum(sexp_unbox_fixnum(sexp_hash_table_size(ht)) - removed);
+    prev = ls;
+  }
+}
+
+/* marking ephemeron values or strong parts of weak tables may reach */
+/* more keys, so repeat until no new values are marked */
+static void sexp_mark_ephemerons (sexp ctx) {
+  int changed;
+  do {
+    changed = sexp_mark_weak_tables(ctx);
+    if (sexp_truep(sexp_global(ctx, SEXP_G_WEAK_OBJECTS_PRESENT)))
+      changed |= sexp_mark_ephemeron_objects(ctx);
+  } while (changed);
+}
+
 int sexp_reset_weak_references(sexp ctx) {
   int i, len, broke, all_reset_p;
   sexp_heap h;
@@ -331,7 +497,10 @@ int sexp_reset_weak_references(sexp ctx) {
   return broke;
 }
 #else
+#define sexp_premark_weak_tables(ctx)
+#define sexp_mark_ephemerons(ctx)
 #define sexp_reset_weak_references(ctx) 0
+#define sexp_reset_weak_tables(ctx)
 #endif
 
 #if SEXP_USE_FINALIZERS
@@ -458,14 +627,43 @@ sexp sexp_sweep (sexp ctx, size_t *sum_freed_ptr) {
   return sexp_make_fixnum(max_freed);
 }
 
-#if SEXP_USE_GLOBAL_SYMBOLS
-void sexp_mark_global_symbols(sexp ctx) {
-  int i;
-  for (i=0; i<SEXP_SYMBOL_TABLE_SIZE; i++)
-    sexp_mark(ctx, sexp_symbol_table[i]);
+#if SEXP_USE_WEAK_REFERENCES
+/* The symbol table holds its symbols weakly.  The table itself is */
+/* marked up front so that marking doesn't trace into it, and the */
+/* slots of symbols left unmarked are cleared before sweeping, */
+/* except for those interned since the last collection. */
+static void sexp_mark_symbol_table (sexp ctx) {
+  if (sexp_vectorp(sexp_context_symbols(ctx)))
+    sexp_markedp(sexp_context_symbols(ctx)) = 1;
+}
+
+static void sexp_reset_weak_symbols (sexp ctx) {
+  sexp_uint_t i, len;
+  sexp *data;
+  if (! sexp_vectorp(sexp_context_symbols(ctx)))
+    return;
+  len = sexp_vector_length(sexp_context_symbols(ctx));
+  data = sexp_vector_data(sexp_context_symbols(ctx));
+  for (i=0; i<len; i++) {
+    if (sexp_lsymbolp(data[i])) {
+      if (sexp_markedp(data[i])) {
+        sexp_lsymbol_newp(data[i]) = 0;
+      } else if (sexp_lsymbol_newp(data[i])) {
+        sexp_lsymbol_newp(data[i]) = 0;
+        sexp_markedp(data[i]) = 1;
+      } else {
+        data[i] = SEXP_VOID;
+      }
+    }
+  }
 }
 #else
-#define sexp_mark_global_symbols(ctx)
+#if SEXP_USE_GLOBAL_SYMBOLS
+#define sexp_mark_symbol_table(ctx) sexp_mark(ctx, sexp_symbol_table)
+#else
+#define sexp_mark_symbol_table(ctx)
+#endif
+#define sexp_reset_weak_symbols(ctx)
 #endif
 
 sexp sexp_gc (sexp ctx, size_t *sum_freed) {
@@ -477,10 +675,14 @@ sexp sexp_gc (sexp ctx, size_t *sum_freed) {
   sexp_debug_printf("%p (heap: %p size: %lu)", ctx, sexp_context_heap(ctx),
                     sexp_heap_total_size(sexp_context_heap(ctx)));
 #endif
-  sexp_mark_global_symbols(ctx);
+  sexp_mark_symbol_table(ctx);
+  sexp_premark_weak_tables(ctx);
   sexp_mark(ctx, ctx);
   sexp_conservative_mark(ctx);
+  sexp_mark_ephemerons(ctx);
   sexp_reset_weak_references(ctx);
+  sexp_reset_weak_symbols(ctx);
+  sexp_reset_weak_tables(ctx);
   finalized = sexp_finalize(ctx);
   res = sexp_sweep(ctx, sum_freed);
 #if SEXP_USE_TIME_GC
@@ -35,6 +35,8 @@ SEXP_API sexp sexp_bignum_mul (sexp ctx, sexp dst, sexp a, sexp b);
 SEXP_API sexp sexp_bignum_div (sexp ctx, sexp dst, sexp a, sexp b);
 SEXP_API sexp sexp_bignum_expt (sexp ctx, sexp n, sexp e);
 SEXP_API sexp sexp_bignum_sqrt (sexp ctx, sexp a, sexp* rem);
+SEXP_API sexp sexp_bignum_gcd (sexp ctx, sexp a, sexp b);
+SEXP_API sexp sexp_gcd (sexp ctx, sexp a, sexp b);
 SEXP_API sexp sexp_add (sexp ctx, sexp a, sexp b);
 SEXP_API sexp sexp_sub (sexp ctx, sexp a, sexp b);
 SEXP_API sexp sexp_mul (sexp ctx, sexp a, sexp b);
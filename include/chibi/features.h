@@ -102,6 +102,10 @@
 /* uncomment this to add additional native gc checks to verify a magic header */
 /* #define SEXP_USE_HEADER_MAGIC 1 */
 
+/* uncomment this to disable storing identity hashes in object headers, */
+/* hashing by address instead (which breaks if objects ever move) */
+/* #define SEXP_USE_HEADER_HASH 0 */
+
 /* uncomment this to add very verbose debugging stats to the native GC */
 /* #define SEXP_USE_DEBUG_GC 1 */
 
@@ -186,10 +190,10 @@
 /*   lot of reading. */
 /* #define SEXP_USE_HUFF_SYMS 0 */
 
-/* uncomment this to just use a single list for hash tables */
+/* uncomment this to disable hashing symbol names */
 /*   You can trade off some space in exchange for longer read */
-/*   times by disabling hashing and just putting all */
-/*   non-immediate symbols in a single list. */
+/*   times by disabling hashing, so that all non-immediate */
+/*   symbols are searched linearly. */
 /* #define SEXP_USE_HASH_SYMS 0 */
 
 /* uncomment this to disable extended char names as defined in R7RS */
@@ -217,6 +221,13 @@
 /*   cursors. */
 /* #define SEXP_USE_DISJOINT_STRING_CURSORS 0 */
 
+/* uncomment this to disable the string index table */
+/*   With mutable UTF-8 strings, large strings lazily record */
+/*   whether they're pure ASCII, or else the byte offset of every */
+/*   SEXP_STRING_INDEX_TABLE_CHUNK_SIZE'th char, so that indexing */
+/*   doesn't need to scan from the start of the string. */
+/* #define SEXP_USE_STRING_INDEX_TABLE 0 */
+
 /* uncomment this to disable automatic closing of ports */
 /*   If enabled, the underlying FILE* for file ports will be */
 /*   automatically closed when they're garbage collected.  Doesn't */
@@ -276,6 +287,11 @@
 #define SEXP_DEFAULT_QUANTUM 500
 #endif
 
+/* the smallest time slice a CPU-bound thread can be shrunk to */
+#ifndef SEXP_MIN_QUANTUM
+#define SEXP_MIN_QUANTUM 50
+#endif
+
 #ifndef SEXP_MAX_ANALYZE_DEPTH
 #define SEXP_MAX_ANALYZE_DEPTH 8192
 #endif
@@ -426,6 +442,20 @@
 #define SEXP_USE_HEADER_MAGIC 0
 #endif
 
+/* only enabled by default where the header has spare bits */
+#ifndef SEXP_USE_HEADER_HASH
+#if SEXP_64_BIT && ! defined(_WIN32)
+#define SEXP_USE_HEADER_HASH 1
+#else
+#define SEXP_USE_HEADER_HASH 0
+#endif
+#endif
+
+/* fills the 32 bits after the tag with the mark and flag bits */
+#ifndef SEXP_HEADER_HASH_BITS
+#define SEXP_HEADER_HASH_BITS 27
+#endif
+
 #ifndef SEXP_GC_PAD
 #define SEXP_GC_PAD 0
 #endif
@@ -570,6 +600,11 @@
 #define SEXP_USE_HASH_SYMS ! SEXP_USE_NO_FEATURES
 #endif
 
+/* initial number of slots in the symbol table, a power of two */
+#ifndef SEXP_INIT_SYMBOL_TABLE_SIZE
+#define SEXP_INIT_SYMBOL_TABLE_SIZE 512
+#endif
+
 #ifndef SEXP_USE_FOLD_CASE_SYMS
 #define SEXP_USE_FOLD_CASE_SYMS ! SEXP_USE_NO_FEATURES
 #endif
@@ -629,6 +664,24 @@
 #define SEXP_USE_DISJOINT_STRING_CURSORS SEXP_USE_UTF8_STRINGS
 #endif
 
+/* the number of bytes checked at once when scanning for ASCII */
+#ifndef SEXP_UTF8_BLOCK_SIZE
+#define SEXP_UTF8_BLOCK_SIZE 32
+#endif
+
+#ifndef SEXP_USE_STRING_INDEX_TABLE
+#define SEXP_USE_STRING_INDEX_TABLE (SEXP_USE_UTF8_STRINGS && ! SEXP_USE_PACKED_STRINGS)
+#endif
+
+#ifndef SEXP_STRING_INDEX_TABLE_CHUNK_SIZE
+#define SEXP_STRING_INDEX_TABLE_CHUNK_SIZE 64
+#endif
+
+/* strings smaller than this many bytes are always scanned */
+#ifndef SEXP_STRING_INDEX_TABLE_MIN_SIZE
+#define SEXP_STRING_INDEX_TABLE_MIN_SIZE 256
+#endif
+
 #ifndef SEXP_USE_AUTOCLOSE_PORTS
 #define SEXP_USE_AUTOCLOSE_PORTS ! SEXP_USE_NO_FEATURES
 #endif
@@ -645,6 +698,11 @@
 #define SEXP_PORT_BUFFER_SIZE 4096
 #endif
 
+/* output string ports double their buffer up to this size */
+#ifndef SEXP_STRING_PORT_MAX_CHUNK_SIZE
+#define SEXP_STRING_PORT_MAX_CHUNK_SIZE (1024*1024)
+#endif
+
 #ifndef SEXP_USE_NTP_GETTIME
 #define SEXP_USE_NTP_GETTIME 0
 #endif
@@ -720,8 +778,28 @@
 #endif
 
 #ifndef SEXP_USE_SEND_FILE
-#define SEXP_USE_SEND_FILE 0
-/* #define SEXP_USE_SEND_FILE (__linux || SEXP_BSD) */
+#define SEXP_USE_SEND_FILE (__linux || SEXP_BSD)
+#endif
+
+/* open-mmap-input-port maps regular files directly as the buffer */
+/* of the port */
+#ifndef SEXP_USE_MMAP_PORTS
+#if defined(PLAN9) || defined(_WIN32)
+#define SEXP_USE_MMAP_PORTS 0
+#else
+#define SEXP_USE_MMAP_PORTS 1
+#endif
+#endif
+
+/* file descriptor ports write large strings together with their */
+/* buffer in a single writev, and read large bytevectors together */
+/* with the next buffer in a single readv */
+#ifndef SEXP_USE_VECTORED_IO
+#if defined(PLAN9) || defined(_WIN32)
+#define SEXP_USE_VECTORED_IO 0
+#else
+#define SEXP_USE_VECTORED_IO 1
+#endif
 #endif
 
 #if SEXP_USE_NATIVE_X86
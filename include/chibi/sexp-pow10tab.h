@@ -0,0 +1,675 @@
+/* auto-generated by tools/generate-pow10-table.scm */
+
+#define SEXP_POW10_MIN -343
+#define SEXP_POW10_MAX 324
+
+static const unsigned long long sexp_pow10_tab[][2] = {
+  {0x5f94ee55d417ef57uLL, 0x1d0cbba1ce203f0duLL},  /* -343 */
+  {0x777a29eb491deb2duLL, 0x044fea8a41a84ed0uLL},  /* -342 */
+  {0x4aac5a330db2b2fcuLL, 0x12b1f29669093142uLL},  /* -341 */
+  {0x5d5770bfd11f5fbbuLL, 0x175e6f3c034b7d93uLL},  /* -340 */
+  {0x74ad4cefc56737a9uLL, 0x7d360b0b041e5cf8uLL},  /* -339 */
+  {0x48ec5015db6082cauLL, 0x1e41c6e6e292fa1buLL},  /* -338 */
+  {0x5b27641b5238a37cuLL, 0x65d238a09b37b8a2uLL},  /* -337 */
+  {0x71f13d2226c6cc5buLL, 0x7f46c6c8c205a6cauLL},  /* -336 */
+  {0x4736c635583c3fb9uLL, 0x3f8c3c3d7943883euLL},  /* -335 */
+  {0x590477c2ae4b4fa7uLL, 0x6f6f4b4cd7946a4euLL},  /* -334 */
+  {0x6f4595b359de2391uLL, 0x6b4b1e200d7984e1uLL},  /* -333 */
+  {0x458b7d90182ad63buLL, 0x130ef2d4086bf30duLL},  /* -332 */
+  {0x56ee5cf41e358bc9uLL, 0x77d2af890a86efd0uLL},  /* -331 */
+  {0x6ca9f43125c2eebcuLL, 0x35c75b6b4d28abc4uLL},  /* -330 */
+  {0x43ea389eb799d535uLL, 0x619c992310396b5buLL},  /* -329 */
+  {0x54e4c6c665804a83uLL, 0x1a03bf6bd447c631uLL},  /* -328 */
+  {0x6a1df877fee05d24uLL, 0x0084af46c959b7bduLL},  /* -327 */
+  {0x4252bb4aff4c3a36uLL, 0x4052ed8c3dd812d6uLL},  /* -326 */
+  {0x52e76a1dbf1f48c4uLL, 0x1067a8ef4d4e178cuLL},  /* -325 */
+  {0x67a144a52ee71af5uLL, 0x1481932b20a19d6fuLL},  /* -324 */
+  {0x40c4cae73d5070d9uLL, 0x1cd0fbfaf4650265uLL},  /* -323 */
+  {0x50f5fda10ca48d0fuLL, 0x44053af9b17e42ffuLL},  /* -322 */
+  {0x65337d094fcdb053uLL, 0x350689b81dddd3beuLL},  /* -321 */
+  {0x7e805c4ba3c11c68uLL, 0x22482c26255548aeuLL},  /* -320 */
+  {0x4f1039af4658b1c1uLL, 0x156d1b97d7554d6duLL},  /* -319 */
+  {0x62d4481b17eede31uLL, 0x3ac8627dcd2aa0c8uLL},  /* -318 */
+  {0x7b895a21ddea95bduLL, 0x697a7b1d407548fauLL},  /* -317 */
+  {0x4d35d8552ab29d96uLL, 0x51ec8cf248494d9cuLL},  /* -316 */
+  {0x60834e6a755f44fcuLL, 0x2667b02eda5ba103uLL},  /* -315 */
+  {0x78a4220512b7163buLL, 0x30019c3a90f28944uLL},  /* -314 */
+  {0x4b6695432bb26de5uLL, 0x0e0101a49a9795cbuLL},  /* -313 */
+  {0x5e403a93f69f095euLL, 0x3181420dc13d7b3duLL},  /* -312 */
+  {0x75d04938f446cbb5uLL, 0x7de19291318cda0cuLL},  /* -311 */
+  {0x49a22dc398ac3f51uLL, 0x5eacfb9abef80848uLL},  /* -310 */
+  {0x5c0ab9347ed74f26uLL, 0x16583a816eb60a5auLL},  /* -309 */
+  {0x730d67819e8d22efuLL, 0x5bee4921ca638cf0uLL},  /* -308 */
+  {0x47e860b1031835d5uLL, 0x6974edb51e7e3816uLL},  /* -307 */
+  {0x59e278dd43de434buLL, 0x23d22922661dc61cuLL},  /* -306 */
+  {0x705b171494d5d41euLL, 0x0cc6b36affa537a2uLL},  /* -305 */
+  {0x4638ee6cdd05a492uLL, 0x67fc3022dfc742c6uLL},  /* -304 */
+  {0x57c72a0814470db7uLL, 0x41fb3c2b97b91377uLL},  /* -303 */
+  {0x6db8f48a1958d125uLL, 0x327a0b367da75855uLL},  /* -302 */
+  {0x449398d64fd782b7uLL, 0x2f8c47020e889735uLL},  /* -301 */
+  {0x55b87f0be3cd6365uLL, 0x1b6f58c2922abd02uLL},  /* -300 */
+  {0x6b269ecedcc0bc3euLL, 0x424b2ef336b56c43uLL},  /* -299 */
+  {0x42f8234149f875a7uLL, 0x096efd58023163aauLL},  /* -298 */
+  {0x53b62c119c769310uLL, 0x6bcabcae02bdbc94uLL},  /* -297 */
+  {0x68a3b716039437d5uLL, 0x06bd6bd9836d2bb9uLL},  /* -296 */
+  {0x4166526dc23ca2e5uLL, 0x14366367f2243b54uLL},  /* -295 */
+  {0x51bfe70932cbcb9euLL, 0x3943fc41eead4a29uLL},  /* -294 */
+  {0x662fe0cb7f7ebe86uLL, 0x0794fb526a589cb3uLL},  /* -293 */
+  {0x7fbbd8fe5f5e6e27uLL, 0x497a3a2704eec3dfuLL},  /* -292 */
+  {0x4fd5679efb9b04d8uLL, 0x5dec645863153a6cuLL},  /* -291 */
+  {0x63cac186ba81c60euLL, 0x75677d6e7bda8906uLL},  /* -290 */
+  {0x7cbd71e869223792uLL, 0x52c15cca1ad12b48uLL},  /* -289 */
+  {0x4df6673141b562bbuLL, 0x53b8d9fe50c2bb0duLL},  /* -288 */
+  {0x617400fd9222bb6auLL, 0x48a7107de4f369d0uLL},  /* -287 */
+  {0x79d1013cf6ab6a45uLL, 0x1ad0d49d5e304444uLL},  /* -286 */
+  {0x4c22a0c61a2b226buLL, 0x20c284e25ade2aabuLL},  /* -285 */
+  {0x5f2b48f7a0b5eb06uLL, 0x08f3261af195b555uLL},  /* -284 */
+  {0x76f61b3588e365c7uLL, 0x4b2fefa1adfb22abuLL},  /* -283 */
+  {0x4a59d101758e1f9cuLL, 0x5efdf5c50cbcf5abuLL},  /* -282 */
+  {0x5cf04541d2f1a783uLL, 0x76bd73364fec3315uLL},  /* -281 */
+  {0x742c569247ae1164uLL, 0x746cd003e3e73fdbuLL},  /* -280 */
+  {0x489bb61b6ccccadfuLL, 0x08c402026e7087e9uLL},  /* -279 */
+  {0x5ac2a3a247fffd96uLL, 0x6af502830a0ca9e3uLL},  /* -278 */
+  {0x71734c8ad9fffcfcuLL, 0x45b24323cc8fd45cuLL},  /* -277 */
+  {0x46e80fd6c83ffe1duLL, 0x6b8f69f65fd9e4b9uLL},  /* -276 */
+  {0x58a213cc7a4ffda5uLL, 0x26734473f7d05de8uLL},  /* -275 */
+  {0x6eca98bf98e3fd0euLL, 0x50101590f5c47561uLL},  /* -274 */
+  {0x453e9f77bf8e7e29uLL, 0x120a0d7a999ac95duLL},  /* -273 */
+  {0x568e4755af721db3uLL, 0x368c90d940017bb4uLL},  /* -272 */
+  {0x6c31d92b1b4ea520uLL, 0x242fb50f9001daa1uLL},  /* -271 */
+  {0x439f27baf1112734uLL, 0x169dd129ba0128a5uLL},  /* -270 */
+  {0x5486f1a9ad557101uLL, 0x1c454574288172ceuLL},  /* -269 */
+  {0x69a8ae1418aacd41uLL, 0x435696d132a1cf81uLL},  /* -268 */
+  {0x42096ccc8f6ac048uLL, 0x7a161e42bfa521b1uLL},  /* -267 */
+  {0x528bc7ffb345705buLL, 0x189ba5d36f8e6a1duLL},  /* -266 */
+  {0x672eb9ffa016cc71uLL, 0x7ec28f484b7204a4uLL},  /* -265 */
+  {0x407d343fc40e3fc7uLL, 0x1f39998d2f2742e7uLL},  /* -264 */
+  {0x509c814fb511cfb9uLL, 0x0707fff07af113a1uLL},  /* -263 */
+  {0x64c3a1a3a25643a7uLL, 0x28c9ffec99ad5889uLL},  /* -262 */
+  {0x7df48a0c8aebd491uLL, 0x12fc7fe7c018aeabuLL},  /* -261 */
+  {0x4eb8d647d6d364dauLL, 0x5bddcff0d80f6d2buLL},  /* -260 */
+  {0x62670bd9cc883e11uLL, 0x32d543ed0e134875uLL},  /* -259 */
+  {0x7b00ced03faa4d95uLL, 0x5f8a94e851981a93uLL},  /* -258 */
+  {0x4ce0814227ca707duLL, 0x4bb69d1132ff109cuLL},  /* -257 */
+  {0x6018a192b1bd0c9cuLL, 0x7ea444557fbed4c3uLL},  /* -256 */
+  {0x781ec9f75e2c4fc4uLL, 0x1e4d556adfae89f3uLL},  /* -255 */
+  {0x4b133e3a9adbb1dauLL, 0x52f05562cbcd1638uLL},  /* -254 */
+  {0x5dd80dc941929e51uLL, 0x27ac6abb7ec05bc6uLL},  /* -253 */
+  {0x754e113b91f745e5uLL, 0x5197856a5e7072b8uLL},  /* -252 */
+  {0x4950cac53b3a8bafuLL, 0x42feb3627b0647b3uLL},  /* -251 */
+  {0x5ba4fd768a092e9buLL, 0x33be603b19c7d99fuLL},  /* -250 */
+  {0x728e3cd42c8b7a42uLL, 0x20adf849e039d007uLL},  /* -249 */
+  {0x4798e6049bd72c69uLL, 0x346cbb2e2c242205uLL},  /* -248 */
+  {0x597f1f85c2ccf783uLL, 0x6187e9f9b72d2a86uLL},  /* -247 */
+  {0x6fdee76733803564uLL, 0x59e9e47824f87527uLL},  /* -246 */
+  {0x45eb50a08030215euLL, 0x78322ecb171b4939uLL},  /* -245 */
+  {0x576624c8a03c29b6uLL, 0x563eba7ddce21b87uLL},  /* -244 */
+  {0x6d3fadfac84b3424uLL, 0x2bce691d541aa268uLL},  /* -243 */
+  {0x4447ccbcbd2f0096uLL, 0x5b6101b25490a581uLL},  /* -242 */
+  {0x5559bfebec7ac0bcuLL, 0x3239421ee9b4cee1uLL},  /* -241 */
+  {0x6ab02fe6e79970ebuLL, 0x3ec792a6a422029auLL},  /* -240 */
+  {0x42ae1df050bfe693uLL, 0x173cbba8269541a0uLL},  /* -239 */
+  {0x5359a56c64efe037uLL, 0x7d0bea92303a9208uLL},  /* -238 */
+  {0x68300ec77e2bd845uLL, 0x7c4ee536bc49368auLL},  /* -237 */
+  {0x411e093caedb672buLL, 0x5db14f4235adc217uLL},  /* -236 */
+  {0x51658b8bda9240f6uLL, 0x551da312c319329cuLL},  /* -235 */
+  {0x65beee6ed136d134uLL, 0x2a650bd773df7f43uLL},  /* -234 */
+  {0x7f2eaa0a85848581uLL, 0x34fe4ecd50d75f14uLL},  /* -233 */
+  {0x4f7d2a469372d370uLL, 0x711ef14052869b6cuLL},  /* -232 */
+  {0x635c74d8384f884duLL, 0x0d66ad9067284247uLL},  /* -231 */
+  {0x7c33920e46636a60uLL, 0x30c058f480f252d9uLL},  /* -230 */
+  {0x4da03b48ebfe227cuLL, 0x1e783798d09773c8uLL},  /* -229 */
+  {0x61084a1b26fdab1buLL, 0x2616457f04bd50bauLL},  /* -228 */
+  {0x794a5ca1f0bd15e2uLL, 0x0f9bd6dec5eca4e8uLL},  /* -227 */
+  {0x4bce79e536762daduLL, 0x29c1664b3bb3e711uLL},  /* -226 */
+  {0x5ec2185e8413b918uLL, 0x5431bfde0aa0e0d5uLL},  /* -225 */
+  {0x76729e762518a75euLL, 0x693e2fd58d49190buLL},  /* -224 */
+  {0x4a07a309d72f689buLL, 0x21c6dde5784dafa7uLL},  /* -223 */
+  {0x5c898bcc4cfb42c2uLL, 0x0a38955ed6611b90uLL},  /* -222 */
+  {0x73abeebf603a1372uLL, 0x4cc6bab68bf96274uLL},  /* -221 */
+  {0x484b75379c244c27uLL, 0x4ffc34b2177bdd89uLL},  /* -220 */
+  {0x5a5e5285832d5f31uLL, 0x43fb41de9d5ad4ebuLL},  /* -219 */
+  {0x70f5e726e3f8b6fduLL, 0x74fa125644b18a26uLL},  /* -218 */
+  {0x4699b0784e7b725euLL, 0x591c4b75eaeef658uLL},  /* -217 */
+  {0x58401c96621a4ef6uLL, 0x2f635e5365aab3eduLL},  /* -216 */
+  {0x6e5023bbfaa0e2b3uLL, 0x7b3c35e83f1560e9uLL},  /* -215 */
+  {0x44f216557ca48db0uLL, 0x3d05a1b1276d5c92uLL},  /* -214 */
+  {0x562e9beadbcdb11cuLL, 0x4c470a1d7148b3b6uLL},  /* -213 */
+  {0x6bba42e592c11d63uLL, 0x5f58cca4cd9ae0a3uLL},  /* -212 */
+  {0x435469cf7bb8b25euLL, 0x2b977fe70080cc66uLL},  /* -211 */
+  {0x542984435aa6def5uLL, 0x767d5fe0c0a0ff80uLL},  /* -210 */
+  {0x6933e554315096b3uLL, 0x341cb7d8f0c93f5fuLL},  /* -209 */
+  {0x41c06f549ed25e30uLL, 0x1091f2e7967dc79cuLL},  /* -208 */
+  {0x52308b29c686f5bcuLL, 0x14b66fa17c1d3983uLL},  /* -207 */
+  {0x66bcadf43828b32buLL, 0x19e40b89db2487e3uLL},  /* -206 */
+  {0x4035ecb8a3196ffbuLL, 0x002e873628f6d4eeuLL},  /* -205 */
+  {0x504367e6cbdfcbf9uLL, 0x603a2903b3348a2auLL},  /* -204 */
+  {0x645441e07ed7bef8uLL, 0x1848b344a001acb4uLL},  /* -203 */
+  {0x7d6952589e8daeb6uLL, 0x1e5ae015c80217e1uLL},  /* -202 */
+  {0x4e61d37763188d31uLL, 0x72f8cc0d9d014eeduLL},  /* -201 */
+  {0x61fa48553bdeb07euLL, 0x2fb6ff110441a2a8uLL},  /* -200 */
+  {0x7a78da6a8ad65c9duLL, 0x7ba4bed545520b52uLL},  /* -199 */
+  {0x4c8b888296c5f9e2uLL, 0x5d46f7454b534713uLL},  /* -198 */
+  {0x5fae6aa33c77785buLL, 0x3498b5169e2818d8uLL},  /* -197 */
+  {0x779a054c0b955672uLL, 0x21bee25c45b21f0euLL},  /* -196 */
+  {0x4ac0434f873d5607uLL, 0x35174d79ab8f5369uLL},  /* -195 */
+  {0x5d705423690cab89uLL, 0x225d20d816732843uLL},  /* -194 */
+  {0x74cc692c434fd66buLL, 0x4af4690e1c0ff253uLL},  /* -193 */
+  {0x48ffc1bbaa11e603uLL, 0x1ed8c1a8d189f774uLL},  /* -192 */
+  {0x5b3fb22a94965f84uLL, 0x068ef21305ec7551uLL},  /* -191 */
+  {0x720f9eb539bbf765uLL, 0x0832ae97c76792a5uLL},  /* -190 */
+  {0x4749c33144157a9fuLL, 0x151fad1edca0bba8uLL},  /* -189 */
+  {0x591c33fd951ad946uLL, 0x7a67986693c8ea91uLL},  /* -188 */
+  {0x6f6340fcfa618f98uLL, 0x59017e8038bb2536uLL},  /* -187 */
+  {0x459e089e1c7cf9bfuLL, 0x37a0ef102374f742uLL},  /* -186 */
+  {0x57058ac5a39c382fuLL, 0x25892ad42c523512uLL},  /* -185 */
+  {0x6cc6ed770c83463buLL, 0x0eeb75893766c256uLL},  /* -184 */
+  {0x43fc546a67d20be4uLL, 0x79532975c2a03976uLL},  /* -183 */
+  {0x54fb698501c68edeuLL, 0x17a7f3d3334847d4uLL},  /* -182 */
+  {0x6a3a43e642383295uLL, 0x5d91f0c8001a59c8uLL},  /* -181 */
+  {0x42646a6fe9631f9duLL, 0x4a7b367d0010781duLL},  /* -180 */
+  {0x52fd850be3bbe784uLL, 0x7d1a041c40149625uLL},  /* -179 */
+  {0x67bce64edcaae166uLL, 0x1c6085235019bbaeuLL},  /* -178 */
+  {0x40d60ff149eaccdfuLL, 0x71bc53361210154duLL},  /* -177 */
+  {0x510b93ed9c658017uLL, 0x6e2b680396941aa0uLL},  /* -176 */
+  {0x654e78e9037ee01duLL, 0x69b642047c392148uLL},  /* -175 */
+  {0x7ea21723445e9825uLL, 0x2423d2859b476999uLL},  /* -174 */
+  {0x4f254e760abb1f17uLL, 0x26966393810ca200uLL},  /* -173 */
+  {0x62eea2138d69e6dduLL, 0x103bfc78614fca80uLL},  /* -172 */
+  {0x7baa4a9870c46094uLL, 0x344afb9679a3bd20uLL},  /* -171 */
+  {0x4d4a6e9f467abc5cuLL, 0x60aedd3e0c065634uLL},  /* -170 */
+  {0x609d0a4718196b73uLL, 0x78da948d8f07ebc1uLL},  /* -169 */
+  {0x78c44cd8de1fc650uLL, 0x771139b0f2c9e6b1uLL},  /* -168 */
+  {0x4b7ab0078ad3dbf2uLL, 0x4a6ac40e97be302fuLL},  /* -167 */
+  {0x5e595c096d88d2efuLL, 0x1d0575123dadbc3auLL},  /* -166 */
+  {0x75efb30bc8eb07abuLL, 0x0446d256cd192b49uLL},  /* -165 */
+  {0x49b5cfe75d92e4cauLL, 0x72ac4376402fbb0euLL},  /* -164 */
+  {0x5c2343e134f79dfduLL, 0x4f575453d03ba9d1uLL},  /* -163 */
+  {0x732c14d98235857duLL, 0x032d2968c44a9445uLL},  /* -162 */
+  {0x47fb8d07f161736euLL, 0x11fc39e17aae9cabuLL},  /* -161 */
+  {0x59fa7049edb9d049uLL, 0x567b4859d95a43d6uLL},  /* -160 */
+  {0x70790c5c6928445cuLL, 0x0c1a1a704fb0d4ccuLL},  /* -159 */
+  {0x464ba7b9c1b92ab9uLL, 0x4790508631ce84ffuLL},  /* -158 */
+  {0x57de91a832277567uLL, 0x797464a7be42263fuLL},  /* -157 */
+  {0x6dd636123eb152c1uLL, 0x77d17dd1add2afcfuLL},  /* -156 */
+  {0x44a5e1cb672ed3b9uLL, 0x1ae2eea30ca3ade1uLL},  /* -155 */
+  {0x55cf5a3e40fa88a7uLL, 0x419baa4bcfcc995auLL},  /* -154 */
+  {0x6b4330cdd1392ad1uLL, 0x320294dec3bfbfb0uLL},  /* -153 */
+  {0x4309fe80a2c3bac2uLL, 0x6f419d0b3a57d7ceuLL},  /* -152 */
+  {0x53cc7e20cb74a973uLL, 0x4b12044e08edcdc2uLL},  /* -151 */
+  {0x68bf9da8fe51d3d0uLL, 0x3dd685618b294132uLL},  /* -150 */
+  {0x4177c2899ef32462uLL, 0x26a6135cf6f9c8bfuLL},  /* -149 */
+  {0x51d5b32c06afed7auLL, 0x704f983434b83aefuLL},  /* -148 */
+  {0x664b1ff7085be8d9uLL, 0x4c637e4141e649abuLL},  /* -147 */
+  {0x7fdde7f4ca72e30fuLL, 0x7f7c5dd1925fdc15uLL},  /* -146 */
+  {0x4feab0f8fe87cde9uLL, 0x7fadbaa2fb7be98duLL},  /* -145 */
+  {0x63e55d373e29c164uLL, 0x3f99294bba5ae3f1uLL},  /* -144 */
+  {0x7cdeb4850db431bduLL, 0x4f7f739ea8f19ceduLL},  /* -143 */
+  {0x4e0b30d328909f16uLL, 0x41afa84329970214uLL},  /* -142 */
+  {0x618dfd07f2b4c6dcuLL, 0x121b9253f3fcc299uLL},  /* -141 */
+  {0x79f17c49ef61f893uLL, 0x16a276e8f0fbf33fuLL},  /* -140 */
+  {0x4c36edae359d3b5buLL, 0x7e258a51969d7808uLL},  /* -139 */
+  {0x5f44a919c3048a32uLL, 0x7daeece5fc44d609uLL},  /* -138 */
+  {0x7715d36033c5acbfuLL, 0x5d1aa81f7b560b8cuLL},  /* -137 */
+  {0x4a6da41c205b8bf7uLL, 0x6a30a913ad15c738uLL},  /* -136 */
+  {0x5d090d2328726ef5uLL, 0x64bcd358985b3905uLL},  /* -135 */
+  {0x744b506bf28f0ab3uLL, 0x1dec082ebe720746uLL},  /* -134 */
+  {0x48af1243779966b0uLL, 0x02b3851d3707448cuLL},  /* -133 */
+  {0x5adad6d4557fc05cuLL, 0x0360666484c915afuLL},  /* -132 */
+  {0x71918c896adfb073uLL, 0x04387ffda5fb5b1buLL},  /* -131 */
+  {0x46faf7d5e2cbce47uLL, 0x72a34ffe87bd18f1uLL},  /* -130 */
+  {0x58b9b5cb5b7ec1d9uLL, 0x6f4c23fe29ac5f2duLL},  /* -129 */
+  {0x6ee8233e325e7250uLL, 0x2b1f2cfdb41776f8uLL},  /* -128 */
+  {0x45511606df7b0772uLL, 0x1af37c1e908eaa5buLL},  /* -127 */
+  {0x56a55b889759c94euLL, 0x61b05b2634b254f2uLL},  /* -126 */
+  {0x6c4eb26abd303ba2uLL, 0x3a1c71efc1deea2euLL},  /* -125 */
+  {0x43b12f82b63e2545uLL, 0x4451c735d92b525duLL},  /* -124 */
+  {0x549d7b6363cdae96uLL, 0x756639034f7626f4uLL},  /* -123 */
+  {0x69c4da3c3cc11a3cuLL, 0x52bfc7442353b0b1uLL},  /* -122 */
+  {0x421b0865a5f8b065uLL, 0x73b7dc8a96144e6fuLL},  /* -121 */
+  {0x52a1ca7f0f76dc7fuLL, 0x30a5d3ad3b99620buLL},  /* -120 */
+  {0x674a3d1ed354939fuLL, 0x1ccf48988a7fba8duLL},  /* -119 */
+  {0x408e66334414dc43uLL, 0x42018d5f568fd498uLL},  /* -118 */
+  {0x50b1ffc0151a1354uLL, 0x3281f0b72c33c9beuLL},  /* -117 */
+  {0x64de7fb01a609829uLL, 0x3f226ce4f740bc2euLL},  /* -116 */
+  {0x7e161f9c20f8be33uLL, 0x6eeb081e3510eb39uLL},  /* -115 */
+  {0x4ecdd3c1949b76e0uLL, 0x3552e512e12a9304uLL},  /* -114 */
+  {0x628148b1f9c25498uLL, 0x42a79e57997537c5uLL},  /* -113 */
+  {0x7b219ade7832e9beuLL, 0x535185ed7fd285b6uLL},  /* -112 */
+  {0x4cf500cb0b1fd217uLL, 0x1412f3b46fe39392uLL},  /* -111 */
+  {0x603240fdcde7c69cuLL, 0x7917b0a18bdc7876uLL},  /* -110 */
+  {0x783ed13d4161b844uLL, 0x175d9cc9eed39694uLL},  /* -109 */
+  {0x4b2742c648dd132auLL, 0x4e9a81fe35443e1cuLL},  /* -108 */
+  {0x5df11377db1457f5uLL, 0x2241227dc2954da3uLL},  /* -107 */
+  {0x756d5855d1d96df2uLL, 0x4ad16b1d333aa10cuLL},  /* -106 */
+  {0x49645735a327e4b7uLL, 0x4ec2e2f24004a4a8uLL},  /* -105 */
+  {0x5bbd6d030bf1dde5uLL, 0x42739baed005cdd2uLL},  /* -104 */
+  {0x72acc843ceee555euLL, 0x7310829a84074146uLL},  /* -103 */
+  {0x47abfd2a6154f55buLL, 0x27ea51a0928488ccuLL},  /* -102 */
+  {0x5996fc74f9aa32b2uLL, 0x11e4e608b725aaffuLL},  /* -101 */
+  {0x6ffcbb923814bf5euLL, 0x565e1f8ae4ef15beuLL},  /* -100 */
+  {0x45fdf53b630cf79buLL, 0x15fad3b6cf156d97uLL},  /* -99 */
+  {0x577d728a3bd03581uLL, 0x7b7988a482dac8fduLL},  /* -98 */
+  {0x6d5ccf2ccac442e2uLL, 0x3a57eacda3917b3cuLL},  /* -97 */
+  {0x445a017bfebaa9cduLL, 0x4476f2c0863aed06uLL},  /* -96 */
+  {0x557081dafe695440uLL, 0x7594af70a7c9a847uLL},  /* -95 */
+  {0x6acca251be03a951uLL, 0x12f9db4cd1bc1258uLL},  /* -94 */
+  {0x42bfe57316c249d2uLL, 0x5bdc291003158b77uLL},  /* -93 */
+  {0x536fdecfdc72dc47uLL, 0x32d3335403daee55uLL},  /* -92 */
+  {0x684bd683d38f9359uLL, 0x1f88002904d1a9eauLL},  /* -91 */
+  {0x412f66126439bc17uLL, 0x63b50019a3030a33uLL},  /* -90 */
+  {0x517b3f96fd482b1duLL, 0x5ca240200bc3ccbfuLL},  /* -89 */
+  {0x65da0f7cbc9a35e5uLL, 0x13cad0280eb4bfefuLL},  /* -88 */
+  {0x7f50935bebc0c35euLL, 0x38bd84321261efebuLL},  /* -87 */
+  {0x4f925c1973587a1buLL, 0x0376729f4b7d35f3uLL},  /* -86 */
+  {0x6376f31fd02e98a1uLL, 0x64540f471e5c836fuLL},  /* -85 */
+  {0x7c54afe7c43a3ecauLL, 0x1d691318e5f3a44buLL},  /* -84 */
+  {0x4db4edf0daa4673euLL, 0x3261abef8fb846afuLL},  /* -83 */
+  {0x6122296d114d810duLL, 0x7efa16eb73a6585buLL},  /* -82 */
+  {0x796ab3c855a0e151uLL, 0x3eb89ca6508fee71uLL},  /* -81 */
+  {0x4be2b05d35848cd2uLL, 0x773361e7f259f507uLL},  /* -80 */
+  {0x5edb5c7482e5b007uLL, 0x55003a61eef07249uLL},  /* -79 */
+  {0x76923391a39f1c09uLL, 0x4a4048fa6aac8edbuLL},  /* -78 */
+  {0x4a1b603b06437185uLL, 0x7e682d9c82abd949uLL},  /* -77 */
+  {0x5ca23849c7d44de7uLL, 0x3e023903a356cf9buLL},  /* -76 */
+  {0x73cac65c39c96161uLL, 0x2d82c7448c2c8382uLL},  /* -75 */
+  {0x485ebbf9a41ddcdcuLL, 0x6c71bc8ad79bd231uLL},  /* -74 */
+  {0x5a766af80d255414uLL, 0x078e2bad8d82c6bduLL},  /* -73 */
+  {0x711405b6106ea919uLL, 0x0971b698f0e3786duLL},  /* -72 */
+  {0x46ac8391ca4529afuLL, 0x55e7121f968e2b44uLL},  /* -71 */
+  {0x5857a4763cd6741buLL, 0x4b60d6a77c31b615uLL},  /* -70 */
+  {0x6e6d8d93cc0c1122uLL, 0x3e390c515b3e239auLL},  /* -69 */
+  {0x4504787c5f878ab5uLL, 0x46e3a7b2d906d640uLL},  /* -68 */
+  {0x5645969b77696d62uLL, 0x789c919f8f488bd0uLL},  /* -67 */
+  {0x6bd6fc425543c8bbuLL, 0x56c3b607731aaec4uLL},  /* -66 */
+  {0x43665da9754a5d75uLL, 0x263a51c4a7f0ad3buLL},  /* -65 */
+  {0x543ff513d29cf4d2uLL, 0x4fc8e635d1ecd88auLL},  /* -64 */
+  {0x694ff258c7443207uLL, 0x23bb1fc346680eacuLL},  /* -63 */
+  {0x41d1f7777c8a9f44uLL, 0x4654f3da0c01092cuLL},  /* -62 */
+  {0x524675555bad4715uLL, 0x57ea30d08f014b76uLL},  /* -61 */
+  {0x66d812aab29898dbuLL, 0x0de4bd04b2c19e54uLL},  /* -60 */
+  {0x40470baaaf9f5f88uLL, 0x78aef622efb902f5uLL},  /* -59 */
+  {0x5058ce955b87376buLL, 0x16dab3ababa743b2uLL},  /* -58 */
+  {0x646f023ab2690545uLL, 0x7c9160969691149euLL},  /* -57 */
+  {0x7d8ac2c95f034697uLL, 0x3bb5b8bc3c3559c5uLL},  /* -56 */
+  {0x4e76b9bddb620c1euLL, 0x55519375a5a1581buLL},  /* -55 */
+  {0x6214682d523a8f26uLL, 0x2aa5f8530f09ae22uLL},  /* -54 */
+  {0x7a998238a6c932efuLL, 0x754f7667d2cc19abuLL},  /* -53 */
+  {0x4c9ff163683dbfd5uLL, 0x7951aa00e3bf900buLL},  /* -52 */
+  {0x5fc7edbc424d2fcbuLL, 0x37a614811caf740duLL},  /* -51 */
+  {0x77b9e92b52e07bbeuLL, 0x258f99a163db5111uLL},  /* -50 */
+  {0x4ad431bb13cc4d56uLL, 0x7779c004de6912abuLL},  /* -49 */
+  {0x5d893e29d8bf60acuLL, 0x5558300616035755uLL},  /* -48 */
+  {0x74eb8db44eef38d7uLL, 0x6aae3c079b842d2auLL},  /* -47 */
+  {0x49133890b1558386uLL, 0x72ace584c1329c3buLL},  /* -46 */
+  {0x5b5806b4ddaae468uLL, 0x4f581ee5f17f4349uLL},  /* -45 */
+  {0x722e086215159d82uLL, 0x632e269f6ddf141buLL},  /* -44 */
+  {0x475cc53d4d2d8271uLL, 0x5dfcd823a4ab6c91uLL},  /* -43 */
+  {0x5933f68ca078e30euLL, 0x157c0e2c8dd647b5uLL},  /* -42 */
+  {0x6f80f42fc8971bd1uLL, 0x5adb11b7b14bd9a3uLL},  /* -41 */
+  {0x45b0989ddd5e7163uLL, 0x08c8eb12cecf6806uLL},  /* -40 */
+  {0x571cbec554b60dbbuLL, 0x6afb25d782834207uLL},  /* -39 */
+  {0x6ce3ee76a9e3912auLL, 0x65b9ef4d63241289uLL},  /* -38 */
+  {0x440e750a2a2e3abauLL, 0x5f9435905df68b96uLL},  /* -37 */
+  {0x5512124cb4b9c969uLL, 0x377942f475742e7buLL},  /* -36 */
+  {0x6a5696dfe1e83bc3uLL, 0x655793b192d13a1auLL},  /* -35 */
+  {0x42761e4bed31255auLL, 0x2f56bc4efbc2c450uLL},  /* -34 */
+  {0x5313a5dee87d6eb0uLL, 0x7b2c6b62bab37564uLL},  /* -33 */
+  {0x67d88f56a29cca5duLL, 0x19f7863b696052bduLL},  /* -32 */
+  {0x40e7599625a1fe7auLL, 0x203ab3e521dc33b6uLL},  /* -31 */
+  {0x51212ffbaf0a7e18uLL, 0x684960de6a5340a4uLL},  /* -30 */
+  {0x65697bfa9acd1d9fuLL, 0x025bb91604e810cduLL},  /* -29 */
+  {0x7ec3daf941806506uLL, 0x62f2a75b86221500uLL},  /* -28 */
+  {0x4f3a68dbc8f03f24uLL, 0x1dd7a89933d54d20uLL},  /* -27 */
+  {0x63090312bb2c4eeduLL, 0x254d92bf80caa068uLL},  /* -26 */
+  {0x7bcb43d769f762a8uLL, 0x4ea0f76f60fd4882uLL},  /* -25 */
+  {0x4d5f0a66a23a9da9uLL, 0x31249aa59c9e4d51uLL},  /* -24 */
+  {0x60b6cd004ac94513uLL, 0x5d6dc14f03c5e0a5uLL},  /* -23 */
+  {0x78e480405d7b9658uLL, 0x54c931a2c4b758cfuLL},  /* -22 */
+  {0x4b8ed0283a6d3df7uLL, 0x34fdbf05baf29781uLL},  /* -21 */
+  {0x5e72843249088d75uLL, 0x223d2ec729af3d62uLL},  /* -20 */
+  {0x760f253edb4ab0d2uLL, 0x4acc7a78f41b0cbauLL},  /* -19 */
+  {0x49c97747490eae83uLL, 0x4ebfcc8b9890e7f4uLL},  /* -18 */
+  {0x5c3bd5191b525a24uLL, 0x426fbfae7eb521f1uLL},  /* -17 */
+  {0x734aca5f6226f0aduLL, 0x530baf9a1e626a6duLL},  /* -16 */
+  {0x480ebe7b9d58566cuLL, 0x43e74dc052fd8285uLL},  /* -15 */
+  {0x5a126e1a84ae6c07uLL, 0x54e1213067bce326uLL},  /* -14 */
+  {0x709709a125da0709uLL, 0x4a19697c81ac1befuLL},  /* -13 */
+  {0x465e6604b7a84465uLL, 0x7e4fe1edd10b9175uLL},  /* -12 */
+  {0x57f5ff85e592557fuLL, 0x3de3da69454e75d3uLL},  /* -11 */
+  {0x6df37f675ef6eadfuLL, 0x2d5cd10396a21347uLL},  /* -10 */
+  {0x44b82fa09b5a52cbuLL, 0x4c5a02a23e254c0duLL},  /* -9 */
+  {0x55e63b88c230e77euLL, 0x3f70834acdae9f10uLL},  /* -8 */
+  {0x6b5fca6af2bd215euLL, 0x0f4ca41d811a46d4uLL},  /* -7 */
+  {0x431bde82d7b634dauLL, 0x698fe69270b06c44uLL},  /* -6 */
+  {0x53e2d6238da3c211uLL, 0x43f3e0370cdc8755uLL},  /* -5 */
+  {0x68db8bac710cb295uLL, 0x74f0d844d013a92buLL},  /* -4 */
+  {0x4189374bc6a7ef9duLL, 0x5916872b020c49bbuLL},  /* -3 */
+  {0x51eb851eb851eb85uLL, 0x0f5c28f5c28f5c29uLL},  /* -2 */
+  {0x6666666666666666uLL, 0x3333333333333334uLL},  /* -1 */
+  {0x4000000000000000uLL, 0x0000000000000001uLL},  /* 0 */
+  {0x5000000000000000uLL, 0x0000000000000001uLL},  /* 1 */
+  {0x6400000000000000uLL, 0x0000000000000001uLL},  /* 2 */
+  {0x7d00000000000000uLL, 0x0000000000000001uLL},  /* 3 */
+  {0x4e20000000000000uLL, 0x0000000000000001uLL},  /* 4 */
+  {0x61a8000000000000uLL, 0x0000000000000001uLL},  /* 5 */
+  {0x7a12000000000000uLL, 0x0000000000000001uLL},  /* 6 */
+  {0x4c4b400000000000uLL, 0x0000000000000001uLL},  /* 7 */
+  {0x5f5e100000000000uLL, 0x0000000000000001uLL},  /* 8 */
+  {0x7735940000000000uLL, 0x0000000000000001uLL},  /* 9 */
+  {0x4a817c8000000000uLL, 0x0000000000000001uLL},  /* 10 */
+  {0x5d21dba000000000uLL, 0x0000000000000001uLL},  /* 11 */
+  {0x746a528800000000uLL, 0x0000000000000001uLL},  /* 12 */
+  {0x48c2739500000000uLL, 0x0000000000000001uLL},  /* 13 */
+  {0x5af3107a40000000uLL, 0x0000000000000001uLL},  /* 14 */
+  {0x71afd498d0000000uLL, 0x0000000000000001uLL},  /* 15 */
+  {0x470de4df82000000uLL, 0x0000000000000001uLL},  /* 16 */
+  {0x58d15e1762800000uLL, 0x0000000000000001uLL},  /* 17 */
+  {0x6f05b59d3b200000uLL, 0x0000000000000001uLL},  /* 18 */
+  {0x4563918244f40000uLL, 0x0000000000000001uLL},  /* 19 */
+  {0x56bc75e2d6310000uLL, 0x0000000000000001uLL},  /* 20 */
+  {0x6c6b935b8bbd4000uLL, 0x0000000000000001uLL},  /* 21 */
+  {0x43c33c1937564800uLL, 0x0000000000000001uLL},  /* 22 */
+  {0x54b40b1f852bda00uLL, 0x0000000000000001uLL},  /* 23 */
+  {0x69e10de76676d080uLL, 0x0000000000000001uLL},  /* 24 */
+  {0x422ca8b0a00a4250uLL, 0x0000000000000001uLL},  /* 25 */
+  {0x52b7d2dcc80cd2e4uLL, 0x0000000000000001uLL},  /* 26 */
+  {0x6765c793fa10079duLL, 0x0000000000000001uLL},  /* 27 */
+  {0x409f9cbc7c4a04c2uLL, 0x1000000000000001uLL},  /* 28 */
+  {0x50c783eb9b5c85f2uLL, 0x5400000000000001uLL},  /* 29 */
+  {0x64f964e68233a76fuLL, 0x2900000000000001uLL},  /* 30 */
+  {0x7e37be2022c0914buLL, 0x1340000000000001uLL},  /* 31 */
+  {0x4ee2d6d415b85aceuLL, 0x7c08000000000001uLL},  /* 32 */
+  {0x629b8c891b267182uLL, 0x5b0a000000000001uLL},  /* 33 */
+  {0x7b426fab61f00de3uLL, 0x31cc800000000001uLL},  /* 34 */
+  {0x4d0985cb1d3608aeuLL, 0x0f1fd00000000001uLL},  /* 35 */
+  {0x604be73de4838ad9uLL, 0x52e7c40000000001uLL},  /* 36 */
+  {0x785ee10d5da46d90uLL, 0x07a1b50000000001uLL},  /* 37 */
+  {0x4b3b4ca85a86c47auLL, 0x04c5112000000001uLL},  /* 38 */
+  {0x5e0a1fd271287598uLL, 0x45f6556800000001uLL},  /* 39 */
+  {0x758ca7c70d7292feuLL, 0x5773eac200000001uLL},  /* 40 */
+  {0x4977e8dc68679bdfuLL, 0x16a872b940000001uLL},  /* 41 */
+  {0x5bd5e313828182d6uLL, 0x7c528f6790000001uLL},  /* 42 */
+  {0x72cb5bd86321e38cuLL, 0x5b67334174000001uLL},  /* 43 */
+  {0x47bf19673df52e37uLL, 0x79208008e8800001uLL},  /* 44 */
+  {0x59aedfc10d7279c5uLL, 0x7768a00b22a00001uLL},  /* 45 */
+  {0x701a97b150cf1837uLL, 0x3542c80deb480001uLL},  /* 46 */
+  {0x46109eced2816f22uLL, 0x5149bd08b30d0001uLL},  /* 47 */
+  {0x5794c6828721caebuLL, 0x259c2c4adfd04001uLL},  /* 48 */
+  {0x6d79f82328ea3da6uLL, 0x0f03375d97c45001uLL},  /* 49 */
+  {0x446c3b15f9926687uLL, 0x6962029a7edab201uLL},  /* 50 */
+  {0x558749db77f70029uLL, 0x63ba83411e915e81uLL},  /* 51 */
+  {0x6ae91c5255f4c034uLL, 0x1ca924116635b621uLL},  /* 52 */
+  {0x42d1b1b375b8f820uLL, 0x51e9b68adfe191d5uLL},  /* 53 */
+  {0x53861e2053273628uLL, 0x6664242d97d9f64auLL},  /* 54 */
+  {0x6867a5a867f103b2uLL, 0x7ffd2d38fdd073dcuLL},  /* 55 */
+  {0x4140c78940f6a24fuLL, 0x6ffe3c439ea2486auLL},  /* 56 */
+  {0x5190f96b91344ae3uLL, 0x6bfdcb54864ada84uLL},  /* 57 */
+  {0x65f537c675815d9cuLL, 0x66fd3e29a7dd9125uLL},  /* 58 */
+  {0x7f7285b812e1b504uLL, 0x00bc8db411d4f56euLL},  /* 59 */
+  {0x4fa793930bcd1122uLL, 0x4075d8908b251965uLL},  /* 60 */
+  {0x63917877cec0556buLL, 0x10934eb4adee5fbeuLL},  /* 61 */
+  {0x7c75d695c2706ac5uLL, 0x74b82261d969f7aduLL},  /* 62 */
+  {0x4dc9a61d998642bbuLL, 0x58f3157d27e23accuLL},  /* 63 */
+  {0x613c0fa4ffe7d36auLL, 0x4f2fdadc71dac97fuLL},  /* 64 */
+  {0x798b138e3fe1c845uLL, 0x22fbd1938e517bdfuLL},  /* 65 */
+  {0x4bf6ec38e7ed1d2buLL, 0x25dd62fc38f2ed6cuLL},  /* 66 */
+  {0x5ef4a74721e86476uLL, 0x0f54bbbb472fa8c6uLL},  /* 67 */
+  {0x76b1d118ea627d93uLL, 0x5329eaaa18fb92f8uLL},  /* 68 */
+  {0x4a2f22af927d8e7cuLL, 0x23fa32aa4f9d3bdbuLL},  /* 69 */
+  {0x5cbaeb5b771cf21buLL, 0x2cf8bf54e3848ad2uLL},  /* 70 */
+  {0x73e9a63254e42ea2uLL, 0x1836ef2a1c65ad86uLL},  /* 71 */
+  {0x487207df750e9d25uLL, 0x2f22557a51bf8c74uLL},  /* 72 */
+  {0x5a8e89d75252446euLL, 0x5aeaead8e62f6f91uLL},  /* 73 */
+  {0x71322c4d26e6d58auLL, 0x31a5a58f1fbb4b75uLL},  /* 74 */
+  {0x46bf5bb038504576uLL, 0x3f07877973d50f29uLL},  /* 75 */
+  {0x586f329c466456d4uLL, 0x0ec96957d0ca52f3uLL},  /* 76 */
+  {0x6e8aff4357fd6c89uLL, 0x127bc3adc4fce7b0uLL},  /* 77 */
+  {0x4516df8a16fe63d5uLL, 0x5b8d5a4c9b1e10ceuLL},  /* 78 */
+  {0x565c976c9cbdfccbuLL, 0x1270b0dfc1e59502uLL},  /* 79 */
+  {0x6bf3bd47c3ed7bfduLL, 0x770cdd17b25efa42uLL},  /* 80 */
+  {0x4378564cda746d7euLL, 0x5a680a2ecf7b5c69uLL},  /* 81 */
+  {0x54566be0111188deuLL, 0x31020cba835a3384uLL},  /* 82 */
+  {0x696c06d81555eb15uLL, 0x7d428fe92430c065uLL},  /* 83 */
+  {0x41e384470d55b2eduLL, 0x5e4999f1b69e783fuLL},  /* 84 */
+  {0x525c6558d0ab1fa9uLL, 0x15dc006e2446164fuLL},  /* 85 */
+  {0x66f37eaf04d5e793uLL, 0x3b530089ad579be2uLL},  /* 86 */
+  {0x40582f2d6305b0bcuLL, 0x1513e0560c56c16euLL},  /* 87 */
+  {0x506e3af8bbc71cebuLL, 0x1a58d86b8f6c71c9uLL},  /* 88 */
+  {0x6489c9b6eab8e426uLL, 0x00ef0e8673478e3buLL},  /* 89 */
+  {0x7dac3c24a5671d2fuLL, 0x412ad228101971c9uLL},  /* 90 */
+  {0x4e8ba596e760723duLL, 0x58bac3590a0fe71euLL},  /* 91 */
+  {0x622e8efca1388ecduLL, 0x0ee9742f4c93e0e6uLL},  /* 92 */
+  {0x7aba32bbc986b280uLL, 0x32a3d13b1fb8d91fuLL},  /* 93 */
+  {0x4cb45fb55df42f90uLL, 0x1fa662c4f3d387b3uLL},  /* 94 */
+  {0x5fe177a2b5713b74uLL, 0x278ffb7630c869a0uLL},  /* 95 */
+  {0x77d9d58b62cd8a51uLL, 0x3173fa53bcfa8408uLL},  /* 96 */
+  {0x4ae825771dc07672uLL, 0x6ee87c74561c9285uLL},  /* 97 */
+  {0x5da22ed4e530940fuLL, 0x4aa29b916ba3b726uLL},  /* 98 */
+  {0x750aba8a1e7cb913uLL, 0x3d4b4275c68ca4f0uLL},  /* 99 */
+  {0x4926b496530df3acuLL, 0x164f09899c17e716uLL},  /* 100 */
+  {0x5b7061bbe7d17097uLL, 0x1be2cbec031de0dcuLL},  /* 101 */
+  {0x724c7a2ae1c5ccbduLL, 0x02db7ee703e55912uLL},  /* 102 */
+  {0x476fcc5acd1b9ff6uLL, 0x11c92f50626f57acuLL},  /* 103 */
+  {0x594bbf71806287f3uLL, 0x563b7b247b0b2d96uLL},  /* 104 */
+  {0x6f9eaf4de07b29f0uLL, 0x4bca59ed99cdf8fcuLL},  /* 105 */
+  {0x45c32d90ac4cfa36uLL, 0x2f5e78348020bb9euLL},  /* 106 */
+  {0x5733f8f4d76038c3uLL, 0x7b361641a028ea85uLL},  /* 107 */
+  {0x6d00f7320d3846f4uLL, 0x7a039bd208332526uLL},  /* 108 */
+  {0x44209a7f48432c59uLL, 0x0c424163451ff738uLL},  /* 109 */
+  {0x5528c11f1a53f76fuLL, 0x2f52d1bc1667f506uLL},  /* 110 */
+  {0x6a72f166e0e8f54buLL, 0x1b27862b1c01f247uLL},  /* 111 */
+  {0x4287d6e04c91994fuLL, 0x00f8b3daf181376duLL},  /* 112 */
+  {0x5329cc985fb5ffa2uLL, 0x6136e0d1ade18548uLL},  /* 113 */
+  {0x67f43fbe77a37f8buLL, 0x398499061959e699uLL},  /* 114 */
+  {0x40f8a7d70ac62fb7uLL, 0x13f2dfa3cfd83020uLL},  /* 115 */
+  {0x5136d1cccd77bba4uLL, 0x78ef978cc3ce3c28uLL},  /* 116 */
+  {0x6584864000d5aa8euLL, 0x172b7d6ff4c1cb32uLL},  /* 117 */
+  {0x7ee5a7d0010b1531uLL, 0x5cf65ccbf1f23dfeuLL},  /* 118 */
+  {0x4f4f88e200a6ed3fuLL, 0x0a19f9ff773766bfuLL},  /* 119 */
+  {0x63236b1a80d0a88euLL, 0x6ca0787f5505406fuLL},  /* 120 */
+  {0x7bec45e12104d2b2uLL, 0x47c8969f2a46908auLL},  /* 121 */
+  {0x4d73abacb4a303afuLL, 0x4cdd5e237a6c1a57uLL},  /* 122 */
+  {0x60d09697e1cbc49buLL, 0x4014b5ac590720ecuLL},  /* 123 */
+  {0x7904bc3dda3eb5c2uLL, 0x3019e3176f48e927uLL},  /* 124 */
+  {0x4ba2f5a6a8673199uLL, 0x3e102deea58d91b9uLL},  /* 125 */
+  {0x5e8bb3105280fdffuLL, 0x6d94396a4ef0f627uLL},  /* 126 */
+  {0x762e9fd467213d7fuLL, 0x68f947c4e2ad33b0uLL},  /* 127 */
+  {0x49dd23e4c074c66fuLL, 0x719bccdb0dac404euLL},  /* 128 */
+  {0x5c546cddf091f80buLL, 0x6e02c011d1175062uLL},  /* 129 */
+  {0x736988156cb6760euLL, 0x69837016455d247auLL},  /* 130 */
+  {0x4821f50d63f209c9uLL, 0x21f2260deb5a36ccuLL},  /* 131 */
+  {0x5a2a7250bcee8c3buLL, 0x4a6eaf916630c47fuLL},  /* 132 */
+  {0x70b50ee4ec2a2f4auLL, 0x3d0a5b75bfbcf59fuLL},  /* 133 */
+  {0x4671294f139a5d8euLL, 0x4626792997d61984uLL},  /* 134 */
+  {0x580d73a2d880f4f2uLL, 0x17b01773fdcb9fe4uLL},  /* 135 */
+  {0x6e10d08b8ea1322euLL, 0x5d9c1d50fd3e87dduLL},  /* 136 */
+  {0x44ca82573924bf5duLL, 0x1a8192529e4714ebuLL},  /* 137 */
+  {0x55fd22ed076def34uLL, 0x4121f6e745d8da25uLL},  /* 138 */
+  {0x6b7c6ba849496b01uLL, 0x516a74a1174f10aeuLL},  /* 139 */
+  {0x432dc3492dcde2e1uLL, 0x02e288e4ae916a6duLL},  /* 140 */
+  {0x53f9341b79415b99uLL, 0x239b2b1dda35c508uLL},  /* 141 */
+  {0x68f781225791b27fuLL, 0x4c81f5e550c3364auLL},  /* 142 */
+  {0x419ab0b576bb0f8fuLL, 0x5fd139af527a01efuLL},  /* 143 */
+  {0x52015ce2d469d373uLL, 0x57c5881b2718826auLL},  /* 144 */
+  {0x6681b41b89844850uLL, 0x4db6ea21f0dea304uLL},  /* 145 */
+  {0x4011109135f2ad32uLL, 0x30925255368b25e3uLL},  /* 146 */
+  {0x501554b5836f587euLL, 0x7cb6e6ea842def5cuLL},  /* 147 */
+  {0x641aa9e2e44b2e9euLL, 0x5be4a0a525396b32uLL},  /* 148 */
+  {0x7d21545b9d5dfa46uLL, 0x32ddc8ce6e87c5ffuLL},  /* 149 */
+  {0x4e34d4b9425abc6buLL, 0x7fca9d810514dbbfuLL},  /* 150 */
+  {0x61c209e792f16b86uLL, 0x7fbd44e1465a12afuLL},  /* 151 */
+  {0x7a328c6177adc668uLL, 0x5fac961997f0975buLL},  /* 152 */
+  {0x4c5f97bceacc9c01uLL, 0x3bcbddcffef65e99uLL},  /* 153 */
+  {0x5f777dac257fc301uLL, 0x6abed543feb3f63fuLL},  /* 154 */
+  {0x77555d172edfb3c2uLL, 0x256e8a94fe60f3cfuLL},  /* 155 */
+  {0x4a955a2e7d4bd059uLL, 0x3765169d1efc9861uLL},  /* 156 */
+  {0x5d3ab0ba1c9ec46fuLL, 0x653e5c4466bbbe7auLL},  /* 157 */
+  {0x74895ce8a3c6758buLL, 0x5e8df355806aae18uLL},  /* 158 */
+  {0x48d5da11665c0977uLL, 0x2b18b8157042accfuLL},  /* 159 */
+  {0x5b0b5095bff30bd5uLL, 0x15dee61acc535803uLL},  /* 160 */
+  {0x71ce24bb2fefcecauLL, 0x3b569fa17f682e03uLL},  /* 161 */
+  {0x4720d6f4fdf5e13euLL, 0x451623c4efa11cc2uLL},  /* 162 */
+  {0x58e90cb23d73598euLL, 0x165bacb62b8963f3uLL},  /* 163 */
+  {0x6f234fdeccd02ff1uLL, 0x5bf297e3b66bbcefuLL},  /* 164 */
+  {0x457611eb40021df7uLL, 0x09779eee52035616uLL},  /* 165 */
+  {0x56d396661002a574uLL, 0x6bd586a9e6842b9buLL},  /* 166 */
+  {0x6c887bff94034ed2uLL, 0x06cae85460253682uLL},  /* 167 */
+  {0x43d54d7fbc821143uLL, 0x243ed134bc174211uLL},  /* 168 */
+  {0x54caa0dfaba29594uLL, 0x0d4e8581eb1d1295uLL},  /* 169 */
+  {0x69fd4917968b3af9uLL, 0x10a226e265e4573buLL},  /* 170 */
+  {0x423e4daebe1704dbuLL, 0x5a65584d7faeb685uLL},  /* 171 */
+  {0x52cde11a6d9cc612uLL, 0x50feae60df9a6426uLL},  /* 172 */
+  {0x678159610903f797uLL, 0x253e59f91780fd2fuLL},  /* 173 */
+  {0x40b0d7dca5a27abeuLL, 0x4746f83baeb09e3euLL},  /* 174 */
+  {0x50dd0dd3cf0b196euLL, 0x1918b64a9a5cc5cduLL},  /* 175 */
+  {0x65145148c2cddfc9uLL, 0x5f5ee3dd40f3f740uLL},  /* 176 */
+  {0x7e59659af38157bcuLL, 0x17369cd49130f510uLL},  /* 177 */
+  {0x4ef7df80d830d6d5uLL, 0x4e822204dabe992auLL},  /* 178 */
+  {0x62b5d7610e3d0c8buLL, 0x0222aa86116e3f75uLL},  /* 179 */
+  {0x7b634d3951cc4faduLL, 0x62ab552795c9cf52uLL},  /* 180 */
+  {0x4d1e1043d31fb1ccuLL, 0x4dab1538bd9e2193uLL},  /* 181 */
+  {0x60659454c7e79e3fuLL, 0x6115da86ed05a9f8uLL},  /* 182 */
+  {0x787ef969f9e185cfuLL, 0x595b5128a8471476uLL},  /* 183 */
+  {0x4b4f5be23c2cf3a1uLL, 0x67d912b9692c6ccauLL},  /* 184 */
+  {0x5e2332dacb38308auLL, 0x21cf5767c37787fcuLL},  /* 185 */
+  {0x75abff917e063cacuLL, 0x6a432d41b45569fbuLL},  /* 186 */
+  {0x498b7fbaeec3e5ecuLL, 0x0269fc4910b5623duLL},  /* 187 */
+  {0x5bee5fa9aa74df67uLL, 0x03047b5b54e2baccuLL},  /* 188 */
+  {0x72e9f79415121740uLL, 0x63c59a322a1b697fuLL},  /* 189 */
+  {0x47d23abc8d2b4e88uLL, 0x3e5b805f5a5121f0uLL},  /* 190 */
+  {0x59c6c96bb076222auLL, 0x4df2607730e56a6cuLL},  /* 191 */
+  {0x70387bc69c93aab5uLL, 0x216ef894fd1ec506uLL},  /* 192 */
+  {0x46234d5c21dc4ab1uLL, 0x24e55b5d1e333b24uLL},  /* 193 */
+  {0x57ac20b32a535d5duLL, 0x4e1eb23465c009eduLL},  /* 194 */
+  {0x6d9728dff4e834b5uLL, 0x01a65ec17f300c68uLL},  /* 195 */
+  {0x447e798bf91120f1uLL, 0x1107fb38ef7e07c1uLL},  /* 196 */
+  {0x559e17eef755692duLL, 0x3549fa072b5d89b1uLL},  /* 197 */
+  {0x6b059deab52ac378uLL, 0x629c7888f634ec1euLL},  /* 198 */
+  {0x42e382b2b13aba2buLL, 0x3da1cb5599e11393uLL},  /* 199 */
+  {0x539c635f5d8968b6uLL, 0x2d0a3e2b00595877uLL},  /* 200 */
+  {0x68837c3734ebc2e3uLL, 0x784ccdb5c06fae95uLL},  /* 201 */
+  {0x41522da2811359ceuLL, 0x3b3000919845cd1duLL},  /* 202 */
+  {0x51a6b90b21583042uLL, 0x09fc00b5fe574065uLL},  /* 203 */
+  {0x6610674de9ae3c52uLL, 0x4c7b00e37ded107euLL},  /* 204 */
+  {0x7f9481216419cb67uLL, 0x1f99c11c5d68549duLL},  /* 205 */
+  {0x4fbcd0b4de901f20uLL, 0x43c018b1ba6134e2uLL},  /* 206 */
+  {0x63ac04e2163426e8uLL, 0x54b01ede28f9821buLL},  /* 207 */
+  {0x7c97061a9bc130a2uLL, 0x69dc2695b337e2a1uLL},  /* 208 */
+  {0x4dde63d0a158be65uLL, 0x6229981d9002eda5uLL},  /* 209 */
+  {0x6155fcc4c9aeedffuLL, 0x1ab3fe24f403a90euLL},  /* 210 */
+  {0x79ab7bf5fc1aa97fuLL, 0x0160fdae31049351uLL},  /* 211 */
+  {0x4c0b2d79bd90a9efuLL, 0x30dc9e8cdea2dc13uLL},  /* 212 */
+  {0x5f0df8d82cf4d46buLL, 0x1d13c630164b9318uLL},  /* 213 */
+  {0x76d1770e38320986uLL, 0x0458b7bc1bde77dduLL},  /* 214 */
+  {0x4a42ea68e31f45f3uLL, 0x62b772d5916b0aebuLL},  /* 215 */
+  {0x5cd3a5031be71770uLL, 0x5b654f8af5c5cda5uLL},  /* 216 */
+  {0x74088e43e2e0dd4cuLL, 0x723ea36db337410euLL},  /* 217 */
+  {0x488558ea6dcc8a50uLL, 0x07672624900288a9uLL},  /* 218 */
+  {0x5aa6af25093face4uLL, 0x0940efadb4032ad3uLL},  /* 219 */
+  {0x71505aee4b8f981duLL, 0x0b912b992103f588uLL},  /* 220 */
+  {0x46d238d4ef39bf12uLL, 0x173abb3fb4a27975uLL},  /* 221 */
+  {0x5886c70a2b082ed6uLL, 0x5d096a0fa1cb17d2uLL},  /* 222 */
+  {0x6ea878ccb5ca3a8cuLL, 0x344bc4938a3dddc7uLL},  /* 223 */
+  {0x45294b7ff19e6497uLL, 0x60af5adc3666aa9cuLL},  /* 224 */
+  {0x56739e5fee05fdbduLL, 0x58db319344005543uLL},  /* 225 */
+  {0x6c1085f7e9877d2duLL, 0x0f11fdf815006a94uLL},  /* 226 */
+  {0x438a53baf1f4ae3cuLL, 0x196b3ebb0d20429duLL},  /* 227 */
+  {0x546ce8a9ae71d9cbuLL, 0x1fc60e69d0685344uLL},  /* 228 */
+  {0x698822d41a0e503euLL, 0x07b7920444826815uLL},  /* 229 */
+  {0x41f515c49048f226uLL, 0x64d2bb42aad1810duLL},  /* 230 */
+  {0x52725b35b45b2eb0uLL, 0x3e076a135585e150uLL},  /* 231 */
+  {0x670ef2032171fa5cuLL, 0x4d8944982ae759a4uLL},  /* 232 */
+  {0x40695741f4e73c79uLL, 0x7075cadf1ad09807uLL},  /* 233 */
+  {0x5083ad1272210b98uLL, 0x2c933d96e184be08uLL},  /* 234 */
+  {0x64a498570ea94e7euLL, 0x37b80cfc99e5ed8auLL},  /* 235 */
+  {0x7dcdbe6cd253a21euLL, 0x05a6103bc05f68eduLL},  /* 236 */
+  {0x4ea0970403744552uLL, 0x6387ca25583ba194uLL},  /* 237 */
+  {0x6248bcc5045156a7uLL, 0x3c69bcaeae4a89f9uLL},  /* 238 */
+  {0x7adaebf64565ac51uLL, 0x2b842bda59dd2c77uLL},  /* 239 */
+  {0x4cc8d379eb5f8bb2uLL, 0x6b329b68782a3bcbuLL},  /* 240 */
+  {0x5ffb085866376e9fuLL, 0x45ff42429634cabduLL},  /* 241 */
+  {0x77f9ca6e7fc54a47uLL, 0x377f12d33bc1fd6duLL},  /* 242 */
+  {0x4afc1e850fdb4e6cuLL, 0x52af6bc405593e64uLL},  /* 243 */
+  {0x5dbb262653d22207uLL, 0x675b46b506af8dfduLL},  /* 244 */
+  {0x7529efafe8c6aa89uLL, 0x61321862485b717cuLL},  /* 245 */
+  {0x493a35cdf17c2a96uLL, 0x0cbf4f3d6d3926eeuLL},  /* 246 */
+  {0x5b88c3416ddb353buLL, 0x4fef230cc88770a9uLL},  /* 247 */
+  {0x726af411c952028auLL, 0x43eaebcffaa94cd3uLL},  /* 248 */
+  {0x4782d88b1dd34196uLL, 0x4a72d361fca9d004uLL},  /* 249 */
+  {0x59638eade54811fcuLL, 0x1d0f883a7bd44405uLL},  /* 250 */
+  {0x6fbc72595e9a167buLL, 0x24536a491ac95506uLL},  /* 251 */
+  {0x45d5c777db204e0duLL, 0x06b4226db0bdd524uLL},  /* 252 */
+  {0x574b3955d1e86190uLL, 0x28612b091ced4a6duLL},  /* 253 */
+  {0x6d1e07ab466279f4uLL, 0x327975cb64289d08uLL},  /* 254 */
+  {0x4432c4cb0bfd8c38uLL, 0x5f8be99f1e996225uLL},  /* 255 */
+  {0x553f75fdcefcef46uLL, 0x776ee406e63fbaaeuLL},  /* 256 */
+  {0x6a8f537d42bc2b18uLL, 0x554a9d089fcfa95auLL},  /* 257 */
+  {0x4299942e49b59aefuLL, 0x354ea22563e1c9d8uLL},  /* 258 */
+  {0x533ff939dc2301abuLL, 0x22a24aaebcda3c4euLL},  /* 259 */
+  {0x680ff788532bc216uLL, 0x0b4add5a6c10cb62uLL},  /* 260 */
+  {0x4109fab533fb594duLL, 0x670eca58838a7f1duLL},  /* 261 */
+  {0x514c796280fa2fa1uLL, 0x20d27ceea46d1ee4uLL},  /* 262 */
+  {0x659f97bb2138bb89uLL, 0x49071c2a4d88669duLL},  /* 263 */
+  {0x7f077da9e986ea6buLL, 0x7b48e334e0ea8045uLL},  /* 264 */
+  {0x4f64ae8a31f45283uLL, 0x3d0d8e010c92902buLL},  /* 265 */
+  {0x633dda2cbe716724uLL, 0x2c50f1814fb73436uLL},  /* 266 */
+  {0x7c0d50b7ee0dc0eduLL, 0x37652de1a3a50143uLL},  /* 267 */
+  {0x4d885272f4c89894uLL, 0x329f3cad064720cauLL},  /* 268 */
+  {0x60ea670fb1fabeb9uLL, 0x3f470bd847d8e8fduLL},  /* 269 */
+  {0x792500d39e796e67uLL, 0x6f18cece59cf233cuLL},  /* 270 */
+  {0x4bb72084430be500uLL, 0x756f8140f8217605uLL},  /* 271 */
+  {0x5ea4e8a553cede41uLL, 0x12cb61913629d387uLL},  /* 272 */
+  {0x764e22cea8c295d1uLL, 0x377e39f583b44868uLL},  /* 273 */
+  {0x49f0d5c129799da2uLL, 0x72aee4397250ad41uLL},  /* 274 */
+  {0x5c6d0b3173d8050buLL, 0x4f5a9d47cee4d891uLL},  /* 275 */
+  {0x73884dfdd0ce064euLL, 0x43314499c29e0eb6uLL},  /* 276 */
+  {0x483530bea280c3f1uLL, 0x09fecae019a2c932uLL},  /* 277 */
+  {0x5a427cee4b20f4eduLL, 0x2c7e7d98200b7b7euLL},  /* 278 */
+  {0x70d31c29dde93228uLL, 0x579e1cfe280e5a5duLL},  /* 279 */
+  {0x4683f19a2ab1bf59uLL, 0x36c2d21ed908f87buLL},  /* 280 */
+  {0x5824ee00b55e2f2fuLL, 0x647386a68f4b3699uLL},  /* 281 */
+  {0x6e2e2980e2b5bafbuLL, 0x5d906850331e043fuLL},  /* 282 */
+  {0x44dcd9f08db194dduLL, 0x2a7a41321ff2c2a8uLL},  /* 283 */
+  {0x5614106cb11dfa14uLL, 0x5518d17ea7ef7352uLL},  /* 284 */
+  {0x6b991487dd657899uLL, 0x6a5f05de51eb5026uLL},  /* 285 */
+  {0x433facd4ea5f6b60uLL, 0x127b63aaf3331218uLL},  /* 286 */
+  {0x540f980a24f74638uLL, 0x171a3c95afffd69euLL},  /* 287 */
+  {0x69137e0cae3517c6uLL, 0x1ce0cbbb1bffcc45uLL},  /* 288 */
+  {0x41ac2ec7ece12edbuLL, 0x720c7f54f17fdfabuLL},  /* 289 */
+  {0x52173a79e8197a92uLL, 0x6e8f9f2a2ddfd796uLL},  /* 290 */
+  {0x669d0918621fd937uLL, 0x4a3386f4b957cd7buLL},  /* 291 */
+  {0x402225af3d53e7c2uLL, 0x5e603458f3d6e06duLL},  /* 292 */
+  {0x502aaf1b0ca8e1b3uLL, 0x35f8416f30cc9888uLL},  /* 293 */
+  {0x64355ae1cfd31a20uLL, 0x237651cafcffbeaauLL},  /* 294 */
+  {0x7d42b19a43c7e0a8uLL, 0x2c53e63dbc3fae55uLL},  /* 295 */
+  {0x4e49af006a5cec69uLL, 0x1bb46fe695a7ccf5uLL},  /* 296 */
+  {0x61dc1ac084f42783uLL, 0x42a18be03b11c033uLL},  /* 297 */
+  {0x7a532170a6313164uLL, 0x3349eed849d6303fuLL},  /* 298 */
+  {0x4c73f4e667debedeuLL, 0x600e35472e25de28uLL},  /* 299 */
+  {0x5f90f22001d66e96uLL, 0x3811c298f9af55b1uLL},  /* 300 */
+  {0x77752ea8024c0a3cuLL, 0x0616333f381b2b1euLL},  /* 301 */
+  {0x4aa93d29016f8665uLL, 0x43cde0078310faf3uLL},  /* 302 */
+  {0x5d538c7341cb67feuLL, 0x74c1580963d539afuLL},  /* 303 */
+  {0x74a86f90123e41feuLL, 0x51f1ae0bbcca881buLL},  /* 304 */
+  {0x48e945ba0b66e93fuLL, 0x13370cc755fe9511uLL},  /* 305 */
+  {0x5b2397288e40a38euLL, 0x7804cff92b7e3a55uLL},  /* 306 */
+  {0x71ec7cf2b1d0cc72uLL, 0x560603f7765dc8eauLL},  /* 307 */
+  {0x4733ce17af227fc7uLL, 0x55c3c27aa9fa9d93uLL},  /* 308 */
+  {0x5900c19d9aeb1fb9uLL, 0x4b34b319547944f7uLL},  /* 309 */
+  {0x6f40f20501a5e7a7uLL, 0x7e01dfdfa9979635uLL},  /* 310 */
+  {0x458897432107b0c8uLL, 0x7ec12bebc9febde1uLL},  /* 311 */
+  {0x56eabd13e9499cfbuLL, 0x1e7176e6bc7e6d59uLL},  /* 312 */
+  {0x6ca56c58e39c043auLL, 0x060dd4a06b9e08b0uLL},  /* 313 */
+  {0x43e763b78e4182a4uLL, 0x23c8a4e44342c56euLL},  /* 314 */
+  {0x54e13ca571d1e34duLL, 0x2cbace1d541376c9uLL},  /* 315 */
+  {0x6a198bcece465c20uLL, 0x57e981a4a918547buLL},  /* 316 */
+  {0x424ff76140ebf994uLL, 0x36f1f106e9af34cduLL},  /* 317 */
+  {0x52e3f5399126f7f9uLL, 0x44ae6d48a41b0201uLL},  /* 318 */
+  {0x679cf287f570b5f7uLL, 0x75da089acd21c281uLL},  /* 319 */
+  {0x40c21794f96671bauLL, 0x79a84560c0351991uLL},  /* 320 */
+  {0x50f29d7a37c00e29uLL, 0x581256b8f0425ff5uLL},  /* 321 */
+  {0x652f44d8c5b011b4uLL, 0x0e16ec672c52f7f2uLL},  /* 322 */
+  {0x7e7b160ef71c1621uLL, 0x119ca780f767b5eeuLL},  /* 323 */
+  {0x4f0cedc95a718dd4uLL, 0x5b01e8b09aa0d1b5uLL}  /* 324 */
+};
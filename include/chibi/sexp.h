@@ -80,6 +80,9 @@ typedef unsigned long size_t;
 #endif
 #include <sys/stat.h>
 #include <sys/types.h>
+#if SEXP_USE_VECTORED_IO
+#include <sys/uio.h>
+#endif
 #include <math.h>
 #if SEXP_USE_FLONUMS
 #include <float.h>
@@ -130,12 +133,6 @@ typedef unsigned long size_t;
 #define SEXP_POINTER_MAGIC 0xFDCA9764uL /* arbitrary */
 #endif
 
-#if SEXP_USE_HASH_SYMS
-#define SEXP_SYMBOL_TABLE_SIZE 389
-#else
-#define SEXP_SYMBOL_TABLE_SIZE 1
-#endif
-
 enum sexp_types {
   SEXP_OBJECT,
   SEXP_TYPE,
@@ -364,11 +361,19 @@ struct sexp_core_form_struct {
 
 struct sexp_struct {
   sexp_tag_t tag;
+#if SEXP_USE_HEADER_HASH
+  /* a bit rather than a byte, to leave more room for the hash */
+  unsigned int markedp:1;
+#else
   char markedp;
+#endif
   unsigned int immutablep:1;
   unsigned int freep:1;
   unsigned int brokenp:1;
   unsigned int syntacticp:1;
+#if SEXP_USE_HEADER_HASH
+  unsigned int hash:SEXP_HEADER_HASH_BITS;
+#endif
 #if SEXP_USE_TRACK_ALLOC_SOURCE
   const char* source;
   void* backtrace[SEXP_BACKTRACE_SIZE];
@@ -400,17 +405,20 @@ struct sexp_struct {
 #else
       sexp_uint_t offset, length;
       sexp bytes;
+#if SEXP_USE_STRING_INDEX_TABLE
+      sexp index_table;
+#endif
 #endif
     } string;
     struct {
-      sexp_uint_t length;
+      sexp_uint_t length, hash;
       char data SEXP_FLEXIBLE_ARRAY;
     } symbol;
     struct {
       FILE *stream;
       char *buf;
       char openp, bidirp, binaryp, shutdownp, no_closep, sourcep,
-        blockedp, fold_casep;
+        blockedp, fold_casep, mmappedp;
       sexp_uint_t offset, line, flags;
       size_t size;
       sexp name;
@@ -501,7 +509,8 @@ struct sexp_struct {
       sexp_heap heap;
       struct sexp_gc_var_t *saves;
 #if SEXP_USE_GREEN_THREADS
-      sexp_sint_t refuel;
+      sexp_sint_t refuel, quantum, priority;
+      sexp_uint_t steps, usecs, resumed;
       unsigned char* ip;
       struct timeval tval;
 #endif
@@ -686,6 +695,7 @@ void* sexp_alloc(sexp ctx, size_t size);
 #define sexp_freep(x)            ((x)->freep)
 #define sexp_brokenp(x)          ((x)->brokenp)
 #define sexp_pointer_magic(x)    ((x)->magic)
+#define sexp_pointer_hash(x)     ((x)->hash)
 
 #if SEXP_USE_TRACK_ALLOC_SOURCE
 #define sexp_pointer_source(x)   ((x)->source)
@@ -795,6 +805,10 @@ SEXP_API int sexp_idp(sexp x);
 #define sexp_port_writer(x)  (sexp_vector_ref(sexp_port_cookie(x), SEXP_THREE))
 #define sexp_port_seeker(x)  (sexp_vector_ref(sexp_port_cookie(x), SEXP_FOUR))
 #define sexp_port_closer(x)  (sexp_vector_ref(sexp_port_cookie(x), SEXP_FIVE))
+/* an exception raised by one of the above, until reported */
+#define sexp_port_exception(x) (sexp_vector_ref(sexp_port_cookie(x), SEXP_ZERO))
+
+#define sexp_port_exceptionp(x) (sexp_port_customp(x) && sexp_exceptionp(sexp_port_exception(x)))
 
 /***************************** constructors ****************************/
 
@@ -999,6 +1013,15 @@ SEXP_API sexp sexp_make_unsigned_integer(sexp ctx, sexp_luint_t x);
 #define sexp_string_offset(x) (sexp_field(x, string, SEXP_STRING, offset))
 #define sexp_string_data(x)   (sexp_bytes_data(sexp_string_bytes(x))+sexp_string_offset(x))
 #endif
+#if SEXP_USE_STRING_INDEX_TABLE
+/* #f if unknown, #t if the string is pure ASCII, otherwise a bytevector */
+/* holding the char length followed by the byte offset of every */
+/* SEXP_STRING_INDEX_TABLE_CHUNK_SIZE'th char */
+#define sexp_string_index_table(x) (sexp_field(x, string, SEXP_STRING, index_table))
+#define sexp_string_index_invalidate(x) (sexp_string_index_table(x) = SEXP_FALSE)
+#else
+#define sexp_string_index_invalidate(x)
+#endif
 #define sexp_string_maybe_null_data(x) (sexp_not(x) ? NULL : sexp_string_data(x))
 
 #if SEXP_USE_PACKED_STRINGS
@@ -1012,6 +1035,8 @@ SEXP_API sexp sexp_make_unsigned_integer(sexp ctx, sexp_luint_t x);
 
 #define sexp_lsymbol_data(x)   (sexp_field(x, symbol, SEXP_SYMBOL, data))
 #define sexp_lsymbol_length(x) (sexp_field(x, symbol, SEXP_SYMBOL, length))
+#define sexp_lsymbol_hash(x)   (sexp_field(x, symbol, SEXP_SYMBOL, hash))
+#define sexp_lsymbol_newp(x)   ((x)->brokenp)
 
 #define sexp_port_stream(p)     (sexp_pred_field(p, port, sexp_portp, stream))
 #define sexp_port_name(p)       (sexp_pred_field(p, port, sexp_portp, name))
@@ -1024,9 +1049,12 @@ SEXP_API sexp sexp_make_unsigned_integer(sexp ctx, sexp_luint_t x);
 #define sexp_port_sourcep(p)    (sexp_pred_field(p, port, sexp_portp, sourcep))
 #define sexp_port_blockedp(p)   (sexp_pred_field(p, port, sexp_portp, blockedp))
 #define sexp_port_fold_casep(p) (sexp_pred_field(p, port, sexp_portp, fold_casep))
+#define sexp_port_mmappedp(p)   (sexp_pred_field(p, port, sexp_portp, mmappedp))
 #define sexp_port_cookie(p)     (sexp_pred_field(p, port, sexp_portp, cookie))
 #define sexp_port_buf(p)        (sexp_pred_field(p, port, sexp_portp, buf))
 #define sexp_port_size(p)       (sexp_pred_field(p, port, sexp_portp, size))
+/* the allocated size of the buffer of a file descriptor port */
+#define sexp_port_capacity(p)   (sexp_stringp(sexp_port_cookie(p)) ? (sexp_uint_t)sexp_string_size(sexp_port_cookie(p)) : (sexp_uint_t)SEXP_PORT_BUFFER_SIZE)
 #define sexp_port_offset(p)     (sexp_pred_field(p, port, sexp_portp, offset))
 #define sexp_port_flags(p)      (sexp_pred_field(p, port, sexp_portp, flags))
 #define sexp_port_fd(p)         (sexp_pred_field(p, port, sexp_portp, fd))
@@ -1162,6 +1190,22 @@ SEXP_API sexp sexp_make_unsigned_integer(sexp ctx, sexp_luint_t x);
 #define sexp_ephemeron_key(x)   (sexp_field(x, ephemeron, SEXP_EPHEMERON, key))
 #define sexp_ephemeron_value(x) (sexp_field(x, ephemeron, SEXP_EPHEMERON, value))
 
+/* The hash table record type is defined in (srfi 69), but weak */
+/* tables are cleaned out by the gc, so their layout is shared here. */
+#define sexp_hash_table_entries(x)     sexp_slot_ref(x, 0)
+#define sexp_hash_table_size(x)        sexp_slot_ref(x, 1)
+#define sexp_hash_table_hash_fn(x)     sexp_slot_ref(x, 2)
+#define sexp_hash_table_eq_fn(x)       sexp_slot_ref(x, 3)
+#define sexp_hash_table_old_entries(x) sexp_slot_ref(x, 4)
+#define sexp_hash_table_migrated(x)    sexp_slot_ref(x, 5)
+#define sexp_hash_table_deleted(x)     sexp_slot_ref(x, 6)
+#define sexp_hash_table_weakness(x)    sexp_slot_ref(x, 7)
+
+/* hash table weakness flags */
+#define SEXP_WEAK_KEYS      1
+#define SEXP_WEAK_VALUES    2
+#define SEXP_EPHEMERAL_KEYS 4
+
 #define sexp_context_env(x)      (sexp_field(x, context, SEXP_CONTEXT, env))
 #define sexp_context_stack(x)    (sexp_field(x, context, SEXP_CONTEXT, stack))
 #define sexp_context_parent(x)   (sexp_field(x, context, SEXP_CONTEXT, parent))
@@ -1181,6 +1225,11 @@ SEXP_API sexp sexp_make_unsigned_integer(sexp ctx, sexp_luint_t x);
 #define sexp_context_gc_usecs(x) 0
 #endif
 #define sexp_context_refuel(x)   (sexp_field(x, context, SEXP_CONTEXT, refuel))
+#define sexp_context_quantum(x)  (sexp_field(x, context, SEXP_CONTEXT, quantum))
+#define sexp_context_priority(x) (sexp_field(x, context, SEXP_CONTEXT, priority))
+#define sexp_context_steps(x)    (sexp_field(x, context, SEXP_CONTEXT, steps))
+#define sexp_context_usecs(x)    (sexp_field(x, context, SEXP_CONTEXT, usecs))
+#define sexp_context_resumed(x)  (sexp_field(x, context, SEXP_CONTEXT, resumed))
 #define sexp_context_ip(x)       (sexp_field(x, context, SEXP_CONTEXT, ip))
 #define sexp_context_proc(x)     (sexp_field(x, context, SEXP_CONTEXT, proc))
 #define sexp_context_timeval(x)  (sexp_field(x, context, SEXP_CONTEXT, tval))
@@ -1224,11 +1273,19 @@ SEXP_API sexp_heap sexp_global_heap;
 #define sexp_context_max_size(ctx) sexp_context_heap(ctx)->max_size
 #endif
 
+/* The symbol table is an open-addressed vector of symbols, with */
+/* SEXP_FALSE in empty slots and SEXP_VOID in those of collected */
+/* symbols, and num_symbols counts the slots which aren't empty. */
+/* Symbols are held weakly, but survive the first collection after */
+/* they're interned, since C code commonly holds an interned symbol */
+/* unrooted across an allocation. */
 #if SEXP_USE_GLOBAL_SYMBOLS
-#define sexp_context_symbols(ctx) sexp_symbol_table
-SEXP_API sexp sexp_symbol_table[SEXP_SYMBOL_TABLE_SIZE];
+#define sexp_context_symbols(ctx)     sexp_symbol_table
+#define sexp_context_num_symbols(ctx) sexp_symbol_table_count
+SEXP_API sexp sexp_symbol_table, sexp_symbol_table_count;
 #else
-#define sexp_context_symbols(ctx) sexp_vector_data(sexp_global(ctx, SEXP_G_SYMBOLS))
+#define sexp_context_symbols(ctx)     sexp_global(ctx, SEXP_G_SYMBOLS)
+#define sexp_context_num_symbols(ctx) sexp_global(ctx, SEXP_G_NUM_SYMBOLS)
 #endif
 
 #define sexp_context_types(ctx)    sexp_vector_data(sexp_global(ctx, SEXP_G_TYPES))
@@ -1321,6 +1378,7 @@ SEXP_API sexp sexp_symbol_table[SEXP_SYMBOL_TABLE_SIZE];
 enum sexp_context_globals {
 #if ! SEXP_USE_GLOBAL_SYMBOLS
   SEXP_G_SYMBOLS,
+  SEXP_G_NUM_SYMBOLS,
 #endif
   SEXP_G_TYPES,
   SEXP_G_FEATURES,
@@ -1351,6 +1409,7 @@ enum sexp_context_globals {
 #endif
 #if SEXP_USE_WEAK_REFERENCES
   SEXP_G_WEAK_OBJECTS_PRESENT,
+  SEXP_G_WEAK_TABLES,
   SEXP_G_FILE_DESCRIPTORS,
   SEXP_G_NUM_FILE_DESCRIPTORS,
 #endif
@@ -1411,7 +1470,8 @@ SEXP_API sexp sexp_push_op(sexp ctx, sexp* loc, sexp x);
 /***************************** general API ****************************/
 
 #define sexp_read_char(x, p) (sexp_port_buf(p) ? ((sexp_port_offset(p) < sexp_port_size(p)) ? ((unsigned char*)sexp_port_buf(p))[sexp_port_offset(p)++] : sexp_buffered_read_char(x, p)) : getc(sexp_port_stream(p)))
-#define sexp_push_char(x, c, p) ((c!=EOF) && (sexp_port_buf(p) ? (sexp_port_buf(p)[--sexp_port_offset(p)] = ((char)(c))) : ungetc(c, sexp_port_stream(p))))
+/* only store the char if it differs, so mapped file buffers stay clean */
+#define sexp_push_char(x, c, p) ((c!=EOF) && (sexp_port_buf(p) ? (sexp_port_buf(p)[--sexp_port_offset(p)] == ((char)(c)) || (sexp_port_buf(p)[sexp_port_offset(p)] = ((char)(c)))) : ungetc(c, sexp_port_stream(p))))
 #define sexp_write_char(x, c, p) (sexp_port_buf(p) ? ((sexp_port_offset(p) < sexp_port_size(p)) ? ((((sexp_port_buf(p))[sexp_port_offset(p)++]) = (char)(c)), 0) : sexp_buffered_write_char(x, c, p)) : putc(c, sexp_port_stream(p)))
 #define sexp_write_string(x, s, p) (sexp_port_buf(p) ? sexp_buffered_write_string(x, s, p) : fputs(s, sexp_port_stream(p)))
 #define sexp_write_string_n(x, s, n, p) (sexp_port_buf(p) ? sexp_buffered_write_string_n(x, s, n, p) : fwrite(s, 1, n, sexp_port_stream(p)))
@@ -1423,6 +1483,7 @@ SEXP_API int sexp_buffered_write_char (sexp ctx, int c, sexp p);
 SEXP_API int sexp_buffered_write_string_n (sexp ctx, const char *str, sexp_uint_t len, sexp p);
 SEXP_API int sexp_buffered_write_string (sexp ctx, const char *str, sexp p);
 SEXP_API int sexp_buffered_flush (sexp ctx, sexp p, int forcep);
+SEXP_API sexp sexp_port_take_exception (sexp p);
 
 #define sexp_newline(ctx, p) sexp_write_char((ctx), '\n', (p))
 #define sexp_at_eofp(p)      (feof(sexp_port_stream(p)))
@@ -1461,6 +1522,7 @@ SEXP_API sexp sexp_cons_op(sexp ctx, sexp self, sexp_sint_t n, sexp head, sexp t
 SEXP_API sexp sexp_list2(sexp ctx, sexp a, sexp b);
 SEXP_API sexp sexp_equalp_bound (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp b, sexp depth, sexp bound);
 SEXP_API sexp sexp_equalp_op (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp b);
+SEXP_API sexp_uint_t sexp_identity_hash (sexp x);
 SEXP_API sexp sexp_listp_op(sexp ctx, sexp self, sexp_sint_t n, sexp obj);
 SEXP_API sexp sexp_reverse_op(sexp ctx, sexp self, sexp_sint_t n, sexp ls);
 SEXP_API sexp sexp_nreverse_op(sexp ctx, sexp self, sexp_sint_t n, sexp ls);
@@ -1496,6 +1558,10 @@ SEXP_API sexp sexp_read_bignum (sexp ctx, sexp in, sexp_uint_t init,
 SEXP_API sexp sexp_write_bignum (sexp ctx, sexp a, sexp out, sexp_uint_t base);
 #endif
 SEXP_API sexp sexp_read_float_tail(sexp ctx, sexp in, double whole, int negp);
+/* decimal digits kept when reading floats, beyond which only */
+/* whether any are nonzero matters for rounding */
+#define SEXP_MAX_DECIMAL_DIGITS 780
+SEXP_API sexp sexp_read_decimal_tail(sexp ctx, sexp in, const char *whole, int n, long exp, int negp);
 #if SEXP_USE_COMPLEX
 SEXP_API sexp sexp_read_complex_tail(sexp ctx, sexp in, sexp res);
 #endif
@@ -1528,6 +1594,7 @@ SEXP_API sexp sexp_lookup_type_op (sexp ctx, sexp self, sexp_sint_t n, sexp name
 SEXP_API sexp sexp_open_input_string_op (sexp ctx, sexp self, sexp_sint_t n, sexp str);
 SEXP_API sexp sexp_open_output_string_op (sexp ctx, sexp self, sexp_sint_t n);
 SEXP_API sexp sexp_get_output_string_op (sexp ctx, sexp self, sexp_sint_t n, sexp port);
+SEXP_API sexp sexp_output_string_chunks (sexp ctx, sexp self, sexp port);
 SEXP_API sexp sexp_make_exception (sexp ctx, sexp kind, sexp message, sexp irritants, sexp procedure, sexp source);
 SEXP_API sexp sexp_user_exception (sexp ctx, sexp self, const char *msg, sexp x);
 SEXP_API sexp sexp_file_exception (sexp ctx, sexp self, const char *msg, sexp x);
@@ -1540,6 +1607,7 @@ SEXP_API sexp sexp_apply (sexp context, sexp proc, sexp args);
 SEXP_API sexp sexp_apply1 (sexp ctx, sexp f, sexp x);
 SEXP_API sexp sexp_apply2 (sexp ctx, sexp f, sexp x, sexp y);
 SEXP_API sexp sexp_apply_no_err_handler (sexp ctx, sexp proc, sexp args);
+SEXP_API sexp sexp_apply_callback (sexp ctx, sexp proc, sexp args);
 SEXP_API sexp sexp_make_trampoline (sexp ctx, sexp proc, sexp args);
 SEXP_API sexp sexp_make_foreign (sexp ctx, const char *name, int num_args, int flags, const char *fname, sexp_proc1 f, sexp data);
 SEXP_API void sexp_init(void);
@@ -1548,11 +1616,18 @@ SEXP_API void sexp_init(void);
 SEXP_API int sexp_utf8_initial_byte_count (int c);
 SEXP_API int sexp_utf8_char_byte_count (int c);
 SEXP_API sexp_uint_t sexp_string_utf8_length (unsigned char *p, long len);
+SEXP_API sexp_uint_t sexp_utf8_lead_byte_count (const unsigned char *p, sexp_uint_t len);
+SEXP_API sexp_uint_t sexp_utf8_ascii_prefix_length (const unsigned char *p, sexp_uint_t len);
+SEXP_API sexp_uint_t sexp_utf8_count_byte (const unsigned char *p, sexp_uint_t len, int c);
+SEXP_API sexp_uint_t sexp_utf8_validate (const unsigned char *p, sexp_uint_t len);
 SEXP_API char* sexp_string_utf8_prev (unsigned char *p);
 SEXP_API sexp sexp_string_utf8_ref (sexp ctx, sexp str, sexp i);
 SEXP_API sexp sexp_string_utf8_index_ref (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp i);
 SEXP_API sexp sexp_string_index_to_cursor (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp index);
 SEXP_API sexp sexp_string_cursor_to_index (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp offset);
+#if SEXP_USE_STRING_INDEX_TABLE
+SEXP_API sexp_uint_t sexp_string_index_length (sexp ctx, sexp str);
+#endif
 SEXP_API sexp sexp_string_cursor_offset (sexp ctx, sexp self, sexp_sint_t n, sexp cur);
 SEXP_API sexp sexp_utf8_substring_op (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp start, sexp end);
 SEXP_API void sexp_utf8_encode_char (unsigned char* p, int len, int c);
@@ -1581,12 +1656,15 @@ SEXP_API int sexp_write_utf8_char (sexp ctx, int c, sexp out);
 #if SEXP_USE_GREEN_THREADS
 SEXP_API int sexp_maybe_block_port (sexp ctx, sexp in, int forcep);
 SEXP_API void sexp_maybe_unblock_port (sexp ctx, sexp in);
+SEXP_API int sexp_port_nonblockingp (sexp ctx, sexp in);
+SEXP_API sexp_sint_t sexp_extend_port_buffer (sexp ctx, sexp in, sexp_uint_t *mark);
 #define sexp_check_block_port(ctx, in, forcep)          \
   if (sexp_maybe_block_port(ctx, in, forcep))           \
     return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR)
 #else
 #define sexp_maybe_block_port(ctx, in, forcep)
 #define sexp_maybe_unblock_port(ctx, in)
+#define sexp_port_nonblockingp(ctx, in) 0
 #define sexp_check_block_port(ctx, in, forcep)
 #endif
 
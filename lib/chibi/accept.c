@@ -24,6 +24,50 @@ sexp sexp_accept (sexp ctx, sexp self, int sock, struct sockaddr* addr, socklen_
   return sexp_make_fileno(ctx, sexp_make_fixnum(res), SEXP_FALSE);
 }
 
+/* Accept up to max pending connections at once, returning a list of */
+/* the new sockets.  Draining the backlog in one call saves a trip */
+/* through the scheduler and poll per connection under load.  Blocks */
+/* like accept if no connections are pending.  Only non-blocking */
+/* listeners are drained, since on a blocking one the second accept */
+/* would wait for another connection to arrive. */
+
+sexp sexp_accept_batch (sexp ctx, sexp self, int sock, int max) {
+  int res = -1, i, flags;
+  sexp_gc_var2(ls, fd);
+  flags = fcntl(sock, F_GETFL);
+  if (flags < 0 || !(flags & O_NONBLOCK))
+    max = 1;
+  sexp_gc_preserve2(ctx, ls, fd);
+  ls = SEXP_NULL;
+  for (i=0; i<max; ++i) {
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && SEXP_USE_GREEN_THREADS
+    res = accept4(sock, NULL, NULL, SOCK_NONBLOCK);
+#else
+    res = accept(sock, NULL, NULL);
+#if SEXP_USE_GREEN_THREADS
+    if (res >= 0)
+      fcntl(res, F_SETFL, fcntl(res, F_GETFL) | O_NONBLOCK);
+#endif
+#endif
+    if (res < 0) break;
+    fd = sexp_make_fileno(ctx, sexp_make_fixnum(res), SEXP_FALSE);
+    ls = sexp_cons(ctx, fd, ls);
+  }
+#if SEXP_USE_GREEN_THREADS
+  if (ls == SEXP_NULL && res < 0 && errno == EWOULDBLOCK) {
+    fd = sexp_global(ctx, SEXP_G_THREADS_BLOCKER);
+    if (sexp_applicablep(fd)) {
+      sexp_apply2(ctx, fd, sexp_make_fixnum(sock), SEXP_FALSE);
+      ls = sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+    }
+  }
+#endif
+  if (sexp_pairp(ls))
+    ls = sexp_nreverse(ctx, ls);
+  sexp_gc_release2(ctx);
+  return ls;
+}
+
 /* likewise sendto and recvfrom should suspend the thread gracefully */
 
 #define sexp_zerop(x) ((x) == SEXP_ZERO || (sexp_flonump(x) && sexp_flonum_value(x) == 0.0))
@@ -91,6 +135,13 @@ sexp sexp_listen (sexp ctx, sexp self, sexp fileno, sexp backlog) {
 
 /* Additional utilities. */
 
+/* SO_REUSEPORT is not available everywhere, use -1 when missing. */
+#ifdef SO_REUSEPORT
+#define SEXP_SO_REUSEPORT SO_REUSEPORT
+#else
+#define SEXP_SO_REUSEPORT -1
+#endif
+
 sexp sexp_sockaddr_name (sexp ctx, sexp self, struct sockaddr* addr) {
   char buf[24];
   /* struct sockaddr_in *sa = (struct sockaddr_in *)addr; */
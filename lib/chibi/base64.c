@@ -0,0 +1,156 @@
+/*  base64.c -- native base64 encoding and decoding kernels   */
+/*  Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/*  BSD-style license: http://synthcode.com/license.txt       */
+
+#include <chibi/eval.h>
+
+/* Both kernels work on byte ranges and carry any partial group */
+/* between calls, so the port procedures can stream fixed size */
+/* chunks.  The decoder state is a fixnum holding the count of */
+/* pending sextets in the low two bits and the sextets above them, */
+/* or -1 once the = padding has been seen. */
+
+static const char base64_encode_table[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define BASE64_OUTSIDE 99
+#define BASE64_PAD 101
+
+static unsigned char base64_decode_table[256];
+
+static void base64_init_decode_table (void) {
+  int i;
+  memset(base64_decode_table, BASE64_OUTSIDE, sizeof(base64_decode_table));
+  for (i = 0; i < 64; i++)
+    base64_decode_table[(unsigned char)base64_encode_table[i]] = i;
+  /* be liberal for different common base64 formats */
+  base64_decode_table['-'] = 62;
+  base64_decode_table['_'] = 63;
+  base64_decode_table['~'] = 63;
+  base64_decode_table['='] = BASE64_PAD;
+}
+
+/* Encodes whole groups of 3 bytes from src[start, end) into dst, */
+/* and if final is true the trailing 1 or 2 bytes with padding. */
+/* Returns the number of bytes written to dst. */
+sexp sexp_base64_encode_x (sexp ctx, sexp self, sexp_sint_t n, sexp src,
+                           sexp start, sexp end, sexp dst, sexp final) {
+  const unsigned char *s;
+  unsigned char *d;
+  sexp_uint_t i, j, lo, hi, need;
+  sexp_uint32_t x;
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, src);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, start);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, end);
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, dst);
+  lo = sexp_unbox_fixnum(start);
+  hi = sexp_unbox_fixnum(end);
+  if (sexp_unbox_fixnum(start) < 0 || lo > hi || hi > sexp_bytes_length(src))
+    return sexp_user_exception(ctx, self, "base64-encode: bad range", end);
+  need = (hi - lo) / 3 * 4 + (sexp_truep(final) && (hi - lo) % 3 ? 4 : 0);
+  if (need > sexp_bytes_length(dst))
+    return sexp_user_exception(ctx, self, "base64-encode: output too small", dst);
+  s = (const unsigned char*) sexp_bytes_data(src);
+  d = (unsigned char*) sexp_bytes_data(dst);
+  for (i = lo, j = 0; i + 3 <= hi; i += 3, j += 4) {
+    x = ((sexp_uint32_t)s[i] << 16) | ((sexp_uint32_t)s[i+1] << 8) | s[i+2];
+    d[j]   = base64_encode_table[x >> 18];
+    d[j+1] = base64_encode_table[(x >> 12) & 63];
+    d[j+2] = base64_encode_table[(x >> 6) & 63];
+    d[j+3] = base64_encode_table[x & 63];
+  }
+  if (sexp_truep(final) && i < hi) {
+    x = (sexp_uint32_t)s[i] << 16;
+    if (i + 1 < hi) x |= (sexp_uint32_t)s[i+1] << 8;
+    d[j]   = base64_encode_table[x >> 18];
+    d[j+1] = base64_encode_table[(x >> 12) & 63];
+    d[j+2] = (i + 1 < hi) ? base64_encode_table[(x >> 6) & 63] : '=';
+    d[j+3] = '=';
+    j += 4;
+  }
+  return sexp_make_fixnum(j);
+}
+
+/* Decodes src[start, end) into dst, skipping characters outside the */
+/* alphabet and stopping at padding.  If final is true any pending */
+/* sextets are flushed.  Returns a pair of the number of bytes */
+/* written to dst and the new state. */
+sexp sexp_base64_decode_x (sexp ctx, sexp self, sexp_sint_t n, sexp src,
+                           sexp start, sexp end, sexp dst, sexp state,
+                           sexp final) {
+  const unsigned char *s;
+  unsigned char *d;
+  sexp_uint_t i, lo, hi, j = 0, need, len;
+  sexp_sint_t st;
+  sexp_uint32_t bits;
+  int count, c;
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, src);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, start);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, end);
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, dst);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, state);
+  lo = sexp_unbox_fixnum(start);
+  hi = sexp_unbox_fixnum(end);
+  if (sexp_unbox_fixnum(start) < 0 || lo > hi || hi > sexp_bytes_length(src))
+    return sexp_user_exception(ctx, self, "base64-decode: bad range", end);
+  st = sexp_unbox_fixnum(state);
+  count = st < 0 ? 0 : st & 3;
+  bits = st < 0 ? 0 : st >> 2;
+  /* an exact bound, at most 3 bytes for every 4 sextets, 1 for a */
+  /* trailing 1 or 2 and 2 for a trailing 3 */
+  len = count + hi - lo;
+  need = len / 4 * 3 + (len % 4 == 3 ? 2 : len % 4 ? 1 : 0);
+  if (need > sexp_bytes_length(dst))
+    return sexp_user_exception(ctx, self, "base64-decode: output too small", dst);
+  s = (const unsigned char*) sexp_bytes_data(src);
+  d = (unsigned char*) sexp_bytes_data(dst);
+  if (st >= 0) {
+    for (i = lo; i < hi; i++) {
+      c = base64_decode_table[s[i]];
+      if (c == BASE64_OUTSIDE)
+        continue;
+      if (c == BASE64_PAD) {
+        st = -1;
+        break;
+      }
+      bits = (bits << 6) | c;
+      if (++count == 4) {
+        d[j]   = bits >> 16;
+        d[j+1] = bits >> 8;
+        d[j+2] = bits;
+        j += 3;
+        bits = 0;
+        count = 0;
+      }
+    }
+  }
+  if (sexp_truep(final) || st < 0) {
+    switch (count) {
+    case 1:
+      d[j++] = bits << 2;
+      break;
+    case 2:
+      d[j++] = bits >> 4;
+      break;
+    case 3:
+      d[j++] = bits >> 10;
+      d[j++] = bits >> 2;
+      break;
+    }
+    count = 0;
+    bits = 0;
+  }
+  if (st >= 0)
+    st = (bits << 2) | count;
+  return sexp_cons(ctx, sexp_make_fixnum(j), sexp_make_fixnum(st));
+}
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  base64_init_decode_table();
+  sexp_define_foreign(ctx, env, "%base64-encode!", 5, sexp_base64_encode_x);
+  sexp_define_foreign(ctx, env, "%base64-decode!", 6, sexp_base64_decode_x);
+  return SEXP_VOID;
+}
@@ -0,0 +1,715 @@
+/* Automatically generated by chibi-ffi; version: 0.3 */
+
+#include <chibi/eval.h>
+/* sha2.c -- SHA-2 digest algorithms native implementations  */
+/* Copyright (c) 2015 Alexei Lozovsky.  All rights reserved. */
+/* BSD-style license: http://synthcode.com/license.txt       */
+
+#if !(SEXP_UINT8_DEFINED && SEXP_UINT32_DEFINED)
+# error SHA-2 requires exact 8-bit and 32-bit integers to be available
+#endif
+
+/*
+ * SHA-2 algorithms are described in RFC 6234:
+ *
+ *    http://tools.ietf.org/html/rfc6234
+ */
+
+/* Initial hash vector for SHA-224 */
+static const sexp_uint32_t h224[8] = {
+  0xC1059ED8UL, 0x367CD507UL, 0x3070DD17UL, 0xF70E5939UL,
+  0xFFC00B31UL, 0x68581511UL, 0x64F98FA7UL, 0xBEFA4FA4UL,
+};
+
+/* Initial hash vector for SHA-256 */
+static const sexp_uint32_t h256[8] = {
+  0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+  0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL,
+};
+
+/* Round constants for SHA-224/256 */
+static const sexp_uint32_t k256[64] = {
+  0x428A2F98UL, 0x71374491UL, 0xB5C0FBCFUL, 0xE9B5DBA5UL,
+  0x3956C25BUL, 0x59F111F1UL, 0x923F82A4UL, 0xAB1C5ED5UL,
+  0xD807AA98UL, 0x12835B01UL, 0x243185BEUL, 0x550C7DC3UL,
+  0x72BE5D74UL, 0x80DEB1FEUL, 0x9BDC06A7UL, 0xC19BF174UL,
+  0xE49B69C1UL, 0xEFBE4786UL, 0x0FC19DC6UL, 0x240CA1CCUL,
+  0x2DE92C6FUL, 0x4A7484AAUL, 0x5CB0A9DCUL, 0x76F988DAUL,
+  0x983E5152UL, 0xA831C66DUL, 0xB00327C8UL, 0xBF597FC7UL,
+  0xC6E00BF3UL, 0xD5A79147UL, 0x06CA6351UL, 0x14292967UL,
+  0x27B70A85UL, 0x2E1B2138UL, 0x4D2C6DFCUL, 0x53380D13UL,
+  0x650A7354UL, 0x766A0ABBUL, 0x81C2C92EUL, 0x92722C85UL,
+  0xA2BFE8A1UL, 0xA81A664BUL, 0xC24B8B70UL, 0xC76C51A3UL,
+  0xD192E819UL, 0xD6990624UL, 0xF40E3585UL, 0x106AA070UL,
+  0x19A4C116UL, 0x1E376C08UL, 0x2748774CUL, 0x34B0BCB5UL,
+  0x391C0CB3UL, 0x4ED8AA4AUL, 0x5B9CCA4FUL, 0x682E6FF3UL,
+  0x748F82EEUL, 0x78A5636FUL, 0x84C87814UL, 0x8CC70208UL,
+  0x90BEFFFAUL, 0xA4506CEBUL, 0xBEF9A3F7UL, 0xC67178F2UL,
+};
+
+/* Supported digest types */
+enum sha_type {
+  SHA_TYPE_224,
+  SHA_TYPE_256,
+  SHA_TYPE_MAX
+};
+
+/* Intermediate digest computation state */
+struct sha_context {
+  enum sha_type type;
+  char sealed;
+  sexp_uint_t len;
+  sexp_uint32_t hash256[8];
+  sexp_uint8_t buffer[128]; /* enough for all SHA-2 */
+};
+
+/* = SHA-224/256 implementation ===================================== */
+
+#define ror32(v, a) (((v) >> (a)) | ((v) << (32 - (a))))
+
+#define sha_ch(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#define sha_maj(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define sha_sum0(x) (ror32(x, 2) ^ ror32(x, 13) ^ ror32(x, 22))
+#define sha_sum1(x) (ror32(x, 6) ^ ror32(x, 11) ^ ror32(x, 25))
+#define sha_sig0(x) (ror32(x, 7) ^ ror32(x, 18) ^ ((x) >> 3))
+#define sha_sig1(x) (ror32(x, 17) ^ ror32(x, 19) ^ ((x) >> 10))
+
+/* The schedule is kept as a rolling window of 16 words */
+#define sha_expand(i)                                                   \
+  (w[(i) & 15] += sha_sig1(w[((i) - 2) & 15]) + w[((i) - 7) & 15]       \
+                  + sha_sig0(w[((i) - 15) & 15]))
+
+#define sha_round(a, b, c, d, e, f, g, h, i, wi)                        \
+  do {                                                                  \
+    tmp1 = h + sha_sum1(e) + sha_ch(e, f, g) + k256[i] + (wi);          \
+    d += tmp1;                                                          \
+    h = tmp1 + sha_sum0(a) + sha_maj(a, b, c);                          \
+  } while (0)
+
+#define sha_8_rounds(i, W)                                              \
+  do {                                                                  \
+    sha_round(a, b, c, d, e, f, g, h, (i) + 0, W((i) + 0));             \
+    sha_round(h, a, b, c, d, e, f, g, (i) + 1, W((i) + 1));             \
+    sha_round(g, h, a, b, c, d, e, f, (i) + 2, W((i) + 2));             \
+    sha_round(f, g, h, a, b, c, d, e, (i) + 3, W((i) + 3));             \
+    sha_round(e, f, g, h, a, b, c, d, (i) + 4, W((i) + 4));             \
+    sha_round(d, e, f, g, h, a, b, c, (i) + 5, W((i) + 5));             \
+    sha_round(c, d, e, f, g, h, a, b, (i) + 6, W((i) + 6));             \
+    sha_round(b, c, d, e, f, g, h, a, (i) + 7, W((i) + 7));             \
+  } while (0)
+
+#define sha_load(i) (w[i])
+
+static void sha_224_256_blocks_portable (sexp_uint32_t hash[8],
+                                         const sexp_uint8_t *chunk,
+                                         sexp_uint_t count) {
+  int i;
+  sexp_uint32_t w[16];
+  sexp_uint32_t tmp1;
+  sexp_uint32_t a, b, c, d, e, f, g, h;
+  for ( ; count > 0; count--, chunk += 64) {
+    /* Initialize schedule array */
+    for (i = 0; i < 16; i++) {
+      w[i] = ((sexp_uint32_t)chunk[4*i + 0] << 24)
+           | ((sexp_uint32_t)chunk[4*i + 1] << 16)
+           | ((sexp_uint32_t)chunk[4*i + 2] <<  8)
+           | ((sexp_uint32_t)chunk[4*i + 3] <<  0);
+    }
+    /* Initialize working variables */
+    a = hash[0]; b = hash[1]; c = hash[2]; d = hash[3];
+    e = hash[4]; f = hash[5]; g = hash[6]; h = hash[7];
+    /* Main loop, expanding the schedule after the first 16 rounds */
+    sha_8_rounds(0, sha_load);
+    sha_8_rounds(8, sha_load);
+    for (i = 16; i < 64; i += 8)
+      sha_8_rounds(i, sha_expand);
+    /* Update hash values */
+    hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+    hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+  }
+}
+
+/* Use the SHA extensions on x86 processors which have them, checked */
+/* once at runtime so the library still loads everywhere else. */
+
+#ifndef SEXP_USE_SHA_NI
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEXP_USE_SHA_NI 1
+#else
+#define SEXP_USE_SHA_NI 0
+#endif
+#endif
+
+#if SEXP_USE_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+
+static int sha_ni_available (void) {
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)
+      || !(c & bit_SSSE3) || !(c & bit_SSE4_1)
+      || __get_cpuid_max(0, NULL) < 7)
+    return 0;
+  __cpuid_count(7, 0, a, b, c, d);
+  return (b & bit_SHA) != 0;
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha_224_256_blocks_ni (sexp_uint32_t hash[8],
+                                   const sexp_uint8_t *chunk,
+                                   sexp_uint_t count) {
+  int i;
+  __m128i state0, state1, abef, cdgh, msg, tmp, w[16];
+  const __m128i mask =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  /* Rearrange the hash into the ABEF/CDGH order the instructions use */
+  tmp = _mm_loadu_si128((const __m128i*) &hash[0]);
+  state1 = _mm_loadu_si128((const __m128i*) &hash[4]);
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);
+  state1 = _mm_shuffle_epi32(state1, 0x1B);
+  state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+  for ( ; count > 0; count--, chunk += 64) {
+    abef = state0;
+    cdgh = state1;
+    for (i = 0; i < 4; i++)
+      w[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i*) (chunk + 16*i)), mask);
+    for (i = 4; i < 16; i++) {
+      tmp = _mm_sha256msg1_epu32(w[i-4], w[i-3]);
+      tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[i-1], w[i-2], 4));
+      w[i] = _mm_sha256msg2_epu32(tmp, w[i-1]);
+    }
+    for (i = 0; i < 16; i++) {
+      msg = _mm_add_epi32(w[i], _mm_loadu_si128((const __m128i*) &k256[4*i]));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+  /* And back to ABCD/EFGH */
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128((__m128i*) &hash[0], state0);
+  _mm_storeu_si128((__m128i*) &hash[4], state1);
+}
+#endif
+
+static void sha_224_256_blocks (sexp_uint32_t hash[8],
+                                const sexp_uint8_t *chunk,
+                                sexp_uint_t count) {
+#if SEXP_USE_SHA_NI
+  static int use_ni = -1;
+  if (use_ni < 0)
+    use_ni = sha_ni_available();
+  if (use_ni) {
+    sha_224_256_blocks_ni(hash, chunk, count);
+    return;
+  }
+#endif
+  sha_224_256_blocks_portable(hash, chunk, count);
+}
+
+static void sha_224_256_round (const sexp_uint8_t chunk[64],
+                               sexp_uint32_t hash[8]) {
+  sha_224_256_blocks(hash, chunk, 1);
+}
+
+static void sha_224_256_remainder (sexp_uint8_t chunk[64], sexp_uint_t offset,
+                                   sexp_uint_t len_bits, sexp_uint32_t hash[8]) {
+  int i;
+  /* Pad with '1' bit and zeros */
+  chunk[offset] = 0x80;
+  memset(chunk + offset + 1, 0, 64 - offset - 1);
+  /* If we can't fit the length, use an additional chunk */
+  if (offset >= 56) {
+    sha_224_256_round(chunk, hash);
+    memset(chunk, 0, 64);
+  }
+  /* Append the message length in bits as big-endian 64-bit integer */
+  for (i = 63; i >= 56; i--) {
+    chunk[i] = len_bits & 0xFF;
+    len_bits >>= 8;
+  }
+  sha_224_256_round(chunk, hash);
+}
+
+/* = Allocating computation context ================================= */
+
+sexp sexp_start_sha (sexp ctx, sexp self, unsigned type, struct sha_context* v) {
+  sexp res;
+  struct sha_context *sha;
+  sexp_uint_t sha_context_tag;
+  if (type >= SHA_TYPE_MAX)
+    return sexp_xtype_exception(ctx, self, "SHA-2 digest type not supported",
+                                sexp_make_fixnum(type));
+  (void)v; /* We receive this phony argument to access the type tag of
+      sha_context and still be able to return an error with Chibi FFI */
+  sha_context_tag = sexp_unbox_fixnum(sexp_vector_ref(sexp_opcode_argn_type(self), SEXP_ZERO));
+  res = sexp_alloc_tagged(ctx, sexp_sizeof(cpointer), sha_context_tag);
+  if (sexp_exceptionp(res))
+    return res;
+  sha = calloc(1, sizeof(*sha));
+  sha->type = type;
+  switch (type) {
+  case SHA_TYPE_224:
+    memcpy(sha->hash256, h224, sizeof(h224));
+    break;
+  case SHA_TYPE_256:
+    memcpy(sha->hash256, h256, sizeof(h256));
+    break;
+  default:
+    break;
+  }
+  sexp_cpointer_value(res) = sha;
+  sexp_freep(res) = 1;
+  return res;
+}
+
+/* = Processing incoming data ======================================= */
+
+static sexp sha_224_256_add_bytes (struct sha_context *sha,
+                                   const sexp_uint8_t *src, sexp_uint_t len) {
+  sexp_uint_t src_offset, buf_offset;
+  /* Realign (src + src_offset) to 64 bytes */
+  src_offset = 0;
+  buf_offset = sha->len % 64;
+  sha->len += len;
+  if (buf_offset) {
+    while ((buf_offset < 64) && (src_offset < len))
+      sha->buffer[buf_offset++] = src[src_offset++];
+    if (buf_offset < 64)
+      return SEXP_VOID;
+    sha_224_256_round(sha->buffer, sha->hash256);
+    buf_offset = 0;
+  }
+  /* Process whole chunks without copying them */
+  if (len - src_offset >= 64) {
+    sha_224_256_blocks(sha->hash256, src + src_offset, (len - src_offset) / 64);
+    src_offset += (len - src_offset) / 64 * 64;
+  }
+  /* Copy the remainder into the buffer */
+  if (src_offset < len)
+    memcpy(sha->buffer + buf_offset, src + src_offset, len - src_offset);
+  return SEXP_VOID;
+}
+
+static sexp sha_add_bytes (sexp ctx, sexp self, struct sha_context *sha,
+                           const char* data, sexp_uint_t len) {
+  switch (sha->type) {
+  case SHA_TYPE_224:
+  case SHA_TYPE_256:
+    return sha_224_256_add_bytes(sha, (const sexp_uint8_t*) data, len);
+  default:
+    return sexp_xtype_exception(ctx, self, "unexpected context type",
+                                sexp_make_fixnum(sha->type));
+  }
+}
+
+/* Adds the first end bytes of data, or all of it if end is not a */
+/* fixnum, so a single buffer can be reused to stream from a port. */
+sexp sexp_add_sha_data (sexp ctx, sexp self, struct sha_context *sha, sexp data, sexp end) {
+  sexp_uint_t len;
+  if (sha->sealed)
+    return sexp_xtype_exception(ctx, self, "cannot add to sealed context", data);
+  if (sexp_bytesp(data))
+    len = sexp_bytes_length(data);
+  else if (sexp_stringp(data))
+    len = sexp_string_size(data);
+  else
+    return sexp_xtype_exception(ctx, self, "data type not supported", data);
+  if (sexp_fixnump(end)) {
+    if (sexp_unbox_fixnum(end) < 0 || (sexp_uint_t)sexp_unbox_fixnum(end) > len)
+      return sexp_xtype_exception(ctx, self, "end out of range", end);
+    len = sexp_unbox_fixnum(end);
+  }
+  return sha_add_bytes(ctx, self, sha, sexp_bytesp(data) ? sexp_bytes_data(data)
+                       : sexp_string_data(data), len);
+}
+
+/* = Extracting computed digest ===================================== */
+
+static const char *hex = "0123456789abcdef";
+
+static sexp sha_224_256_hash_string (sexp ctx, sexp self,
+                                     const sexp_uint32_t hash[8], int count) {
+  sexp res;
+  int i, j;
+  sexp_uint32_t next_word;
+  /* Allocate a string of target length */
+  res = sexp_make_string(ctx, sexp_make_fixnum(count * 8), SEXP_VOID);
+  if (sexp_exceptionp(res))
+    return res;
+  /* Write 32-bit words as nibbles in big-endian order */
+  for (i = 0; i < count; i++) {
+    next_word = hash[i];
+    for (j = 7; j >= 0; j--) {
+      sexp_string_data(res)[8*i + j] = hex[next_word & 0xF];
+      next_word >>= 4;
+    }
+  }
+  return res;
+}
+
+sexp sexp_get_sha (sexp ctx, sexp self, struct sha_context *sha) {
+  if (!sha->sealed) {
+    sha->sealed = 1;
+    switch (sha->type) {
+    case SHA_TYPE_224:
+    case SHA_TYPE_256:
+      sha_224_256_remainder(sha->buffer, sha->len % 64,
+                            sha->len * 8, sha->hash256);
+      break;
+    default:
+      break;
+    }
+  }
+  switch (sha->type) {
+  case SHA_TYPE_224:
+    return sha_224_256_hash_string(ctx, self, sha->hash256, 7);
+  case SHA_TYPE_256:
+    return sha_224_256_hash_string(ctx, self, sha->hash256, 8);
+  default:
+    return sexp_xtype_exception(ctx, self, "unexpected context type",
+                                sexp_make_fixnum(sha->type));
+  }
+}
+/* md5.c -- MD5 digest algorithm native implementation       */
+/* Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/* BSD-style license: http://synthcode.com/license.txt       */
+
+#if !(SEXP_UINT8_DEFINED && SEXP_UINT32_DEFINED)
+# error MD5 requires exact 8-bit and 32-bit integers to be available
+#endif
+
+/*
+ * MD5 is described in RFC 1321:
+ *
+ *    http://tools.ietf.org/html/rfc1321
+ */
+
+/* Intermediate digest computation state */
+struct md5_context {
+  char sealed;
+  sexp_uint_t len;
+  sexp_uint32_t hash[4];
+  sexp_uint8_t buffer[64];
+};
+
+/* = MD5 implementation ============================================= */
+
+#define rol32(v, a) (((v) << (a)) | ((v) >> (32 - (a))))
+
+#define md5_f(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define md5_g(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define md5_h(x, y, z) ((x) ^ (y) ^ (z))
+#define md5_i(x, y, z) ((y) ^ ((x) | ~(z)))
+
+#define md5_step(f, a, b, c, d, k, t, s)        \
+  do {                                          \
+    a += f(b, c, d) + x[k] + (t);               \
+    a = rol32(a, s) + b;                        \
+  } while (0)
+
+static void md5_blocks (sexp_uint32_t hash[4], const sexp_uint8_t *chunk,
+                        sexp_uint_t count) {
+  int i;
+  sexp_uint32_t x[16];
+  sexp_uint32_t a, b, c, d;
+  for ( ; count > 0; count--, chunk += 64) {
+    /* Words are little-endian */
+    for (i = 0; i < 16; i++) {
+      x[i] = ((sexp_uint32_t)chunk[4*i + 0] <<  0)
+           | ((sexp_uint32_t)chunk[4*i + 1] <<  8)
+           | ((sexp_uint32_t)chunk[4*i + 2] << 16)
+           | ((sexp_uint32_t)chunk[4*i + 3] << 24);
+    }
+    a = hash[0]; b = hash[1]; c = hash[2]; d = hash[3];
+    /* Round 1 */
+    md5_step(md5_f, a, b, c, d,  0, 0xd76aa478UL,  7);
+    md5_step(md5_f, d, a, b, c,  1, 0xe8c7b756UL, 12);
+    md5_step(md5_f, c, d, a, b,  2, 0x242070dbUL, 17);
+    md5_step(md5_f, b, c, d, a,  3, 0xc1bdceeeUL, 22);
+    md5_step(md5_f, a, b, c, d,  4, 0xf57c0fafUL,  7);
+    md5_step(md5_f, d, a, b, c,  5, 0x4787c62aUL, 12);
+    md5_step(md5_f, c, d, a, b,  6, 0xa8304613UL, 17);
+    md5_step(md5_f, b, c, d, a,  7, 0xfd469501UL, 22);
+    md5_step(md5_f, a, b, c, d,  8, 0x698098d8UL,  7);
+    md5_step(md5_f, d, a, b, c,  9, 0x8b44f7afUL, 12);
+    md5_step(md5_f, c, d, a, b, 10, 0xffff5bb1UL, 17);
+    md5_step(md5_f, b, c, d, a, 11, 0x895cd7beUL, 22);
+    md5_step(md5_f, a, b, c, d, 12, 0x6b901122UL,  7);
+    md5_step(md5_f, d, a, b, c, 13, 0xfd987193UL, 12);
+    md5_step(md5_f, c, d, a, b, 14, 0xa679438eUL, 17);
+    md5_step(md5_f, b, c, d, a, 15, 0x49b40821UL, 22);
+    /* Round 2 */
+    md5_step(md5_g, a, b, c, d,  1, 0xf61e2562UL,  5);
+    md5_step(md5_g, d, a, b, c,  6, 0xc040b340UL,  9);
+    md5_step(md5_g, c, d, a, b, 11, 0x265e5a51UL, 14);
+    md5_step(md5_g, b, c, d, a,  0, 0xe9b6c7aaUL, 20);
+    md5_step(md5_g, a, b, c, d,  5, 0xd62f105dUL,  5);
+    md5_step(md5_g, d, a, b, c, 10, 0x02441453UL,  9);
+    md5_step(md5_g, c, d, a, b, 15, 0xd8a1e681UL, 14);
+    md5_step(md5_g, b, c, d, a,  4, 0xe7d3fbc8UL, 20);
+    md5_step(md5_g, a, b, c, d,  9, 0x21e1cde6UL,  5);
+    md5_step(md5_g, d, a, b, c, 14, 0xc33707d6UL,  9);
+    md5_step(md5_g, c, d, a, b,  3, 0xf4d50d87UL, 14);
+    md5_step(md5_g, b, c, d, a,  8, 0x455a14edUL, 20);
+    md5_step(md5_g, a, b, c, d, 13, 0xa9e3e905UL,  5);
+    md5_step(md5_g, d, a, b, c,  2, 0xfcefa3f8UL,  9);
+    md5_step(md5_g, c, d, a, b,  7, 0x676f02d9UL, 14);
+    md5_step(md5_g, b, c, d, a, 12, 0x8d2a4c8aUL, 20);
+    /* Round 3 */
+    md5_step(md5_h, a, b, c, d,  5, 0xfffa3942UL,  4);
+    md5_step(md5_h, d, a, b, c,  8, 0x8771f681UL, 11);
+    md5_step(md5_h, c, d, a, b, 11, 0x6d9d6122UL, 16);
+    md5_step(md5_h, b, c, d, a, 14, 0xfde5380cUL, 23);
+    md5_step(md5_h, a, b, c, d,  1, 0xa4beea44UL,  4);
+    md5_step(md5_h, d, a, b, c,  4, 0x4bdecfa9UL, 11);
+    md5_step(md5_h, c, d, a, b,  7, 0xf6bb4b60UL, 16);
+    md5_step(md5_h, b, c, d, a, 10, 0xbebfbc70UL, 23);
+    md5_step(md5_h, a, b, c, d, 13, 0x289b7ec6UL,  4);
+    md5_step(md5_h, d, a, b, c,  0, 0xeaa127faUL, 11);
+    md5_step(md5_h, c, d, a, b,  3, 0xd4ef3085UL, 16);
+    md5_step(md5_h, b, c, d, a,  6, 0x04881d05UL, 23);
+    md5_step(md5_h, a, b, c, d,  9, 0xd9d4d039UL,  4);
+    md5_step(md5_h, d, a, b, c, 12, 0xe6db99e5UL, 11);
+    md5_step(md5_h, c, d, a, b, 15, 0x1fa27cf8UL, 16);
+    md5_step(md5_h, b, c, d, a,  2, 0xc4ac5665UL, 23);
+    /* Round 4 */
+    md5_step(md5_i, a, b, c, d,  0, 0xf4292244UL,  6);
+    md5_step(md5_i, d, a, b, c,  7, 0x432aff97UL, 10);
+    md5_step(md5_i, c, d, a, b, 14, 0xab9423a7UL, 15);
+    md5_step(md5_i, b, c, d, a,  5, 0xfc93a039UL, 21);
+    md5_step(md5_i, a, b, c, d, 12, 0x655b59c3UL,  6);
+    md5_step(md5_i, d, a, b, c,  3, 0x8f0ccc92UL, 10);
+    md5_step(md5_i, c, d, a, b, 10, 0xffeff47dUL, 15);
+    md5_step(md5_i, b, c, d, a,  1, 0x85845dd1UL, 21);
+    md5_step(md5_i, a, b, c, d,  8, 0x6fa87e4fUL,  6);
+    md5_step(md5_i, d, a, b, c, 15, 0xfe2ce6e0UL, 10);
+    md5_step(md5_i, c, d, a, b,  6, 0xa3014314UL, 15);
+    md5_step(md5_i, b, c, d, a, 13, 0x4e0811a1UL, 21);
+    md5_step(md5_i, a, b, c, d,  4, 0xf7537e82UL,  6);
+    md5_step(md5_i, d, a, b, c, 11, 0xbd3af235UL, 10);
+    md5_step(md5_i, c, d, a, b,  2, 0x2ad7d2bbUL, 15);
+    md5_step(md5_i, b, c, d, a,  9, 0xeb86d391UL, 21);
+    hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+  }
+}
+
+static void md5_remainder (sexp_uint8_t chunk[64], sexp_uint_t offset,
+                           sexp_uint_t len_bits, sexp_uint32_t hash[4]) {
+  int i;
+  /* Pad with '1' bit and zeros */
+  chunk[offset] = 0x80;
+  memset(chunk + offset + 1, 0, 64 - offset - 1);
+  /* If we can't fit the length, use an additional chunk */
+  if (offset >= 56) {
+    md5_blocks(hash, chunk, 1);
+    memset(chunk, 0, 64);
+  }
+  /* Append the message length in bits as little-endian 64-bit integer */
+  for (i = 56; i < 64; i++) {
+    chunk[i] = len_bits & 0xFF;
+    len_bits >>= 8;
+  }
+  md5_blocks(hash, chunk, 1);
+}
+
+/* = Allocating computation context ================================= */
+
+sexp sexp_start_md5 (sexp ctx, sexp self, struct md5_context* v) {
+  sexp res;
+  struct md5_context *md5;
+  sexp_uint_t md5_context_tag;
+  (void)v; /* phony argument to access the type tag, as in start-sha, */
+            /* here the only argument so it's typed in arg3_type */
+  md5_context_tag = sexp_unbox_fixnum(sexp_opcode_arg3_type(self));
+  res = sexp_alloc_tagged(ctx, sexp_sizeof(cpointer), md5_context_tag);
+  if (sexp_exceptionp(res))
+    return res;
+  md5 = calloc(1, sizeof(*md5));
+  md5->hash[0] = 0x67452301UL;
+  md5->hash[1] = 0xefcdab89UL;
+  md5->hash[2] = 0x98badcfeUL;
+  md5->hash[3] = 0x10325476UL;
+  sexp_cpointer_value(res) = md5;
+  sexp_freep(res) = 1;
+  return res;
+}
+
+/* = Processing incoming data ======================================= */
+
+static void md5_add_bytes (struct md5_context *md5,
+                           const sexp_uint8_t *src, sexp_uint_t len) {
+  sexp_uint_t src_offset = 0, buf_offset = md5->len % 64;
+  md5->len += len;
+  if (buf_offset) {
+    while ((buf_offset < 64) && (src_offset < len))
+      md5->buffer[buf_offset++] = src[src_offset++];
+    if (buf_offset < 64)
+      return;
+    md5_blocks(md5->hash, md5->buffer, 1);
+    buf_offset = 0;
+  }
+  if (len - src_offset >= 64) {
+    md5_blocks(md5->hash, src + src_offset, (len - src_offset) / 64);
+    src_offset += (len - src_offset) / 64 * 64;
+  }
+  if (src_offset < len)
+    memcpy(md5->buffer, src + src_offset, len - src_offset);
+}
+
+sexp sexp_add_md5_data (sexp ctx, sexp self, struct md5_context *md5, sexp data, sexp end) {
+  sexp_uint_t len;
+  if (md5->sealed)
+    return sexp_xtype_exception(ctx, self, "cannot add to sealed context", data);
+  if (sexp_bytesp(data))
+    len = sexp_bytes_length(data);
+  else if (sexp_stringp(data))
+    len = sexp_string_size(data);
+  else
+    return sexp_xtype_exception(ctx, self, "data type not supported", data);
+  if (sexp_fixnump(end)) {
+    if (sexp_unbox_fixnum(end) < 0 || (sexp_uint_t)sexp_unbox_fixnum(end) > len)
+      return sexp_xtype_exception(ctx, self, "end out of range", end);
+    len = sexp_unbox_fixnum(end);
+  }
+  md5_add_bytes(md5, (const sexp_uint8_t*) (sexp_bytesp(data) ? sexp_bytes_data(data)
+                                            : sexp_string_data(data)), len);
+  return SEXP_VOID;
+}
+
+/* = Extracting computed digest ===================================== */
+
+sexp sexp_get_md5 (sexp ctx, sexp self, struct md5_context *md5) {
+  static const char *digits = "0123456789abcdef";
+  sexp res;
+  int i;
+  if (!md5->sealed) {
+    md5->sealed = 1;
+    md5_remainder(md5->buffer, md5->len % 64, md5->len * 8, md5->hash);
+  }
+  res = sexp_make_string(ctx, sexp_make_fixnum(32), SEXP_VOID);
+  if (sexp_exceptionp(res))
+    return res;
+  /* Bytes in little-endian order, starting with the low byte of A */
+  for (i = 0; i < 16; i++) {
+    sexp_uint8_t b = (md5->hash[i/4] >> (8*(i%4))) & 0xFF;
+    sexp_string_data(res)[2*i] = digits[b >> 4];
+    sexp_string_data(res)[2*i + 1] = digits[b & 0xF];
+  }
+  return res;
+}
+/*
+types: (md5_context sha_context)
+enums: ()
+*/
+
+sexp sexp_get_md5_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  if (! (sexp_pointerp(arg2) && (sexp_pointer_tag(arg2) == sexp_unbox_fixnum(sexp_opcode_arg3_type(self)))))
+    return sexp_type_exception(ctx, self, sexp_unbox_fixnum(sexp_opcode_arg3_type(self)), arg2);
+  res = sexp_get_md5(ctx, self, (struct md5_context*)sexp_cpointer_value(arg2));
+  return res;
+}
+
+sexp sexp_25_add_md5_data_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  if (! (sexp_pointerp(arg2) && (sexp_pointer_tag(arg2) == sexp_unbox_fixnum(sexp_opcode_arg3_type(self)))))
+    return sexp_type_exception(ctx, self, sexp_unbox_fixnum(sexp_opcode_arg3_type(self)), arg2);
+  res = sexp_add_md5_data(ctx, self, (struct md5_context*)sexp_cpointer_value(arg2), arg3, arg4);
+  return res;
+}
+
+sexp sexp_start_md5_stub (sexp ctx, sexp self, sexp_sint_t n) {
+  sexp res;
+  res = sexp_start_md5(ctx, self, NULL);
+  return res;
+}
+
+sexp sexp_get_sha_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  if (! (sexp_pointerp(arg2) && (sexp_pointer_tag(arg2) == sexp_unbox_fixnum(sexp_opcode_arg3_type(self)))))
+    return sexp_type_exception(ctx, self, sexp_unbox_fixnum(sexp_opcode_arg3_type(self)), arg2);
+  res = sexp_get_sha(ctx, self, (struct sha_context*)sexp_cpointer_value(arg2));
+  return res;
+}
+
+sexp sexp_25_add_sha_data_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  if (! (sexp_pointerp(arg2) && (sexp_pointer_tag(arg2) == sexp_unbox_fixnum(sexp_opcode_arg3_type(self)))))
+    return sexp_type_exception(ctx, self, sexp_unbox_fixnum(sexp_opcode_arg3_type(self)), arg2);
+  res = sexp_add_sha_data(ctx, self, (struct sha_context*)sexp_cpointer_value(arg2), arg3, arg4);
+  return res;
+}
+
+sexp sexp_start_sha_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  if (! sexp_exact_integerp(arg2))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg2);
+  res = sexp_start_sha(ctx, self, sexp_uint_value(arg2), NULL);
+  return res;
+}
+
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  sexp sexp_md5_context_type_obj;
+  sexp sexp_sha_context_type_obj;
+  sexp_gc_var3(name, tmp, op);
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  sexp_gc_preserve3(ctx, name, tmp, op);
+  name = sexp_intern(ctx, "type-sha-256", 12);
+  sexp_env_define(ctx, env, name, tmp=sexp_make_unsigned_integer(ctx, SHA_TYPE_256));
+  name = sexp_intern(ctx, "type-sha-224", 12);
+  sexp_env_define(ctx, env, name, tmp=sexp_make_unsigned_integer(ctx, SHA_TYPE_224));
+  name = sexp_c_string(ctx, "md5_context", -1);
+  sexp_md5_context_type_obj = sexp_register_c_type(ctx, name, sexp_finalize_c_type);
+  tmp = sexp_string_to_symbol(ctx, name);
+  sexp_env_define(ctx, env, tmp, sexp_md5_context_type_obj);
+  name = sexp_c_string(ctx, "sha_context", -1);
+  sexp_sha_context_type_obj = sexp_register_c_type(ctx, name, sexp_finalize_c_type);
+  tmp = sexp_string_to_symbol(ctx, name);
+  sexp_env_define(ctx, env, tmp, sexp_sha_context_type_obj);
+  op = sexp_define_foreign(ctx, env, "get-md5", 1, sexp_get_md5_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(sexp_type_tag(sexp_md5_context_type_obj));
+  }
+  op = sexp_define_foreign(ctx, env, "%add-md5-data!", 3, sexp_25_add_md5_data_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(sexp_type_tag(sexp_md5_context_type_obj));
+  }
+  op = sexp_define_foreign(ctx, env, "start-md5", 0, sexp_start_md5_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(sexp_type_tag(sexp_md5_context_type_obj));
+  }
+  op = sexp_define_foreign(ctx, env, "get-sha", 1, sexp_get_sha_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(sexp_type_tag(sexp_sha_context_type_obj));
+  }
+  op = sexp_define_foreign(ctx, env, "%add-sha-data!", 3, sexp_25_add_sha_data_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(sexp_type_tag(sexp_sha_context_type_obj));
+  }
+  op = sexp_define_foreign(ctx, env, "start-sha", 1, sexp_start_sha_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(SEXP_FIXNUM);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_ONE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ZERO, sexp_make_fixnum(sexp_type_tag(sexp_sha_context_type_obj)));
+  }
+  sexp_gc_release3(ctx);
+  return SEXP_VOID;
+}
+
@@ -0,0 +1,27 @@
+;; md5-native.scm -- MD5 digest algorithm native interface
+;; Copyright (c) 2026 Alex Shinn.  All rights reserved.
+;; BSD-style license: http://synthcode.com/license.txt
+
+;;> \procedure{(add-md5-data! md5-context src)}
+;;>
+;;> Adds \var{src}, which can be a string, a bytevector, or a binary
+;;> input port, to a context created with \scheme{start-md5}.  Ports
+;;> are read to the end in fixed size chunks.
+
+(define (add-md5-data! context src)
+  (cond ((or (bytevector? src) (string? src))
+         (%add-md5-data! context src #f))
+        ((input-port? src)
+         (let ((buf (make-bytevector 65536)))
+           (let lp ()
+             (let ((n (read-bytevector! buf src)))
+               (unless (eof-object? n)
+                 (%add-md5-data! context buf n)
+                 (lp))))))
+        (else
+         (error "unknown digest source: " src))))
+
+(define (md5 src)
+  (let ((context (start-md5)))
+    (add-md5-data! context src)
+    (get-md5 context)))
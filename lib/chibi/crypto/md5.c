@@ -0,0 +1,227 @@
+/* md5.c -- MD5 digest algorithm native implementation       */
+/* Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/* BSD-style license: http://synthcode.com/license.txt       */
+
+#if !(SEXP_UINT8_DEFINED && SEXP_UINT32_DEFINED)
+# error MD5 requires exact 8-bit and 32-bit integers to be available
+#endif
+
+/*
+ * MD5 is described in RFC 1321:
+ *
+ *    http://tools.ietf.org/html/rfc1321
+ */
+
+/* Intermediate digest computation state */
+struct md5_context {
+  char sealed;
+  sexp_uint_t len;
+  sexp_uint32_t hash[4];
+  sexp_uint8_t buffer[64];
+};
+
+/* = MD5 implementation ============================================= */
+
+#define rol32(v, a) (((v) << (a)) | ((v) >> (32 - (a))))
+
+#define md5_f(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define md5_g(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define md5_h(x, y, z) ((x) ^ (y) ^ (z))
+#define md5_i(x, y, z) ((y) ^ ((x) | ~(z)))
+
+#define md5_step(f, a, b, c, d, k, t, s)        \
+  do {                                          \
+    a += f(b, c, d) + x[k] + (t);               \
+    a = rol32(a, s) + b;                        \
+  } while (0)
+
+static void md5_blocks (sexp_uint32_t hash[4], const sexp_uint8_t *chunk,
+                        sexp_uint_t count) {
+  int i;
+  sexp_uint32_t x[16];
+  sexp_uint32_t a, b, c, d;
+  for ( ; count > 0; count--, chunk += 64) {
+    /* Words are little-endian */
+    for (i = 0; i < 16; i++) {
+      x[i] = ((sexp_uint32_t)chunk[4*i + 0] <<  0)
+           | ((sexp_uint32_t)chunk[4*i + 1] <<  8)
+           | ((sexp_uint32_t)chunk[4*i + 2] << 16)
+           | ((sexp_uint32_t)chunk[4*i + 3] << 24);
+    }
+    a = hash[0]; b = hash[1]; c = hash[2]; d = hash[3];
+    /* Round 1 */
+    md5_step(md5_f, a, b, c, d,  0, 0xd76aa478UL,  7);
+    md5_step(md5_f, d, a, b, c,  1, 0xe8c7b756UL, 12);
+    md5_step(md5_f, c, d, a, b,  2, 0x242070dbUL, 17);
+    md5_step(md5_f, b, c, d, a,  3, 0xc1bdceeeUL, 22);
+    md5_step(md5_f, a, b, c, d,  4, 0xf57c0fafUL,  7);
+    md5_step(md5_f, d, a, b, c,  5, 0x4787c62aUL, 12);
+    md5_step(md5_f, c, d, a, b,  6, 0xa8304613UL, 17);
+    md5_step(md5_f, b, c, d, a,  7, 0xfd469501UL, 22);
+    md5_step(md5_f, a, b, c, d,  8, 0x698098d8UL,  7);
+    md5_step(md5_f, d, a, b, c,  9, 0x8b44f7afUL, 12);
+    md5_step(md5_f, c, d, a, b, 10, 0xffff5bb1UL, 17);
+    md5_step(md5_f, b, c, d, a, 11, 0x895cd7beUL, 22);
+    md5_step(md5_f, a, b, c, d, 12, 0x6b901122UL,  7);
+    md5_step(md5_f, d, a, b, c, 13, 0xfd987193UL, 12);
+    md5_step(md5_f, c, d, a, b, 14, 0xa679438eUL, 17);
+    md5_step(md5_f, b, c, d, a, 15, 0x49b40821UL, 22);
+    /* Round 2 */
+    md5_step(md5_g, a, b, c, d,  1, 0xf61e2562UL,  5);
+    md5_step(md5_g, d, a, b, c,  6, 0xc040b340UL,  9);
+    md5_step(md5_g, c, d, a, b, 11, 0x265e5a51UL, 14);
+    md5_step(md5_g, b, c, d, a,  0, 0xe9b6c7aaUL, 20);
+    md5_step(md5_g, a, b, c, d,  5, 0xd62f105dUL,  5);
+    md5_step(md5_g, d, a, b, c, 10, 0x02441453UL,  9);
+    md5_step(md5_g, c, d, a, b, 15, 0xd8a1e681UL, 14);
+    md5_step(md5_g, b, c, d, a,  4, 0xe7d3fbc8UL, 20);
+    md5_step(md5_g, a, b, c, d,  9, 0x21e1cde6UL,  5);
+    md5_step(md5_g, d, a, b, c, 14, 0xc33707d6UL,  9);
+    md5_step(md5_g, c, d, a, b,  3, 0xf4d50d87UL, 14);
+    md5_step(md5_g, b, c, d, a,  8, 0x455a14edUL, 20);
+    md5_step(md5_g, a, b, c, d, 13, 0xa9e3e905UL,  5);
+    md5_step(md5_g, d, a, b, c,  2, 0xfcefa3f8UL,  9);
+    md5_step(md5_g, c, d, a, b,  7, 0x676f02d9UL, 14);
+    md5_step(md5_g, b, c, d, a, 12, 0x8d2a4c8aUL, 20);
+    /* Round 3 */
+    md5_step(md5_h, a, b, c, d,  5, 0xfffa3942UL,  4);
+    md5_step(md5_h, d, a, b, c,  8, 0x8771f681UL, 11);
+    md5_step(md5_h, c, d, a, b, 11, 0x6d9d6122UL, 16);
+    md5_step(md5_h, b, c, d, a, 14, 0xfde5380cUL, 23);
+    md5_step(md5_h, a, b, c, d,  1, 0xa4beea44UL,  4);
+    md5_step(md5_h, d, a, b, c,  4, 0x4bdecfa9UL, 11);
+    md5_step(md5_h, c, d, a, b,  7, 0xf6bb4b60UL, 16);
+    md5_step(md5_h, b, c, d, a, 10, 0xbebfbc70UL, 23);
+    md5_step(md5_h, a, b, c, d, 13, 0x289b7ec6UL,  4);
+    md5_step(md5_h, d, a, b, c,  0, 0xeaa127faUL, 11);
+    md5_step(md5_h, c, d, a, b,  3, 0xd4ef3085UL, 16);
+    md5_step(md5_h, b, c, d, a,  6, 0x04881d05UL, 23);
+    md5_step(md5_h, a, b, c, d,  9, 0xd9d4d039UL,  4);
+    md5_step(md5_h, d, a, b, c, 12, 0xe6db99e5UL, 11);
+    md5_step(md5_h, c, d, a, b, 15, 0x1fa27cf8UL, 16);
+    md5_step(md5_h, b, c, d, a,  2, 0xc4ac5665UL, 23);
+    /* Round 4 */
+    md5_step(md5_i, a, b, c, d,  0, 0xf4292244UL,  6);
+    md5_step(md5_i, d, a, b, c,  7, 0x432aff97UL, 10);
+    md5_step(md5_i, c, d, a, b, 14, 0xab9423a7UL, 15);
+    md5_step(md5_i, b, c, d, a,  5, 0xfc93a039UL, 21);
+    md5_step(md5_i, a, b, c, d, 12, 0x655b59c3UL,  6);
+    md5_step(md5_i, d, a, b, c,  3, 0x8f0ccc92UL, 10);
+    md5_step(md5_i, c, d, a, b, 10, 0xffeff47dUL, 15);
+    md5_step(md5_i, b, c, d, a,  1, 0x85845dd1UL, 21);
+    md5_step(md5_i, a, b, c, d,  8, 0x6fa87e4fUL,  6);
+    md5_step(md5_i, d, a, b, c, 15, 0xfe2ce6e0UL, 10);
+    md5_step(md5_i, c, d, a, b,  6, 0xa3014314UL, 15);
+    md5_step(md5_i, b, c, d, a, 13, 0x4e0811a1UL, 21);
+    md5_step(md5_i, a, b, c, d,  4, 0xf7537e82UL,  6);
+    md5_step(md5_i, d, a, b, c, 11, 0xbd3af235UL, 10);
+    md5_step(md5_i, c, d, a, b,  2, 0x2ad7d2bbUL, 15);
+    md5_step(md5_i, b, c, d, a,  9, 0xeb86d391UL, 21);
+    hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+  }
+}
+
+static void md5_remainder (sexp_uint8_t chunk[64], sexp_uint_t offset,
+                           sexp_uint_t len_bits, sexp_uint32_t hash[4]) {
+  int i;
+  /* Pad with '1' bit and zeros */
+  chunk[offset] = 0x80;
+  memset(chunk + offset + 1, 0, 64 - offset - 1);
+  /* If we can't fit the length, use an additional chunk */
+  if (offset >= 56) {
+    md5_blocks(hash, chunk, 1);
+    memset(chunk, 0, 64);
+  }
+  /* Append the message length in bits as little-endian 64-bit integer */
+  for (i = 56; i < 64; i++) {
+    chunk[i] = len_bits & 0xFF;
+    len_bits >>= 8;
+  }
+  md5_blocks(hash, chunk, 1);
+}
+
+/* = Allocating computation context ================================= */
+
+sexp sexp_start_md5 (sexp ctx, sexp self, struct md5_context* v) {
+  sexp res;
+  struct md5_context *md5;
+  sexp_uint_t md5_context_tag;
+  (void)v; /* phony argument to access the type tag, as in start-sha, */
+            /* here the only argument so it's typed in arg3_type */
+  md5_context_tag = sexp_unbox_fixnum(sexp_opcode_arg3_type(self));
+  res = sexp_alloc_tagged(ctx, sexp_sizeof(cpointer), md5_context_tag);
+  if (sexp_exceptionp(res))
+    return res;
+  md5 = calloc(1, sizeof(*md5));
+  md5->hash[0] = 0x67452301UL;
+  md5->hash[1] = 0xefcdab89UL;
+  md5->hash[2] = 0x98badcfeUL;
+  md5->hash[3] = 0x10325476UL;
+  sexp_cpointer_value(res) = md5;
+  sexp_freep(res) = 1;
+  return res;
+}
+
+/* = Processing incoming data ======================================= */
+
+static void md5_add_bytes (struct md5_context *md5,
+                           const sexp_uint8_t *src, sexp_uint_t len) {
+  sexp_uint_t src_offset = 0, buf_offset = md5->len % 64;
+  md5->len += len;
+  if (buf_offset) {
+    while ((buf_offset < 64) && (src_offset < len))
+      md5->buffer[buf_offset++] = src[src_offset++];
+    if (buf_offset < 64)
+      return;
+    md5_blocks(md5->hash, md5->buffer, 1);
+    buf_offset = 0;
+  }
+  if (len - src_offset >= 64) {
+    md5_blocks(md5->hash, src + src_offset, (len - src_offset) / 64);
+    src_offset += (len - src_offset) / 64 * 64;
+  }
+  if (src_offset < len)
+    memcpy(md5->buffer, src + src_offset, len - src_offset);
+}
+
+sexp sexp_add_md5_data (sexp ctx, sexp self, struct md5_context *md5, sexp data, sexp end) {
+  sexp_uint_t len;
+  if (md5->sealed)
+    return sexp_xtype_exception(ctx, self, "cannot add to sealed context", data);
+  if (sexp_bytesp(data))
+    len = sexp_bytes_length(data);
+  else if (sexp_stringp(data))
+    len = sexp_string_size(data);
+  else
+    return sexp_xtype_exception(ctx, self, "data type not supported", data);
+  if (sexp_fixnump(end)) {
+    if (sexp_unbox_fixnum(end) < 0 || (sexp_uint_t)sexp_unbox_fixnum(end) > len)
+      return sexp_xtype_exception(ctx, self, "end out of range", end);
+    len = sexp_unbox_fixnum(end);
+  }
+  md5_add_bytes(md5, (const sexp_uint8_t*) (sexp_bytesp(data) ? sexp_bytes_data(data)
+                                            : sexp_string_data(data)), len);
+  return SEXP_VOID;
+}
+
+/* = Extracting computed digest ===================================== */
+
+sexp sexp_get_md5 (sexp ctx, sexp self, struct md5_context *md5) {
+  static const char *digits = "0123456789abcdef";
+  sexp res;
+  int i;
+  if (!md5->sealed) {
+    md5->sealed = 1;
+    md5_remainder(md5->buffer, md5->len % 64, md5->len * 8, md5->hash);
+  }
+  res = sexp_make_string(ctx, sexp_make_fixnum(32), SEXP_VOID);
+  if (sexp_exceptionp(res))
+    return res;
+  /* Bytes in little-endian order, starting with the low byte of A */
+  for (i = 0; i < 16; i++) {
+    sexp_uint8_t b = (md5->hash[i/4] >> (8*(i%4))) & 0xFF;
+    sexp_string_data(res)[2*i] = digits[b >> 4];
+    sexp_string_data(res)[2*i + 1] = digits[b & 0xF];
+  }
+  return res;
+}
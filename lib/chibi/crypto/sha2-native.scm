@@ -2,23 +2,32 @@
 ;; Copyright (c) 2015 Alexei Lozovsky.  All rights reserved.
 ;; BSD-style license: http://synthcode.com/license.txt
 
-(define (process-sha-data! context src)
+;;> \procedure{(add-sha-data! sha-context src)}
+;;>
+;;> Adds \var{src}, which can be a string, a bytevector, or a binary
+;;> input port, to a context created with \scheme{start-sha}.  Ports
+;;> are read to the end in fixed size chunks, so arbitrarily large
+;;> sources are hashed in constant space.
+
+(define (add-sha-data! context src)
   (cond ((or (bytevector? src) (string? src))
-         (add-sha-data! context src))
+         (%add-sha-data! context src #f))
         ((input-port? src)
-         (let lp ((chunk (read-bytevector 1024 src)))
-           (unless (eof-object? chunk)
-             (add-sha-data! context chunk)
-             (lp (read-bytevector 1024 src)))))
+         (let ((buf (make-bytevector 65536)))
+           (let lp ()
+             (let ((n (read-bytevector! buf src)))
+               (unless (eof-object? n)
+                 (%add-sha-data! context buf n)
+                 (lp))))))
         (else
          (error "unknown digest source: " src))))
 
 (define (sha-224 src)
   (let ((context (start-sha type-sha-224)))
-    (process-sha-data! context src)
+    (add-sha-data! context src)
     (get-sha context)))
 
 (define (sha-256 src)
   (let ((context (start-sha type-sha-256)))
-    (process-sha-data! context src)
+    (add-sha-data! context src)
     (get-sha context)))
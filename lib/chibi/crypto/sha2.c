@@ -64,43 +64,156 @@ struct sha_context {
 
 #define ror32(v, a) (((v) >> (a)) | ((v) << (32 - (a))))
 
-static void sha_224_256_round (const sexp_uint8_t chunk[64],
-                               sexp_uint32_t hash[8]) {
+#define sha_ch(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#define sha_maj(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define sha_sum0(x) (ror32(x, 2) ^ ror32(x, 13) ^ ror32(x, 22))
+#define sha_sum1(x) (ror32(x, 6) ^ ror32(x, 11) ^ ror32(x, 25))
+#define sha_sig0(x) (ror32(x, 7) ^ ror32(x, 18) ^ ((x) >> 3))
+#define sha_sig1(x) (ror32(x, 17) ^ ror32(x, 19) ^ ((x) >> 10))
+
+/* The schedule is kept as a rolling window of 16 words */
+#define sha_expand(i)                                                   \
+  (w[(i) & 15] += sha_sig1(w[((i) - 2) & 15]) + w[((i) - 7) & 15]       \
+                  + sha_sig0(w[((i) - 15) & 15]))
+
+#define sha_round(a, b, c, d, e, f, g, h, i, wi)                        \
+  do {                                                                  \
+    tmp1 = h + sha_sum1(e) + sha_ch(e, f, g) + k256[i] + (wi);          \
+    d += tmp1;                                                          \
+    h = tmp1 + sha_sum0(a) + sha_maj(a, b, c);                          \
+  } while (0)
+
+#define sha_8_rounds(i, W)                                              \
+  do {                                                                  \
+    sha_round(a, b, c, d, e, f, g, h, (i) + 0, W((i) + 0));             \
+    sha_round(h, a, b, c, d, e, f, g, (i) + 1, W((i) + 1));             \
+    sha_round(g, h, a, b, c, d, e, f, (i) + 2, W((i) + 2));             \
+    sha_round(f, g, h, a, b, c, d, e, (i) + 3, W((i) + 3));             \
+    sha_round(e, f, g, h, a, b, c, d, (i) + 4, W((i) + 4));             \
+    sha_round(d, e, f, g, h, a, b, c, (i) + 5, W((i) + 5));             \
+    sha_round(c, d, e, f, g, h, a, b, (i) + 6, W((i) + 6));             \
+    sha_round(b, c, d, e, f, g, h, a, (i) + 7, W((i) + 7));             \
+  } while (0)
+
+#define sha_load(i) (w[i])
+
+static void sha_224_256_blocks_portable (sexp_uint32_t hash[8],
+                                         const sexp_uint8_t *chunk,
+                                         sexp_uint_t count) {
   int i;
-  sexp_uint32_t w[64];
-  sexp_uint32_t tmp1, tmp2;
+  sexp_uint32_t w[16];
+  sexp_uint32_t tmp1;
   sexp_uint32_t a, b, c, d, e, f, g, h;
-  /* Initialize schedule array */
-  for (i = 0; i < 16; i++) {
-    w[i] = (chunk[4*i + 0] << 24)
-         | (chunk[4*i + 1] << 16)
-         | (chunk[4*i + 2] <<  8)
-         | (chunk[4*i + 3] <<  0);
+  for ( ; count > 0; count--, chunk += 64) {
+    /* Initialize schedule array */
+    for (i = 0; i < 16; i++) {
+      w[i] = ((sexp_uint32_t)chunk[4*i + 0] << 24)
+           | ((sexp_uint32_t)chunk[4*i + 1] << 16)
+           | ((sexp_uint32_t)chunk[4*i + 2] <<  8)
+           | ((sexp_uint32_t)chunk[4*i + 3] <<  0);
+    }
+    /* Initialize working variables */
+    a = hash[0]; b = hash[1]; c = hash[2]; d = hash[3];
+    e = hash[4]; f = hash[5]; g = hash[6]; h = hash[7];
+    /* Main loop, expanding the schedule after the first 16 rounds */
+    sha_8_rounds(0, sha_load);
+    sha_8_rounds(8, sha_load);
+    for (i = 16; i < 64; i += 8)
+      sha_8_rounds(i, sha_expand);
+    /* Update hash values */
+    hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+    hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
   }
-  for (i = 16; i < 64; i++) {
-    w[i] = w[i - 16]
-         + (ror32(w[i-15], 7) ^ ror32(w[i-15], 18) ^ (w[i-15] >> 3))
-         + w[i - 7]
-         + (ror32(w[i-2], 17) ^ ror32(w[i-2], 19) ^ (w[i-2] >> 10));
+}
+
+/* Use the SHA extensions on x86 processors which have them, checked */
+/* once at runtime so the library still loads everywhere else. */
+
+#ifndef SEXP_USE_SHA_NI
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEXP_USE_SHA_NI 1
+#else
+#define SEXP_USE_SHA_NI 0
+#endif
+#endif
+
+#if SEXP_USE_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+
+static int sha_ni_available (void) {
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)
+      || !(c & bit_SSSE3) || !(c & bit_SSE4_1)
+      || __get_cpuid_max(0, NULL) < 7)
+    return 0;
+  __cpuid_count(7, 0, a, b, c, d);
+  return (b & bit_SHA) != 0;
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha_224_256_blocks_ni (sexp_uint32_t hash[8],
+                                   const sexp_uint8_t *chunk,
+                                   sexp_uint_t count) {
+  int i;
+  __m128i state0, state1, abef, cdgh, msg, tmp, w[16];
+  const __m128i mask =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  /* Rearrange the hash into the ABEF/CDGH order the instructions use */
+  tmp = _mm_loadu_si128((const __m128i*) &hash[0]);
+  state1 = _mm_loadu_si128((const __m128i*) &hash[4]);
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);
+  state1 = _mm_shuffle_epi32(state1, 0x1B);
+  state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+  for ( ; count > 0; count--, chunk += 64) {
+    abef = state0;
+    cdgh = state1;
+    for (i = 0; i < 4; i++)
+      w[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i*) (chunk + 16*i)), mask);
+    for (i = 4; i < 16; i++) {
+      tmp = _mm_sha256msg1_epu32(w[i-4], w[i-3]);
+      tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[i-1], w[i-2], 4));
+      w[i] = _mm_sha256msg2_epu32(tmp, w[i-1]);
+    }
+    for (i = 0; i < 16; i++) {
+      msg = _mm_add_epi32(w[i], _mm_loadu_si128((const __m128i*) &k256[4*i]));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
   }
-  /* Initialize working variables */
-  a = hash[0]; b = hash[1]; c = hash[2]; d = hash[3];
-  e = hash[4]; f = hash[5]; g = hash[6]; h = hash[7];
-  /* Main loop */
-  for (i = 0; i < 64; i++) {
-    tmp1 = h
-         + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25))
-         + ((e & f) ^ ((~e) & g))
-         + k256[i]
-         + w[i];
-    tmp2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22))
-         + ((a & b) ^ (a & c) ^ (b & c));
-    h = g; g = f; f = e; e = d + tmp1;
-    d = c; c = b; b = a; a = tmp1 + tmp2;
+  /* And back to ABCD/EFGH */
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128((__m128i*) &hash[0], state0);
+  _mm_storeu_si128((__m128i*) &hash[4], state1);
+}
+#endif
+
+static void sha_224_256_blocks (sexp_uint32_t hash[8],
+                                const sexp_uint8_t *chunk,
+                                sexp_uint_t count) {
+#if SEXP_USE_SHA_NI
+  static int use_ni = -1;
+  if (use_ni < 0)
+    use_ni = sha_ni_available();
+  if (use_ni) {
+    sha_224_256_blocks_ni(hash, chunk, count);
+    return;
   }
-  /* Update hash values */
-  hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
-  hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+#endif
+  sha_224_256_blocks_portable(hash, chunk, count);
+}
+
+static void sha_224_256_round (const sexp_uint8_t chunk[64],
+                               sexp_uint32_t hash[8]) {
+  sha_224_256_blocks(hash, chunk, 1);
 }
 
 static void sha_224_256_remainder (sexp_uint8_t chunk[64], sexp_uint_t offset,
@@ -166,15 +279,15 @@ static sexp sha_224_256_add_bytes (struct sha_context *sha,
   if (buf_offset) {
     while ((buf_offset < 64) && (src_offset < len))
       sha->buffer[buf_offset++] = src[src_offset++];
-    if (buf_offset == 64)
-      sha_224_256_round(sha->buffer, sha->hash256);
-    else
+    if (buf_offset < 64)
       return SEXP_VOID;
+    sha_224_256_round(sha->buffer, sha->hash256);
+    buf_offset = 0;
   }
   /* Process whole chunks without copying them */
-  if (len >= 64) {
-    for ( ; src_offset <= (len - 64); src_offset += 64)
-      sha_224_256_round(src + src_offset, sha->hash256);
+  if (len - src_offset >= 64) {
+    sha_224_256_blocks(sha->hash256, src + src_offset, (len - src_offset) / 64);
+    src_offset += (len - src_offset) / 64 * 64;
   }
   /* Copy the remainder into the buffer */
   if (src_offset < len)
@@ -194,14 +307,25 @@ static sexp sha_add_bytes (sexp ctx, sexp self, struct sha_context *sha,
   }
 }
 
-sexp sexp_add_sha_data (sexp ctx, sexp self, struct sha_context *sha, sexp data) {
+/* Adds the first end bytes of data, or all of it if end is not a */
+/* fixnum, so a single buffer can be reused to stream from a port. */
+sexp sexp_add_sha_data (sexp ctx, sexp self, struct sha_context *sha, sexp data, sexp end) {
+  sexp_uint_t len;
   if (sha->sealed)
     return sexp_xtype_exception(ctx, self, "cannot add to sealed context", data);
   if (sexp_bytesp(data))
-    return sha_add_bytes(ctx, self, sha, sexp_bytes_data(data), sexp_bytes_length(data));
-  if (sexp_stringp(data))
-    return sha_add_bytes(ctx, self, sha, sexp_string_data(data), sexp_string_size(data));
-  return sexp_xtype_exception(ctx, self, "data type not supported", data);
+    len = sexp_bytes_length(data);
+  else if (sexp_stringp(data))
+    len = sexp_string_size(data);
+  else
+    return sexp_xtype_exception(ctx, self, "data type not supported", data);
+  if (sexp_fixnump(end)) {
+    if (sexp_unbox_fixnum(end) < 0 || (sexp_uint_t)sexp_unbox_fixnum(end) > len)
+      return sexp_xtype_exception(ctx, self, "end out of range", end);
+    len = sexp_unbox_fixnum(end);
+  }
+  return sha_add_bytes(ctx, self, sha, sexp_bytesp(data) ? sexp_bytes_data(data)
+                       : sexp_string_data(data), len);
 }
 
 /* = Extracting computed digest ===================================== */
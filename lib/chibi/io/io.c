@@ -0,0 +1,1564 @@
+/* Automatically generated by chibi-ffi; version: 0.3 */
+
+#include <chibi/eval.h>
+
+#include <stdio.h>
+#include <chibi/eval.h>
+
+#if SEXP_USE_SEND_FILE
+#ifdef __linux
+#include <sys/sendfile.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+#if ! (defined(PLAN9) || defined(_WIN32))
+#include <poll.h>
+#endif
+
+#if SEXP_USE_MMAP_PORTS
+#include <sys/mman.h>
+#endif
+
+#define SEXP_LAST_CONTEXT_CHECK_LIMIT 256
+
+#define sexp_cookie_ctx(vec) sexp_vector_ref((sexp)vec, SEXP_ZERO)
+#define sexp_cookie_buffer(vec) sexp_vector_ref((sexp)vec, SEXP_ONE)
+#define sexp_cookie_read(vec) sexp_vector_ref((sexp)vec, SEXP_TWO)
+#define sexp_cookie_write(vec) sexp_vector_ref((sexp)vec, SEXP_THREE)
+#define sexp_cookie_seek(vec) sexp_vector_ref((sexp)vec, SEXP_FOUR)
+#define sexp_cookie_close(vec) sexp_vector_ref((sexp)vec, SEXP_FIVE)
+
+#define sexp_cookie_ctx_set(vec, x) sexp_vector_set((sexp)vec, SEXP_ZERO, x)
+#define sexp_cookie_buffer_set(vec, x) sexp_vector_set((sexp)vec, SEXP_ONE, x)
+#define sexp_cookie_read_set(vec, x) sexp_vector_set((sexp)vec, SEXP_TWO, x)
+#define sexp_cookie_write_set(vec, x) sexp_vector_set((sexp)vec, SEXP_THREE, x)
+#define sexp_cookie_seek_set(vec, x) sexp_vector_set((sexp)vec, SEXP_FOUR, x)
+#define sexp_cookie_close_set(vec, x) sexp_vector_set((sexp)vec, SEXP_FIVE, x)
+
+#if SEXP_USE_STRING_STREAMS
+#if ! SEXP_USE_BOEHM
+static int in_heap_p (sexp_heap h, sexp p) {
+  for ( ; h; h = h->next)
+    if (((sexp)h < p) && (p < (sexp)((char*)h + h->size)))
+      return 1;
+  return 0;
+}
+#endif
+
+static sexp sexp_last_context (sexp ctx, sexp *cstack) {
+  sexp res=SEXP_FALSE;
+#if ! SEXP_USE_BOEHM
+  sexp p;
+  sexp_sint_t i;
+  sexp_heap h = sexp_context_heap(ctx);
+  for (i=0; i<SEXP_LAST_CONTEXT_CHECK_LIMIT; i++) {
+    p = cstack[i];
+    if (p && (p != ctx) && sexp_pointerp(p) && in_heap_p(h, p)
+        && (sexp_pointer_tag(p) == SEXP_CONTEXT)
+        && (sexp_context_heap(p) == h)) {
+      res = p;
+      break;
+    }
+  }
+#endif
+  return res;
+}
+
+#if SEXP_BSD
+static int sexp_cookie_reader (void *cookie, char *buffer, int size)
+#else
+static ssize_t sexp_cookie_reader (void *cookie, char *buffer, size_t size)
+#endif
+{
+  sexp vec = (sexp)cookie, ctx, res;
+  if (! sexp_procedurep(sexp_cookie_read(vec))) return -1;
+  sexp_gc_var2(ctx2, args);
+  ctx = sexp_cookie_ctx(vec);
+  ctx2 = sexp_last_context(ctx, (sexp*)&cookie);
+  sexp_gc_preserve2(ctx, ctx2, args);
+  if (size > sexp_string_size(sexp_cookie_buffer(vec)))
+    sexp_cookie_buffer_set(vec, sexp_make_string(ctx, sexp_make_fixnum(size), SEXP_VOID));
+  args = sexp_list2(ctx, SEXP_ZERO, sexp_make_fixnum(size));
+  args = sexp_cons(ctx, sexp_cookie_buffer(vec), args);
+  res = sexp_apply_callback(ctx, sexp_cookie_read(vec), args);
+  sexp_gc_release2(ctx);
+  if (sexp_fixnump(res)) {
+    memcpy(buffer, sexp_string_data(sexp_cookie_buffer(vec)), sexp_unbox_fixnum(res));
+    return sexp_unbox_fixnum(res);
+  } else {
+    return -1;
+  }
+}
+
+#if SEXP_BSD
+static int sexp_cookie_writer (void *cookie, const char *buffer, int size)
+#else
+static ssize_t sexp_cookie_writer (void *cookie, const char *buffer, size_t size)
+#endif
+{
+  sexp vec = (sexp)cookie, ctx, res;
+  if (! sexp_procedurep(sexp_cookie_write(vec))) return -1;
+  sexp_gc_var2(ctx2, args);
+  ctx = sexp_cookie_ctx(vec);
+  ctx2 = sexp_last_context(ctx, (sexp*)&cookie);
+  sexp_gc_preserve2(ctx, ctx2, args);
+  if (size > sexp_string_size(sexp_cookie_buffer(vec)))
+    sexp_cookie_buffer_set(vec, sexp_make_string(ctx, sexp_make_fixnum(size), SEXP_VOID));
+  memcpy(sexp_string_data(sexp_cookie_buffer(vec)), buffer, size);
+  sexp_string_index_invalidate(sexp_cookie_buffer(vec));
+  args = sexp_list2(ctx, SEXP_ZERO, sexp_make_fixnum(size));
+  args = sexp_cons(ctx, sexp_cookie_buffer(vec), args);
+  res = sexp_apply_callback(ctx, sexp_cookie_write(vec), args);
+  sexp_gc_release2(ctx);
+  return (sexp_fixnump(res) ? sexp_unbox_fixnum(res) : -1);
+}
+
+#if ! SEXP_BSD
+
+#ifdef __CYGWIN__
+#define off64_t off_t
+#endif
+
+static int sexp_cookie_seeker (void *cookie, off64_t *position, int whence) {
+  sexp vec = (sexp)cookie, ctx, res;
+  if (! sexp_procedurep(sexp_cookie_seek(vec))) return -1;
+  sexp_gc_var2(ctx2, args);
+  ctx = sexp_cookie_ctx(vec);
+  ctx2 = sexp_last_context(ctx, (sexp*)&cookie);
+  sexp_gc_preserve2(ctx, ctx2, args);
+  args = sexp_make_integer(ctx, *position);
+  args = sexp_list2(ctx, args, sexp_make_fixnum(whence));
+  res = sexp_apply_callback(ctx, sexp_cookie_seek(vec), args);
+  if (sexp_fixnump(res))
+    *position = sexp_unbox_fixnum(res);
+  sexp_gc_release2(ctx);
+  return sexp_fixnump(res);
+}
+#endif  /* !SEXP_BSD */
+
+static int sexp_cookie_cleaner (void *cookie) {
+  sexp vec = (sexp)cookie, ctx, res;
+  if (! sexp_procedurep(sexp_cookie_close(vec))) return 0;
+  ctx = sexp_cookie_ctx(vec);
+  res = sexp_apply_callback(ctx, sexp_cookie_close(vec), SEXP_NULL);
+  return (sexp_exceptionp(res) ? -1 : sexp_truep(res));
+}
+
+#if !SEXP_BSD
+
+static cookie_io_functions_t sexp_cookie = {
+  .read  = (cookie_read_function_t*)sexp_cookie_reader,
+  .write = (cookie_write_function_t*)sexp_cookie_writer,
+  .seek  = (cookie_seek_function_t*)sexp_cookie_seeker,
+  .close = (cookie_close_function_t*)sexp_cookie_cleaner,
+};
+
+static cookie_io_functions_t sexp_cookie_no_seek = {
+  .read  = (cookie_read_function_t*)sexp_cookie_reader,
+  .write = (cookie_write_function_t*)sexp_cookie_writer,
+  .seek  = NULL,
+  .close = (cookie_close_function_t*)sexp_cookie_cleaner,
+};
+
+#endif  /* !SEXP_BSD */
+
+static sexp sexp_make_custom_port (sexp ctx, sexp self, const char *mode,
+                                   sexp read, sexp write,
+                                   sexp seek, sexp close) {
+  FILE *in;
+  sexp res;
+  sexp_gc_var1(vec);
+  if (sexp_truep(read) && ! sexp_procedurep(read))
+    return sexp_type_exception(ctx, self, SEXP_PROCEDURE, read);
+  if (sexp_truep(write) && ! sexp_procedurep(write))
+    return sexp_type_exception(ctx, self, SEXP_PROCEDURE, write);
+  if (sexp_truep(seek) && ! sexp_procedurep(seek))
+    return sexp_type_exception(ctx, self, SEXP_PROCEDURE, seek);
+  if (sexp_truep(close) && ! sexp_procedurep(close))
+    return sexp_type_exception(ctx, self, SEXP_PROCEDURE, close);
+  sexp_gc_preserve1(ctx, vec);
+  vec = sexp_make_vector(ctx, SEXP_SIX, SEXP_VOID);
+  sexp_cookie_ctx_set(vec, ctx);
+  sexp_cookie_buffer_set(vec, sexp_make_string(ctx, sexp_make_fixnum(SEXP_PORT_BUFFER_SIZE), SEXP_VOID));
+  sexp_cookie_read_set(vec, read);
+  sexp_cookie_write_set(vec, write);
+  sexp_cookie_seek_set(vec, seek);
+  sexp_cookie_close_set(vec, close);
+#if SEXP_BSD
+  in = funopen(vec,
+               (sexp_procedurep(read) ? sexp_cookie_reader : NULL),
+               (sexp_procedurep(write) ? sexp_cookie_writer : NULL),
+               NULL, /* (sexp_procedurep(seek) ? sexp_cookie_reader : NULL), */
+               (sexp_procedurep(close) ? sexp_cookie_cleaner : NULL));
+#else
+  in = fopencookie(vec, mode, (sexp_truep(seek) ? sexp_cookie : sexp_cookie_no_seek));
+#endif
+  if (! in) {
+    res = sexp_user_exception(ctx, self, "couldn't make custom port", read);
+  } else {
+    res = sexp_make_input_port(ctx, in, SEXP_FALSE);
+    sexp_port_cookie(res) = vec;  /* for gc preserving */
+  }
+  if (mode && mode[0] == 'w')
+    sexp_pointer_tag(res) = SEXP_OPORT;
+  sexp_gc_release1(ctx);
+  return res;
+}
+
+#else  /* ! SEXP_USE_STRING_STREAMS */
+
+static sexp sexp_make_custom_port (sexp ctx, sexp self,
+                                   const char *mode, sexp read, sexp write,
+                                   sexp seek, sexp close) {
+  sexp vec;
+  sexp_gc_var2(res, str);
+  sexp_gc_preserve2(ctx, res, str);
+  str = sexp_make_string(ctx, sexp_make_fixnum(SEXP_PORT_BUFFER_SIZE), SEXP_VOID);
+  if (sexp_exceptionp(str)) return str;
+  res = sexp_open_input_string(ctx, str);
+  if (sexp_exceptionp(res)) return res;
+  if (mode && mode[0] == 'w') {
+    sexp_pointer_tag(res) = SEXP_OPORT;
+    sexp_port_cookie(res) = str;
+  } else {
+    sexp_port_offset(res) = 0;
+    sexp_port_size(res) = 0;
+  }
+  vec = sexp_make_vector(ctx, SEXP_SIX, SEXP_VOID);
+  if (sexp_exceptionp(vec)) return vec;
+  sexp_vector_set(vec, SEXP_ZERO, SEXP_FALSE);
+  sexp_vector_set(vec, SEXP_ONE, sexp_port_cookie(res));
+  sexp_vector_set(vec, SEXP_TWO, read);
+  sexp_vector_set(vec, SEXP_THREE, write);
+  sexp_vector_set(vec, SEXP_FOUR, seek);
+  sexp_vector_set(vec, SEXP_FIVE, close);
+  sexp_port_cookie(res) = vec;
+  sexp_gc_release2(ctx);
+  return res;
+}
+
+#endif
+
+sexp sexp_make_custom_input_port (sexp ctx, sexp self,
+                                  sexp read, sexp seek, sexp close) {
+  return sexp_make_custom_port(ctx, self, "r", read, SEXP_FALSE, seek, close);
+}
+
+sexp sexp_make_custom_output_port (sexp ctx, sexp self,
+                                   sexp write, sexp seek, sexp close) {
+  sexp res = sexp_make_custom_port(ctx, self, "w", SEXP_FALSE, write, seek, close);
+#if SEXP_USE_STRING_STREAMS
+  if (!sexp_exceptionp(res))
+    sexp_pointer_tag(res) = SEXP_OPORT;
+#endif
+  return res;
+}
+
+sexp sexp_make_custom_binary_input_port (sexp ctx, sexp self,
+                                         sexp read, sexp seek, sexp close) {
+  sexp res = sexp_make_custom_input_port(ctx, self, read, seek, close);
+  sexp_port_binaryp(res) = 1;
+  return res;
+}
+
+sexp sexp_make_custom_binary_output_port (sexp ctx, sexp self,
+                                          sexp write, sexp seek, sexp close) {
+  sexp res = sexp_make_custom_output_port(ctx, self, write, seek, close);
+  sexp_port_binaryp(res) = 1;
+  return res;
+}
+
+sexp sexp_bytes_to_string (sexp ctx, sexp vec) {
+  sexp res;
+#if SEXP_USE_PACKED_STRINGS
+  res = sexp_c_string(ctx, sexp_bytes_data(vec), sexp_bytes_length(vec));
+#else
+  res = sexp_alloc_type(ctx, string, SEXP_STRING);
+  sexp_string_bytes(res) = vec;
+  sexp_string_offset(res) = 0;
+  sexp_string_size(res) = sexp_bytes_length(vec);
+  sexp_string_index_invalidate(res);
+#endif
+  return res;
+}
+
+sexp sexp_open_input_bytevector (sexp ctx, sexp self, sexp vec) {
+  sexp_gc_var2(str, res);
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, vec);
+  sexp_gc_preserve2(ctx, str, res);
+  str = sexp_bytes_to_string(ctx, vec);
+  res = sexp_open_input_string(ctx, str);
+  sexp_port_binaryp(res) = 1;
+  sexp_gc_release2(ctx);
+  return res;
+}
+
+sexp sexp_open_output_bytevector (sexp ctx, sexp self) {
+  sexp res = sexp_open_output_string(ctx);
+  sexp_port_binaryp(res) = 1;
+  return res;
+}
+
+sexp sexp_get_output_bytevector (sexp ctx, sexp self, sexp port) {
+  sexp_gc_var1(res);
+  sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, port);
+  if (!sexp_port_binaryp(port))
+    return sexp_xtype_exception(ctx, self, "not a binary port", port);
+  sexp_gc_preserve1(ctx, res);
+  res = sexp_get_output_string(ctx, port);
+  if (!sexp_exceptionp(res))
+    res = sexp_string_to_bytes(ctx, res);
+  sexp_gc_release1(ctx);
+  return res;
+}
+
+sexp sexp_string_count (sexp ctx, sexp self, sexp ch, sexp str, sexp start, sexp end) {
+  const unsigned char *s, *e;
+  sexp_sint_t c, count = 0;
+#if SEXP_USE_UTF8_STRINGS
+  unsigned char buf[4];
+  int len;
+#endif
+  sexp_assert_type(ctx, sexp_charp, SEXP_CHAR, ch);
+  sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, str);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, start);
+  if (sexp_not(end)) end = sexp_make_fixnum(sexp_string_size(str));
+  else sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, end);
+  c = sexp_unbox_character(ch);
+  s = (unsigned char*)sexp_string_data(str) + sexp_unbox_fixnum(start);
+  e = (unsigned char*)sexp_string_data(str) + sexp_unbox_fixnum(end);
+  if (e > (unsigned char*)sexp_string_data(str) + sexp_string_size(str))
+    return sexp_user_exception(ctx, self, "string-count: end index out of range", end);
+#if SEXP_USE_UTF8_STRINGS
+  if (c < 128) {
+    /* fast case for ASCII chars */
+    if (s < e) count = sexp_utf8_count_byte(s, e - s, c);
+  } else {
+    /* look for the encoded char, which can't match mid-char */
+    len = sexp_utf8_char_byte_count(c);
+    sexp_utf8_encode_char(buf, len, c);
+    while (s < e && (s = memchr(s, buf[0], e - s)) != NULL) {
+      if (e - s >= len && memcmp(s, buf, len) == 0) count++;
+      s++;
+    }
+  }
+#else
+  while (s < e) if (*s++ == c) count++;
+#endif
+  return sexp_make_fixnum(count);
+}
+
+sexp sexp_string_to_utf8 (sexp ctx, sexp self, sexp str) {
+  sexp res;
+  sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, str);
+  res = sexp_c_string(ctx, sexp_string_data(str), sexp_string_size(str));
+  return sexp_string_to_bytes(ctx, res);
+}
+
+/* doesn't validate, use utf8-valid? to check untrusted input */
+sexp sexp_utf8_to_string_x (sexp ctx, sexp self, sexp vec) {
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, vec);
+  return sexp_bytes_to_string(ctx, vec);
+}
+
+sexp sexp_utf8_validp (sexp ctx, sexp self, sexp vec, sexp start, sexp end) {
+  sexp_sint_t i, j;
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, vec);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, start);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, end);
+  i = sexp_unbox_fixnum(start);
+  j = sexp_unbox_fixnum(end);
+  if (i < 0 || i > j || j > (sexp_sint_t)sexp_bytes_length(vec))
+    return sexp_user_exception(ctx, self, "utf8-valid?: invalid range", sexp_list2(ctx, start, end));
+#if SEXP_USE_UTF8_STRINGS
+  return sexp_make_boolean(sexp_utf8_validate((unsigned char*)sexp_bytes_data(vec)+i, j-i) == (sexp_uint_t)(j-i));
+#else
+  return SEXP_TRUE;
+#endif
+}
+
+sexp sexp_write_u8 (sexp ctx, sexp self, sexp u8, sexp out) {
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, u8);
+  if (sexp_unbox_fixnum(u8) < 0 || sexp_unbox_fixnum(u8) > 255)
+    return sexp_xtype_exception(ctx, self, "not a u8 value", u8);
+  sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
+  if (!sexp_port_binaryp(out))
+    return sexp_xtype_exception(ctx, self, "not a binary port", out);
+#if SEXP_USE_GREEN_THREADS
+  errno = 0;
+#endif
+  if (sexp_write_char(ctx, sexp_unbox_fixnum(u8), out) == EOF) {
+    if (sexp_port_stream(out))
+      clearerr(sexp_port_stream(out));
+#if SEXP_USE_GREEN_THREADS
+    if (errno == EAGAIN) {
+      if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER)))
+        sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), out, SEXP_FALSE);
+      return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+    }
+#endif
+  }
+  return SEXP_VOID;
+}
+
+sexp sexp_read_u8 (sexp ctx, sexp self, sexp in) {
+  int c;
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);
+  if (!sexp_port_binaryp(in))
+    return sexp_xtype_exception(ctx, self, "not a binary port", in);
+#if SEXP_USE_GREEN_THREADS
+  errno = 0;
+#endif
+  c = sexp_read_char(ctx, in);
+#if SEXP_USE_GREEN_THREADS
+  if ((c == EOF)
+      && (errno == EAGAIN)) {
+    if (sexp_port_stream(in))
+      clearerr(sexp_port_stream(in));
+    if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER)))
+      sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, SEXP_FALSE);
+    return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+  }
+#endif
+  if (c == EOF && sexp_port_exceptionp(in))
+    return sexp_port_take_exception(in);
+  if (c == '\n') sexp_port_line(in)++;
+  return (c==EOF) ? SEXP_EOF : sexp_make_fixnum(c);
+}
+
+sexp sexp_peek_u8 (sexp ctx, sexp self, sexp in) {
+  sexp res = sexp_read_u8(ctx, self, in);
+  if (sexp_fixnump(res))
+    sexp_push_char(ctx, sexp_unbox_fixnum(res), in);
+  return res;
+}
+
+/* Bulk reads work directly on the port buffer, scanning and copying */
+/* whole runs of bytes rather than going through read-char. */
+
+#define SEXP_READ_LINE  1       /* stop after a line terminator */
+#define SEXP_READ_BYTES 2       /* count bytes rather than chars */
+#define SEXP_READ_NONBLOCK 4    /* stop instead of blocking */
+
+#define SEXP_READ_EOF   0
+#define SEXP_READ_LIMIT 1
+#define SEXP_READ_EOL   2
+#define SEXP_READ_BLOCK 3
+
+#define SEXP_READ_BUFFER_INIT_SIZE 256
+
+#if SEXP_USE_UTF8_STRINGS
+#define sexp_utf8_continuationp(c) (((c) & 0xC0) == 0x80)
+#define sexp_count_newlines(p, len) sexp_utf8_count_byte(p, len, '\n')
+#else
+#define sexp_utf8_continuationp(c) 0
+static sexp_sint_t sexp_count_newlines (const unsigned char *p, sexp_sint_t len) {
+  const unsigned char *end = p + len;
+  sexp_sint_t res = 0;
+  while ((p = (const unsigned char*) memchr(p, '\n', end - p))) {
+    res++;
+    p++;
+  }
+  return res;
+}
+#endif
+
+struct sexp_read_buf {
+  char *data, *init;
+  sexp_sint_t len, size;
+};
+
+static int sexp_read_buf_append (struct sexp_read_buf *b, const char *p, sexp_sint_t n) {
+  char *tmp;
+  sexp_sint_t size;
+  if (b->len + n > b->size) {
+    if (!b->init) return -1;
+    size = b->size * 2 > b->len + n ? b->size * 2 : b->len + n;
+    if (b->data == b->init) {
+      if (!(tmp = (char*) malloc(size))) return -1;
+      memcpy(tmp, b->data, b->len);
+    } else if (!(tmp = (char*) realloc(b->data, size))) {
+      return -1;
+    }
+    b->data = tmp;
+    b->size = size;
+  }
+  memcpy(b->data + b->len, p, n);
+  b->len += n;
+  return 0;
+}
+
+static void sexp_read_buf_free (struct sexp_read_buf *b) {
+  if (b->data != b->init && b->init) free(b->data);
+}
+
+/* the number of bytes at the end of the buffer which don't yet */
+/* make up a whole char */
+static sexp_sint_t sexp_read_buf_incomplete (struct sexp_read_buf *b) {
+#if SEXP_USE_UTF8_STRINGS
+  sexp_sint_t i = b->len - 1;
+  while (i > 0 && i > b->len - 4 && sexp_utf8_continuationp((unsigned char)b->data[i]))
+    i--;
+  if (i < 0
+      || b->len - i >= sexp_utf8_initial_byte_count(((unsigned char*)b->data)[i]))
+    return 0;
+  return b->len - i;
+#else
+  return 0;
+#endif
+}
+
+#define sexp_read_buf_completep(b) (sexp_read_buf_incomplete(b) == 0)
+
+/* consume the \n after a \r */
+static void sexp_read_eol (sexp ctx, sexp in, int c) {
+  if (c == '\r') {
+    c = sexp_read_char(ctx, in);
+    if (c != '\n') {
+      sexp_push_char(ctx, c, in);
+      return;
+    }
+  }
+  sexp_port_line(in)++;
+}
+
+#if SEXP_USE_GREEN_THREADS
+/* Reads more input into the buffer of a non-blocking port.  The */
+/* bytes of a partly read char at the end of b are still in the port */
+/* buffer just before the offset, so if this would block they're */
+/* handed back to the port to be read whole next time. */
+static sexp_sint_t sexp_read_chars_more (sexp ctx, sexp in, struct sexp_read_buf *b, int flags) {
+  sexp_sint_t res, k = flags & SEXP_READ_BYTES ? 0 : sexp_read_buf_incomplete(b);
+  sexp_uint_t mark = sexp_port_offset(in) - k;
+  res = sexp_extend_port_buffer(ctx, in, &mark);
+  if (res < 0 && errno == EAGAIN) {
+    b->len -= k;
+    sexp_port_offset(in) -= k;
+  }
+  return res;
+}
+#endif
+
+/* Reads up to n chars (or bytes) from in into b.  When reading lines */
+/* stops after a \n, \r or \r\n, which is consumed but not stored, */
+/* including one immediately following the n'th char.  Returns how */
+/* the read ended, or -1 if out of memory.  With SEXP_READ_NONBLOCK, */
+/* if more input would block SEXP_READ_BLOCK is returned with the */
+/* whole chars read so far in b, and the caller can yield and then */
+/* read the rest from where this left off. */
+static int sexp_read_chars (sexp ctx, sexp in, struct sexp_read_buf *b, sexp_sint_t n, int flags) {
+  unsigned char *p, *q;
+  sexp_sint_t avail, seg, k, count = 0;
+  char ch;
+  int c;
+  for (;;) {
+    if (sexp_port_buf(in) && sexp_port_offset(in) < sexp_port_size(in)) {
+      p = (unsigned char*)sexp_port_buf(in) + sexp_port_offset(in);
+      avail = seg = sexp_port_size(in) - sexp_port_offset(in);
+      if (flags & SEXP_READ_LINE) {
+        if ((q = (unsigned char*) memchr(p, '\n', seg))) seg = q - p;
+        if ((q = (unsigned char*) memchr(p, '\r', seg))) seg = q - p;
+      }
+      if (flags & SEXP_READ_BYTES || !SEXP_USE_UTF8_STRINGS) {
+        k = seg < n - count ? seg : n - count;
+        count += k;
+      } else if (count + seg <= n) {
+        /* each char is at least one byte, so the whole run fits */
+        k = seg;
+        count += sexp_utf8_lead_byte_count(p, seg);
+      } else {
+        for (k = 0; k < seg; k++)
+          if (!sexp_utf8_continuationp(p[k])) {
+            if (count >= n) break;
+            count++;
+          }
+      }
+      if (sexp_read_buf_append(b, (char*)p, k) < 0) return -1;
+      sexp_port_offset(in) += k;
+      if (!(flags & SEXP_READ_LINE))
+        sexp_port_line(in) += sexp_count_newlines(p, k);
+      if (k < seg)
+        return SEXP_READ_LIMIT;
+      if (seg < avail) {
+        c = p[seg];
+#if SEXP_USE_GREEN_THREADS
+        if (flags & SEXP_READ_NONBLOCK && c == '\r' && seg + 1 == avail) {
+          /* check for a following \n before consuming the \r */
+          if ((k = sexp_read_chars_more(ctx, in, b, flags)) > 0)
+            continue;
+          if (k < 0 && errno == EAGAIN)
+            return SEXP_READ_BLOCK;
+        }
+#endif
+        sexp_port_offset(in)++;
+        sexp_read_eol(ctx, in, c);
+        return SEXP_READ_EOL;
+      }
+      if (!(flags & SEXP_READ_LINE) && count >= n
+          && (flags & SEXP_READ_BYTES || sexp_read_buf_completep(b)))
+        return SEXP_READ_LIMIT;
+#if SEXP_USE_GREEN_THREADS
+    } else if (flags & SEXP_READ_NONBLOCK) {
+      if ((k = sexp_read_chars_more(ctx, in, b, flags)) > 0)
+        continue;
+      return k < 0 && errno == EAGAIN ? SEXP_READ_BLOCK : SEXP_READ_EOF;
+#endif
+    } else {
+      c = sexp_read_char(ctx, in);
+      if (c == EOF)
+        return SEXP_READ_EOF;
+      if (sexp_port_buf(in)) {
+        /* refilled, go back to scanning the buffer */
+        sexp_push_char(ctx, c, in);
+        continue;
+      }
+      /* unbuffered stream */
+      if (flags & SEXP_READ_LINE && (c == '\n' || c == '\r')) {
+        sexp_read_eol(ctx, in, c);
+        return SEXP_READ_EOL;
+      }
+      if (flags & SEXP_READ_BYTES || !sexp_utf8_continuationp(c)) {
+        if (count >= n) {
+          sexp_push_char(ctx, c, in);
+          return SEXP_READ_LIMIT;
+        }
+        count++;
+      }
+      if (c == '\n') sexp_port_line(in)++;
+      ch = c;
+      if (sexp_read_buf_append(b, &ch, 1) < 0) return -1;
+      if (!(flags & SEXP_READ_LINE) && count >= n
+          && (flags & SEXP_READ_BYTES || sexp_read_buf_completep(b)))
+        return SEXP_READ_LIMIT;
+    }
+  }
+}
+
+/* A bulk read may consume part of the input before finding it needs */
+/* more, so it can't be restarted like a single char read.  Buffered */
+/* descriptor ports read in SEXP_READ_NONBLOCK mode, returning what */
+/* they have so far to yield.  For other ports, if there is no input at all we register */
+/* the thread blocker and return -1 so the caller can yield, otherwise */
+/* we make the port block until the read is done. */
+static int sexp_bulk_read_mode (sexp ctx, sexp in) {
+#if SEXP_USE_GREEN_THREADS
+  int c;
+  if (sexp_port_nonblockingp(ctx, in))
+    return SEXP_READ_NONBLOCK;
+  if (!sexp_port_buf(in) || sexp_port_offset(in) >= sexp_port_size(in)) {
+    errno = 0;
+    c = sexp_read_char(ctx, in);
+    if (c == EOF && errno == EAGAIN) {
+      if (sexp_port_stream(in))
+        clearerr(sexp_port_stream(in));
+      if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER))) {
+        sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, SEXP_FALSE);
+        return -1;
+      }
+    }
+    sexp_push_char(ctx, c, in);
+  }
+  sexp_maybe_block_port(ctx, in, 1);
+#endif
+  return 0;
+}
+
+#define sexp_check_bulk_read(ctx, self, in, mode)                       \
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);                   \
+  if (!sexp_port_openp(in))                                             \
+    return sexp_xtype_exception(ctx, self, "port is closed", in);       \
+  if ((mode = sexp_bulk_read_mode(ctx, in)) < 0)                        \
+    return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);                     \
+  if (sexp_port_exceptionp(in))                                         \
+    return sexp_port_take_exception(in)
+
+/* report an error from a custom port's reader */
+#define sexp_check_bulk_read_exception(in, status, b)                   \
+  if (status == SEXP_READ_EOF && sexp_port_exceptionp(in)) {            \
+    sexp_read_buf_free(b);                                              \
+    return sexp_port_take_exception(in);                                \
+  }
+
+#if SEXP_USE_GREEN_THREADS
+/* nothing was read, wait for more input and retry */
+#define sexp_check_bulk_read_block(ctx, in, status, b)                  \
+  if (status == SEXP_READ_BLOCK && (b)->len == 0) {                     \
+    sexp_read_buf_free(b);                                              \
+    sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, SEXP_FALSE); \
+    return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);                     \
+  }
+
+/* Otherwise the result so far is returned in a list, and the caller */
+/* should call again for the rest once there's more input. */
+static sexp sexp_read_partial (sexp ctx, int status, sexp x) {
+  sexp_gc_var1(res);
+  if (status != SEXP_READ_BLOCK || sexp_exceptionp(x)) return x;
+  sexp_gc_preserve1(ctx, res);
+  res = x;
+  res = sexp_list1(ctx, res);
+  sexp_gc_release1(ctx);
+  return res;
+}
+#else
+#define sexp_check_bulk_read_block(ctx, in, status, b)
+#define sexp_read_partial(ctx, status, x) (x)
+#endif
+
+sexp sexp_read_line_n (sexp ctx, sexp self, sexp_sint_t n, sexp in) {
+  char init[SEXP_READ_BUFFER_INIT_SIZE];
+  struct sexp_read_buf b = {init, init, 0, sizeof(init)};
+  sexp res;
+  int status, mode;
+  sexp_check_bulk_read(ctx, self, in, mode);
+  status = sexp_read_chars(ctx, in, &b, n, SEXP_READ_LINE|mode);
+  sexp_maybe_unblock_port(ctx, in);
+  sexp_check_bulk_read_block(ctx, in, status, &b);
+  sexp_check_bulk_read_exception(in, status, &b);
+  if (status < 0)
+    res = sexp_global(ctx, SEXP_G_OOM_ERROR);
+  else if (status == SEXP_READ_EOF && b.len == 0)
+    res = SEXP_EOF;
+  else
+    res = sexp_read_partial(ctx, status, sexp_c_string(ctx, b.data, b.len));
+  sexp_read_buf_free(&b);
+  return res;
+}
+
+sexp sexp_read_string_n (sexp ctx, sexp self, sexp_sint_t n, sexp in) {
+  char init[SEXP_READ_BUFFER_INIT_SIZE];
+  struct sexp_read_buf b = {init, init, 0, sizeof(init)};
+  sexp res;
+  int status, mode;
+  if (n <= 0) return sexp_c_string(ctx, "", 0);
+  sexp_check_bulk_read(ctx, self, in, mode);
+  status = sexp_read_chars(ctx, in, &b, n, mode);
+  sexp_maybe_unblock_port(ctx, in);
+  sexp_check_bulk_read_block(ctx, in, status, &b);
+  sexp_check_bulk_read_exception(in, status, &b);
+  if (status < 0)
+    res = sexp_global(ctx, SEXP_G_OOM_ERROR);
+  else if (b.len == 0)
+    res = SEXP_EOF;
+  else
+    res = sexp_read_partial(ctx, status, sexp_c_string(ctx, b.data, b.len));
+  sexp_read_buf_free(&b);
+  return res;
+}
+
+/* Reads up to n chars into str from the start'th char, returning */
+/* the number of chars read.  The string is resized if the chars */
+/* replaced have a different utf8 length than those read. */
+sexp sexp_read_string_x (sexp ctx, sexp self, sexp str, sexp_sint_t start, sexp_sint_t n, sexp in) {
+  char init[SEXP_READ_BUFFER_INIT_SIZE];
+  struct sexp_read_buf b = {init, init, 0, sizeof(init)};
+  sexp_sint_t count, offset, old_len;
+  sexp res = SEXP_VOID, bytes;
+  int status, mode;
+  sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, str);
+  if (n <= 0) return SEXP_ZERO;
+  sexp_check_bulk_read(ctx, self, in, mode);
+  status = sexp_read_chars(ctx, in, &b, n, mode);
+  sexp_maybe_unblock_port(ctx, in);
+  sexp_check_bulk_read_block(ctx, in, status, &b);
+  sexp_check_bulk_read_exception(in, status, &b);
+  if (status < 0) {
+    sexp_read_buf_free(&b);
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  }
+#if SEXP_USE_UTF8_STRINGS
+  count = sexp_string_utf8_length((unsigned char*)b.data, b.len);
+  res = sexp_string_index_to_cursor(ctx, self, 1, str, sexp_make_fixnum(start));
+  if (!sexp_exceptionp(res)) {
+    offset = sexp_unbox_string_cursor(res);
+    res = sexp_string_index_to_cursor(ctx, self, 1, str, sexp_make_fixnum(start + count));
+  }
+  if (sexp_exceptionp(res)) {
+    sexp_read_buf_free(&b);
+    return res;
+  }
+  old_len = sexp_unbox_string_cursor(res) - offset;
+#else
+  offset = start;
+  count = old_len = b.len;
+#endif
+  if (old_len != b.len) {
+#if SEXP_USE_PACKED_STRINGS
+    res = sexp_xtype_exception(ctx, self, "read-string!: can't resize packed string", str);
+#else
+    bytes = sexp_make_bytes(ctx, sexp_make_fixnum(sexp_string_size(str) - old_len + b.len), SEXP_VOID);
+    if (sexp_exceptionp(bytes)) {
+      res = bytes;
+    } else {
+      memcpy(sexp_bytes_data(bytes), sexp_string_data(str), offset);
+      memcpy(sexp_bytes_data(bytes) + offset + b.len,
+             sexp_string_data(str) + offset + old_len,
+             sexp_string_size(str) - offset - old_len);
+      sexp_string_bytes(str) = bytes;
+      sexp_string_offset(str) = 0;
+      sexp_string_size(str) += b.len - old_len;
+      sexp_bytes_data(bytes)[sexp_string_size(str)] = '\0';
+    }
+#endif
+  }
+  if (!sexp_exceptionp(res)) {
+    memcpy(sexp_string_data(str) + offset, b.data, b.len);
+    sexp_string_index_invalidate(str);
+    res = sexp_read_partial(ctx, status, sexp_make_fixnum(count));
+  }
+  sexp_read_buf_free(&b);
+  return res;
+}
+
+/* Reads a line into bytes from start to end without the terminator, */
+/* returning the number of bytes read. */
+sexp sexp_read_line_x (sexp ctx, sexp self, sexp bv, sexp in, sexp_sint_t start, sexp_sint_t end) {
+  struct sexp_read_buf b;
+  int status, mode;
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, bv);
+  if (start < 0 || start > end || end > (sexp_sint_t)sexp_bytes_length(bv))
+    return sexp_user_exception(ctx, self, "read-line!: invalid range", sexp_list2(ctx, sexp_make_fixnum(start), sexp_make_fixnum(end)));
+  sexp_check_bulk_read(ctx, self, in, mode);
+  b.data = sexp_bytes_data(bv) + start;
+  b.init = NULL;
+  b.len = 0;
+  b.size = end - start;
+  status = sexp_read_chars(ctx, in, &b, b.size, SEXP_READ_LINE|SEXP_READ_BYTES|mode);
+  sexp_maybe_unblock_port(ctx, in);
+  sexp_check_bulk_read_block(ctx, in, status, &b);
+  sexp_check_bulk_read_exception(in, status, &b);
+  if (status == SEXP_READ_EOF && b.len == 0)
+    return SEXP_EOF;
+  return sexp_read_partial(ctx, status, sexp_make_fixnum(b.len));
+}
+
+/* Reads up to end-start bytes into bv, returning the number read, */
+/* which is less than requested only at EOF, or when more input */
+/* would block, in which case the caller should call again. */
+sexp sexp_read_bytes_x (sexp ctx, sexp self, sexp bv, sexp_sint_t start, sexp_sint_t end, sexp in) {
+  sexp_sint_t n = 0, k, len;
+  char *dst;
+  int c;
+#if SEXP_USE_VECTORED_IO
+  struct iovec iov[2];
+#endif
+  sexp_assert_type(ctx, sexp_bytesp, SEXP_BYTES, bv);
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);
+  if (!sexp_port_binaryp(in))
+    return sexp_xtype_exception(ctx, self, "not a binary port", in);
+  if (start < 0 || start > end || end > (sexp_sint_t)sexp_bytes_length(bv))
+    return sexp_user_exception(ctx, self, "read-bytevector!: invalid range", sexp_list2(ctx, sexp_make_fixnum(start), sexp_make_fixnum(end)));
+  dst = sexp_bytes_data(bv) + start;
+  len = end - start;
+  while (n < len) {
+    if (sexp_port_buf(in) && sexp_port_offset(in) < sexp_port_size(in)) {
+      k = sexp_port_size(in) - sexp_port_offset(in);
+      if (k > len - n) k = len - n;
+      memcpy(dst + n, sexp_port_buf(in) + sexp_port_offset(in), k);
+      sexp_port_line(in) += sexp_count_newlines((unsigned char*)dst + n, k);
+      sexp_port_offset(in) += k;
+      n += k;
+      continue;
+    }
+#if SEXP_USE_GREEN_THREADS
+    errno = 0;
+#endif
+    if (sexp_port_buf(in) && !sexp_port_stream(in) && sexp_port_openp(in)
+        && sexp_filenop(sexp_port_fd(in))
+        && len - n >= (sexp_sint_t)sexp_port_capacity(in)) {
+      /* large reads go straight from the fd, refilling the buffer */
+      /* in the same call where we can */
+#if SEXP_USE_VECTORED_IO
+      iov[0].iov_base = dst + n;
+      iov[0].iov_len = len - n;
+      iov[1].iov_base = sexp_port_buf(in);
+      iov[1].iov_len = sexp_port_capacity(in);
+      k = readv(sexp_port_fileno(in), iov, 2);
+      if (k > len - n) {
+        sexp_port_offset(in) = 0;
+        sexp_port_size(in) = k - (len - n);
+        k = len - n;
+      }
+#else
+      k = read(sexp_port_fileno(in), dst + n, len - n);
+#endif
+      if (k > 0) {
+        sexp_port_line(in) += sexp_count_newlines((unsigned char*)dst + n, k);
+        n += k;
+        continue;
+      }
+      c = EOF;
+    } else {
+      c = sexp_read_char(ctx, in);
+    }
+    if (c == EOF) {
+      if (sexp_port_exceptionp(in))
+        return sexp_port_take_exception(in);
+#if SEXP_USE_GREEN_THREADS
+      if (errno == EAGAIN) {
+        if (sexp_port_stream(in))
+          clearerr(sexp_port_stream(in));
+        if (n > 0) break;
+        if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER)))
+          sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, SEXP_FALSE);
+        return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+      }
+#endif
+      return n == 0 ? SEXP_EOF : sexp_make_fixnum(n);
+    }
+    if (sexp_port_buf(in)) {
+      sexp_push_char(ctx, c, in);
+    } else {
+      if (c == '\n') sexp_port_line(in)++;
+      dst[n++] = c;
+    }
+  }
+  return sexp_make_fixnum(n);
+}
+
+/* Writes the bytes of a string or bytevector between the positions */
+/* start and end, which are string cursors for strings, returning */
+/* the position after the last byte written.  This is short of end */
+/* only if the port would block, in which case the caller should */
+/* call again to write the rest. */
+sexp sexp_write_range (sexp ctx, sexp self, sexp x, sexp start, sexp end, sexp out) {
+  sexp_sint_t s, e, n;
+  char *data;
+  sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
+  if (!sexp_port_openp(out))
+    return sexp_xtype_exception(ctx, self, "port is closed", out);
+  if (sexp_stringp(x)) {
+    sexp_assert_type(ctx, sexp_string_cursorp, SEXP_STRING_CURSOR, start);
+    sexp_assert_type(ctx, sexp_string_cursorp, SEXP_STRING_CURSOR, end);
+    s = sexp_unbox_string_cursor(start);
+    e = sexp_unbox_string_cursor(end);
+    data = sexp_string_data(x);
+    n = sexp_string_size(x);
+  } else if (sexp_bytesp(x)) {
+    sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, start);
+    sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, end);
+    s = sexp_unbox_fixnum(start);
+    e = sexp_unbox_fixnum(end);
+    data = sexp_bytes_data(x);
+    n = sexp_bytes_length(x);
+  } else {
+    return sexp_type_exception(ctx, self, SEXP_BYTES, x);
+  }
+  if (s < 0 || s > e || e > n)
+    return sexp_user_exception(ctx, self, "write: invalid range", sexp_list2(ctx, start, end));
+#if SEXP_USE_GREEN_THREADS
+  errno = 0;
+#endif
+  n = sexp_write_string_n(ctx, data + s, e - s, out);
+  if (sexp_port_exceptionp(out))
+    return sexp_port_take_exception(out);
+  if (n < 0) n = 0;
+#if SEXP_USE_GREEN_THREADS
+  if (n < e - s && errno == EAGAIN) {
+    if (sexp_port_stream(out)) clearerr(sexp_port_stream(out));
+    if (n == 0) {
+      if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER)))
+        sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), out, SEXP_FALSE);
+      return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+    }
+  }
+#endif
+  return sexp_stringp(x) ? sexp_make_string_cursor(s + n) : sexp_make_fixnum(s + n);
+}
+
+/* Opens a regular file as an input port whose buffer is the whole */
+/* file mapped into memory, so reads involve no syscalls or copying. */
+/* Returns #f if the file can't be mapped, e.g. it isn't a regular */
+/* file or is empty, and the caller should open it normally. */
+sexp sexp_open_mmap_input_port (sexp ctx, sexp self, sexp path) {
+#if SEXP_USE_MMAP_PORTS
+  struct stat st;
+  void *addr;
+  int fd;
+  sexp res;
+  sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, path);
+  fd = open(sexp_string_data(path), O_RDONLY);
+  if (fd < 0)
+    return sexp_file_exception(ctx, self, "couldn't open input file", path);
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+      || (off_t)(size_t)st.st_size != st.st_size) {
+    close(fd);
+    return SEXP_FALSE;
+  }
+  /* writable but private, since pushing back a different char than */
+  /* was read writes into the buffer */
+  addr = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    return SEXP_FALSE;
+#ifdef MADV_SEQUENTIAL
+  madvise(addr, st.st_size, MADV_SEQUENTIAL);
+#endif
+  res = sexp_make_input_port(ctx, NULL, path);
+  if (sexp_exceptionp(res)) {
+    munmap(addr, st.st_size);
+    return res;
+  }
+  sexp_port_buf(res) = (char*)addr;
+  sexp_port_offset(res) = 0;
+  sexp_port_size(res) = st.st_size;
+  sexp_port_mmappedp(res) = 1;
+  return res;
+#else
+  return SEXP_FALSE;
+#endif
+}
+
+/* Replaces the buffer of a file descriptor port with one of the */
+/* given size, keeping any buffered data. */
+sexp sexp_set_port_buffer_size (sexp ctx, sexp self, sexp port, sexp_sint_t size) {
+  sexp_sint_t used;
+  char *start;
+  sexp_gc_var1(str);
+  if (!sexp_portp(port))
+    return sexp_type_exception(ctx, self, SEXP_IPORT, port);
+  if (!(sexp_port_buf(port) && !sexp_port_stream(port)
+        && sexp_filenop(sexp_port_fd(port))
+        && sexp_stringp(sexp_port_cookie(port))))
+    return sexp_xtype_exception(ctx, self, "not a file descriptor port", port);
+  if (size <= 0)
+    return sexp_xtype_exception(ctx, self, "invalid buffer size", sexp_make_fixnum(size));
+  if (sexp_oportp(port)) {
+    if (sexp_port_offset(port) > (sexp_uint_t)size)
+      sexp_flush(ctx, port);
+    start = sexp_port_buf(port);
+    used = sexp_port_offset(port);
+    if (used > size)
+      return sexp_xtype_exception(ctx, self, "can't flush port to resize buffer", port);
+  } else {
+    start = sexp_port_buf(port) + sexp_port_offset(port);
+    used = sexp_port_size(port) - sexp_port_offset(port);
+    if (used > size) size = used;
+  }
+  sexp_gc_preserve1(ctx, str);
+  str = sexp_make_string(ctx, sexp_make_fixnum(size), SEXP_VOID);
+  if (!sexp_exceptionp(str)) {
+    memcpy(sexp_string_data(str), start, used);
+    sexp_port_cookie(port) = str;
+    sexp_port_buf(port) = sexp_string_data(str);
+    if (sexp_oportp(port)) {
+      sexp_port_offset(port) = used;
+      sexp_port_size(port) = size;
+    } else {
+      sexp_port_offset(port) = 0;
+      sexp_port_size(port) = used;
+    }
+    str = SEXP_VOID;
+  }
+  sexp_gc_release1(ctx);
+  return str;
+}
+
+sexp sexp_get_port_buffer_size (sexp ctx, sexp self, sexp port) {
+  if (!sexp_portp(port))
+    return sexp_type_exception(ctx, self, SEXP_IPORT, port);
+  if (!sexp_port_buf(port) || sexp_port_stream(port) || !sexp_filenop(sexp_port_fd(port)))
+    return SEXP_FALSE;
+  return sexp_make_fixnum(sexp_port_capacity(port));
+}
+
+int sexp_is_a_socket_p (int fd) {
+#if defined(PLAN9) || defined(_WIN32)
+  return 0;
+#else
+  struct stat statbuf;
+  fstat(fd, &statbuf);
+  return S_ISSOCK(statbuf.st_mode);
+#endif
+}
+
+/* Returns true if reading from the port won't block, i.e. there is  */
+/* buffered data or the fd is readable (or at EOF or in error),      */
+/* waiting up to timeout seconds.  When green threads are running   */
+/* this doesn't wait but registers the blocker and returns false,    */
+/* and the caller should yield and check again with a #f timeout.    */
+sexp sexp_input_port_wait (sexp ctx, sexp self, sexp in, sexp timeout) {
+#if defined(PLAN9) || defined(_WIN32)
+  return SEXP_TRUE;
+#else
+  int ms;
+  struct pollfd pfd;
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);
+  if (!sexp_port_openp(in) || sexp_stream_portp(in) || !sexp_port_buf(in)
+      || sexp_port_offset(in) < sexp_port_size(in)
+      || sexp_port_fileno(in) < 0)
+    return SEXP_TRUE;
+  pfd.fd = sexp_port_fileno(in);
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) != 0)
+    return SEXP_TRUE;
+  if (sexp_fixnump(timeout))
+    ms = sexp_unbox_fixnum(timeout) * 1000;
+#if SEXP_USE_FLONUMS
+  else if (sexp_flonump(timeout))
+    ms = sexp_flonum_value(timeout) * 1000;
+#endif
+  else
+    return SEXP_FALSE;
+#if SEXP_USE_GREEN_THREADS
+  if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER))) {
+    sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, timeout);
+    return SEXP_FALSE;
+  }
+#endif
+  return sexp_make_boolean(poll(&pfd, 1, ms) != 0);
+#endif
+}
+
+sexp sexp_seek (sexp ctx, sexp self, sexp x, off_t offset, int whence) {
+  off_t res;
+  if (! (sexp_portp(x) || sexp_filenop(x)))
+    return sexp_type_exception(ctx, self, SEXP_IPORT, x);
+#if SEXP_USE_MMAP_PORTS
+  if (sexp_portp(x) && sexp_port_mmappedp(x)) {
+    res = offset + (whence == SEEK_CUR ? (off_t)sexp_port_offset(x)
+                    : whence == SEEK_END ? (off_t)sexp_port_size(x) : 0);
+    if (res < 0 || res > (off_t)sexp_port_size(x))
+      return sexp_make_integer(ctx, -1);
+    sexp_port_offset(x) = res;
+    return sexp_make_integer(ctx, res);
+  }
+#endif
+  if (sexp_filenop(x))
+    return sexp_make_integer(ctx, lseek(sexp_fileno_fd(x), offset, whence));
+  if (sexp_filenop(sexp_port_fd(x))) {
+    res = lseek(sexp_fileno_fd(sexp_port_fd(x)), offset, whence);
+    if (res >= 0 && !(whence == SEEK_CUR && offset == 0))
+      sexp_port_offset(x) = 0;
+    else if (sexp_oportp(x))
+      res += sexp_port_offset(x);
+    return sexp_make_integer(ctx, res);
+  }
+  if (sexp_stream_portp(x))
+    return sexp_make_integer(ctx, fseek(sexp_port_stream(x), offset, whence));
+  return sexp_xtype_exception(ctx, self, "not a seekable port", x);
+}
+
+sexp sexp_tell (sexp ctx, sexp self, sexp x) {
+  if (sexp_portp(x) && sexp_stream_portp(x))
+    return sexp_make_integer(ctx, ftell(sexp_port_stream(x)));
+  return sexp_seek(ctx, self, x, 0, SEEK_CUR);
+}
+
+#define SEXP_SEND_FILE_CHUNK_SIZE (1<<30)
+#define SEXP_COPY_FILE_BUFFER_SIZE (64*1024)
+
+#if ! (defined(PLAN9) || defined(_WIN32))
+/* copy with pread so we never touch the file position, which may be */
+/* shared with other threads sending the same descriptor */
+static ssize_t sexp_copy_file_range (int fd, int s, off_t offset, off_t len) {
+  char buf[SEXP_COPY_FILE_BUFFER_SIZE];
+  ssize_t n = pread(fd, buf, (len > 0 && len < (off_t)sizeof(buf)) ? len : (off_t)sizeof(buf), offset);
+  return (n <= 0) ? n : write(s, buf, n);
+}
+
+/* likewise but through the buffer of a port with no usable */
+/* descriptor, returning the number of bytes read from the file and */
+/* setting *written to the number the port took */
+static ssize_t sexp_copy_file_range_to_port (sexp ctx, int fd, sexp out, off_t offset, off_t len, ssize_t *written) {
+  char buf[SEXP_COPY_FILE_BUFFER_SIZE];
+  ssize_t n = pread(fd, buf, (len > 0 && len < (off_t)sizeof(buf)) ? len : (off_t)sizeof(buf), offset);
+  *written = 0;
+  if (n > 0) {
+    errno = 0;
+    *written = sexp_write_string_n(ctx, buf, n, out);
+  }
+  return n;
+}
+#endif
+
+/* Sends up to len bytes (or the rest of the file if len is 0) of fd */
+/* starting at offset to the output port or fileno out, returning the */
+/* number of bytes sent, or 0 at end of file.  Ports without a        */
+/* descriptor are written through their buffer.  The file position   */
+/* of fd is unchanged.  If the socket would block we wait for it to   */
+/* drain, letting other green threads run, and other errors such as   */
+/* EPIPE raise an exception.                                          */
+sexp sexp_send_file (sexp ctx, sexp self, int fd, sexp out, off_t offset, off_t len) {
+#if defined(PLAN9) || defined(_WIN32)
+  return SEXP_FALSE;
+#else
+  int s;
+  ssize_t n = -1, k;
+#if SEXP_USE_SEND_FILE
+  off_t off;
+#endif
+  struct pollfd pfd;
+  if (sexp_oportp(out))
+    s = sexp_port_fileno(out);
+  else if (sexp_filenop(out))
+    s = sexp_fileno_fd(out);
+  else
+    return sexp_type_exception(ctx, self, SEXP_OPORT, out);
+  if (sexp_oportp(out) && (s < 0 || sexp_port_offset(out) > 0)) {
+    n = sexp_copy_file_range_to_port(ctx, fd, out, offset, len, &k);
+    if (n < 0)
+      return sexp_file_exception(ctx, self, "couldn't read file", sexp_make_fixnum(fd));
+    if (sexp_port_exceptionp(out))
+      return sexp_port_take_exception(out);
+    if (k >= n)
+      return sexp_make_integer(ctx, n);
+    /* a short write, only report what the port took */
+    if (errno == EAGAIN) {
+      if (sexp_port_stream(out))
+        clearerr(sexp_port_stream(out));
+      if (k > 0)
+        return sexp_make_integer(ctx, k);
+#if SEXP_USE_GREEN_THREADS
+      if (sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER))) {
+        sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), out, SEXP_FALSE);
+        return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+      }
+#endif
+    }
+    return sexp_file_exception(ctx, self, "couldn't send file", out);
+  } else if (s < 0) {
+    return sexp_file_exception(ctx, self, "invalid file descriptor", out);
+  }
+ retry:
+  errno = 0;
+#if SEXP_USE_SEND_FILE
+#ifdef __linux
+  off = offset;
+  n = sendfile(s, fd, &off, len > 0 ? len : SEXP_SEND_FILE_CHUNK_SIZE);
+#elif defined(__APPLE__)
+  off = len;
+  n = sendfile(fd, s, offset, &off, NULL, 0);
+  if (n == 0 || (errno == EAGAIN && off > 0)) n = off;
+#else
+  off = 0;
+  n = sendfile(fd, s, offset, len, NULL, &off, 0);
+  if (n == 0 || (errno == EAGAIN && off > 0)) n = off;
+#endif
+  if (n < 0 && (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP))
+#endif
+    n = sexp_copy_file_range(fd, s, offset, len);
+  if (n >= 0)
+    return sexp_make_integer(ctx, n);
+  if (errno == EAGAIN) {
+#if SEXP_USE_GREEN_THREADS
+    if (sexp_oportp(out)
+        && sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER))) {
+      sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), out, SEXP_FALSE);
+      return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+    }
+#endif
+    pfd.fd = s;
+    pfd.events = POLLOUT;
+    poll(&pfd, 1, -1);
+    goto retry;
+  }
+  return sexp_file_exception(ctx, self, "couldn't send file", out);
+#endif
+}
+/*
+types: ()
+enums: ()
+*/
+
+sexp sexp_peek_u8_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_peek_u8(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_read_u8_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_read_u8(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_write_u8_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3) {
+  sexp res;
+  res = sexp_write_u8(ctx, self, arg2, arg3);
+  return res;
+}
+
+sexp sexp_25_write_range_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  res = sexp_write_range(ctx, self, arg2, arg3, arg4, arg5);
+  return res;
+}
+
+sexp sexp_25_read_bytevector_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  if (! sexp_exact_integerp(arg3))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg3);
+  if (! sexp_exact_integerp(arg4))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg4);
+  res = sexp_read_bytes_x(ctx, self, arg2, sexp_sint_value(arg3), sexp_sint_value(arg4), arg5);
+  return res;
+}
+
+sexp sexp_25_read_line_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  if (! sexp_exact_integerp(arg4))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg4);
+  if (! sexp_exact_integerp(arg5))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg5);
+  res = sexp_read_line_x(ctx, self, arg2, arg3, sexp_sint_value(arg4), sexp_sint_value(arg5));
+  return res;
+}
+
+sexp sexp_25_read_string_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  if (! sexp_exact_integerp(arg3))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg3);
+  if (! sexp_exact_integerp(arg4))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg4);
+  res = sexp_read_string_x(ctx, self, arg2, sexp_sint_value(arg3), sexp_sint_value(arg4), arg5);
+  return res;
+}
+
+sexp sexp_25_read_string_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3) {
+  sexp res;
+  if (! sexp_exact_integerp(arg2))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg2);
+  res = sexp_read_string_n(ctx, self, sexp_sint_value(arg2), arg3);
+  return res;
+}
+
+sexp sexp_25_read_line_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3) {
+  sexp res;
+  if (! sexp_exact_integerp(arg2))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg2);
+  res = sexp_read_line_n(ctx, self, sexp_sint_value(arg2), arg3);
+  return res;
+}
+
+sexp sexp_25_utf8_valid_p_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  res = sexp_utf8_validp(ctx, self, arg2, arg3, arg4);
+  return res;
+}
+
+sexp sexp_utf8_3e_string_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_utf8_to_string_x(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_25_string_3e_utf8_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_string_to_utf8(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_string_count_chars_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  res = sexp_string_count(ctx, self, arg2, arg3, arg4, arg5);
+  return res;
+}
+
+sexp sexp_25_output_string_chunks_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_output_string_chunks(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_get_output_bytevector_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_get_output_bytevector(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_open_output_bytevector_stub (sexp ctx, sexp self, sexp_sint_t n) {
+  sexp res;
+  res = sexp_open_output_bytevector(ctx, self);
+  return res;
+}
+
+sexp sexp_open_input_bytevector_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_open_input_bytevector(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_25_make_custom_binary_output_port_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  res = sexp_make_custom_binary_output_port(ctx, self, arg2, arg3, arg4);
+  return res;
+}
+
+sexp sexp_25_make_custom_binary_input_port_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  res = sexp_make_custom_binary_input_port(ctx, self, arg2, arg3, arg4);
+  return res;
+}
+
+sexp sexp_25_make_custom_output_port_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  res = sexp_make_custom_output_port(ctx, self, arg2, arg3, arg4);
+  return res;
+}
+
+sexp sexp_25_make_custom_input_port_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  res = sexp_make_custom_input_port(ctx, self, arg2, arg3, arg4);
+  return res;
+}
+
+sexp sexp_25_send_file_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4, sexp arg5) {
+  sexp res;
+  if (! (sexp_filenop(arg2) || sexp_fixnump(arg2)))
+    return sexp_type_exception(ctx, self, SEXP_FILENO, arg2);
+  if (! sexp_exact_integerp(arg4))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg4);
+  if (! sexp_exact_integerp(arg5))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg5);
+  res = sexp_send_file(ctx, self, (sexp_filenop(arg2) ? sexp_fileno_fd(arg2) : sexp_unbox_fixnum(arg2)), arg3, sexp_uint_value(arg4), sexp_uint_value(arg5));
+  return res;
+}
+
+sexp sexp_25_input_port_wait_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3) {
+  sexp res;
+  res = sexp_input_port_wait(ctx, self, arg2, arg3);
+  return res;
+}
+
+sexp sexp_set_port_buffer_size_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3) {
+  sexp res;
+  if (! sexp_exact_integerp(arg3))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg3);
+  res = sexp_set_port_buffer_size(ctx, self, arg2, sexp_sint_value(arg3));
+  return res;
+}
+
+sexp sexp_port_buffer_size_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_get_port_buffer_size(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_25_open_mmap_input_port_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_open_mmap_input_port(ctx, self, arg2);
+  return res;
+}
+
+sexp sexp_is_a_socket_p_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg0) {
+  sexp res;
+  if (! (sexp_filenop(arg0) || sexp_fixnump(arg0)))
+    return sexp_type_exception(ctx, self, SEXP_FILENO, arg0);
+  res = sexp_make_boolean(sexp_is_a_socket_p((sexp_filenop(arg0) ? sexp_fileno_fd(arg0) : sexp_unbox_fixnum(arg0))));
+  return res;
+}
+
+sexp sexp_set_file_position_x_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2, sexp arg3, sexp arg4) {
+  sexp res;
+  if (! sexp_exact_integerp(arg3))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg3);
+  if (! sexp_exact_integerp(arg4))
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, arg4);
+  res = sexp_seek(ctx, self, arg2, sexp_uint_value(arg3), sexp_sint_value(arg4));
+  return res;
+}
+
+sexp sexp_file_position_stub (sexp ctx, sexp self, sexp_sint_t n, sexp arg2) {
+  sexp res;
+  res = sexp_tell(ctx, self, arg2);
+  return res;
+}
+
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  sexp_gc_var3(name, tmp, op);
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  sexp_gc_preserve3(ctx, name, tmp, op);
+  name = sexp_intern(ctx, "seek/end", 8);
+  sexp_env_define(ctx, env, name, tmp=sexp_make_integer(ctx, SEEK_END));
+  name = sexp_intern(ctx, "seek/cur", 8);
+  sexp_env_define(ctx, env, name, tmp=sexp_make_integer(ctx, SEEK_CUR));
+  name = sexp_intern(ctx, "seek/set", 8);
+  sexp_env_define(ctx, env, name, tmp=sexp_make_integer(ctx, SEEK_SET));
+  op = sexp_define_foreign_param(ctx, env, "peek-u8", 1, sexp_peek_u8_stub, "current-input-port");
+  op = sexp_define_foreign_param(ctx, env, "read-u8", 1, sexp_read_u8_stub, "current-input-port");
+  op = sexp_define_foreign_param(ctx, env, "write-u8", 2, sexp_write_u8_stub, "current-output-port");
+  op = sexp_define_foreign(ctx, env, "%write-range", 4, sexp_25_write_range_stub);
+  op = sexp_define_foreign(ctx, env, "%read-bytevector!", 4, sexp_25_read_bytevector_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_THREE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ZERO, sexp_make_fixnum(SEXP_FIXNUM));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ONE, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "%read-line!", 4, sexp_25_read_line_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_THREE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ONE, sexp_make_fixnum(SEXP_FIXNUM));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_TWO, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "%read-string!", 4, sexp_25_read_string_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_THREE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ZERO, sexp_make_fixnum(SEXP_FIXNUM));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ONE, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "%read-string", 2, sexp_25_read_string_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(SEXP_FIXNUM);
+  }
+  op = sexp_define_foreign(ctx, env, "%read-line", 2, sexp_25_read_line_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(SEXP_FIXNUM);
+  }
+  op = sexp_define_foreign(ctx, env, "%utf8-valid?", 3, sexp_25_utf8_valid_p_stub);
+  op = sexp_define_foreign(ctx, env, "utf8->string!", 1, sexp_utf8_3e_string_x_stub);
+  op = sexp_define_foreign(ctx, env, "%string->utf8", 1, sexp_25_string_3e_utf8_stub);
+  op = sexp_define_foreign_opt(ctx, env, "string-count-chars", 4, sexp_string_count_chars_stub, SEXP_FALSE);
+  op = sexp_define_foreign(ctx, env, "%output-string-chunks", 1, sexp_25_output_string_chunks_stub);
+  op = sexp_define_foreign(ctx, env, "get-output-bytevector", 1, sexp_get_output_bytevector_stub);
+  op = sexp_define_foreign(ctx, env, "open-output-bytevector", 0, sexp_open_output_bytevector_stub);
+  op = sexp_define_foreign(ctx, env, "open-input-bytevector", 1, sexp_open_input_bytevector_stub);
+  op = sexp_define_foreign(ctx, env, "%make-custom-binary-output-port", 3, sexp_25_make_custom_binary_output_port_stub);
+  op = sexp_define_foreign(ctx, env, "%make-custom-binary-input-port", 3, sexp_25_make_custom_binary_input_port_stub);
+  op = sexp_define_foreign(ctx, env, "%make-custom-output-port", 3, sexp_25_make_custom_output_port_stub);
+  op = sexp_define_foreign(ctx, env, "%make-custom-input-port", 3, sexp_25_make_custom_input_port_stub);
+  op = sexp_define_foreign_opt(ctx, env, "%send-file", 4, sexp_25_send_file_stub, sexp_make_unsigned_integer(ctx, 0));
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_arg3_type(op) = sexp_make_fixnum(SEXP_FILENO);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_THREE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ONE, sexp_make_fixnum(SEXP_FIXNUM));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_TWO, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "%input-port-wait", 2, sexp_25_input_port_wait_stub);
+  op = sexp_define_foreign(ctx, env, "set-port-buffer-size!", 2, sexp_set_port_buffer_size_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_ONE, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ZERO, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "port-buffer-size", 1, sexp_port_buffer_size_stub);
+  op = sexp_define_foreign(ctx, env, "%open-mmap-input-port", 1, sexp_25_open_mmap_input_port_stub);
+  op = sexp_define_foreign(ctx, env, "is-a-socket?", 1, sexp_is_a_socket_p_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_BOOLEAN);
+    sexp_opcode_arg1_type(op) = sexp_make_fixnum(SEXP_FILENO);
+  }
+  op = sexp_define_foreign(ctx, env, "set-file-position!", 3, sexp_set_file_position_x_stub);
+  if (sexp_opcodep(op)) {
+    sexp_opcode_return_type(op) = sexp_make_fixnum(SEXP_OBJECT);
+    sexp_opcode_argn_type(op) = sexp_make_vector(ctx, SEXP_TWO, sexp_make_fixnum(SEXP_OBJECT));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ZERO, sexp_make_fixnum(SEXP_FIXNUM));
+    sexp_vector_set(sexp_opcode_argn_type(op), SEXP_ONE, sexp_make_fixnum(SEXP_FIXNUM));
+  }
+  op = sexp_define_foreign(ctx, env, "file-position", 1, sexp_file_position_stub);
+  sexp_gc_release3(ctx);
+  return SEXP_VOID;
+}
+
@@ -29,6 +29,19 @@
         (utf8->string (subbytes vec start end)))
       (string-copy (utf8->string! vec))))
 
+;;> \procedure{(utf8-valid? vec [start [end]])}
+
+;;> Returns true iff the bytes of \var{vec} from \var{start} to
+;;> \var{end} are valid UTF-8.  \scheme{utf8->string} doesn't check
+;;> its input, so use this first on bytes from untrusted sources.
+
+(define (utf8-valid? vec . o)
+  (let* ((start (if (pair? o) (car o) 0))
+         (end (if (and (pair? o) (pair? (cdr o)))
+                  (cadr o)
+                  (bytevector-length vec))))
+    (%utf8-valid? vec start end)))
+
 (define (string->utf8 str . o)
   (if (pair? o)
       (let ((start (car o))
@@ -59,15 +72,42 @@
     (if (pair? o)
         (let ((start (car o))
               (end (if (pair? (cdr o)) (cadr o) (string-length str))))
-          (cond-expand
-           (string-streams
-            (if (zero? start)
-                (%write-string str end out)
-                (display (substring str start end) out)))
-           (else
-            (display (substring str start end) out))))
+          (%write-all str
+                      (string-index->cursor str start)
+                      (string-index->cursor str end)
+                      out))
         (display str out))))
 
+;; Write the bytes of \var{x} between \var{start} and \var{end},
+;; continuing after short writes to non-blocking ports.
+(define (%write-all x start end out)
+  (let lp ((start start))
+    (let ((next (%write-range x start end out)))
+      (if (not (or (eqv? next end) (eqv? next start)))
+          (lp next)))))
+
+;; Reads from non-blocking ports which would block after reading some
+;; input return what they have so far in a list, to be called again
+;; for the rest.  Keep calling \var{read} with the number of chars
+;; still wanted until it returns a whole result, joining the pieces.
+(define (%read-chars read n)
+  (let lp ((n n) (res '()))
+    (let ((x (read n)))
+      (cond
+       ((pair? x) (lp (- n (string-length (car x))) (cons (car x) res)))
+       ((null? res) x)
+       ((eof-object? x) (string-concatenate (reverse res)))
+       (else (string-concatenate (reverse (cons x res))))))))
+
+;; Likewise for reads into a buffer, which return the count read.
+(define (%read-chars! read start)
+  (let lp ((start start) (count 0))
+    (let ((x (read start)))
+      (cond
+       ((pair? x) (lp (+ start (car x)) (+ count (car x))))
+       ((eof-object? x) (if (zero? count) x count))
+       (else (+ count x))))))
+
 ;;> \procedure{(read-line [in [n]])}
 
 ;;> Read a line from the input port \var{in}, defaulting to
@@ -75,49 +115,28 @@
 ;;> a string not including the newline.  Reads at most \var{n}
 ;;> characters, defaulting to 8192.
 
-(cond-expand
- ((not string-streams)
-  (define (%read-line n in)
-    (let ((out (open-output-string)))
-      (let lp ((i 0))
-        (let ((ch (peek-char in)))
-          (cond
-           ((eof-object? ch)
-            (let ((res (get-output-string out)))
-              (and (not (equal? res "")) res)))
-           ((eqv? ch #\newline)
-            (read-char in)
-            (get-output-string out))
-           ((eqv? ch #\return)
-            (read-char in)
-            (if (eqv? #\newline (peek-char in))
-                (read-char in))
-            (get-output-string out))
-           ((>= i n)
-            (get-output-string out))
-           (else
-            (write-char (read-char in) out)
-            (lp (+ i 1))))))))))
-
 (define (read-line . o)
   (let ((in (if (pair? o) (car o) (current-input-port)))
         (n (if (and (pair? o) (pair? (cdr o))) (car (cdr o)) 8192)))
-    (let ((res (%read-line n in)))
-      (cond-expand
-       (string-streams
-        (port-line-set! in (+ 1 (port-line in)))))
-      (if (not res)
-          eof
-          (let ((len (string-length res)))
-            (cond
-             ((and (> len 0) (eqv? #\newline (string-ref res (- len 1))))
-              (if (and (> len 1) (eqv? #\return (string-ref res (- len 2))))
-                  (substring res 0 (- len 2))
-                  (substring res 0 (- len 1))))
-             ((and (> len 0) (eqv? #\return (string-ref res (- len 1))))
-              (substring res 0 (- len 1)))
-             (else
-              res)))))))
+    (%read-chars (lambda (n) (%read-line n in)) n)))
+
+;;> \procedure{(read-line! bv [in [start [end]]])}
+
+;;> Reads a line from the input port \var{in}, defaulting to
+;;> \scheme{(current-input-port)}, into the bytevector \var{bv}
+;;> between \var{start} and \var{end}, without allocating a new
+;;> string.  Returns the number of bytes read, not including the
+;;> newline, or the eof-object at the end of input.  If the line
+;;> doesn't fit the rest is left to be read by the next call.
+
+(define (read-line! bv . o)
+  (let* ((in (if (pair? o) (car o) (current-input-port)))
+         (o (if (pair? o) (cdr o) o))
+         (start (if (pair? o) (car o) 0))
+         (end (if (and (pair? o) (pair? (cdr o)))
+                  (cadr o)
+                  (bytevector-length bv))))
+    (%read-chars! (lambda (start) (%read-line! bv in start end)) start)))
 
 ;;> \procedure{(read-string n [in])}
 
@@ -128,27 +147,9 @@
 ;;> than \var{n} characters if the end of file is reached,
 ;;> or the eof-object if no characters are available.
 
-(cond-expand
- ((not string-streams)
-  (define (%read-string n in)
-    (let ((out (open-output-string)))
-      (let lp ((i 0))
-        (cond ((or (= i n) (eof-object? (peek-char in)))
-               (list i (get-output-string out)))
-              (else (write-char (read-char in) out) (lp (+ i 1)))))))))
-
 (define (read-string n . o)
-  (if (zero? n)
-      ""
-      (let ((in (if (pair? o) (car o) (current-input-port))))
-        (let ((res (%read-string n in)))
-          (cond
-           ((if (pair? res) (= 0 (car res)) #t)
-            eof)
-           (else
-            (port-line-set! in (+ (string-count-chars #\newline (cadr res) 0)
-                                  (port-line in)))
-            (cadr res)))))))
+  (let ((in (if (pair? o) (car o) (current-input-port))))
+    (%read-chars (lambda (n) (%read-string n in)) n)))
 
 ;;> \procedure{(read-string! str n [in])}
 
@@ -159,42 +160,160 @@
 ;;> An error is signalled if the length of \var{str} is smaller
 ;;> than \var{n}.
 
-(cond-expand
- ((not string-streams)
-  (define (%read-string! str n in)
-    (let lp ((i 0))
-      (cond ((or (= i n) (eof-object? (peek-char in))) i)
-            (else (string-set! str i (read-char in)) (lp (+ i 1))))))))
-
 (define (read-string! str n . o)
   (if (> n (string-length str))
       (error "string to small to read chars" str n))
-  (let* ((in (if (pair? o) (car o) (current-input-port)))
-         (res (%read-string! str n in)))
-    (port-line-set! in (+ (string-count-chars #\newline str 0 n) (port-line in)))
-    res))
+  (let ((in (if (pair? o) (car o) (current-input-port))))
+    (%read-chars! (lambda (start) (%read-string! str start (- n start) in))
+                  0)))
+
+;;> \procedure{(read-bytevector n [in])}
 
-;;> Sends the entire contents of a file or input port to an output port.
+;;> Reads up to \var{n} bytes from the binary input port \var{in},
+;;> defaulting to \scheme{(current-input-port)}, returning them in
+;;> a new bytevector, or the eof-object if no bytes are available.
+
+(define (read-bytevector n . o)
+  (if (zero? n)
+      (make-bytevector 0)
+      (let* ((in (if (pair? o) (car o) (current-input-port)))
+             (res (make-bytevector n))
+             (len (read-bytevector! res in)))
+        (cond ((eof-object? len) len)
+              ((< len n) (subbytes res 0 len))
+              (else res)))))
+
+;;> \procedure{(read-bytevector! bv [in [start [end]]])}
+
+;;> Reads bytes from the binary input port \var{in} into \var{bv}
+;;> from \var{start} to \var{end}, returning the number of bytes
+;;> read, which is fewer than requested only at the end of file, or
+;;> the eof-object if no bytes are available.
+
+(define (read-bytevector! bv . o)
+  (let* ((in (if (pair? o) (car o) (current-input-port)))
+         (o (if (pair? o) (cdr o) o))
+         (start (if (pair? o) (car o) 0))
+         (end (if (and (pair? o) (pair? (cdr o)))
+                  (cadr o)
+                  (bytevector-length bv))))
+    (if (>= start end)
+        0
+        (let lp ((i start))
+          (let ((n (%read-bytevector! bv i end in)))
+            (cond
+             ((eof-object? n) (if (= i start) n (- i start)))
+             ((>= (+ i n) end) (- end start))
+             (else (lp (+ i n)))))))))
+
+;;> \procedure{(write-bytevector bv [out [start [end]]])}
+
+;;> Writes the bytes of \var{bv} from \var{start} to \var{end} to
+;;> the binary output port \var{out}, defaulting to
+;;> \scheme{(current-output-port)}.
+
+(define (write-bytevector bv . o)
+  (let* ((out (if (pair? o) (car o) (current-output-port)))
+         (o (if (pair? o) (cdr o) '()))
+         (start (if (pair? o) (car o) 0))
+         (o (if (pair? o) (cdr o) '()))
+         (end (if (pair? o) (car o) (bytevector-length bv))))
+    (%write-all bv start end out)))
+
+;;> \procedure{(write-output-string str-port [out])}
+;;>
+;;> Writes everything written so far to the output string or
+;;> bytevector port \var{str-port} to \var{out}, which defaults to
+;;> \scheme{(current-output-port)}, without building the string as
+;;> \scheme{get-output-string} would.
+
+(define (write-output-string str-port . o)
+  (let ((out (if (pair? o) (car o) (current-output-port))))
+    (if (eq? str-port out)
+        (error "can't write an output string port to itself" out))
+    (for-each (lambda (chunk) (%write-string (car chunk) (cdr chunk) out))
+              (%output-string-chunks str-port))))
+
+;;> \procedure{(send-file fd-port-or-filename [out [start [count]]])}
+;;>
+;;> Sends the contents of a file, file descriptor or input port to an
+;;> output port, defaulting to the current output port.  If \var{start}
+;;> is given sends from that byte offset, and if \var{count} is given
+;;> sends at most that many bytes.  When both ends are file
+;;> descriptors the data is sent by the OS (with \scheme{sendfile} where
+;;> available) without passing through Scheme, and without changing
+;;> the file position of the input, so a descriptor can be shared by
+;;> multiple threads sending the same file.  Raises an error if the
+;;> output fails, for instance when the peer closes a socket.
 
 (define (send-file fd-port-or-filename . o)
   (let* ((in (if (string? fd-port-or-filename)
                  (open-input-file fd-port-or-filename)
                  fd-port-or-filename))
          (out (if (pair? o) (car o) (current-output-port)))
-         (fd (if (port? in) (port-fileno in) in))
-         (sock (if (port? out) (port-fileno out) out)))
-    (define (copy-bytes)
-      (let ((b (read-u8 in)))
-        (cond ((not (eof-object? b))
-               (write-u8 b out)
-               (copy-bytes)))))
-    (if (and fd sock (is-a-socket? sock))
-        (let lp ((start 0))
-          (let ((res (%send-file fd sock start)))
-            (cond
-             ((not res) (copy-bytes))
-             ((not (zero? res)) (lp (+ start res))))))
-        (copy-bytes))))
+         (start (if (and (pair? o) (pair? (cdr o))) (cadr o) 0))
+         (count (and (pair? o) (pair? (cdr o)) (pair? (cddr o)) (car (cddr o))))
+         (fd (if (port? in) (port-fileno in) in)))
+    (define (copy-bytes count)
+      (if (not (and count (<= count 0)))
+          (let ((b (read-u8 in)))
+            (cond ((not (eof-object? b))
+                   (write-u8 b out)
+                   (copy-bytes (and count (- count 1))))))))
+    (if (port? out)
+        (flush-output out))
+    (let lp ((start start) (count count))
+      (cond
+       ((and count (<= count 0)))
+       (else
+        (let ((res (and fd (%send-file fd out start (or count 0)))))
+          (cond
+           ((not res)
+            (if (positive? start)
+                (set-file-position! in start seek/set))
+            (copy-bytes count))
+           ((positive? res)
+            (lp (+ start res) (and count (- count res)))))))))
+    (if (string? fd-port-or-filename)
+        (close-input-port in))))
+
+;;> \procedure{(open-mmap-input-port filename)}
+;;>
+;;> Opens \var{filename} for input like \scheme{open-input-file},
+;;> but if it's a regular file maps it into memory and uses the
+;;> mapping directly as the port buffer, so that reading even very
+;;> large files needs no further system calls or copying.  The file
+;;> shouldn't be truncated while the port is open.  Files which can't
+;;> be mapped are opened normally.
+
+(define (open-mmap-input-port filename)
+  (or (%open-mmap-input-port filename)
+      (open-input-file filename)))
+
+;;> \procedure{(call-with-mmap-input-file filename proc)}
+;;>
+;;> Calls \var{proc} with an input port open on \var{filename} as by
+;;> \scheme{open-mmap-input-port}, closing the port and returning the
+;;> result when \var{proc} returns.
+
+(define (call-with-mmap-input-file filename proc)
+  (let* ((in (open-mmap-input-port filename))
+         (res (proc in)))
+    (close-input-port in)
+    res))
+
+;;> \procedure{(input-port-wait in timeout)}
+;;>
+;;> Waits up to \var{timeout} seconds for input to be available on
+;;> the port \var{in}, returning \scheme{#t} if a read won't block
+;;> and \scheme{#f} if the timeout expired first.  Other threads
+;;> keep running while we wait.
+
+(define (input-port-wait in timeout)
+  (or (%input-port-wait in timeout)
+      (begin
+        (yield!)
+        (%input-port-wait in #f))))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; higher order port operations
@@ -0,0 +1,432 @@
+/*  prime.c -- native modular arithmetic                      */
+/*  Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/*  BSD-style license: http://synthcode.com/license.txt       */
+
+#include <chibi/eval.h>
+
+/* Modular exponentiation is done in Montgomery form on digit */
+/* buffers allocated once per call, so the inner loop never touches */
+/* the heap.  Anything outside the supported domain (non-integers, */
+/* even moduli, negative exponents, non-invertible arguments) */
+/* returns #f and is left to the Scheme definitions. */
+
+#if SEXP_USE_BIGNUMS
+
+#define SEXP_DIGIT_BITS (sizeof(sexp_uint_t)*8)
+
+#define sexp_exact_integerp(x) (sexp_fixnump(x) || sexp_bignump(x))
+
+/* copies |x| into the n digit buffer r, which must be large enough */
+static void sexp_prime_digits (sexp_uint_t *r, sexp x, sexp_uint_t n) {
+  sexp_sint_t v;
+  memset(r, 0, n*sizeof(sexp_uint_t));
+  if (sexp_fixnump(x)) {
+    v = sexp_unbox_fixnum(x);
+    r[0] = (sexp_uint_t)(v < 0 ? -v : v);
+  } else {
+    memcpy(r, sexp_bignum_data(x), sexp_bignum_hi(x)*sizeof(sexp_uint_t));
+  }
+}
+
+static sexp_uint_t sexp_prime_length (sexp x) {
+  return sexp_fixnump(x) ? 1 : sexp_bignum_hi(x);
+}
+
+static int sexp_prime_negativep (sexp x) {
+  return sexp_fixnump(x) ? sexp_unbox_fixnum(x) < 0 : sexp_bignum_sign(x) < 0;
+}
+
+static sexp sexp_prime_result (sexp ctx, sexp_uint_t *r, sexp_uint_t n, int neg) {
+  sexp res = sexp_make_bignum(ctx, n);
+  if (sexp_exceptionp(res)) return res;
+  memcpy(sexp_bignum_data(res), r, n*sizeof(sexp_uint_t));
+  if (neg) sexp_bignum_sign(res) = -1;
+  return sexp_bignum_normalize(res);
+}
+
+static int sexp_digits_cmp (const sexp_uint_t *a, const sexp_uint_t *b,
+                            sexp_uint_t n) {
+  while (n-- > 0)
+    if (a[n] != b[n])
+      return a[n] < b[n] ? -1 : 1;
+  return 0;
+}
+
+static sexp_uint_t sexp_digits_sub (sexp_uint_t *r, const sexp_uint_t *a,
+                                    const sexp_uint_t *b, sexp_uint_t n) {
+  sexp_uint_t i, x, y, borrow=0;
+  for (i=0; i<n; i++) {
+    x = a[i];
+    y = b[i];
+    r[i] = x - y - borrow;
+    borrow = (x < y) | ((x - y) < borrow);
+  }
+  return borrow;
+}
+
+static sexp_uint_t sexp_digits_add (sexp_uint_t *r, const sexp_uint_t *a,
+                                    const sexp_uint_t *b, sexp_uint_t n) {
+  sexp_uint_t i, x, carry=0;
+  for (i=0; i<n; i++) {
+    x = a[i] + carry;
+    carry = (x < carry);
+    r[i] = x + b[i];
+    carry |= (r[i] < x);
+  }
+  return carry;
+}
+
+static int sexp_digits_zerop (const sexp_uint_t *a, sexp_uint_t n) {
+  while (n-- > 0)
+    if (a[n]) return 0;
+  return 1;
+}
+
+/**************************** Montgomery form ****************************/
+
+/* -m^-1 mod 2^w for odd m, by Newton iteration */
+static sexp_uint_t sexp_montgomery_inverse (sexp_uint_t m0) {
+  sexp_uint_t x = m0;           /* correct to 3 bits */
+  int i;
+  for (i=3; i<(int)SEXP_DIGIT_BITS; i*=2)
+    x *= 2 - m0*x;
+  return -x;
+}
+
+/* reduces the 2n+1 digit t in place, leaving t*R^-1 mod m in r */
+static void sexp_montgomery_redc (sexp_uint_t *r, sexp_uint_t *t,
+                                  const sexp_uint_t *m, sexp_uint_t n,
+                                  sexp_uint_t minv) {
+  sexp_uint_t i, j, k, q, carry;
+  sexp_luint_t p;
+  for (i=0; i<n; i++) {
+    q = t[i] * minv;
+    carry = 0;
+    for (j=0; j<n; j++) {
+      p = (sexp_luint_t)q*m[j] + t[i+j] + carry;
+      t[i+j] = (sexp_uint_t)p;
+      carry = (sexp_uint_t)(p >> SEXP_DIGIT_BITS);
+    }
+    for (k=i+n; carry; k++) {
+      t[k] += carry;
+      carry = (t[k] < carry);
+    }
+  }
+  if (t[2*n] || sexp_digits_cmp(t+n, m, n) >= 0)
+    sexp_digits_sub(r, t+n, m, n);
+  else
+    memcpy(r, t+n, n*sizeof(sexp_uint_t));
+}
+
+/* r = a*b*R^-1 mod m, t is scratch of 2n+1 digits, r may alias a or b */
+static void sexp_montgomery_mul (sexp_uint_t *r, const sexp_uint_t *a,
+                                 const sexp_uint_t *b, const sexp_uint_t *m,
+                                 sexp_uint_t n, sexp_uint_t minv,
+                                 sexp_uint_t *t) {
+  sexp_uint_t i, j, carry;
+  sexp_luint_t p;
+  memset(t, 0, (2*n+1)*sizeof(sexp_uint_t));
+  for (i=0; i<n; i++) {
+    carry = 0;
+    for (j=0; j<n; j++) {
+      p = (sexp_luint_t)a[i]*b[j] + t[i+j] + carry;
+      t[i+j] = (sexp_uint_t)p;
+      carry = (sexp_uint_t)(p >> SEXP_DIGIT_BITS);
+    }
+    t[i+n] = carry;
+  }
+  sexp_montgomery_redc(r, t, m, n, minv);
+}
+
+/* r = a*a*R^-1 mod m, computing each cross product once */
+static void sexp_montgomery_sqr (sexp_uint_t *r, const sexp_uint_t *a,
+                                 const sexp_uint_t *m, sexp_uint_t n,
+                                 sexp_uint_t minv, sexp_uint_t *t) {
+  sexp_uint_t i, j, carry, hi;
+  sexp_luint_t p;
+  memset(t, 0, (2*n+1)*sizeof(sexp_uint_t));
+  for (i=0; i<n; i++) {
+    carry = 0;
+    for (j=i+1; j<n; j++) {
+      p = (sexp_luint_t)a[i]*a[j] + t[i+j] + carry;
+      t[i+j] = (sexp_uint_t)p;
+      carry = (sexp_uint_t)(p >> SEXP_DIGIT_BITS);
+    }
+    t[i+n] = carry;
+  }
+  for (i=0, hi=0; i<2*n; i++) {
+    carry = t[i] >> (SEXP_DIGIT_BITS-1);
+    t[i] = (t[i] << 1) | hi;
+    hi = carry;
+  }
+  t[2*n] = hi;
+  for (i=0, carry=0; i<n; i++) {
+    p = (sexp_luint_t)a[i]*a[i] + t[2*i] + carry;
+    t[2*i] = (sexp_uint_t)p;
+    p = (p >> SEXP_DIGIT_BITS) + t[2*i+1];
+    t[2*i+1] = (sexp_uint_t)p;
+    carry = (sexp_uint_t)(p >> SEXP_DIGIT_BITS);
+  }
+  t[2*n] += carry;
+  sexp_montgomery_redc(r, t, m, n, minv);
+}
+
+/* r = 2^bits mod m by doubling, for r < m on entry */
+static void sexp_montgomery_double (sexp_uint_t *r, const sexp_uint_t *m,
+                                    sexp_uint_t n, sexp_uint_t bits) {
+  sexp_uint_t top;
+  while (bits-- > 0) {
+    top = sexp_digits_add(r, r, r, n);
+    if (top || sexp_digits_cmp(r, m, n) >= 0)
+      sexp_digits_sub(r, r, m, n);
+  }
+}
+
+/************************* modular exponentiation *************************/
+
+static int sexp_modular_window (sexp_uint_t bits) {
+  return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3
+    : bits > 7 ? 2 : 1;
+}
+
+static int sexp_exponent_bit (sexp e, sexp_uint_t i) {
+  if (sexp_fixnump(e))
+    return i < SEXP_DIGIT_BITS ? (sexp_unbox_fixnum(e) >> i) & 1 : 0;
+  return (sexp_bignum_data(e)[i/SEXP_DIGIT_BITS] >> (i%SEXP_DIGIT_BITS)) & 1;
+}
+
+static sexp_uint_t sexp_exponent_bits (sexp e) {
+  sexp_uint_t hi, d;
+  if (sexp_fixnump(e)) {
+    d = sexp_unbox_fixnum(e);
+    hi = 0;
+  } else {
+    hi = sexp_bignum_hi(e) - 1;
+    d = sexp_bignum_data(e)[hi];
+  }
+  hi *= SEXP_DIGIT_BITS;
+  while (d) {
+    hi++;
+    d >>= 1;
+  }
+  return hi;
+}
+
+sexp sexp_modular_expt (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp e, sexp m) {
+  sexp_uint_t len, ebits, minv, *buf, *md, *x, *sq, *t, *g, i, j, wval;
+  int k, neg, started=0;
+  sexp res;
+  sexp_gc_var1(r);
+  if (!sexp_exact_integerp(a) || !sexp_exact_integerp(e)
+      || !sexp_exact_integerp(m) || sexp_prime_negativep(e))
+    return SEXP_FALSE;
+  if (sexp_fixnump(m) ? !(sexp_unbox_fixnum(m) & 1)
+      || sexp_unbox_fixnum(m) == 1 || sexp_unbox_fixnum(m) == -1
+      : !(sexp_bignum_data(m)[0] & 1))
+    return SEXP_FALSE;
+  neg = sexp_prime_negativep(a) && sexp_exponent_bit(e, 0);
+  len = sexp_prime_length(m);
+  sexp_gc_preserve1(ctx, r);
+  r = a;
+  if (sexp_prime_length(a) > len) {
+    r = sexp_remainder(ctx, a, m);
+    if (sexp_exceptionp(r)) {
+      sexp_gc_release1(ctx);
+      return r;
+    }
+  }
+  ebits = sexp_exponent_bits(e);
+  k = sexp_modular_window(ebits);
+  /* m, x, a^2, 2n+1 digits of scratch and 2^(k-1) odd powers of a */
+  buf = (sexp_uint_t*) sexp_malloc(((5 + ((sexp_uint_t)1<<(k-1)))*len + 1)
+                                   * sizeof(sexp_uint_t));
+  if (!buf) {
+    sexp_gc_release1(ctx);
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  }
+  md = buf;
+  x = md + len;
+  sq = x + len;
+  t = sq + len;
+  g = t + 2*len + 1;
+  sexp_prime_digits(md, m, len);
+  minv = sexp_montgomery_inverse(md[0]);
+  /* x = R mod m, the Montgomery form of 1, and R^2 mod m in sq */
+  memset(x, 0, len*sizeof(sexp_uint_t));
+  x[0] = 1;
+  sexp_montgomery_double(x, md, len, len*SEXP_DIGIT_BITS);
+  memcpy(sq, x, len*sizeof(sexp_uint_t));
+  sexp_montgomery_double(sq, md, len, len*SEXP_DIGIT_BITS);
+  /* g[i] = a^(2i+1)*R mod m */
+  sexp_prime_digits(g, r, len);
+  sexp_montgomery_mul(g, g, sq, md, len, minv, t);
+  sexp_montgomery_sqr(sq, g, md, len, minv, t);
+  for (i=1; i<((sexp_uint_t)1<<(k-1)); i++)
+    sexp_montgomery_mul(g+i*len, g+(i-1)*len, sq, md, len, minv, t);
+  /* left-to-right sliding window */
+  for (i=ebits; i-- > 0; ) {
+    if (!sexp_exponent_bit(e, i)) {
+      sexp_montgomery_sqr(x, x, md, len, minv, t);
+      continue;
+    }
+    j = (i+1 >= (sexp_uint_t)k) ? i+1-k : 0;
+    while (!sexp_exponent_bit(e, j))
+      j++;
+    for (wval=0; ; i--) {
+      if (started)
+        sexp_montgomery_sqr(x, x, md, len, minv, t);
+      wval = (wval << 1) | sexp_exponent_bit(e, i);
+      if (i == j) break;
+    }
+    if (started) {
+      sexp_montgomery_mul(x, x, g+(wval>>1)*len, md, len, minv, t);
+    } else {
+      memcpy(x, g+(wval>>1)*len, len*sizeof(sexp_uint_t));
+      started = 1;
+    }
+  }
+  /* out of Montgomery form */
+  memset(t, 0, (2*len+1)*sizeof(sexp_uint_t));
+  memcpy(t, x, len*sizeof(sexp_uint_t));
+  sexp_montgomery_redc(x, t, md, len, minv);
+  res = sexp_prime_result(ctx, x, len, neg && !sexp_digits_zerop(x, len));
+  sexp_free(buf);
+  sexp_gc_release1(ctx);
+  return res;
+}
+
+/*************************** modular inverse ***************************/
+
+/* The binary extended gcd needs only shifts, additions and */
+/* subtractions, so it runs in place.  The cofactors may go negative */
+/* and are kept in two's complement with a spare high digit. */
+
+static void sexp_digits_half (sexp_uint_t *r, sexp_uint_t n, int sign) {
+  sexp_uint_t i, hi = (sign && (r[n-1] >> (SEXP_DIGIT_BITS-1))) ? 1 : 0;
+  for (i=n; i-- > 0; ) {
+    sexp_uint_t lo = r[i] & 1;
+    r[i] = (r[i] >> 1) | (hi << (SEXP_DIGIT_BITS-1));
+    hi = lo;
+  }
+}
+
+/* r += b or r -= b for the n digit b zero-extended to w digits */
+static void sexp_digits_add_wide (sexp_uint_t *r, sexp_uint_t w,
+                                  const sexp_uint_t *b, sexp_uint_t n,
+                                  int sub) {
+  sexp_uint_t i, c = sub ? sexp_digits_sub(r, r, b, n)
+    : sexp_digits_add(r, r, b, n);
+  for (i=n; i<w && c; i++) {
+    if (sub) {
+      c = (r[i] == 0);
+      r[i]--;
+    } else {
+      r[i]++;
+      c = (r[i] == 0);
+    }
+  }
+}
+
+#define sexp_twos_negativep(r, w) ((r)[(w)-1] >> (SEXP_DIGIT_BITS-1))
+
+sexp sexp_modular_inverse (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp m) {
+  sexp_uint_t len, w, *buf, *u, *v, *x, *y, *A, *B, *C, *D;
+  sexp res;
+  sexp_gc_var1(r);
+  if (!sexp_exact_integerp(a) || !sexp_exact_integerp(m)
+      || sexp_prime_negativep(m)
+      || (sexp_fixnump(m) && sexp_unbox_fixnum(m) <= 1))
+    return SEXP_FALSE;
+  len = sexp_prime_length(m);
+  w = len + 1;
+  sexp_gc_preserve1(ctx, r);
+  r = a;
+  if (sexp_prime_negativep(a) || sexp_prime_length(a) > len) {
+    r = sexp_remainder(ctx, a, m);
+    if (!sexp_exceptionp(r) && sexp_prime_negativep(r))
+      r = sexp_add(ctx, r, m);
+    if (sexp_exceptionp(r)) {
+      sexp_gc_release1(ctx);
+      return r;
+    }
+  }
+  buf = (sexp_uint_t*) sexp_malloc((4*len + 4*w) * sizeof(sexp_uint_t));
+  if (!buf) {
+    sexp_gc_release1(ctx);
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  }
+  u = buf; v = u + len; x = v + len; y = x + len;
+  A = y + len; B = A + w; C = B + w; D = C + w;
+  sexp_prime_digits(x, r, len);
+  sexp_prime_digits(y, m, len);
+  res = SEXP_FALSE;
+  if (sexp_digits_zerop(x, len) || !((x[0] | y[0]) & 1))
+    goto done;
+  memcpy(u, x, len*sizeof(sexp_uint_t));
+  memcpy(v, y, len*sizeof(sexp_uint_t));
+  memset(A, 0, 4*w*sizeof(sexp_uint_t));
+  A[0] = D[0] = 1;
+  /* invariants: A*x + B*y = u, C*x + D*y = v */
+  while (!sexp_digits_zerop(u, len)) {
+    while (!(u[0] & 1)) {
+      sexp_digits_half(u, len, 0);
+      if ((A[0] | B[0]) & 1) {
+        sexp_digits_add_wide(A, w, y, len, 0);
+        sexp_digits_add_wide(B, w, x, len, 1);
+      }
+      sexp_digits_half(A, w, 1);
+      sexp_digits_half(B, w, 1);
+    }
+    while (!(v[0] & 1)) {
+      sexp_digits_half(v, len, 0);
+      if ((C[0] | D[0]) & 1) {
+        sexp_digits_add_wide(C, w, y, len, 0);
+        sexp_digits_add_wide(D, w, x, len, 1);
+      }
+      sexp_digits_half(C, w, 1);
+      sexp_digits_half(D, w, 1);
+    }
+    if (sexp_digits_cmp(u, v, len) >= 0) {
+      sexp_digits_sub(u, u, v, len);
+      sexp_digits_sub(A, A, C, w);
+      sexp_digits_sub(B, B, D, w);
+    } else {
+      sexp_digits_sub(v, v, u, len);
+      sexp_digits_sub(C, C, A, w);
+      sexp_digits_sub(D, D, B, w);
+    }
+  }
+  /* v is the gcd, and C the inverse of x if it's 1 */
+  if (v[0] != 1 || !sexp_digits_zerop(v+1, len-1))
+    goto done;
+  while (sexp_twos_negativep(C, w))
+    sexp_digits_add_wide(C, w, y, len, 0);
+  while (C[len] || sexp_digits_cmp(C, y, len) >= 0)
+    sexp_digits_add_wide(C, w, y, len, 1);
+  res = sexp_prime_result(ctx, C, len, 0);
+ done:
+  sexp_free(buf);
+  sexp_gc_release1(ctx);
+  return res;
+}
+
+#else
+
+sexp sexp_modular_expt (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp e, sexp m) {
+  return SEXP_FALSE;
+}
+
+sexp sexp_modular_inverse (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp m) {
+  return SEXP_FALSE;
+}
+
+#endif
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  sexp_define_foreign(ctx, env, "%modular-expt", 3, sexp_modular_expt);
+  sexp_define_foreign(ctx, env, "%modular-inverse", 2, sexp_modular_inverse);
+  return SEXP_VOID;
+}
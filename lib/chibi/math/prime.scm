@@ -11,24 +11,30 @@
        (r n (arithmetic-shift r -1)))
       ((odd? r) (cons p r))))
 
+;; The native %modular-inverse and %modular-expt work in place on
+;; digit buffers, and return #f for anything they don't handle, which
+;; includes even moduli for %modular-expt.
+
 ;;> Returns the multiplicative inverse of \var{a} modulo \var{b}.
 (define (modular-inverse a b)
-  (let lp ((a1 a) (b1 b) (x 0) (y 1) (last-x 1) (last-y 0))
-    (if (zero? b1)
-        (if (negative? last-x) (+ last-x b) last-x)
-        (let ((q (quotient a1 b1)))
-          (lp b1 (remainder a1 b1)
-              (- last-x (* q x)) (- last-y (* q y))
-              x y)))))
+  (or (%modular-inverse a b)
+      (let lp ((a1 a) (b1 b) (x 0) (y 1) (last-x 1) (last-y 0))
+        (if (zero? b1)
+            (if (negative? last-x) (+ last-x b) last-x)
+            (let ((q (quotient a1 b1)))
+              (lp b1 (remainder a1 b1)
+                  (- last-x (* q x)) (- last-y (* q y))
+                  x y))))))
 
 ;;> Returns (remainder (expt a e) m).
 (define (modular-expt a e m)
-  (let lp ((tmp a) (e e) (res 1))
-    (if (zero? e)
-        res
-        (lp (remainder (* tmp tmp) m)
-            (arithmetic-shift e -1)
-            (if (odd? e) (remainder (* res tmp) m) res)))))
+  (or (%modular-expt a e m)
+      (let lp ((tmp a) (e e) (res 1))
+        (if (zero? e)
+            res
+            (lp (remainder (* tmp tmp) m)
+                (arithmetic-shift e -1)
+                (if (odd? e) (remainder (* res tmp) m) res))))))
 
 ;;> Returns true iff n and m are coprime.
 (define (coprime? n m)
@@ -69,6 +69,7 @@
 ;;> \item{init-size: a hint for the initial size of the backing hash table}
 ;;> \item{size-limit: the maximum size of the cache}
 ;;> \item{compute-size: compute the size of a cache entry}
+;;> \item{weak: if true, only keep results while their arguments are live}
 ;;> ]
 ;;>
 ;;> \var{compute-size} is a procedure of two arguments, the key and
@@ -83,6 +84,14 @@
 ;;>
 ;;> If \var{size-limit} is \scheme{#f} then the cache is unlimited,
 ;;> and a simple hash-table will be used in place of an LRU cache.
+;;>
+;;> If \var{weak} is true then the cache is a hash-table with
+;;> ephemeral keys, and an entry is dropped by the next garbage
+;;> collection once nothing else references its argument.  Entries
+;;> for immediate arguments such as fixnums and characters are never
+;;> dropped, so this doesn't bound the size of the cache.  For
+;;> procedures of more than one argument the key is a new list on
+;;> each call, so results are only kept until the next collection.
 
 (define (memoize proc . o)
   (let-keywords* o
@@ -93,9 +102,12 @@
        (init-size init-size: 31)
        (limit size-limit: 1000)
        (compute-size compute-size: (lambda (k v) 1))
+       (weak weak: #f)
        (cache-init cache: '()))
     (let ((cache (cond ((lru-cache? cache-init)
                         cache-init)
+                       (weak
+                        (make-hash-table equal hash 'ephemeral-keys))
                        (limit
                         (make-lru-cache 'equal: equal
                                         'hash: hash
@@ -73,16 +73,20 @@
           (close-file-descriptor (car io))
           res))))
 
-;;> \procedure{(make-listener-socket addrinfo [max-conn])}
+;;> \procedure{(make-listener-socket addrinfo [max-conn [reuse-port?]])}
 
 ;;> Convenience wrapper to call socket, bind and listen to return
 ;;> a socket suitable for accepting connections on the given
 ;;> \var{addrinfo}.  \var{max-conn} is the maximum number of pending
 ;;> connections, and defaults to 128.  Automatically specifies
-;;> \scheme{socket-opt/reuseaddr}.
+;;> \scheme{socket-opt/reuseaddr}.  If \var{reuse-port?} is true
+;;> also specifies \scheme{socket-opt/reuseport}, so that several
+;;> processes can each listen on the same port with the kernel
+;;> balancing connections between them.
 
 (define (make-listener-socket addrinfo . o)
   (let* ((max-connections (if (pair? o) (car o) 128))
+         (reuse-port? (and (pair? o) (pair? (cdr o)) (cadr o)))
          (sock (socket (address-info-family addrinfo)
                        (address-info-socket-type addrinfo)
                        (address-info-protocol addrinfo))))
@@ -91,6 +95,12 @@
       (error "couldn't create socket for: " addrinfo))
      ((not (set-socket-option! sock level/socket socket-opt/reuseaddr 1))
       (error "couldn't set the socket to be reusable" addrinfo))
+     ((and reuse-port?
+           (not (and (>= socket-opt/reuseport 0)
+                     (set-socket-option! sock level/socket
+                                         socket-opt/reuseport 1))))
+      (close-file-descriptor sock)
+      (error "couldn't set the socket port to be reusable" addrinfo))
      ((not (bind sock
                  (address-info-address addrinfo)
                  (address-info-address-length addrinfo)))
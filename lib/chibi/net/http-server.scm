@@ -22,28 +22,259 @@
 ;;>      (set! count (+ 1 count))
 ;;>      (servlet-write request (sxml->xml `(html (body (p ,count))))))))
 ;;> }
+;;>
+;;> HTTP/1.1 connections are kept open for further (possibly
+;;> pipelined) requests, for up to the config's \scheme{keep-alive-timeout}
+;;> seconds of idle time (default 5) and \scheme{keep-alive-max-requests}
+;;> requests (default 100).  Responses without a Content-Length are
+;;> sent with chunked encoding to make this possible, so servlets
+;;> needn't do anything special.  Requests with a body, and anything
+;;> other than HTTP/1.1, still close the connection after the response.
 
 (define (run-http-server listener-or-addr servlet . o)
-  (let ((cfg (if (pair? o) (car o) (make-conf '() #f #f #f))))
+  (let* ((cfg (if (pair? o) (car o) (make-conf '() #f #f #f)))
+         (timeout (conf-get cfg 'keep-alive-timeout
+                            default-keep-alive-timeout))
+         (max-requests (conf-get cfg 'keep-alive-max-requests
+                                 default-keep-alive-max-requests)))
     (run-net-server
      listener-or-addr
-     (command-handler
-      (lambda (command ls in out sock addr)
+     (lambda (in out sock addr)
+       (let ((framer (make-http-framer out)))
+         (let lp ((count 1))
+           (let ((line (read-line in)))
+             (cond
+              ((eof-object? line))
+              ((and (http-handle-request
+                     cfg servlet line in out sock addr
+                     (and timeout (< count max-requests) framer))
+                    (input-port-wait in timeout))
+               (lp (+ count 1))))))
+         (http-framer-close framer))))))
+
+;; Handles a single request line, returning true if the connection
+;; can be used for another request.  If framer is false the response
+;; goes straight to the connection, which is closed afterwards.
+(define (http-handle-request cfg servlet line in out sock addr framer)
+  (if (equal? line "")
+      ;; tolerate a blank line between requests
+      (and framer #t)
+      (http-handle-request-line cfg servlet line in out sock addr framer)))
+
+(define (http-handle-request-line cfg servlet line in out sock addr framer)
+  (let* ((ls (parse-command line))
+         (command (car ls))
+         (ls (cdr ls)))
+    (cond
+     ((= 2 (length ls))
+      (let* ((request
+              (make-request command (car ls) (cadr ls) in out sock addr))
+             (framer (and framer (http-keep-alive-request? request) framer)))
         (cond
-         ((= 2 (length ls))
-          (let ((request
-                 (make-request command (car ls) (cadr ls) in out sock addr)))
-            (log-info `(request: ,command ,(car ls) ,(cadr ls)
-                                 ,(request-headers request)))
-            (protect (exn
-                      (else
-                       (log-error "internal error: " exn)
-                       (servlet-respond request 500 "Internal server error")))
-              (let restart ((request request))
-                (servlet cfg request servlet-bad-request restart)))))
-         (else
-          (let ((request (make-request command #f #f in out sock addr)))
-            (servlet-respond request 400 "bad request")))))))))
+         (framer
+          (http-framer-reset! framer command)
+          (request-out-set! request (http-framer-port framer))))
+        (log-info `(request: ,command ,(car ls) ,(cadr ls)
+                             ,(request-headers request)))
+        (protect (exn
+                  (else
+                   (log-error "internal error: " exn)
+                   (if framer (http-framer-close?-set! framer #t))
+                   (servlet-respond request 500 "Internal server error")))
+          (parameterize ((current-http-connection
+                          (and framer (cons (http-framer-port framer) out))))
+            (let restart ((request request))
+              (servlet cfg request servlet-bad-request restart))))
+        (and framer (http-framer-finish! framer))))
+     (else
+      (let ((request (make-request command #f #f in out sock addr)))
+        (servlet-respond request 400 "bad request")
+        #f)))))
+
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; Persistent connections.
+
+(define default-keep-alive-timeout 5)
+(define default-keep-alive-max-requests 100)
+
+;; We only keep the connection open if we know where the request
+;; ends, which we don't if the servlet may or may not have read a
+;; body.
+(define (http-keep-alive-request? request)
+  (let ((headers (request-headers request)))
+    (and (equal? "HTTP/1.1" (request-version request))
+         (not (cond ((assq 'connection headers)
+                     => (lambda (x)
+                          (string-contains (string-downcase-ascii (cdr x))
+                                           "close")))
+                    (else #f)))
+         (not (assq 'transfer-encoding headers))
+         (cond ((assq 'content-length headers)
+                => (lambda (x) (eqv? 0 (string->number (string-trim (cdr x))))))
+               (else #t)))))
+
+;; Servlets just write a status line, headers and body to the request
+;; output port, traditionally ending the body by closing the
+;; connection.  A framer is a binary port in front of the connection
+;; which reads the response headers as they're written, and if there's
+;; no Content-Length or Transfer-Encoding adds a chunked encoding
+;; header and encodes the body.  It's reset and reused for each
+;; response on the connection.
+
+(define-record-type Http-Framer
+  (%make-http-framer out port state head method close? finishing?)
+  http-framer?
+  (out http-framer-out)
+  (port http-framer-port http-framer-port-set!)
+  ;; one of headers, raw, chunked or discard
+  (state http-framer-state http-framer-state-set!)
+  (head http-framer-head http-framer-head-set!)
+  (method http-framer-method http-framer-method-set!)
+  (close? http-framer-close? http-framer-close?-set!)
+  (finishing? http-framer-finishing? http-framer-finishing?-set!))
+
+(define (make-http-framer out)
+  (%make-http-framer out #f 'headers (make-bytevector 0) 'GET #f #f))
+
+(define (http-framer-reset! framer method)
+  (if (not (http-framer-port framer))
+      (http-framer-port-set!
+       framer
+       (make-custom-binary-output-port
+        (lambda (bv start end)
+          (http-framer-write!
+           framer
+           (if (and (zero? start) (= end (bytevector-length bv)))
+               bv
+               (subbytes bv start end)))
+          (- end start)))))
+  (http-framer-state-set! framer 'headers)
+  (http-framer-head-set! framer (make-bytevector 0))
+  (http-framer-method-set! framer method)
+  (http-framer-close?-set! framer #f)
+  (http-framer-finishing?-set! framer #f))
+
+(define (bytevector-search-crlfcrlf bv . o)
+  (let ((end (- (bytevector-length bv) 3)))
+    (let lp ((i (if (pair? o) (car o) 0)))
+      (cond
+       ((>= i end) #f)
+       ((and (eqv? 13 (bytevector-u8-ref bv i))
+             (eqv? 10 (bytevector-u8-ref bv (+ i 1)))
+             (eqv? 13 (bytevector-u8-ref bv (+ i 2)))
+             (eqv? 10 (bytevector-u8-ref bv (+ i 3))))
+        i)
+       (else (lp (+ i 1)))))))
+
+(define (http-framer-write-raw! framer x)
+  (let ((out (http-framer-out framer)))
+    (if (string? x)
+        (%write-string x (string-size x) out)
+        (%write-string x (bytevector-length x) out))))
+
+(define (http-framer-write! framer bv)
+  (define headers? (eq? 'headers (http-framer-state framer)))
+  (case (http-framer-state framer)
+    ((headers)
+     ;; the body may be binary, so only the headers are decoded
+     (let* ((prev (http-framer-head framer))
+            (head (if (zero? (bytevector-length prev))
+                      bv
+                      (bytevector-append prev bv)))
+            (end (bytevector-search-crlfcrlf
+                  head (max 0 (- (bytevector-length prev) 3)))))
+       (cond
+        (end
+         (http-framer-head-set! framer (make-bytevector 0))
+         (http-framer-start-body! framer (utf8->string (subbytes head 0 (+ end 2))))
+         (if (< (+ end 4) (bytevector-length head))
+             (http-framer-write!
+              framer
+              (subbytes head (+ end 4) (bytevector-length head)))))
+        (else
+         (http-framer-head-set! framer head)))))
+    ((raw)
+     (http-framer-write-raw! framer bv))
+    ((chunked)
+     (let ((len (bytevector-length bv)))
+       (cond
+        ((positive? len)
+         (http-framer-write-raw! framer (number->string len 16))
+         (http-framer-write-raw! framer "\r\n")
+         (http-framer-write-raw! framer bv)
+         (http-framer-write-raw! framer "\r\n")))))
+    (else
+     ;; discard: HEAD requests and responses which can't have a body
+     #f))
+  ;; Pass on flushes of the body so streaming works, but hold the
+  ;; headers back to go out in the same packet as the body.
+  (if (not (or headers? (http-framer-finishing? framer)))
+      (flush-output (http-framer-out framer))))
+
+;; Decides how to frame the body from the status line and headers,
+;; which end with a single CRLF, and writes them out.
+(define (http-framer-start-body! framer head)
+  (let* ((lower (string-downcase-ascii head))
+         (status (and (string-prefix? "http/1.1 " lower)
+                      (> (string-length head) 12)
+                      (string->number (substring head 9 12))))
+         (has-header? (lambda (name)
+                        (string-contains lower
+                                         (string-append "\r\n" name ":")))))
+    (cond
+     ((or (not status)
+          (http-framer-close? framer)
+          (<= 100 status 199)
+          (string-contains lower "\r\nconnection: close"))
+      (http-framer-close?-set! framer #t)
+      (http-framer-state-set! framer 'raw)
+      (http-framer-write-raw! framer head))
+     ((or (eq? 'HEAD (http-framer-method framer))
+          (memv status '(204 304)))
+      (http-framer-state-set! framer 'discard)
+      (http-framer-write-raw! framer head))
+     ((or (has-header? "content-length") (has-header? "transfer-encoding"))
+      (http-framer-state-set! framer 'raw)
+      (http-framer-write-raw! framer head))
+     (else
+      (http-framer-state-set! framer 'chunked)
+      (http-framer-write-raw! framer head)
+      (http-framer-write-raw! framer "Transfer-Encoding: chunked\r\n")))
+    (http-framer-write-raw! framer "\r\n")))
+
+;; Ends the current response, returning true if the connection can be
+;; reused.  Responses which errored or didn't finish their headers are
+;; left unterminated and the connection closed, so the client knows
+;; the response is incomplete.
+(define (http-framer-finish! framer)
+  (http-framer-finishing?-set! framer #t)
+  (flush-output (http-framer-port framer))
+  (case (http-framer-state framer)
+    ((headers)
+     (http-framer-close?-set! framer #t)
+     (http-framer-write-raw! framer (http-framer-head framer)))
+    ((chunked)
+     (if (not (http-framer-close? framer))
+         (http-framer-write-raw! framer "0\r\n\r\n"))))
+  (flush-output (http-framer-out framer))
+  (not (http-framer-close? framer)))
+
+(define (http-framer-close framer)
+  (if (http-framer-port framer)
+      (close-output-port (http-framer-port framer))))
+
+;; The framer's port and the underlying connection port for the
+;; response in progress, if it's being framed.
+(define current-http-connection (make-parameter #f))
+
+;; The port to write the body of the request's response to.  Once a
+;; servlet has sent a Content-Length the framer passes the body through
+;; unchanged, so it can go straight to the connection.
+(define (http-request-body-output request)
+  (let ((conn (current-http-connection)))
+    (if (and conn (eq? (car conn) (request-out request)))
+        (cdr conn)
+        (request-out request))))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; Servlets.
@@ -74,6 +305,112 @@
     (servlet-parse-body! request2)
     (next cfg request2)))
 
+;;> A servlet which gzips the responses of the servlets after it in a
+;;> chain for clients which accept it, in-process at the config's
+;;> \scheme{gzip-level} (default 6).  Only 200 responses with a text
+;;> or text-like Content-Type (or none), and no Content-Encoding of
+;;> their own, are compressed.  The compressor buffers the body, so
+;;> servlets which stream partial output shouldn't be wrapped.
+
+(define (http-gzip-servlet cfg request next restart)
+  (cond
+   ((and (not (eq? 'HEAD (request-method request)))
+         (http-accepts-gzip? request))
+    (let* ((out (request-out request))
+           (gz-out (make-http-gzip-port out (conf-get cfg 'gzip-level 6)))
+           (request2 (copy-request request)))
+      (request-out-set! request2 gz-out)
+      (next cfg request2)
+      (close-output-port gz-out)))
+   (else
+    (next cfg request))))
+
+(define (http-accepts-gzip? request)
+  (cond
+   ((assq 'accept-encoding (request-headers request))
+    => (lambda (x)
+         (let ((m (regexp-search
+                   '(: (or bos ",") (* space) (or "gzip" "x-gzip" "*")
+                       (* space)
+                       (? ";" (* space) "q" (* space) "=" (* space)
+                          ($ (+ (or digit "."))))
+                       (* space) (or eos ","))
+                   (string-downcase-ascii (cdr x)))))
+           (and m
+                (let ((q (regexp-match-submatch m 1)))
+                  (not (and q (eqv? 0 (string->number q)))))))))
+   (else #f)))
+
+(define (http-compressible-response? head)
+  (let* ((lower (string-downcase-ascii head))
+         (header (lambda (name)
+                   (let ((m (regexp-search
+                             `(: "\r\n" ,name ":" (* space)
+                                 ($ (* (~ ("\r\n")))))
+                             lower)))
+                     (and m (regexp-match-submatch m 1)))))
+         (type (header "content-type")))
+    (and (regexp-matches? '(: "http/1." digit " 200" (* any)) lower)
+         (not (header "content-encoding"))
+         (or (not type)
+             (string-prefix? "text/" type)
+             (regexp-search '(or "json" "xml" "javascript" "svg") type)))))
+
+;; Rewrites the headers of a response we're compressing: the length
+;; and byte ranges refer to the uncompressed body, so are dropped.
+(define (http-gzip-headers head)
+  (let lp ((ls (string-split head #\newline)) (res '()))
+    (cond
+     ((or (null? ls) (member (car ls) '("\r" "")))
+      (string-append
+       (apply string-append (reverse res))
+       "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n\r\n"))
+     ((let ((lower (string-downcase-ascii (car ls))))
+        (or (string-prefix? "content-length:" lower)
+            (string-prefix? "accept-ranges:" lower)))
+      (lp (cdr ls) res))
+     (else
+      (lp (cdr ls) (cons (string-append (car ls) "\n") res))))))
+
+;; A port in front of the response which buffers the status line and
+;; headers, then either passes the response through unchanged or
+;; rewrites the headers and gzips the body.
+(define (make-http-gzip-port out level)
+  (let ((head (make-bytevector 0))
+        (body-out #f))
+    (define (start-body! head-end)
+      (let ((str (utf8->string head 0 head-end))
+            (rest (subbytes head head-end)))
+        (cond
+         ((http-compressible-response? str)
+          (write-bytevector (string->utf8 (http-gzip-headers str)) out)
+          (set! body-out (make-deflate-output-port out 'gzip level)))
+         (else
+          (write-bytevector head out 0 head-end)
+          (set! body-out out)))
+        ;; as servlet-respond does, so a framer sees the headers alone
+        (flush-output out)
+        (set! head #f)
+        (write-bytevector rest body-out)))
+    (make-custom-binary-output-port
+     (lambda (bv start end)
+       (cond
+        (body-out
+         (write-bytevector bv body-out start end))
+        (else
+         (set! head (bytevector-append head (subbytes bv start end)))
+         (let ((i (bytevector-search-crlfcrlf head)))
+           (if i (start-body! (+ i 4))))))
+       (- end start))
+     #f
+     (lambda (port)
+       (cond
+        ((not body-out)
+         (write-bytevector head out))
+        ((not (eq? body-out out))
+         (close-output-port body-out)))
+       (flush-output out)))))
+
 (define (http-get*-servlet proc)
   (lambda (cfg request next restart)
     (if (memq (request-method request) '(GET POST))
@@ -113,13 +450,100 @@
    (else
     (send-directory path (request-out request)))))
 
+;; Open files are cached for reuse, keyed on the path and checked
+;; against the file's inode, size and modification time on each use.
+;; send-file doesn't touch the file position so concurrent requests
+;; can share a descriptor, and evicted descriptors are closed when
+;; they're collected.
+(define http-file-cache-size 64)
+(define http-file-cache
+  (make-lru-cache 'size-limit: http-file-cache-size))
+
+(define (http-file-descriptor path st)
+  ;; lru-ref only returns the default on a miss, it doesn't add it,
+  ;; and only successful opens are cached below
+  (let ((cell (lru-ref http-file-cache path (lambda (path) #f))))
+    (if (and cell
+             (eqv? (file-inode st) (vector-ref cell 1))
+             (eqv? (file-size st) (vector-ref cell 2))
+             (eqv? (file-modification-time st) (vector-ref cell 3)))
+        (vector-ref cell 0)
+        (let ((fd (open path open/read)))
+          (if fd
+              (lru-set! http-file-cache
+                        path
+                        (vector fd (file-inode st) (file-size st)
+                                (file-modification-time st))))
+          fd))))
+
+;; Returns the inclusive (start . end) byte range the request asks
+;; for, #f for the whole file, or unsatisfiable.  Only a single range
+;; is supported, for anything else we send the whole file, as we do
+;; if there's an If-Range since we don't send validators.
+(define (http-request-range request size)
+  (let* ((headers (request-headers request))
+         (range (assq 'range headers))
+         (m (and range
+                 (not (assq 'if-range headers))
+                 (regexp-matches
+                  '(: (* space) "bytes" (* space) "=" (* space)
+                      ($ (* digit)) (* space) "-" (* space) ($ (* digit))
+                      (* space))
+                  (cdr range)))))
+    (and
+     m
+     (let ((start (string->number (regexp-match-submatch m 1)))
+           (end (string->number (regexp-match-submatch m 2))))
+       (cond
+        ((and (not start) end)
+         ;; the last end bytes
+         (if (or (zero? end) (zero? size))
+             'unsatisfiable
+             (cons (max 0 (- size end)) (- size 1))))
+        ((not start) #f)
+        ((>= start size) 'unsatisfiable)
+        ((not end) (cons start (- size 1)))
+        ((> start end) #f)
+        (else (cons start (min end (- size 1)))))))))
+
 (define (http-send-file request path)
-  (cond
-   ((file-exists? path)
-    (servlet-respond request 200 "OK")
-    (send-file path (request-out request)))
-   (else
-    (servlet-respond request 404 "Not Found"))))
+  (let ((st (file-status path)))
+    (cond
+     ((not (and st (file-regular? st)))
+      (servlet-respond request 404 "Not Found"))
+     (else
+      (let* ((size (file-size st))
+             (range (http-request-range request size))
+             (fd (http-file-descriptor path st)))
+        (cond
+         ((not fd)
+          (servlet-respond request 403 "Forbidden"))
+         ((eq? range 'unsatisfiable)
+          (servlet-respond
+           request 416 "Range Not Satisfiable"
+           `((Content-Range . ,(string-append "bytes */" (number->string size)))
+             (Content-Length . 0))))
+         (else
+          (let ((start (if range (car range) 0))
+                (count (if range (+ 1 (- (cdr range) (car range))) size)))
+            (servlet-respond
+             request
+             (if range 206 200)
+             (if range "Partial Content" "OK")
+             `((Content-Length . ,count)
+               (Accept-Ranges . "bytes")
+               ,@(if range
+                     `((Content-Range
+                        . ,(string-append
+                            "bytes " (number->string (car range))
+                            "-" (number->string (cdr range))
+                            "/" (number->string size))))
+                     '())))
+            ;; an error sending, e.g. the client going away, closes the
+            ;; connection
+            (if (not (eq? 'HEAD (request-method request)))
+                (send-file fd (http-request-body-output request)
+                           start count))))))))))
 
 (define (http-file-servlet . o)
   (let ((dir (if (pair? o) (car o) "."))
@@ -399,7 +823,8 @@
 ;; gives the intuitive order, but manual ordering can be imposed with
 ;; regexp rules.
 (define ordered-config-servlets
-  `((redirect . ,(lambda (rules cfg) (http-redirect-servlet rules)))
+  `((gzip . ,(lambda (x cfg) http-gzip-servlet))
+    (redirect . ,(lambda (rules cfg) (http-redirect-servlet rules)))
     (rewrite . ,(lambda (rules cfg) (http-rewrite-servlet rules)))
     (host . ,(lambda (hosts cfg)
                (http-host-regexp-servlet
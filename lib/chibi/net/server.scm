@@ -3,79 +3,287 @@
 
 (define default-max-requests 10000)
 
+;; the most connections to take off the backlog per accept
+(define default-accept-batch-size 64)
+
 (define (make-socket-listener-thunk listener port)
-  (lambda ()
-    (let ((addr (get-address-info #f port)))
+  (let ((pending '()))
+    (lambda ()
+      (if (null? pending)
+          (set! pending (accept-batch listener default-accept-batch-size)))
       (cond
-       ((accept listener
-                (address-info-address addr)
-                (address-info-address-length addr))
-        => (lambda (sock) (list sock addr)))
+       ((pair? pending)
+        (let ((sock (car pending))
+              (addr (get-address-info #f port)))
+          (set! pending (cdr pending))
+          ;; fill in the peer address as accept would have
+          (get-peer-name sock (address-info-address addr))
+          (list sock addr)))
        (else #f)))))
 
-(define (make-listener-thunk x)
-  (cond
-   ((integer? x)
-    (make-socket-listener-thunk
-     (make-listener-socket (get-address-info #f x))
-     x))
-   ((address-info? x)
-    (make-socket-listener-thunk (make-listener-socket x) 80))
-   ((fileno? x)
-    (make-socket-listener-thunk x 80))
-   ((procedure? x)
-    x)
-   (else
-    (error "expected a listener socket, fileno or thunk" x))))
+(define (make-listener-socket/reuse-port addrinfo reuse-port?)
+  (if reuse-port?
+      (make-listener-socket addrinfo 128 #t)
+      (make-listener-socket addrinfo)))
+
+(define (make-listener-thunk x . o)
+  (let ((reuse-port? (and (pair? o) (car o))))
+    (cond
+     ((integer? x)
+      (make-socket-listener-thunk
+       (make-listener-socket/reuse-port (get-address-info #f x) reuse-port?)
+       x))
+     ((address-info? x)
+      (make-socket-listener-thunk
+       (make-listener-socket/reuse-port x reuse-port?)
+       80))
+     ((fileno? x)
+      (make-socket-listener-thunk x 80))
+     ((procedure? x)
+      x)
+     (else
+      (error "expected a listener socket, fileno or thunk" x)))))
+
+;; Accept and handle connections until (stopping?) returns true, then
+;; wait for the requests in progress to finish.  Returns the number of
+;; connections handled.
+(define (serve-net-connections listener-thunk handler max-requests stopping?)
+  (define requests 0)
+  (define handled 0)
+  (define (run sock addr count)
+    (log-debug "net-server: accepting request:" count)
+    (let ((ports
+           (protect (exn
+                     (else
+                      (log-error "net-server: couldn't create port:" sock)
+                      (close-file-descriptor sock)))
+             (cons (open-input-file-descriptor sock)
+                   (open-output-file-descriptor sock)))))
+      (protect (exn
+                (else (log-error "net-server: error in request:" count)
+                      (print-exception exn)
+                      (print-stack-trace exn)
+                      (close-input-port (car ports))
+                      (close-output-port (cdr ports))
+                      (close-file-descriptor sock)))
+        (handler (car ports) (cdr ports) sock addr)
+        (flush-output (cdr ports))
+        (close-input-port (car ports))
+        (close-output-port (cdr ports))
+        (close-file-descriptor sock)))
+    (set! handled (+ handled 1))
+    (log-debug "net-server: finished: " count))
+  (let serve ((count 0))
+    (cond
+     ((stopping?)
+      (let drain ()
+        (cond
+         ((positive? requests)
+          (thread-sleep! 0.01)
+          (drain))))
+      handled)
+     ((>= requests max-requests)
+      (thread-yield!)
+      (serve count))
+     (else
+      (let ((sock+addr (listener-thunk)))
+        (cond
+         ((not sock+addr)
+          (serve count))
+         ((= 1 max-requests)
+          (run (car sock+addr) (cadr sock+addr) count)
+          (serve (+ 1 count)))
+         (else
+          (set! requests (+ requests 1))
+          (thread-start!
+           (make-thread
+            (lambda ()
+              (run (car sock+addr) (cadr sock+addr) count)
+              (set! requests (- requests 1)))
+            (string-append "net-client-" (number->string count))))
+          (serve (+ 1 count)))))))))
+
+;; A worker process with its own listener.  SIGTERM stops accepting
+;; new connections and exits once the current requests finish, and
+;; SIGUSR1 logs the number of connections handled so far.
+(define (run-net-server-worker listener-or-addr handler max-requests)
+  (let* ((listener
+          (cond
+           ((integer? listener-or-addr)
+            (make-listener-socket (get-address-info #f listener-or-addr) 128 #t))
+           ((address-info? listener-or-addr)
+            (make-listener-socket listener-or-addr 128 #t))
+           (else listener-or-addr)))
+         (port (if (integer? listener-or-addr) listener-or-addr 80))
+         (stopping #f)
+         (handled 0)
+         (pid (current-process-id)))
+    (define (stop! sig)
+      (cond
+       ((not stopping)
+        (log-info "net-server: worker stopping:" pid)
+        (set! stopping #t)
+        ;; wakes the accept loop, which then sees we're stopping
+        (close-file-descriptor listener))))
+    (set-signal-action! signal/hang-up #f)
+    (set-signal-action! signal/term stop!)
+    (set-signal-action! signal/interrupt stop!)
+    (set-signal-action!
+     signal/user1
+     (lambda (sig)
+       (log-info "net-server: worker " pid " connections: " handled)))
+    (serve-net-connections
+     (let ((thunk (make-socket-listener-thunk listener port)))
+       (lambda ()
+         (let ((res (and (not stopping) (thunk))))
+           (if res (set! handled (+ handled 1)))
+           res)))
+     handler
+     max-requests
+     (lambda () stopping))
+    (log-info "net-server: worker " pid " exiting, connections: " handled)
+    ;; don't let exit's stdio cleanup move the supervisor's shared file
+    ;; offsets, e.g. of the script it's still loading
+    (flush-output (current-output-port))
+    (flush-output (current-error-port))
+    (emergency-exit 0)))
+
+(define (delete-worker pid ls)
+  (cond ((null? ls) '())
+        ((eqv? pid (caar ls)) (cdr ls))
+        (else (cons (car ls) (delete-worker pid (cdr ls))))))
+
+;; workers dying sooner than this after starting are restarted with an
+;; exponential backoff, up to the max delay
+(define worker-min-lifetime 1)
+(define worker-max-restart-delay 10)
+
+(define (current-seconds/float)
+  (time->seconds (current-time)))
+
+;; The supervisor: forks the workers and restarts any that die.
+;; SIGHUP does a graceful reload, starting a fresh set of workers and
+;; then asking the old ones to finish their requests and exit.
+;; SIGTERM and SIGINT stop all workers gracefully, and SIGUSR1 has
+;; every worker log its connection count.
+(define (run-net-server-workers listener-or-addr handler max-requests
+                                num-workers)
+  (let ((workers '())                   ; alist of (pid . start-time)
+        (stopping #f)
+        (reload #f)
+        (restarts 0)
+        (restart-delay 0)
+        (restart-at 0))
+    (define (spawn-worker!)
+      (let ((pid (fork)))
+        (cond
+         ((zero? pid)
+          (run-net-server-worker listener-or-addr handler max-requests))
+         ((negative? pid)
+          (log-error "net-server: couldn't fork worker"))
+         (else
+          (log-info "net-server: started worker:" pid)
+          (set! workers (cons (cons pid (current-seconds/float)) workers))))))
+    (define (spawn-workers! n)
+      (do ((i 0 (+ i 1))) ((>= i n))
+        (spawn-worker!)))
+    (define (signal-workers! sig ls)
+      (for-each (lambda (w) (kill (car w) sig)) ls))
+    (define (worker-died! w)
+      (let ((now (current-seconds/float)))
+        (set! restart-delay
+              (if (< (- now (cdr w)) worker-min-lifetime)
+                  (min worker-max-restart-delay (max 0.1 (* 2 restart-delay)))
+                  0))
+        (log-warn "net-server: worker died, restarting in "
+                  restart-delay "s: " (car w))
+        (set! restarts (+ restarts 1))
+        (set! restart-at (+ now restart-delay))))
+    (define (stop! sig)
+      (set! stopping #t)
+      (signal-workers! signal/term workers))
+    (set-signal-action! signal/hang-up (lambda (sig) (set! reload #t)))
+    (set-signal-action! signal/term stop!)
+    (set-signal-action! signal/interrupt stop!)
+    (set-signal-action!
+     signal/user1
+     (lambda (sig) (signal-workers! signal/user1 workers)))
+    (spawn-workers! num-workers)
+    (let lp ()
+      (cond
+       ((and reload (not stopping))
+        (let ((old workers))
+          (log-info "net-server: reloading workers")
+          (set! reload #f)
+          (set! workers '())
+          (set! restarts 0)
+          (spawn-workers! num-workers)
+          (signal-workers! signal/term old)))
+       ((and (positive? restarts)
+             (not stopping)
+             (>= (current-seconds/float) restart-at))
+        (spawn-workers! restarts)
+        (set! restarts 0)))
+      (let ((res (waitpid -1 wait/no-hang)))
+        (cond
+         ((and (pair? res) (positive? (car res)))
+          (let ((w (assv (car res) workers)))
+            (cond
+             (w
+              (set! workers (delete-worker (car w) workers))
+              (if (not stopping)
+                  (worker-died! w)))))
+          (lp))
+         ((and stopping (pair? res) (negative? (car res)))
+          ;; all workers have exited
+          #t)
+         (else
+          (thread-sleep! 0.1)
+          (lp)))))))
+
+;;> \procedure{(run-net-server listener-or-addr handler [max-requests [workers]])}
+;;>
+;;> Runs a server accepting connections on \var{listener-or-addr},
+;;> which can be a port number, address-info, listener socket or
+;;> thunk returning a list of the connected socket and address.
+;;> \var{handler} is called in its own thread for each connection,
+;;> with the input port, output port, socket and address, and the
+;;> connection is closed when it returns.
+;;>
+;;> At most \var{max-requests} connections are handled at once,
+;;> defaulting to the value of \scheme{CHIBI_NET_SERVER_MAX_THREADS}.
+;;> If \var{workers}, defaulting to the value of
+;;> \scheme{CHIBI_NET_SERVER_WORKERS}, is greater than 1, forks that
+;;> many worker processes, each with its own listener socket sharing
+;;> the port with \scheme{socket-opt/reuseport} (or sharing the given
+;;> listener socket).  The parent process supervises the workers,
+;;> reloads them gracefully on SIGHUP and stops them on SIGTERM.
 
 (define (run-net-server listener-or-addr handler . o)
-  (let ((listener-thunk (make-listener-thunk listener-or-addr))
-        (max-requests
+  (let ((max-requests
          (or
           (cond ((pair? o) (car o))
                 ((get-environment-variable "CHIBI_NET_SERVER_MAX_THREADS")
                  => string->number)
                 (else #f))
-          default-max-requests)))
-    (define (run sock addr count)
-      (log-debug "net-server: accepting request:" count)
-      (let ((ports
-             (protect (exn
-                       (else
-                        (log-error "net-server: couldn't create port:" sock)
-                        (close-file-descriptor sock)))
-               (cons (open-input-file-descriptor sock)
-                     (open-output-file-descriptor sock)))))
-        (protect (exn
-                  (else (log-error "net-server: error in request:" count)
-                        (print-exception exn)
-                        (print-stack-trace exn)
-                        (close-input-port (car ports))
-                        (close-output-port (cdr ports))
-                        (close-file-descriptor sock)))
-          (handler (car ports) (cdr ports) sock addr)
-          (flush-output (cdr ports))
-          (close-input-port (car ports))
-          (close-output-port (cdr ports))
-          (close-file-descriptor sock)))
-      (log-debug "net-server: finished: " count))
-    (let ((requests 0))
-      (let serve ((count 0))
-        (if (>= requests  max-requests)
-            (thread-yield!)
-            (let ((sock+addr (listener-thunk)))
-              (cond
-               ((not sock+addr)
-                (serve count))
-               ((= 1 max-requests)
-                (run (car sock+addr) (cadr sock+addr) count)
-                (serve (+ 1 count)))
-               (else
-                (thread-start!
-                 (make-thread
-                  (lambda ()
-                    (set! requests (+ requests 1))
-                    (run (car sock+addr) (cadr sock+addr) count)
-                    (set! requests (- requests 1)))
-                  (string-append "net-client-" (number->string count))))
-                (serve (+ 1 count))))))))))
+          default-max-requests))
+        (num-workers
+         (or
+          (cond ((and (pair? o) (pair? (cdr o))) (cadr o))
+                ((get-environment-variable "CHIBI_NET_SERVER_WORKERS")
+                 => string->number)
+                (else #f))
+          1)))
+    (cond
+     ((and (> num-workers 1)
+           (not (procedure? listener-or-addr))
+           (or (fileno? listener-or-addr) (>= socket-opt/reuseport 0)))
+      (run-net-server-workers listener-or-addr handler max-requests
+                              num-workers))
+     (else
+      (if (> num-workers 1)
+          (log-warn "net-server: can't fork workers, running single process"))
+      (serve-net-connections (make-listener-thunk listener-or-addr)
+                             handler
+                             max-requests
+                             (lambda () #f))))))
@@ -6,12 +6,18 @@
                (if (string? (car o))
                    (car o)
                    (if (eq? #t (car o)) "" "chibi error"))
-               ""))))
+               "")))
+  (define emergency-exit exit))
  (else
   (define (exit . o)
     (%exit (if (pair? o)
                (if (integer? (car o)) (car o) (if (eq? #t (car o)) 0 1))
-               0)))))
+               0)))
+  (define (emergency-exit . o)
+    (%emergency-exit
+     (if (pair? o)
+         (if (integer? (car o)) (car o) (if (eq? #t (car o)) 0 1))
+         0)))))
 
 (cond-expand
  (bsd
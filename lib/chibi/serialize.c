@@ -0,0 +1,1069 @@
+/* serialize.c -- compact binary serialization of data       */
+/* Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/* BSD-style license: http://synthcode.com/license.txt       */
+
+#include <chibi/eval.h>
+
+#if SEXP_USE_HUFF_SYMS
+#if SEXP_USE_STATIC_LIBS
+#include "chibi/sexp-hufftabdefs.h"
+#else
+#include "chibi/sexp-hufftabs.h"
+#endif
+#endif
+
+/* Each serialized datum is a version byte followed by a single */
+/* object.  Objects are a tag byte and a tag-specific payload, with */
+/* unsigned integers written as little-endian base-128 varints. */
+/* Symbols and record types are written once per datum and then */
+/* referred to by index.  Every pair, vector, string, bytevector and */
+/* record is implicitly numbered in the order it's first written, so */
+/* shared structure and cycles are written as a reference back to */
+/* that number, without a separate pass to find them as in srfi 38. */
+
+#define SEXP_SER_VERSION 0xC1
+
+enum sexp_ser_tags {
+  SEXP_SER_NULL,
+  SEXP_SER_FALSE,
+  SEXP_SER_TRUE,
+  SEXP_SER_EOF,
+  SEXP_SER_VOID,
+  SEXP_SER_FIXNUM,              /* zig-zag varint */
+  SEXP_SER_CHAR,                /* varint code point */
+  SEXP_SER_FLONUM,              /* 8 byte little-endian IEEE double */
+  SEXP_SER_BIGNUM,              /* sign byte, varint length, bytes */
+  SEXP_SER_RATIO,               /* numerator, denominator */
+  SEXP_SER_COMPLEX,             /* real, imaginary */
+  SEXP_SER_STRING,              /* varint length, utf8 bytes */
+  SEXP_SER_BYTES,               /* varint length, bytes */
+  SEXP_SER_SYMBOL,              /* varint length, utf8 bytes */
+  SEXP_SER_ATOM_REF,            /* varint index of a symbol */
+  SEXP_SER_LIST,                /* varint count, cars, final cdr */
+  SEXP_SER_VECTOR,              /* varint count, elements */
+  SEXP_SER_RECORD,              /* varint type index+1 or 0, name, id */
+                                /* and tag, varint count, slots */
+  SEXP_SER_REF                  /* varint number of an earlier object */
+};
+
+#define SEXP_SER_NEW -1
+#define SEXP_SER_OOM -2
+
+#define SEXP_SER_BUFFER_SIZE 4096
+#define SEXP_SER_MAX_DIRECT_LENGTH 65536
+
+/* open addressed eq table from objects to small integers */
+struct sexp_ser_entry {
+  sexp key;
+  sexp_sint_t val;
+};
+
+struct sexp_ser_table {
+  struct sexp_ser_entry *entries;
+  sexp_uint_t size, count;
+};
+
+#define SEXP_SER_HEAP_INDEX (! (SEXP_USE_BOEHM || SEXP_USE_MALLOC))
+
+#if SEXP_SER_HEAP_INDEX
+/* Object numbers for a heap segment, indexed by chunk offset as the */
+/* gc walks it, allocated on first use.  0 means not yet written. */
+struct sexp_ser_segment {
+  char *start, *end;
+  unsigned int *nums;
+};
+#endif
+
+struct sexp_ser_out {
+  sexp ctx, self, out;
+#if SEXP_SER_HEAP_INDEX
+  struct sexp_ser_segment *segs;
+  int num_segs, last_seg;
+#endif
+  struct sexp_ser_table objs, atoms;
+  sexp_sint_t next_obj, next_atom;
+  sexp_uint_t len;
+  unsigned char buf[SEXP_SER_BUFFER_SIZE];
+};
+
+/* The numbered objects are all reachable from the partially read */
+/* result, so they're kept in a plain array outside the heap. */
+struct sexp_ser_in {
+  sexp ctx, self, in;
+  sexp *objs, *atoms;
+  sexp_uint_t num_objs, objs_size;
+  sexp_sint_t num_atoms;
+  int nonblockp;
+};
+
+/* immediate symbols differ mostly in their high bits */
+static sexp_uint_t sexp_ser_hash (sexp x, sexp_uint_t size) {
+  sexp_uint_t h = (sexp_uint_t)x;
+#if SEXP_64_BIT
+  h ^= h >> 32;
+#endif
+  h = (h ^ (h >> 16)) * 0x45d9f3b;
+  h = (h ^ (h >> 16)) * 0x45d9f3b;
+  return (h ^ (h >> 16)) & (size - 1);
+}
+
+static int sexp_ser_table_init (struct sexp_ser_table *t, sexp_uint_t size) {
+  t->entries = calloc(size, sizeof(struct sexp_ser_entry));
+  t->size = size;
+  t->count = 0;
+  return t->entries != NULL;
+}
+
+/* Returns the value for x, or adds x with value val and returns */
+/* SEXP_SER_NEW if it's not present. */
+static sexp_sint_t sexp_ser_table_intern (struct sexp_ser_table *t, sexp x, sexp_sint_t val) {
+  sexp_uint_t i, j;
+  struct sexp_ser_table tmp;
+  for (i = sexp_ser_hash(x, t->size); t->entries[i].key; i = (i + 1) & (t->size - 1))
+    if (t->entries[i].key == x)
+      return t->entries[i].val;
+  if (2 * (t->count + 1) > t->size) {
+    if (!sexp_ser_table_init(&tmp, t->size * 2))
+      return SEXP_SER_OOM;
+    for (i = 0; i < t->size; i++)
+      if (t->entries[i].key) {
+        for (j = sexp_ser_hash(t->entries[i].key, tmp.size); tmp.entries[j].key;
+             j = (j + 1) & (tmp.size - 1))
+          ;
+        tmp.entries[j] = t->entries[i];
+      }
+    tmp.count = t->count;
+    free(t->entries);
+    *t = tmp;
+    for (i = sexp_ser_hash(x, t->size); t->entries[i].key; i = (i + 1) & (t->size - 1))
+      ;
+  }
+  t->entries[i].key = x;
+  t->entries[i].val = val;
+  t->count++;
+  return SEXP_SER_NEW;
+}
+
+/* As above for the numbers of shared objects, looked up directly by */
+/* heap position when possible, falling back on the table otherwise. */
+static sexp_sint_t sexp_ser_intern_obj (struct sexp_ser_out *st, sexp x) {
+#if SEXP_SER_HEAP_INDEX
+  struct sexp_ser_segment *seg = &st->segs[st->last_seg];
+  sexp_uint_t i;
+  if (!((char*)x >= seg->start && (char*)x < seg->end)) {
+    for (i = 0; i < (sexp_uint_t)st->num_segs; i++)
+      if ((char*)x >= st->segs[i].start && (char*)x < st->segs[i].end)
+        break;
+    if (i == (sexp_uint_t)st->num_segs)
+      return sexp_ser_table_intern(&st->objs, x, st->next_obj);
+    seg = &st->segs[st->last_seg = i];
+  }
+  if (!seg->nums
+      && !(seg->nums = calloc(sexp_heap_chunks(seg->end - seg->start), sizeof(unsigned int))))
+    return SEXP_SER_OOM;
+  i = sexp_heap_chunks((char*)x - seg->start);
+  if (seg->nums[i])
+    return seg->nums[i] - 1;
+  if (st->next_obj >= (sexp_sint_t)UINT_MAX)
+    return sexp_ser_table_intern(&st->objs, x, st->next_obj);
+  seg->nums[i] = st->next_obj + 1;
+  return SEXP_SER_NEW;
+#else
+  return sexp_ser_table_intern(&st->objs, x, st->next_obj);
+#endif
+}
+
+#if SEXP_USE_OBJECT_BRACE_LITERALS
+/* the same records the #{...} reader syntax accepts */
+static int sexp_ser_recordp (sexp ctx, sexp x) {
+  sexp t;
+  if (sexp_pointer_tag(x) < SEXP_NUM_CORE_TYPES
+      || sexp_pointer_tag(x) >= sexp_context_num_types(ctx))
+    return 0;
+  t = sexp_object_type(ctx, x);
+  return sexp_type_print(t) && sexp_opcodep(sexp_type_print(t))
+    && sexp_opcode_func(sexp_type_print(t)) == (sexp_proc1)sexp_write_simple_object;
+}
+#else
+#define sexp_ser_recordp(ctx, x) 0
+#endif
+
+/* objects whose identity is preserved */
+static int sexp_ser_sharablep (sexp ctx, sexp x) {
+  if (!x || !sexp_pointerp(x))
+    return 0;
+  switch (sexp_pointer_tag(x)) {
+  case SEXP_PAIR: case SEXP_VECTOR: case SEXP_STRING: case SEXP_BYTES:
+    return 1;
+  default:
+    return sexp_ser_recordp(ctx, x);
+  }
+}
+
+/**************************** writing ****************************/
+
+static void sexp_ser_flush (struct sexp_ser_out *st) {
+  if (st->len > 0)
+    sexp_write_string_n(st->ctx, (char*)st->buf, st->len, st->out);
+  st->len = 0;
+}
+
+#define sexp_ser_put_byte(st, c)                                \
+  do {                                                          \
+    if ((st)->len >= SEXP_SER_BUFFER_SIZE) sexp_ser_flush(st);  \
+    (st)->buf[(st)->len++] = (unsigned char)(c);                \
+  } while (0)
+
+static void sexp_ser_put_varint (struct sexp_ser_out *st, sexp_uint_t n) {
+  if (st->len + 10 > SEXP_SER_BUFFER_SIZE)
+    sexp_ser_flush(st);
+  while (n >= 0x80) {
+    st->buf[st->len++] = (unsigned char)(n | 0x80);
+    n >>= 7;
+  }
+  st->buf[st->len++] = (unsigned char)n;
+}
+
+static void sexp_ser_put_bytes (struct sexp_ser_out *st, const char *s, sexp_uint_t n) {
+  sexp_ser_put_varint(st, n);
+  if (st->len + n > SEXP_SER_BUFFER_SIZE) {
+    sexp_ser_flush(st);
+    if (n > SEXP_SER_BUFFER_SIZE / 2) {
+      sexp_write_string_n(st->ctx, s, n, st->out);
+      return;
+    }
+  }
+  memcpy(st->buf + st->len, s, n);
+  st->len += n;
+}
+
+/* Writes the name of a symbol, or a string, from its bytes. */
+static void sexp_ser_write_name (struct sexp_ser_out *st, sexp x) {
+#if SEXP_USE_HUFF_SYMS
+  char buf[sizeof(sexp_uint_t) * 8];
+  sexp_uint_t c, len;
+  int res;
+  if (sexp_isymbolp(x)) {
+    c = ((sexp_uint_t)x)>>SEXP_IMMEDIATE_BITS;
+    for (len = 0; c; len++) {
+#include "chibi/sexp-unhuff.h"
+      buf[len] = res;
+    }
+    sexp_ser_put_bytes(st, buf, len);
+    return;
+  }
+#endif
+  if (sexp_lsymbolp(x))
+    sexp_ser_put_bytes(st, sexp_lsymbol_data(x), sexp_lsymbol_length(x));
+  else
+    sexp_ser_put_bytes(st, sexp_string_data(x), sexp_string_size(x));
+}
+
+static sexp sexp_ser_write (struct sexp_ser_out *st, sexp x) {
+  sexp y, t, res;
+  sexp_sint_t i, k, len;
+  sexp_uint_t u;
+  union {double d; unsigned long long u;} f;
+ loop:
+  if (sexp_ser_sharablep(st->ctx, x)) {
+    if ((k = sexp_ser_intern_obj(st, x)) >= 0) {
+      sexp_ser_put_byte(st, SEXP_SER_REF);
+      sexp_ser_put_varint(st, k);
+      return NULL;
+    } else if (k == SEXP_SER_OOM) {
+      return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+    }
+    st->next_obj++;
+  }
+  if (sexp_fixnump(x)) {
+    i = sexp_unbox_fixnum(x);
+    sexp_ser_put_byte(st, SEXP_SER_FIXNUM);
+    sexp_ser_put_varint(st, i < 0 ? ((~(sexp_uint_t)i) << 1) | 1 : (sexp_uint_t)i << 1);
+  } else if (sexp_pairp(x)) {
+    /* a run of new pairs is written as one list, in bounded */
+    /* chunks so the reader can allocate the pairs up front */
+    for (len = 1, k = SEXP_SER_NEW, y = sexp_cdr(x);
+         sexp_pairp(y) && len < SEXP_SER_MAX_DIRECT_LENGTH; y = sexp_cdr(y), len++) {
+      if ((k = sexp_ser_intern_obj(st, y)) >= 0)
+        break;
+      else if (k == SEXP_SER_OOM)
+        return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+      st->next_obj++;
+    }
+    sexp_ser_put_byte(st, SEXP_SER_LIST);
+    sexp_ser_put_varint(st, len);
+    for ( ; len > 0; len--, x = sexp_cdr(x))
+      if ((res = sexp_ser_write(st, sexp_car(x))))
+        return res;
+    /* y if it was seen, which can't be numbered again */
+    if (sexp_pairp(x) && k >= 0) {
+      sexp_ser_put_byte(st, SEXP_SER_REF);
+      sexp_ser_put_varint(st, k);
+      return NULL;
+    }
+    goto loop;
+  } else if (x == SEXP_NULL) {
+    sexp_ser_put_byte(st, SEXP_SER_NULL);
+  } else if (x == SEXP_FALSE) {
+    sexp_ser_put_byte(st, SEXP_SER_FALSE);
+  } else if (x == SEXP_TRUE) {
+    sexp_ser_put_byte(st, SEXP_SER_TRUE);
+  } else if (x == SEXP_EOF) {
+    sexp_ser_put_byte(st, SEXP_SER_EOF);
+  } else if (x == SEXP_VOID) {
+    sexp_ser_put_byte(st, SEXP_SER_VOID);
+  } else if (sexp_charp(x)) {
+    sexp_ser_put_byte(st, SEXP_SER_CHAR);
+    sexp_ser_put_varint(st, sexp_unbox_character(x));
+  } else if (sexp_symbolp(x)) {
+    if ((k = sexp_ser_table_intern(&st->atoms, x, st->next_atom)) >= 0) {
+      sexp_ser_put_byte(st, SEXP_SER_ATOM_REF);
+      sexp_ser_put_varint(st, k);
+    } else if (k == SEXP_SER_OOM) {
+      return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+    } else {
+      st->next_atom++;
+      sexp_ser_put_byte(st, SEXP_SER_SYMBOL);
+      sexp_ser_write_name(st, x);
+    }
+  } else if (sexp_stringp(x)) {
+    sexp_ser_put_byte(st, SEXP_SER_STRING);
+    sexp_ser_put_bytes(st, sexp_string_data(x), sexp_string_size(x));
+  } else if (sexp_bytesp(x)) {
+    sexp_ser_put_byte(st, SEXP_SER_BYTES);
+    sexp_ser_put_bytes(st, sexp_bytes_data(x), sexp_bytes_length(x));
+  } else if (sexp_vectorp(x)) {
+    len = sexp_vector_length(x);
+    sexp_ser_put_byte(st, SEXP_SER_VECTOR);
+    sexp_ser_put_varint(st, len);
+    for (i = 0; i < len; i++)
+      if ((res = sexp_ser_write(st, sexp_vector_data(x)[i])))
+        return res;
+#if SEXP_USE_FLONUMS
+  } else if (sexp_flonump(x)) {
+    f.d = sexp_flonum_value(x);
+    sexp_ser_put_byte(st, SEXP_SER_FLONUM);
+    if (st->len + 8 > SEXP_SER_BUFFER_SIZE)
+      sexp_ser_flush(st);
+    for (i = 0; i < 8; i++)
+      st->buf[st->len++] = (unsigned char)(f.u >> (8 * i));
+#endif
+#if SEXP_USE_BIGNUMS
+  } else if (sexp_bignump(x)) {
+    len = sexp_bignum_length(x);
+    while (len > 1 && sexp_bignum_data(x)[len-1] == 0)
+      len--;
+    u = sexp_bignum_data(x)[len-1];
+    len *= sizeof(sexp_uint_t);
+    for (i = sizeof(sexp_uint_t) - 1; i > 0 && !(u >> (8*i)); i--)
+      len--;
+    sexp_ser_put_byte(st, SEXP_SER_BIGNUM);
+    sexp_ser_put_byte(st, sexp_bignum_sign(x) < 0);
+    sexp_ser_put_varint(st, len);
+    for (i = 0; i < len; i++) {
+      u = sexp_bignum_data(x)[i / sizeof(sexp_uint_t)];
+      sexp_ser_put_byte(st, u >> (8 * (i % sizeof(sexp_uint_t))));
+    }
+#endif
+#if SEXP_USE_RATIOS
+  } else if (sexp_ratiop(x)) {
+    sexp_ser_put_byte(st, SEXP_SER_RATIO);
+    if ((res = sexp_ser_write(st, sexp_ratio_numerator(x))))
+      return res;
+    x = sexp_ratio_denominator(x);
+    goto loop;
+#endif
+#if SEXP_USE_COMPLEX
+  } else if (sexp_complexp(x)) {
+    sexp_ser_put_byte(st, SEXP_SER_COMPLEX);
+    if ((res = sexp_ser_write(st, sexp_complex_real(x))))
+      return res;
+    x = sexp_complex_imag(x);
+    goto loop;
+#endif
+  } else if (sexp_ser_recordp(st->ctx, x)) {
+    t = sexp_object_type(st->ctx, x);
+    if ((k = sexp_ser_table_intern(&st->atoms, t, st->next_atom)) == SEXP_SER_OOM)
+      return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+    sexp_ser_put_byte(st, SEXP_SER_RECORD);
+    if (k >= 0) {
+      sexp_ser_put_varint(st, k + 1);
+    } else {
+      st->next_atom++;
+      sexp_ser_put_varint(st, 0);
+      sexp_ser_write_name(st, sexp_type_name(t));
+      if (sexp_stringp(sexp_type_id(t))) {
+        sexp_ser_put_byte(st, 1);
+        sexp_ser_write_name(st, sexp_type_id(t));
+      } else {
+        sexp_ser_put_byte(st, 0);
+      }
+      sexp_ser_put_varint(st, sexp_type_tag(t));
+    }
+    len = sexp_type_num_slots_of_object(t, x);
+    sexp_ser_put_varint(st, len);
+    for (i = 0; i < len; i++)
+      if ((res = sexp_ser_write(st, sexp_slot_ref(x, i) ? sexp_slot_ref(x, i) : SEXP_FALSE)))
+        return res;
+  } else {
+    return sexp_user_exception(st->ctx, st->self, "can't serialize object", x);
+  }
+  return NULL;
+}
+
+sexp sexp_serialize (sexp ctx, sexp self, sexp_sint_t n, sexp x, sexp out) {
+  sexp res;
+  struct sexp_ser_out *st;
+#if SEXP_SER_HEAP_INDEX
+  sexp_heap h;
+  int i;
+#endif
+  sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
+  if (!sexp_port_openp(out))
+    return sexp_xtype_exception(ctx, self, "port is closed", out);
+  if (!(st = malloc(sizeof(struct sexp_ser_out))))
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  st->ctx = ctx;
+  st->self = self;
+  st->out = out;
+  st->next_obj = st->next_atom = 0;
+  st->len = 0;
+  st->atoms.entries = NULL;
+#if SEXP_SER_HEAP_INDEX
+  /* no new heap segments can hold any part of x */
+  for (st->num_segs = 0, h = sexp_context_heap(ctx); h; h = h->next)
+    st->num_segs++;
+  st->last_seg = 0;
+  if ((st->segs = calloc(st->num_segs, sizeof(struct sexp_ser_segment))))
+    for (i = 0, h = sexp_context_heap(ctx); h; h = h->next, i++) {
+      st->segs[i].start = h->data;
+      st->segs[i].end = h->data + h->size;
+    }
+  if (!st->segs) {
+    free(st);
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  }
+#endif
+  if (!(sexp_ser_table_init(&st->objs, 64) && sexp_ser_table_init(&st->atoms, 64))) {
+    res = sexp_global(ctx, SEXP_G_OOM_ERROR);
+  } else {
+    sexp_ser_put_byte(st, SEXP_SER_VERSION);
+    res = sexp_ser_write(st, x);
+    sexp_ser_flush(st);
+  }
+#if SEXP_SER_HEAP_INDEX
+  for (i = 0; i < st->num_segs; i++)
+    free(st->segs[i].nums);
+  free(st->segs);
+#endif
+  free(st->objs.entries);
+  free(st->atoms.entries);
+  free(st);
+  return res ? res : SEXP_VOID;
+}
+
+/**************************** reading ****************************/
+
+#define sexp_ser_error(st, msg, x) \
+  sexp_user_exception((st)->ctx, (st)->self, msg, x)
+
+#define sexp_ser_eof(st) \
+  sexp_ser_error(st, "unexpected end of serialized data", (st)->in)
+
+/* Reads a byte.  The whole object from a non-blocking port is */
+/* already in the port buffer (see sexp_deserialize_ready), so we */
+/* never read more, which could block. */
+static int sexp_ser_get_byte (struct sexp_ser_in *st) {
+#if SEXP_USE_GREEN_THREADS
+  if (st->nonblockp)
+    return sexp_port_offset(st->in) < sexp_port_size(st->in)
+      ? ((unsigned char*)sexp_port_buf(st->in))[sexp_port_offset(st->in)++]
+      : EOF;
+#endif
+  return sexp_read_char(st->ctx, st->in);
+}
+
+static int sexp_ser_get_varint (struct sexp_ser_in *st, sexp_uint_t *res) {
+  int c, shift = 0;
+  sexp_uint_t n = 0;
+  do {
+    if ((c = sexp_ser_get_byte(st)) == EOF
+        || shift >= (int)(sizeof(sexp_uint_t) * 8))
+      return 0;
+    n |= (sexp_uint_t)(c & 0x7F) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  *res = n;
+  return 1;
+}
+
+/* Copies n bytes from the port to dst, directly from the buffer */
+/* where possible. */
+static int sexp_ser_get_bytes (struct sexp_ser_in *st, char *dst, sexp_uint_t n) {
+  sexp in = st->in;
+  sexp_uint_t k;
+  int c;
+  while (n > 0) {
+    if (sexp_port_buf(in) && sexp_port_offset(in) < sexp_port_size(in)) {
+      k = sexp_port_size(in) - sexp_port_offset(in);
+      if (k > n) k = n;
+      memcpy(dst, sexp_port_buf(in) + sexp_port_offset(in), k);
+      sexp_port_offset(in) += k;
+      dst += k;
+      n -= k;
+    } else if ((c = sexp_ser_get_byte(st)) == EOF) {
+      return 0;
+    } else {
+      *dst++ = (char)c;
+      n--;
+    }
+  }
+  return 1;
+}
+
+/* Reads n bytes into a new bytevector.  Large lengths are only */
+/* trusted as far as the data actually arrives, so corrupt input */
+/* can't request huge allocations. */
+static sexp sexp_ser_read_payload (struct sexp_ser_in *st, sexp_uint_t n) {
+  sexp res;
+  char *buf, *tmp;
+  sexp_uint_t size, got;
+  if (n <= SEXP_SER_MAX_DIRECT_LENGTH) {
+    res = sexp_make_bytes(st->ctx, sexp_make_fixnum(n), SEXP_VOID);
+    if (!sexp_exceptionp(res) && !sexp_ser_get_bytes(st, sexp_bytes_data(res), n))
+      res = sexp_ser_eof(st);
+    return res;
+  }
+  if (n > (sexp_uint_t)SEXP_MAX_FIXNUM)
+    return sexp_ser_error(st, "serialized length too large", sexp_make_fixnum(0));
+  size = SEXP_SER_MAX_DIRECT_LENGTH;
+  if (!(buf = malloc(size)))
+    return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+  for (got = 0; got < n; got = size) {
+    if (got == size) {
+      size = (2 * size < n) ? 2 * size : n;
+      if (!(tmp = realloc(buf, size))) {
+        free(buf);
+        return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+      }
+      buf = tmp;
+    }
+    if (!sexp_ser_get_bytes(st, buf + got, size - got)) {
+      free(buf);
+      return sexp_ser_eof(st);
+    }
+  }
+  res = sexp_make_bytes(st->ctx, sexp_make_fixnum(n), SEXP_VOID);
+  if (!sexp_exceptionp(res))
+    memcpy(sexp_bytes_data(res), buf, n);
+  free(buf);
+  return res;
+}
+
+/* Reads a length-prefixed string or symbol name, without copying */
+/* when it's contiguous in the port buffer. */
+static sexp sexp_ser_read_name (struct sexp_ser_in *st, int symbolp) {
+  sexp in = st->in;
+  sexp_uint_t len;
+  char *start;
+  sexp_gc_var1(tmp);
+  if (!sexp_ser_get_varint(st, &len))
+    return sexp_ser_eof(st);
+  if (sexp_port_buf(in) && sexp_port_size(in) - sexp_port_offset(in) >= len) {
+    start = sexp_port_buf(in) + sexp_port_offset(in);
+    sexp_port_offset(in) += len;
+    return symbolp ? sexp_intern(st->ctx, start, len)
+      : sexp_c_string(st->ctx, start, len);
+  }
+  sexp_gc_preserve1(st->ctx, tmp);
+  tmp = sexp_ser_read_payload(st, len);
+  if (!sexp_exceptionp(tmp))
+    tmp = symbolp ? sexp_intern(st->ctx, sexp_bytes_data(tmp), len)
+      : sexp_c_string(st->ctx, sexp_bytes_data(tmp), len);
+  sexp_gc_release1(st->ctx);
+  return tmp;
+}
+
+/* Appends x to the vector at *vec, growing it as needed. */
+static sexp sexp_ser_push (sexp ctx, sexp *vec, sexp_sint_t i, sexp x) {
+  sexp tmp;
+  if (i >= (sexp_sint_t)sexp_vector_length(*vec)) {
+    tmp = sexp_make_vector(ctx, sexp_make_fixnum(2 * i), SEXP_VOID);
+    if (sexp_exceptionp(tmp))
+      return tmp;
+    memcpy(sexp_vector_data(tmp), sexp_vector_data(*vec), i * sizeof(sexp));
+    *vec = tmp;
+  }
+  sexp_vector_data(*vec)[i] = x;
+  return NULL;
+}
+
+static sexp sexp_ser_number (struct sexp_ser_in *st, sexp x) {
+  sexp *tmp;
+  if (st->num_objs >= st->objs_size) {
+    tmp = realloc(st->objs, 2 * st->objs_size * sizeof(sexp));
+    if (!tmp)
+      return sexp_global(st->ctx, SEXP_G_OOM_ERROR);
+    st->objs = tmp;
+    st->objs_size *= 2;
+  }
+  st->objs[st->num_objs++] = x;
+  return NULL;
+}
+
+static sexp sexp_ser_read (struct sexp_ser_in *st) {
+  sexp ctx = st->ctx, t;
+  sexp_uint_t i, len;
+  sexp_sint_t k;
+  int c, negp;
+  union {double d; unsigned long long u;} f;
+  unsigned char b[8];
+  sexp_gc_var3(res, ls, tmp);
+  sexp_gc_preserve3(ctx, res, ls, tmp);
+  switch (c = sexp_ser_get_byte(st)) {
+  case SEXP_SER_NULL: res = SEXP_NULL; break;
+  case SEXP_SER_FALSE: res = SEXP_FALSE; break;
+  case SEXP_SER_TRUE: res = SEXP_TRUE; break;
+  case SEXP_SER_EOF: res = SEXP_EOF; break;
+  case SEXP_SER_VOID: res = SEXP_VOID; break;
+  case SEXP_SER_FIXNUM:
+    if (!sexp_ser_get_varint(st, &i))
+      res = sexp_ser_eof(st);
+    else
+      res = sexp_make_integer(ctx, (i & 1) ? ~(sexp_lsint_t)(i >> 1)
+                              : (sexp_lsint_t)(i >> 1));
+    break;
+  case SEXP_SER_CHAR:
+    res = sexp_ser_get_varint(st, &i) ? sexp_make_character(i) : sexp_ser_eof(st);
+    break;
+#if SEXP_USE_FLONUMS
+  case SEXP_SER_FLONUM:
+    if (!sexp_ser_get_bytes(st, (char*)b, 8)) {
+      res = sexp_ser_eof(st);
+    } else {
+      for (f.u = 0, k = 7; k >= 0; k--)
+        f.u = (f.u << 8) | b[k];
+      res = sexp_make_flonum(ctx, f.d);
+    }
+    break;
+#endif
+#if SEXP_USE_BIGNUMS
+  case SEXP_SER_BIGNUM:
+    if ((negp = sexp_ser_get_byte(st)) == EOF || !sexp_ser_get_varint(st, &len)) {
+      res = sexp_ser_eof(st);
+      break;
+    }
+    tmp = sexp_ser_read_payload(st, len);
+    if (sexp_exceptionp(tmp)) {
+      res = tmp;
+      break;
+    }
+    res = sexp_make_bignum(ctx, (len + sizeof(sexp_uint_t) - 1) / sizeof(sexp_uint_t) + 1);
+    if (sexp_exceptionp(res)) break;
+    memset(sexp_bignum_data(res), 0, sexp_bignum_length(res) * sizeof(sexp_uint_t));
+    for (i = 0; i < len; i++)
+      sexp_bignum_data(res)[i / sizeof(sexp_uint_t)]
+        |= (sexp_uint_t)(unsigned char)sexp_bytes_data(tmp)[i] << (8 * (i % sizeof(sexp_uint_t)));
+    if (sexp_bignump(res)) {
+      sexp_bignum_sign(res) = negp ? -1 : 1;
+      res = sexp_bignum_normalize(res);
+    }
+    break;
+#endif
+#if SEXP_USE_RATIOS
+  case SEXP_SER_RATIO:
+#endif
+#if SEXP_USE_COMPLEX
+  case SEXP_SER_COMPLEX:
+#endif
+#if SEXP_USE_RATIOS || SEXP_USE_COMPLEX
+    tmp = sexp_ser_read(st);
+    if (sexp_exceptionp(tmp)) {
+      res = tmp;
+      break;
+    }
+    res = sexp_ser_read(st);
+    if (sexp_exceptionp(res)) break;
+    if (!sexp_numberp(tmp) || !sexp_numberp(res))
+      res = sexp_ser_error(st, "invalid serialized number", res);
+#if SEXP_USE_RATIOS
+    else if (c == SEXP_SER_RATIO)
+      res = sexp_make_ratio(ctx, tmp, res);
+#endif
+#if SEXP_USE_COMPLEX
+    else
+      res = sexp_make_complex(ctx, tmp, res);
+#endif
+    break;
+#endif
+  case SEXP_SER_STRING:
+  case SEXP_SER_SYMBOL:
+    res = sexp_ser_read_name(st, c == SEXP_SER_SYMBOL);
+    if (!sexp_exceptionp(res)
+        && (tmp = (c == SEXP_SER_SYMBOL
+                   ? sexp_ser_push(ctx, st->atoms, st->num_atoms++, res)
+                   : sexp_ser_number(st, res))))
+      res = tmp;
+    break;
+  case SEXP_SER_ATOM_REF:
+    if (!sexp_ser_get_varint(st, &i))
+      res = sexp_ser_eof(st);
+    else if (i >= (sexp_uint_t)st->num_atoms || !sexp_symbolp(sexp_vector_ref(*st->atoms, sexp_make_fixnum(i))))
+      res = sexp_ser_error(st, "invalid serialized symbol reference", sexp_make_fixnum(i));
+    else
+      res = sexp_vector_ref(*st->atoms, sexp_make_fixnum(i));
+    break;
+  case SEXP_SER_BYTES:
+    if (!sexp_ser_get_varint(st, &len)) {
+      res = sexp_ser_eof(st);
+      break;
+    }
+    res = sexp_ser_read_payload(st, len);
+    if (!sexp_exceptionp(res) && (tmp = sexp_ser_number(st, res)))
+      res = tmp;
+    break;
+  case SEXP_SER_LIST:
+    if (!sexp_ser_get_varint(st, &len) || len == 0 || len > SEXP_SER_MAX_DIRECT_LENGTH) {
+      res = sexp_ser_error(st, "invalid serialized list", st->in);
+      break;
+    }
+    res = SEXP_NULL;
+    for (i = 0; i < len && !sexp_exceptionp(res); i++)
+      res = sexp_cons(ctx, SEXP_FALSE, res);
+    for (ls = res; sexp_pairp(ls); ls = sexp_cdr(ls))
+      if ((tmp = sexp_ser_number(st, ls))) {
+        res = tmp;
+        break;
+      }
+    if (sexp_exceptionp(res)) break;
+    for (ls = res; ; ls = sexp_cdr(ls)) {
+      tmp = sexp_ser_read(st);
+      if (sexp_exceptionp(tmp)) {
+        res = tmp;
+        break;
+      }
+      sexp_car(ls) = tmp;
+      if (!sexp_pairp(sexp_cdr(ls))) {
+        tmp = sexp_ser_read(st);
+        if (sexp_exceptionp(tmp))
+          res = tmp;
+        else
+          sexp_cdr(ls) = tmp;
+        break;
+      }
+    }
+    break;
+  case SEXP_SER_VECTOR:
+    if (!sexp_ser_get_varint(st, &len)) {
+      res = sexp_ser_eof(st);
+      break;
+    }
+    if (len > (sexp_uint_t)SEXP_MAX_FIXNUM / sizeof(sexp)) {
+      res = sexp_ser_error(st, "serialized length too large", sexp_make_fixnum(0));
+      break;
+    }
+    res = sexp_make_vector(ctx, sexp_make_fixnum(len), SEXP_FALSE);
+    if (!sexp_exceptionp(res) && (sexp_uint_t)sexp_vector_length(res) != len)
+      res = sexp_ser_error(st, "serialized length too large", sexp_make_fixnum(len));
+    if (!sexp_exceptionp(res) && (tmp = sexp_ser_number(st, res)))
+      res = tmp;
+    for (i = 0; i < len && !sexp_exceptionp(res); i++) {
+      tmp = sexp_ser_read(st);
+      if (sexp_exceptionp(tmp))
+        res = tmp;
+      else
+        sexp_vector_data(res)[i] = tmp;
+    }
+    break;
+  case SEXP_SER_RECORD:
+    if (!sexp_ser_get_varint(st, &i)) {
+      res = sexp_ser_eof(st);
+      break;
+    }
+    if (i == 0) {
+#if SEXP_USE_OBJECT_BRACE_LITERALS
+      tmp = sexp_ser_read_name(st, 0);
+      if (sexp_exceptionp(tmp)) {
+        res = tmp;
+        break;
+      }
+      if ((c = sexp_ser_get_byte(st)) == EOF) {
+        res = sexp_ser_eof(st);
+        break;
+      }
+      res = c ? sexp_ser_read_name(st, 0) : SEXP_FALSE;
+      if (sexp_exceptionp(res)) break;
+      if (!sexp_ser_get_varint(st, &i)) {
+        res = sexp_ser_eof(st);
+        break;
+      }
+      /* prefer the type with the same tag, as when */
+      /* deserializing in the same process */
+      t = i < (sexp_uint_t)sexp_context_num_types(ctx)
+        ? sexp_lookup_type(ctx, tmp, sexp_make_fixnum(i)) : SEXP_FALSE;
+      if (!sexp_typep(t) || (sexp_stringp(res)
+                             && !(sexp_stringp(sexp_type_id(t))
+                                  && strcmp(sexp_string_data(res), sexp_string_data(sexp_type_id(t))) == 0)))
+        t = sexp_lookup_type(ctx, tmp, res);
+      if (!(t && sexp_typep(t) && sexp_type_print(t)
+            && sexp_opcodep(sexp_type_print(t))
+            && sexp_opcode_func(sexp_type_print(t)) == (sexp_proc1)sexp_write_simple_object)) {
+        res = sexp_ser_error(st, "unknown serialized record type", tmp);
+        break;
+      }
+      if ((res = sexp_ser_push(ctx, st->atoms, st->num_atoms++, t)))
+        break;
+#else
+      res = sexp_ser_error(st, "records aren't supported", st->in);
+      break;
+#endif
+    } else if (i > (sexp_uint_t)st->num_atoms
+               || !sexp_typep(t = sexp_vector_ref(*st->atoms, sexp_make_fixnum(i - 1)))) {
+      res = sexp_ser_error(st, "invalid serialized type reference", sexp_make_fixnum(i));
+      break;
+    }
+    if (!sexp_ser_get_varint(st, &len)) {
+      res = sexp_ser_eof(st);
+      break;
+    }
+    if (len != (sexp_uint_t)sexp_type_field_len_base(t)) {
+      res = sexp_ser_error(st, "wrong number of slots for record type", sexp_type_name(t));
+      break;
+    }
+    res = sexp_alloc_tagged(ctx, sexp_type_size_base(t), sexp_type_tag(t));
+    if (sexp_exceptionp(res)) break;
+    for (i = 0; i < len; i++)
+      sexp_slot_set(res, i, SEXP_FALSE);
+    if ((tmp = sexp_ser_number(st, res)))
+      res = tmp;
+    for (i = 0; i < len && !sexp_exceptionp(res); i++) {
+      tmp = sexp_ser_read(st);
+      if (sexp_exceptionp(tmp))
+        res = tmp;
+      else
+        sexp_slot_set(res, i, tmp);
+    }
+    break;
+  case SEXP_SER_REF:
+    if (!sexp_ser_get_varint(st, &i))
+      res = sexp_ser_eof(st);
+    else if (i >= st->num_objs)
+      res = sexp_ser_error(st, "invalid serialized object reference", sexp_make_fixnum(i));
+    else
+      res = st->objs[i];
+    break;
+  case EOF:
+    res = sexp_ser_eof(st);
+    break;
+  default:
+    res = sexp_ser_error(st, "invalid serialized object tag", sexp_make_fixnum(c));
+    break;
+  }
+  sexp_gc_release3(ctx);
+  return res;
+}
+
+#if SEXP_USE_GREEN_THREADS
+
+/* Finding where an object ends without decoding it, so that objects */
+/* from non-blocking ports can be buffered whole before reading. */
+/* These return the number of bytes skipped, 0 if the input is cut */
+/* off before end, or -1 if it's invalid, in which case decoding it */
+/* reports the error. */
+
+static sexp_sint_t sexp_ser_scan_varint (const unsigned char *p, const unsigned char *end, sexp_uint_t *res) {
+  const unsigned char *q = p;
+  int shift = 0;
+  sexp_uint_t n = 0;
+  do {
+    if (q >= end)
+      return 0;
+    if (shift >= (int)(sizeof(sexp_uint_t) * 8))
+      return -1;
+    n |= (sexp_uint_t)(*q & 0x7F) << shift;
+    shift += 7;
+  } while (*q++ & 0x80);
+  *res = n;
+  return q - p;
+}
+
+#define sexp_ser_scan_next(q, end, res)                         \
+  if ((k = sexp_ser_scan_varint(q, end, &res)) <= 0) return k;  \
+  q += k
+#define sexp_ser_scan_skip(q, end, n)                   \
+  if ((sexp_uint_t)((end) - (q)) < (n)) return 0;       \
+  q += (n)
+
+/* skips the tag and payload of the object at p, setting *count to */
+/* the number of objects contained in it */
+static sexp_sint_t sexp_ser_scan (const unsigned char *p, const unsigned char *end, sexp_uint_t *count) {
+  const unsigned char *q = p + 1;
+  sexp_uint_t len;
+  sexp_sint_t k;
+  *count = 0;
+  if (p >= end)
+    return 0;
+  switch (*p) {
+  case SEXP_SER_NULL: case SEXP_SER_FALSE: case SEXP_SER_TRUE:
+  case SEXP_SER_EOF: case SEXP_SER_VOID:
+    break;
+  case SEXP_SER_FIXNUM: case SEXP_SER_CHAR:
+  case SEXP_SER_ATOM_REF: case SEXP_SER_REF:
+    sexp_ser_scan_next(q, end, len);
+    break;
+  case SEXP_SER_FLONUM:
+    sexp_ser_scan_skip(q, end, 8);
+    break;
+  case SEXP_SER_BIGNUM:
+    sexp_ser_scan_skip(q, end, 1);
+    /* ... FALLTHROUGH ... */
+  case SEXP_SER_STRING: case SEXP_SER_SYMBOL: case SEXP_SER_BYTES:
+    sexp_ser_scan_next(q, end, len);
+    sexp_ser_scan_skip(q, end, len);
+    break;
+  case SEXP_SER_RATIO: case SEXP_SER_COMPLEX:
+    *count = 2;
+    break;
+  case SEXP_SER_LIST:
+    sexp_ser_scan_next(q, end, len);
+    if (len == 0 || len > SEXP_SER_MAX_DIRECT_LENGTH)
+      return -1;
+    *count = len + 1;
+    break;
+  case SEXP_SER_VECTOR:
+    sexp_ser_scan_next(q, end, len);
+    if (len > (sexp_uint_t)SEXP_MAX_FIXNUM / sizeof(sexp))
+      return -1;
+    *count = len;
+    break;
+  case SEXP_SER_RECORD:
+    sexp_ser_scan_next(q, end, len);
+    if (len == 0) {
+      sexp_ser_scan_next(q, end, len);
+      sexp_ser_scan_skip(q, end, len);
+      if (q >= end)
+        return 0;
+      if (*q++) {
+        sexp_ser_scan_next(q, end, len);
+        sexp_ser_scan_skip(q, end, len);
+      }
+      sexp_ser_scan_next(q, end, len);
+    }
+    sexp_ser_scan_next(q, end, len);
+    if (len > (sexp_uint_t)SEXP_MAX_FIXNUM / sizeof(sexp))
+      return -1;
+    *count = len;
+    break;
+  default:
+    return -1;
+  }
+  return q - p;
+}
+
+/* Reads input from a non-blocking port into its buffer until it has */
+/* the whole next object, so it can be deserialized without blocking. */
+/* Returns #t when it's ready.  If more input would block after some */
+/* was read, returns the scan position and number of objects still */
+/* to skip, to be passed back in to continue once there's more. */
+sexp sexp_deserialize_ready (sexp ctx, sexp self, sexp_sint_t n, sexp in, sexp state) {
+  sexp_uint_t pos = 0, pending = 1, count, mark;
+  sexp_sint_t k;
+  unsigned char *p;
+  int readp = 0;
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);
+  if (!sexp_port_openp(in) || !sexp_port_nonblockingp(ctx, in))
+    return SEXP_TRUE;
+  if (sexp_pairp(state)) {
+    pos = sexp_unbox_fixnum(sexp_car(state));
+    pending = sexp_unbox_fixnum(sexp_cdr(state));
+  }
+  for (;;) {
+    p = (unsigned char*)sexp_port_buf(in) + sexp_port_offset(in);
+    k = 0;
+    count = 0;
+    if (pos == 0) {
+      /* the version byte */
+      if (sexp_port_offset(in) < sexp_port_size(in)) {
+        if (*p != SEXP_SER_VERSION)
+          return SEXP_TRUE;
+        k = 1;
+        count = 1;
+      }
+    } else {
+      k = sexp_ser_scan(p + pos, (unsigned char*)sexp_port_buf(in) + sexp_port_size(in), &count);
+    }
+    if (k < 0 || count > (sexp_uint_t)SEXP_MAX_FIXNUM - pending)
+      return SEXP_TRUE;
+    if (k > 0) {
+      pos += k;
+      if ((pending += count - 1) == 0)
+        return SEXP_TRUE;
+      continue;
+    }
+    mark = sexp_port_offset(in);
+    if ((k = sexp_extend_port_buffer(ctx, in, &mark)) > 0) {
+      readp = 1;
+    } else if (k == 0 || errno != EAGAIN) {
+      /* let the read report the error */
+      return SEXP_TRUE;
+    } else if (readp) {
+      return sexp_cons(ctx, sexp_make_fixnum(pos), sexp_make_fixnum(pending));
+    } else {
+      sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), in, SEXP_FALSE);
+      return sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR);
+    }
+  }
+}
+
+#else
+
+sexp sexp_deserialize_ready (sexp ctx, sexp self, sexp_sint_t n, sexp in, sexp state) {
+  return SEXP_TRUE;
+}
+
+#endif
+
+sexp sexp_deserialize (sexp ctx, sexp self, sexp_sint_t n, sexp in) {
+  int c;
+  struct sexp_ser_in st;
+  sexp_gc_var2(res, atoms);
+  sexp_assert_type(ctx, sexp_iportp, SEXP_IPORT, in);
+  if (!sexp_port_openp(in))
+    return sexp_xtype_exception(ctx, self, "port is closed", in);
+  sexp_gc_preserve2(ctx, res, atoms);
+  st.ctx = ctx;
+  st.in = in;
+  st.nonblockp = sexp_port_nonblockingp(ctx, in);
+  if (!st.nonblockp)
+    sexp_maybe_block_port(ctx, in, 1);
+  if ((c = sexp_ser_get_byte(&st)) == EOF) {
+    res = SEXP_EOF;
+  } else if (c != SEXP_SER_VERSION) {
+    res = sexp_user_exception(ctx, self, "unknown serialization format", sexp_make_fixnum(c));
+  } else if (!(st.objs = malloc(64 * sizeof(sexp)))) {
+    res = sexp_global(ctx, SEXP_G_OOM_ERROR);
+  } else {
+    atoms = sexp_make_vector(ctx, SEXP_EIGHT, SEXP_VOID);
+    st.self = self;
+    st.atoms = &atoms;
+    st.num_objs = st.num_atoms = 0;
+    st.objs_size = 64;
+    res = sexp_ser_read(&st);
+    free(st.objs);
+  }
+  sexp_maybe_unblock_port(ctx, in);
+  if (sexp_port_exceptionp(in))
+    res = sexp_port_take_exception(in);
+  sexp_gc_release2(ctx);
+  return res;
+}
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  sexp_define_foreign_param(ctx, env, "serialize", 2, sexp_serialize, "current-output-port");
+  sexp_define_foreign(ctx, env, "%deserialize", 1, sexp_deserialize);
+  sexp_define_foreign(ctx, env, "%deserialize-ready", 2, sexp_deserialize_ready);
+  return SEXP_VOID;
+}
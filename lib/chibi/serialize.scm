@@ -0,0 +1,23 @@
+;; Objects from non-blocking ports are buffered whole before decoding,
+;; yielding to other threads while waiting for the rest of the input.
+
+(define (deserialize . o)
+  (let ((in (if (pair? o) (car o) (current-input-port))))
+    (let lp ((state #f))
+      (let ((state (%deserialize-ready in state)))
+        (if (pair? state)
+            (lp state)
+            (%deserialize in))))))
+
+
+;;> Returns a bytevector containing the serialization of \var{obj}.
+
+(define (object->bytevector obj)
+  (let ((out (open-output-bytevector)))
+    (serialize obj out)
+    (get-output-bytevector out)))
+
+;;> Returns the object serialized in the bytevector \var{bv}.
+
+(define (bytevector->object bv)
+  (deserialize (open-input-bytevector bv)))
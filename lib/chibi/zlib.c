@@ -0,0 +1,228 @@
+/*  zlib.c -- in-process deflate and inflate streams          */
+/*  Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/*  BSD-style license: http://synthcode.com/license.txt       */
+
+#include <chibi/eval.h>
+
+/* A zstream wraps a single zlib deflate or inflate stream.  The */
+/* Scheme side drives it over byte ranges with %zstream-run!, which */
+/* accepts strings as well as bytevectors since custom port buffers */
+/* are strings.  Without zlib the constructors return #f and the */
+/* library falls back to an external gzip where it can. */
+
+#if SEXP_USE_ZLIB
+
+#include <zlib.h>
+
+struct sexp_zstream {
+  z_stream strm;
+  char deflatep, endp;
+};
+
+static sexp_uint_t sexp_zstream_type_id;
+
+#define sexp_zstreamp(x) (sexp_pointerp(x) && sexp_pointer_tag(x) == sexp_zstream_type_id)
+#define sexp_zstream(x) ((struct sexp_zstream*)sexp_cpointer_value(x))
+
+static sexp sexp_finalize_zstream (sexp ctx, sexp self, sexp_sint_t n, sexp obj) {
+  struct sexp_zstream *z = sexp_zstream(obj);
+  if (z) {
+    if (z->deflatep)
+      deflateEnd(&z->strm);
+    else
+      inflateEnd(&z->strm);
+    free(z);
+    sexp_cpointer_value(obj) = NULL;
+  }
+  return SEXP_VOID;
+}
+
+static sexp sexp_wrap_zstream (sexp ctx, struct sexp_zstream *z) {
+  sexp res = sexp_make_cpointer(ctx, sexp_zstream_type_id, z, SEXP_FALSE, 1);
+  if (sexp_exceptionp(res)) {
+    if (z->deflatep)
+      deflateEnd(&z->strm);
+    else
+      inflateEnd(&z->strm);
+    free(z);
+  }
+  return res;
+}
+
+/* window_bits selects the framing as in zlib: 8..15 for zlib, */
+/* -8..-15 for raw deflate, +16 for gzip and +32 to autodetect. */
+sexp sexp_make_deflate (sexp ctx, sexp self, sexp_sint_t n, sexp window_bits, sexp level) {
+  struct sexp_zstream *z;
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, window_bits);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, level);
+  z = (struct sexp_zstream*) calloc(1, sizeof(struct sexp_zstream));
+  if (!z)
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  z->deflatep = 1;
+  if (deflateInit2(&z->strm, sexp_unbox_fixnum(level), Z_DEFLATED,
+                   sexp_unbox_fixnum(window_bits), 8, Z_DEFAULT_STRATEGY)
+      != Z_OK) {
+    free(z);
+    return sexp_user_exception(ctx, self, "invalid deflate parameters", level);
+  }
+  return sexp_wrap_zstream(ctx, z);
+}
+
+sexp sexp_make_inflate (sexp ctx, sexp self, sexp_sint_t n, sexp window_bits) {
+  struct sexp_zstream *z;
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, window_bits);
+  z = (struct sexp_zstream*) calloc(1, sizeof(struct sexp_zstream));
+  if (!z)
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  if (inflateInit2(&z->strm, sexp_unbox_fixnum(window_bits)) != Z_OK) {
+    free(z);
+    return sexp_user_exception(ctx, self, "invalid inflate parameters", window_bits);
+  }
+  return sexp_wrap_zstream(ctx, z);
+}
+
+static unsigned char* sexp_zstream_range (sexp x, sexp start, sexp end,
+                                          sexp_uint_t *len) {
+  unsigned char *data;
+  sexp_uint_t size, lo, hi;
+  if (sexp_bytesp(x)) {
+    data = (unsigned char*) sexp_bytes_data(x);
+    size = sexp_bytes_length(x);
+  } else if (sexp_stringp(x)) {
+    data = (unsigned char*) sexp_string_data(x);
+    size = sexp_string_size(x);
+  } else {
+    return NULL;
+  }
+  if (!sexp_fixnump(start) || !sexp_fixnump(end) || sexp_unbox_fixnum(start) < 0)
+    return NULL;
+  lo = sexp_unbox_fixnum(start);
+  hi = sexp_unbox_fixnum(end);
+  if (lo > hi || hi > size)
+    return NULL;
+  *len = hi - lo;
+  return data + lo;
+}
+
+/* Runs the stream over src[start, end) writing to dst[dst_start, */
+/* dst_end), where flush is one of zlib's Z_NO_FLUSH, Z_SYNC_FLUSH */
+/* or Z_FINISH.  Returns a pair of the number of bytes consumed and */
+/* produced.  Running out of input or output isn't an error, the */
+/* caller just loops until the stream reports its end. */
+sexp sexp_zstream_run_x (sexp ctx, sexp self, sexp_sint_t n, sexp zs,
+                         sexp src, sexp start, sexp end,
+                         sexp dst, sexp dst_start, sexp dst_end, sexp flush) {
+  struct sexp_zstream *z;
+  unsigned char *in, *out;
+  sexp_uint_t in_len, out_len;
+  int err;
+  if (!sexp_zstreamp(zs) || !sexp_zstream(zs))
+    return sexp_type_exception(ctx, self, sexp_zstream_type_id, zs);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, flush);
+  in = sexp_zstream_range(src, start, end, &in_len);
+  if (!in)
+    return sexp_user_exception(ctx, self, "invalid zstream input", src);
+  out = sexp_zstream_range(dst, dst_start, dst_end, &out_len);
+  if (!out)
+    return sexp_user_exception(ctx, self, "invalid zstream output", dst);
+  z = sexp_zstream(zs);
+  if (z->endp)
+    return sexp_cons(ctx, SEXP_ZERO, SEXP_ZERO);
+  z->strm.next_in = in;
+  z->strm.avail_in = in_len;
+  z->strm.next_out = out;
+  z->strm.avail_out = out_len;
+  if (z->deflatep)
+    err = deflate(&z->strm, sexp_unbox_fixnum(flush));
+  else
+    err = inflate(&z->strm, sexp_unbox_fixnum(flush));
+  switch (err) {
+  case Z_STREAM_END:
+    z->endp = 1;
+    /* fallthrough */
+  case Z_OK:
+  case Z_BUF_ERROR:
+    break;
+  case Z_NEED_DICT:
+    return sexp_user_exception(ctx, self, "preset dictionaries are not supported", zs);
+  case Z_MEM_ERROR:
+    return sexp_global(ctx, SEXP_G_OOM_ERROR);
+  default:
+    return sexp_user_exception(ctx, self, z->strm.msg ? z->strm.msg : "corrupt compressed data", zs);
+  }
+  return sexp_cons(ctx, sexp_make_fixnum(in_len - z->strm.avail_in),
+                   sexp_make_fixnum(out_len - z->strm.avail_out));
+}
+
+sexp sexp_zstream_endp (sexp ctx, sexp self, sexp_sint_t n, sexp zs) {
+  if (!sexp_zstreamp(zs) || !sexp_zstream(zs))
+    return sexp_type_exception(ctx, self, sexp_zstream_type_id, zs);
+  return sexp_make_boolean(sexp_zstream(zs)->endp);
+}
+
+/* Starts a new stream with the same parameters, used for gzip */
+/* files made of several concatenated members. */
+sexp sexp_zstream_reset_x (sexp ctx, sexp self, sexp_sint_t n, sexp zs) {
+  struct sexp_zstream *z;
+  if (!sexp_zstreamp(zs) || !sexp_zstream(zs))
+    return sexp_type_exception(ctx, self, sexp_zstream_type_id, zs);
+  z = sexp_zstream(zs);
+  if (z->deflatep)
+    deflateReset(&z->strm);
+  else
+    inflateReset(&z->strm);
+  z->endp = 0;
+  return SEXP_VOID;
+}
+
+#else  /* ! SEXP_USE_ZLIB */
+
+sexp sexp_make_deflate (sexp ctx, sexp self, sexp_sint_t n, sexp window_bits, sexp level) {
+  return SEXP_FALSE;
+}
+
+sexp sexp_make_inflate (sexp ctx, sexp self, sexp_sint_t n, sexp window_bits) {
+  return SEXP_FALSE;
+}
+
+sexp sexp_zstream_run_x (sexp ctx, sexp self, sexp_sint_t n, sexp zs,
+                         sexp src, sexp start, sexp end,
+                         sexp dst, sexp dst_start, sexp dst_end, sexp flush) {
+  return SEXP_FALSE;
+}
+
+sexp sexp_zstream_endp (sexp ctx, sexp self, sexp_sint_t n, sexp zs) {
+  return SEXP_TRUE;
+}
+
+sexp sexp_zstream_reset_x (sexp ctx, sexp self, sexp_sint_t n, sexp zs) {
+  return SEXP_VOID;
+}
+
+#endif
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+#if SEXP_USE_ZLIB
+  sexp_gc_var2(name, t);
+#endif
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+#if SEXP_USE_ZLIB
+  sexp_gc_preserve2(ctx, name, t);
+  name = sexp_c_string(ctx, "zstream", -1);
+  t = sexp_register_c_type(ctx, name, sexp_finalize_zstream);
+  if (sexp_exceptionp(t)) {
+    sexp_gc_release2(ctx);
+    return t;
+  }
+  sexp_zstream_type_id = sexp_type_tag(t);
+  sexp_gc_release2(ctx);
+#endif
+  sexp_define_foreign(ctx, env, "%make-deflate", 2, sexp_make_deflate);
+  sexp_define_foreign(ctx, env, "%make-inflate", 1, sexp_make_inflate);
+  sexp_define_foreign(ctx, env, "%zstream-run!", 8, sexp_zstream_run_x);
+  sexp_define_foreign(ctx, env, "%zstream-end?", 1, sexp_zstream_endp);
+  sexp_define_foreign(ctx, env, "%zstream-reset!", 1, sexp_zstream_reset_x);
+  return SEXP_VOID;
+}
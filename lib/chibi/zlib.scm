@@ -1,51 +1,207 @@
 
-;; Temporary hack, need to rewrite in pure Scheme.
+;;> Deflate compression with the raw, zlib (RFC 1950) or gzip (RFC
+;;> 1952) framing, run in-process with the system zlib.  The
+;;> \var{format} arguments below are one of the symbols \scheme{gzip},
+;;> \scheme{zlib} or \scheme{raw}, and \var{level} is the compression
+;;> level from 0 (store only) to 9 (best), defaulting to 6.
+;;>
+;;> If Chibi was built without zlib, \scheme{gzip}, \scheme{gunzip}
+;;> and the file utilities fall back to running an external gzip,
+;;> and the remaining procedures signal an error.
 
-;;> Gzip compress a file in place, renaming with a .gz suffix.
+(define zlib-buffer-size 65536)
 
-(define (gzip-file path)
-  (system "gzip" path))
+;; zlib's flush values
+(define z-no-flush 0)
+(define z-finish 4)
 
-;;> Gunzip decompress a file in place, removing any .gz suffix.
+(define (zlib-window-bits format)
+  (case format
+    ((gzip) 31)
+    ((zlib) 15)
+    ((raw) -15)
+    ((auto) 47)
+    (else (error "unknown compression format" format))))
 
-(define (gunzip-file path)
-  (system "gzip" "-d" path))
-
-;; Utility to filter a bytevector to a process and return the
-;; accumulated output as a new bytevector.
-;; (define (process-pipe-bytevector cmd bvec)
-;;   (call-with-process-io
-;;    cmd
-;;    (lambda (pid proc-in proc-out proc-err)
-;;      (let ((len (bytevector-length bvec))
-;;            (out (open-output-bytevector)))
-;;        (let lp ((i 0))
-;;          (cond
-;;           ((u8-ready? proc-out)
-;;            (let ((u8 (read-u8 proc-out)))
-;;              (cond
-;;               ((eof-object? u8)
-;;                (get-output-bytevector out))
-;;               (else
-;;                (write-u8 u8 out)
-;;                (lp i)))))
-;;           ((< i len)
-;;            (write-u8 (bytevector-u8-ref bvec i) proc-in)
-;;            (lp (+ i 1)))
-;;           (else
-;;            ;; Once we've completed sending the input we busy wait
-;;            ;; until all output has been read.  We can't just waitpid
-;;            ;; here because the remaining output may still overflow the
-;;            ;; pipe buffer.
-;;            (close-output-port proc-in)
-;;            (let lp ()
-;;              (let ((u8 (read-u8 proc-out)))
-;;                (cond
-;;                 ((eof-object? u8)
-;;                  (get-output-bytevector out))
-;;                 (else
-;;                  (write-u8 u8 out)
-;;                  (lp))))))))))))
+(define (make-deflate-stream format level)
+  (if (eq? format 'auto)
+      (error "can't compress to an unknown format" format))
+  (if (not (and (exact-integer? level) (<= 0 level 9)))
+      (error "compression level must be an integer from 0 to 9" level))
+  (or (%make-deflate (zlib-window-bits format) level)
+      (error "zlib support is not available")))
+
+(define (make-inflate-stream format)
+  (or (%make-inflate (zlib-window-bits format))
+      (error "zlib support is not available")))
+
+;; Feeds src[start, end) to the stream, writing all output produced
+;; to out via buf.  With z-finish this runs until the end of the
+;; stream.
+(define (zstream-pump! z src start end buf out flush)
+  (let ((size (bytevector-length buf)))
+    (let lp ((start start))
+      (let* ((res (%zstream-run! z src start end buf 0 size flush))
+             (start (+ start (car res))))
+        (if (positive? (cdr res))
+            (write-bytevector buf out 0 (cdr res)))
+        (if (or (< start end)
+                (= (cdr res) size)
+                (and (eqv? flush z-finish) (not (%zstream-end? z))))
+            (lp start))))))
+
+;;> \procedure{(make-deflate-output-port out [format [level]])}
+;;>
+;;> Returns a binary output port which compresses everything written
+;;> to it and writes the result to the binary port \var{out}.
+;;> \var{format} defaults to \scheme{gzip}.  Output is buffered by the
+;;> compressor, and the stream is only complete once the port is
+;;> closed, which flushes but doesn't close \var{out}.  An error
+;;> writing to \var{out} is raised by the write, flush or close of
+;;> the port which triggered it, and again by any later ones.
+
+(define (make-deflate-output-port out . o)
+  (let* ((format (if (pair? o) (car o) 'gzip))
+         (level (if (and (pair? o) (pair? (cdr o))) (cadr o) 6))
+         (z (make-deflate-stream format level))
+         (buf (make-bytevector zlib-buffer-size))
+         (err #f))
+    ;; the stream can't continue after a partial write
+    (define (pump! bv start end flush)
+      (if err (raise err))
+      (guard (exn (else (set! err exn) (raise exn)))
+        (zstream-pump! z bv start end buf out flush)))
+    (make-custom-binary-output-port
+     (lambda (bv start end)
+       (pump! bv start end z-no-flush)
+       (- end start))
+     #f
+     (lambda (port)
+       (pump! buf 0 0 z-finish)
+       (flush-output-port out)))))
+
+;; Returns a procedure (inflate! bv start end) which decompresses
+;; data read from the binary port in into bv, returning the number of
+;; bytes written, or 0 at the end of the data.  Corrupt or truncated
+;; data raises an error.
+(define (make-inflater in format)
+  (let* ((z (make-inflate-stream format))
+         (buf (make-bytevector zlib-buffer-size))
+         (pos 0)
+         (len 0)
+         (eof? #f))
+    ;; refills buf, keeping any unconsumed bytes at the front
+    (define (fill!)
+      (let ((rest (- len pos)))
+        (if (positive? rest)
+            (bytevector-copy! buf 0 buf pos len))
+        (let ((n (read-bytevector! buf in rest)))
+          (set! pos 0)
+          (set! len (+ rest (if (eof-object? n) 0 n)))
+          (if (< len zlib-buffer-size)
+              (set! eof? #t)))))
+    (define (input-available? k)
+      (if (and (< (- len pos) k) (not eof?))
+          (fill!))
+      (>= (- len pos) k))
+    (lambda (bv start end)
+      (let lp ()
+        (cond
+         ((%zstream-end? z)
+          (cond
+           ((and (input-available? 2)
+                 (gzip-member-follows? format buf pos len))
+            (%zstream-reset! z)
+            (lp))
+           (else 0)))
+         (else
+          (input-available? 1)
+          (let* ((res (%zstream-run! z buf pos len bv start end z-no-flush))
+                 (n (cdr res)))
+            (set! pos (+ pos (car res)))
+            (cond
+             ((positive? n) n)
+             ((%zstream-end? z) (lp))
+             ((and eof? (= pos len))
+              (error "truncated compressed data"))
+             (else (lp))))))))))
+
+;;> \procedure{(make-inflate-input-port in [format])}
+;;>
+;;> Returns a binary input port which reads compressed data from the
+;;> binary port \var{in} and returns it decompressed.  \var{format}
+;;> may also be \scheme{auto}, the default, to accept either gzip or
+;;> zlib framing.  As with gunzip, gzip members concatenated together
+;;> are decompressed in sequence.  Compressed data is read from
+;;> \var{in} in large blocks, so anything following it may be
+;;> consumed.  Reading corrupt or truncated data raises an error,
+;;> as does any read after that.
+
+(define (make-inflate-input-port in . o)
+  (let ((inflate! (make-inflater in (if (pair? o) (car o) 'auto)))
+        (err #f))
+    (make-custom-binary-input-port
+     (lambda (bv start end)
+       (if err (raise err))
+       (guard (exn (else (set! err exn) (raise exn)))
+         (inflate! bv start end))))))
+
+;;> \procedure{(deflate bytevector [format [level]])}
+;;>
+;;> Compresses \var{bytevector} in memory, returning a new bytevector.
+;;> \var{format} defaults to \scheme{zlib}.
+
+(define (deflate bvec . o)
+  (let* ((format (if (pair? o) (car o) 'zlib))
+         (level (if (and (pair? o) (pair? (cdr o))) (cadr o) 6))
+         (z (make-deflate-stream format level))
+         (buf (make-bytevector
+               (min zlib-buffer-size (+ 64 (bytevector-length bvec)))))
+         (out (open-output-bytevector)))
+    (zstream-pump! z bvec 0 (bytevector-length bvec) buf out z-finish)
+    (get-output-bytevector out)))
+
+;;> \procedure{(inflate bytevector [format])}
+;;>
+;;> Decompresses \var{bytevector} in memory, returning a new
+;;> bytevector.  \var{format} defaults to \scheme{auto}.
+
+(define (inflate bvec . o)
+  (let* ((format (if (pair? o) (car o) 'auto))
+         (z (make-inflate-stream format))
+         (len (bytevector-length bvec))
+         (size (min zlib-buffer-size (* 4 (+ 64 len))))
+         (buf (make-bytevector size))
+         (out (open-output-bytevector)))
+    (let lp ((start 0))
+      (let* ((res (%zstream-run! z bvec start len buf 0 size z-no-flush))
+             (start (+ start (car res))))
+        (write-bytevector buf out 0 (cdr res))
+        (cond
+         ((%zstream-end? z)
+          (cond
+           ((gzip-member-follows? format bvec start len)
+            (%zstream-reset! z)
+            (lp start))))
+         ((and (= start len) (< (cdr res) size))
+          (error "truncated compressed data"))
+         (else
+          (lp start)))))
+    (get-output-bytevector out)))
+
+;; Any further gzip members are decompressed as if concatenated, but
+;; as with gunzip other trailing data is ignored.
+(define (gzip-member-follows? format bvec start end)
+  (and (memq format '(gzip auto))
+       (< (+ start 1) end)
+       (eqv? #x1f (bytevector-u8-ref bvec start))
+       (eqv? #x8b (bytevector-u8-ref bvec (+ start 1)))))
+
+;;> True iff zlib is linked in.  Otherwise only the gzip and gunzip
+;;> utilities work, by running the external gzip command.
+
+(define zlib-available?
+  (and (%make-inflate (zlib-window-bits 'auto)) #t))
 
 ;; Use a temp file to avoid dead-lock issues with pipes.
 (define (process-run-bytevector cmd bvec)
@@ -55,17 +211,24 @@
       (close-output-port out)
       (process->bytevector (append cmd (list path))))))
 
-;;> Gzip compress a string or bytevector in memory.
+;;> Gzip compress a string or bytevector in memory, with an optional
+;;> compression \var{level}.
 
-(define (gzip x)
-  (if (string? x)
-      (gzip (string->utf8 x))
-      (process-run-bytevector '("gzip" "-c") x)))
+(define (gzip x . o)
+  (cond
+   ((string? x)
+    (apply gzip (string->utf8 x) o))
+   (zlib-available?
+    (deflate x 'gzip (if (pair? o) (car o) 6)))
+   (else
+    (process-run-bytevector '("gzip" "-c") x))))
 
 ;;> Gunzip decompress a bytevector in memory.
 
 (define (gunzip bvec)
-  (process-run-bytevector '("gzip" "-c" "-d") bvec))
+  (if zlib-available?
+      (inflate bvec 'gzip)
+      (process-run-bytevector '("gzip" "-c" "-d") bvec)))
 
 ;;> Gunzip decompress a bytevector in memory if it has been
 ;;> compressed, or return as-is otherwise.
@@ -76,3 +239,70 @@
            (eqv? #x8b (bytevector-u8-ref bvec 1)))
       (gunzip bvec)
       bvec))
+
+(define (string-suffix-gz? path)
+  (let ((len (string-length path)))
+    (and (> len 3) (string=? ".gz" (substring path (- len 3) len)))))
+
+;; Replaces the file src with dest, written by (proc in out) through
+;; a temp file beside dest, which is only renamed into place once proc
+;; returns.  On error src is left as it was and nothing is written.
+(define (convert-file src dest proc)
+  (let ((tmp (string-append dest ".tmp" (number->string (current-process-id))))
+        (in (open-binary-input-file src))
+        (out #f))
+    (guard (exn
+            (else
+             (close-input-port in)
+             (if out (close-output-port out))
+             (if (file-exists? tmp) (delete-file tmp))
+             (raise exn)))
+      (set! out (open-binary-output-file tmp))
+      (proc in out)
+      (close-output-port out)
+      (close-input-port in)
+      (rename-file tmp dest)
+      (delete-file src))))
+
+;;> Gzip compress a file in place, renaming with a .gz suffix.
+
+(define (gzip-file path . o)
+  (cond
+   (zlib-available?
+    (convert-file
+     path (string-append path ".gz")
+     (lambda (in out)
+       (let ((z (make-deflate-stream 'gzip (if (pair? o) (car o) 6)))
+             (src (make-bytevector zlib-buffer-size))
+             (buf (make-bytevector zlib-buffer-size)))
+         (let lp ()
+           (let ((n (read-bytevector! src in)))
+             (cond
+              ((eof-object? n)
+               (zstream-pump! z src 0 0 buf out z-finish))
+              (else
+               (zstream-pump! z src 0 n buf out z-no-flush)
+               (lp)))))))))
+   (else
+    (system "gzip" path))))
+
+;;> Gunzip decompress a file in place, removing any .gz suffix.
+
+(define (gunzip-file path)
+  (cond
+   ((not (string-suffix-gz? path))
+    (error "gunzip-file: no .gz suffix" path))
+   (zlib-available?
+    (convert-file
+     path (substring path 0 (- (string-length path) 3))
+     (lambda (in out)
+       (let ((inflate! (make-inflater in 'gzip))
+             (buf (make-bytevector zlib-buffer-size)))
+         (let lp ()
+           (let ((n (inflate! buf 0 zlib-buffer-size)))
+             (cond
+              ((positive? n)
+               (write-bytevector buf out 0 n)
+               (lp)))))))))
+   (else
+    (system "gzip" "-d" path))))
@@ -1170,9 +1170,10 @@
         (if (>= res 0) res (+ res b)))))
 
 (define (gcd2 a b)
-  (if (= b 0)
-      (abs a)
-      (gcd b (remainder a b))))
+  (cond
+   ((and (exact-integer? a) (exact-integer? b)) (%gcd a b))
+   ((= b 0) (abs a))
+   (else (gcd b (remainder a b)))))
 
 (define (gcd . args)
   (if (null? args)
@@ -95,51 +95,6 @@
 
 (define (eof-object) (read-char (open-input-string "")))
 
-(define (read-bytevector n . o)
-  (if (zero? n)
-      #u8()
-      (let ((in (if (pair? o) (car o) (current-input-port)))
-            (res (make-bytevector n)))
-        (let lp ((i 0))
-          (if (>= i n)
-              res
-              (let ((x (read-u8 in)))
-                (cond ((eof-object? x)
-                       (if (zero? i) x (subbytes res 0 i)))
-                      (else
-                       (bytevector-u8-set! res i x)
-                       (lp (+ i 1))))))))))
-
-(define (read-bytevector! vec . o)
-  (let* ((in (if (pair? o) (car o) (current-input-port)))
-         (o (if (pair? o) (cdr o) o))
-         (start (if (pair? o) (car o) 0))
-         (end (if (and (pair? o) (pair? (cdr o)))
-                  (cadr o)
-                  (bytevector-length vec))))
-    (if (>= start end)
-        0
-        (let ((res (read-bytevector (- end start) in)))
-          (cond
-           ((eof-object? res)
-            res)
-           (else
-            (let ((len (bytevector-length res)))
-              (do ((i 0 (+ i 1)))
-                  ((>= i len) len)
-                (bytevector-u8-set! vec (+ i start) (bytevector-u8-ref res i))
-                ))))))))
-
-(define (write-bytevector vec . o)
-  (let* ((out (if (pair? o) (car o) (current-output-port)))
-         (o (if (pair? o) (cdr o) '()))
-         (start (if (pair? o) (car o) 0))
-         (o (if (pair? o) (cdr o) '()))
-         (end (if (pair? o) (car o) (bytevector-length vec))))
-    (do ((i start (+ i 1)))
-        ((>= i end))
-      (write-u8 (bytevector-u8-ref vec i) out))))
-
 (define (list-set! ls k x)
   (cond ((null? ls) (error "invalid list index"))
         ((zero? k) (set-car! ls x))
@@ -2,23 +2,27 @@
 ;; Copyright (c) 2009-2012 Alex Shinn.  All rights reserved.
 ;; BSD-style license: http://synthcode.com/license.txt
 
+;; The native %delete, %delete-duplicates and %lset-* kernels take
+;; the code for a standard equivalence, and return #f for anything
+;; they don't handle.
+
+(define (%equivalence-code eq)
+  (cond ((eq? eq eq?) 1) ((eq? eq eqv?) 2) ((eq? eq equal?) 3)
+        ((eq? eq equiv?) 4) (else #f)))
+
 (define (delete x ls . o)
   (let ((eq (if (pair? o) (car o) equal?)))
-    (if (eq? eq eq?)
-        (let lp ((ls ls) (rev '())) ;; fast path for delq
-          (let ((tail (memq x ls)))
-            (if tail
-                (lp (cdr tail) (take-up-to-reverse ls tail rev))
-                (if (pair? rev) (append-reverse! rev ls) ls))))
+    (or (%delete x ls (%equivalence-code eq))
         (remove (lambda (y) (eq x y)) ls))))
 
 (define delete! delete)
 
 (define (delete-duplicates ls . o)
   (let ((eq (if (pair? o) (car o) equal?)))
-    (let lp ((ls ls) (res '()))
-      (if (pair? ls)
-          (lp (cdr ls) (if (member (car ls) res eq) res (cons (car ls) res)))
-          (reverse! res)))))
+    (or (%delete-duplicates ls (%equivalence-code eq))
+        (let lp ((ls ls) (res '()))
+          (if (pair? ls)
+              (lp (cdr ls) (if (member (car ls) res eq) res (cons (car ls) res)))
+              (reverse! res))))))
 
 (define delete-duplicates! delete-duplicates)
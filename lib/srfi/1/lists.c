@@ -0,0 +1,362 @@
+/*  lists.c -- native deletion and lset kernels               */
+/*  Copyright (c) 2026 Alex Shinn.  All rights reserved.      */
+/*  BSD-style license: http://synthcode.com/license.txt       */
+
+#include <chibi/eval.h>
+
+/* The kernels here handle proper lists compared with one of the */
+/* standard equivalences, passed as a code: 1 for eq?, 2 for eqv?, */
+/* 3 for equal? and 4 for the cycle-safe equiv? which (scheme base) */
+/* exports as equal?.  Anything else returns #f and is left to the */
+/* general Scheme definitions.  Membership is checked with a hash */
+/* table of (hash . pair) slots in a vector, built for the call. */
+
+#define SEXP_LISTS_HASH_DEPTH 4
+#define SEXP_LISTS_HASH_BREADTH 8
+
+/* equiv? first compares this far as equal? does, the same as the */
+/* bounds in lib/chibi/equiv.scm */
+#define SEXP_LISTS_EQUIV_BOUND sexp_make_fixnum(100000)
+
+static sexp_uint_t sexp_lists_mix (sexp_uint_t h) {
+#if SEXP_64_BIT
+  h ^= h >> 33;
+  h *= (sexp_uint_t)0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+#else
+  h ^= h >> 16;
+  h *= 0x85ebca6bUL;
+  h ^= h >> 13;
+#endif
+  return h;
+}
+
+static sexp_uint_t sexp_lists_hash_bytes (const char *p, sexp_uint_t len) {
+  sexp_uint_t acc = len;
+  while (len-- > 0)
+    acc = acc * 31 + (unsigned char)*p++;
+  return acc;
+}
+
+/* A hash consistent with the equivalence.  Nothing can move during */
+/* a call, so eq? can hash on addresses directly.  Numbers hash by */
+/* value for eqv? and equal?, and equal? also hashes the contents */
+/* of strings, bytevectors, pairs and vectors, falling back on just */
+/* the type for anything else. */
+static sexp_uint_t sexp_lists_hash (sexp ctx, sexp x, int code, int depth) {
+  sexp_uint_t acc = 0;
+  sexp_sint_t i, len;
+  if (code == 1 || ! sexp_pointerp(x))
+    return sexp_lists_mix((sexp_uint_t)x);
+#if SEXP_USE_FLONUMS && ! SEXP_USE_IMMEDIATE_FLONUMS
+  if (sexp_flonump(x))
+    return sexp_lists_hash_bytes(sexp_flonum_bits(x), sizeof(double));
+#endif
+#if SEXP_USE_BIGNUMS
+  if (sexp_bignump(x))
+    return sexp_bignum_sign(x)
+      + sexp_lists_hash_bytes((char*)sexp_bignum_data(x),
+                              sexp_bignum_hi(x)*sizeof(sexp_uint_t));
+#endif
+#if SEXP_USE_RATIOS
+  if (sexp_ratiop(x))
+    return sexp_lists_hash(ctx, sexp_ratio_numerator(x), 3, 0) * 31
+      + sexp_lists_hash(ctx, sexp_ratio_denominator(x), 3, 0);
+#endif
+#if SEXP_USE_COMPLEX
+  if (sexp_complexp(x))
+    return sexp_lists_hash(ctx, sexp_complex_real(x), 3, 0) * 31
+      + sexp_lists_hash(ctx, sexp_complex_imag(x), 3, 0);
+#endif
+  if (code == 2)
+    return sexp_lists_mix((sexp_uint_t)x);
+  /* equiv? hashes as equal? from here on */
+  if (sexp_stringp(x))
+    return sexp_lists_hash_bytes(sexp_string_data(x), sexp_string_size(x));
+  if (sexp_bytesp(x))
+    return ~sexp_lists_hash_bytes(sexp_bytes_data(x), sexp_bytes_length(x));
+  if (sexp_lsymbolp(x))
+    return sexp_lists_mix((sexp_uint_t)x);
+  acc = sexp_pointer_tag(x);
+  if (depth > 0) {
+    if (sexp_pairp(x)) {
+      for (i=0; sexp_pairp(x) && i<SEXP_LISTS_HASH_BREADTH; i++, x=sexp_cdr(x))
+        acc = acc * 31 + sexp_lists_hash(ctx, sexp_car(x), code, depth-1);
+    } else if (sexp_vectorp(x)) {
+      len = sexp_vector_length(x);
+      acc = acc * 31 + len;
+      for (i=0; i<len && i<SEXP_LISTS_HASH_BREADTH; i++)
+        acc = acc * 31 + sexp_lists_hash(ctx, sexp_vector_ref(x, sexp_make_fixnum(i)), code, depth-1);
+    }
+  }
+  return acc;
+}
+
+/* Returns 1 if a and b are equivalent, 0 if not, and -1 if equiv? */
+/* couldn't decide within its bounds (e.g. for cyclic structures), */
+/* in which case the kernel gives up and returns #f. */
+static int sexp_lists_equiv (sexp ctx, int code, sexp a, sexp b) {
+  sexp res;
+  if (a == b)
+    return 1;
+  if (code == 1 || ! sexp_pointerp(a) || ! sexp_pointerp(b))
+    return 0;
+  if (code == 2 && ! sexp_numberp(a))
+    return 0;
+  if (code == 4) {
+    res = sexp_equalp_bound(ctx, NULL, 4, a, b, SEXP_LISTS_EQUIV_BOUND,
+                            SEXP_LISTS_EQUIV_BOUND);
+    return res == SEXP_FALSE ? 0 : sexp_unbox_fixnum(res) > 0 ? 1 : -1;
+  }
+  return sexp_truep(sexp_equalp(ctx, a, b));
+}
+
+static int sexp_lists_code (sexp code) {
+  if (sexp_fixnump(code) && sexp_unbox_fixnum(code) >= 1
+      && sexp_unbox_fixnum(code) <= 4)
+    return sexp_unbox_fixnum(code);
+  return 0;
+}
+
+static sexp_sint_t sexp_lists_length (sexp ctx, sexp ls) {
+  sexp_sint_t len = 0;
+  if (! sexp_truep(sexp_listp(ctx, ls)))
+    return -1;
+  for ( ; sexp_pairp(ls); ls=sexp_cdr(ls))
+    len++;
+  return len;
+}
+
+static sexp sexp_lists_make_table (sexp ctx, sexp_sint_t n) {
+  sexp_sint_t size = 8;
+  while (size < 2*n)
+    size *= 2;
+  return sexp_make_vector(ctx, sexp_make_fixnum(size*2), SEXP_FALSE);
+}
+
+#define sexp_lists_table_slots(t) (sexp_vector_length(t)/2)
+#define sexp_lists_table_hash(t, i) (sexp_vector_data(t)[(i)*2])
+#define sexp_lists_table_pair(t, i) (sexp_vector_data(t)[(i)*2+1])
+
+/* returns the pair whose car is equivalent to x, #f if none, */
+/* or void if that couldn't be decided */
+static sexp sexp_lists_lookup (sexp ctx, sexp table, int code, sexp x, sexp_uint_t h) {
+  sexp_uint_t i, mask = sexp_lists_table_slots(table) - 1;
+  sexp hash = sexp_make_fixnum(h & SEXP_MAX_FIXNUM);
+  int res;
+  for (i=h & mask; sexp_lists_table_pair(table, i) != SEXP_FALSE; i=(i+1) & mask)
+    if (sexp_lists_table_hash(table, i) == hash
+        && (res = sexp_lists_equiv(ctx, code, x, sexp_car(sexp_lists_table_pair(table, i)))))
+      return res > 0 ? sexp_lists_table_pair(table, i) : SEXP_VOID;
+  return SEXP_FALSE;
+}
+
+static void sexp_lists_insert (sexp table, sexp pair, sexp_uint_t h) {
+  sexp_uint_t i, mask = sexp_lists_table_slots(table) - 1;
+  for (i=h & mask; sexp_lists_table_pair(table, i) != SEXP_FALSE; i=(i+1) & mask)
+    ;
+  sexp_lists_table_hash(table, i) = sexp_make_fixnum(h & SEXP_MAX_FIXNUM);
+  sexp_lists_table_pair(table, i) = pair;
+}
+
+/* adds every pair of ls to the table */
+static void sexp_lists_insert_all (sexp ctx, sexp table, int code, sexp ls) {
+  for ( ; sexp_pairp(ls); ls=sexp_cdr(ls))
+    sexp_lists_insert(table, ls, sexp_lists_hash(ctx, sexp_car(ls), code, SEXP_LISTS_HASH_DEPTH));
+}
+
+/* appends x to the list being built in *res, with its last pair in *tail */
+static sexp sexp_lists_push (sexp ctx, sexp *res, sexp *tail, sexp x) {
+  sexp pair = sexp_cons(ctx, x, SEXP_NULL);
+  if (sexp_exceptionp(pair))
+    return pair;
+  if (sexp_pairp(*tail))
+    sexp_cdr(*tail) = pair;
+  else
+    *res = pair;
+  *tail = pair;
+  return SEXP_VOID;
+}
+
+/* Copies ls without the elements equivalent to x.  The tail after */
+/* the last deleted element is shared with ls. */
+sexp sexp_delete (sexp ctx, sexp self, sexp_sint_t n, sexp x, sexp ls, sexp code) {
+  int c = sexp_lists_code(code);
+  int e;
+  sexp start, tmp;
+  sexp_gc_var2(res, tail);
+  if (! c || sexp_lists_length(ctx, ls) < 0)
+    return SEXP_FALSE;
+  sexp_gc_preserve2(ctx, res, tail);
+  res = tail = SEXP_NULL;
+  for (start=ls; sexp_pairp(ls); ls=sexp_cdr(ls)) {
+    if ((e = sexp_lists_equiv(ctx, c, x, sexp_car(ls))) < 0) {
+      res = SEXP_FALSE;
+      goto done;
+    } else if (e) {
+      for ( ; start != ls; start=sexp_cdr(start)) {
+        tmp = sexp_lists_push(ctx, &res, &tail, sexp_car(start));
+        if (sexp_exceptionp(tmp)) {
+          res = tmp;
+          goto done;
+        }
+      }
+      start = sexp_cdr(ls);
+    }
+  }
+  if (sexp_pairp(tail))
+    sexp_cdr(tail) = start;
+  else
+    res = start;
+ done:
+  sexp_gc_release2(ctx);
+  return res;
+}
+
+sexp sexp_delete_duplicates (sexp ctx, sexp self, sexp_sint_t n, sexp ls, sexp code) {
+  int c = sexp_lists_code(code);
+  sexp_sint_t len = sexp_lists_length(ctx, ls);
+  sexp_uint_t h;
+  sexp tmp;
+  sexp_gc_var3(table, res, tail);
+  if (! c || len < 0)
+    return SEXP_FALSE;
+  sexp_gc_preserve3(ctx, table, res, tail);
+  res = tail = SEXP_NULL;
+  table = sexp_lists_make_table(ctx, len);
+  if (sexp_exceptionp(table)) {
+    res = table;
+  } else {
+    for ( ; sexp_pairp(ls); ls=sexp_cdr(ls)) {
+      h = sexp_lists_hash(ctx, sexp_car(ls), c, SEXP_LISTS_HASH_DEPTH);
+      tmp = sexp_lists_lookup(ctx, table, c, sexp_car(ls), h);
+      if (tmp == SEXP_VOID) {
+        res = SEXP_FALSE;
+        break;
+      } else if (tmp == SEXP_FALSE) {
+        sexp_lists_insert(table, ls, h);
+        tmp = sexp_lists_push(ctx, &res, &tail, sexp_car(ls));
+        if (sexp_exceptionp(tmp)) {
+          res = tmp;
+          break;
+        }
+      }
+    }
+  }
+  sexp_gc_release3(ctx);
+  return res;
+}
+
+/* Adds the elements of each later set not already present onto the */
+/* front of the first, as (reduce lset-union2 '() sets) would. */
+sexp sexp_lset_union (sexp ctx, sexp self, sexp_sint_t n, sexp code, sexp sets) {
+  int c = sexp_lists_code(code);
+  sexp_sint_t len, total = 0;
+  sexp_uint_t h;
+  sexp ls, tmp;
+  sexp_gc_var2(table, res);
+  if (! c || sexp_lists_length(ctx, sets) < 0)
+    return SEXP_FALSE;
+  for (ls=sets; sexp_pairp(ls); ls=sexp_cdr(ls)) {
+    if ((len = sexp_lists_length(ctx, sexp_car(ls))) < 0)
+      return SEXP_FALSE;
+    total += len;
+  }
+  if (! sexp_pairp(sets))
+    return SEXP_NULL;
+  sexp_gc_preserve2(ctx, table, res);
+  res = sexp_car(sets);
+  table = sexp_lists_make_table(ctx, total);
+  if (sexp_exceptionp(table)) {
+    res = table;
+  } else {
+    sexp_lists_insert_all(ctx, table, c, res);
+    for (sets=sexp_cdr(sets); sexp_pairp(sets); sets=sexp_cdr(sets)) {
+      for (ls=sexp_car(sets); sexp_pairp(ls); ls=sexp_cdr(ls)) {
+        h = sexp_lists_hash(ctx, sexp_car(ls), c, SEXP_LISTS_HASH_DEPTH);
+        tmp = sexp_lists_lookup(ctx, table, c, sexp_car(ls), h);
+        if (tmp == SEXP_VOID) {
+          res = SEXP_FALSE;
+          goto done;
+        } else if (tmp == SEXP_FALSE) {
+          tmp = sexp_cons(ctx, sexp_car(ls), res);
+          if (sexp_exceptionp(tmp)) {
+            res = tmp;
+            goto done;
+          }
+          res = tmp;
+          sexp_lists_insert(table, res, h);
+        }
+      }
+    }
+  }
+ done:
+  sexp_gc_release2(ctx);
+  return res;
+}
+
+/* Filters set by membership in each of the other sets, keeping the */
+/* members if keepp, or the non-members otherwise. */
+static sexp sexp_lset_filter (sexp ctx, int c, sexp set, sexp sets, int keepp) {
+  sexp_sint_t len;
+  sexp ls, tmp;
+  sexp_gc_var4(table, res, tail, acc);
+  if (sexp_lists_length(ctx, set) < 0 || sexp_lists_length(ctx, sets) < 0)
+    return SEXP_FALSE;
+  for (ls=sets; sexp_pairp(ls); ls=sexp_cdr(ls))
+    if (sexp_lists_length(ctx, sexp_car(ls)) < 0)
+      return SEXP_FALSE;
+  sexp_gc_preserve4(ctx, table, res, tail, acc);
+  acc = set;
+  for ( ; sexp_pairp(sets) && sexp_pairp(acc); sets=sexp_cdr(sets)) {
+    len = sexp_lists_length(ctx, sexp_car(sets));
+    table = sexp_lists_make_table(ctx, len);
+    if (sexp_exceptionp(table)) {
+      acc = table;
+      break;
+    }
+    sexp_lists_insert_all(ctx, table, c, sexp_car(sets));
+    res = tail = SEXP_NULL;
+    for (ls=acc; sexp_pairp(ls); ls=sexp_cdr(ls)) {
+      tmp = sexp_lists_lookup(ctx, table, c, sexp_car(ls),
+                              sexp_lists_hash(ctx, sexp_car(ls), c, SEXP_LISTS_HASH_DEPTH));
+      if (tmp == SEXP_VOID) {
+        res = SEXP_FALSE;
+        break;
+      } else if ((tmp != SEXP_FALSE) == keepp) {
+        tmp = sexp_lists_push(ctx, &res, &tail, sexp_car(ls));
+        if (sexp_exceptionp(tmp)) {
+          res = tmp;
+          break;
+        }
+      }
+    }
+    acc = res;
+    if (sexp_exceptionp(acc))
+      break;
+  }
+  sexp_gc_release4(ctx);
+  return acc;
+}
+
+sexp sexp_lset_intersection (sexp ctx, sexp self, sexp_sint_t n, sexp code, sexp set, sexp sets) {
+  int c = sexp_lists_code(code);
+  return c ? sexp_lset_filter(ctx, c, set, sets, 1) : SEXP_FALSE;
+}
+
+sexp sexp_lset_difference (sexp ctx, sexp self, sexp_sint_t n, sexp code, sexp set, sexp sets) {
+  int c = sexp_lists_code(code);
+  return c ? sexp_lset_filter(ctx, c, set, sets, 0) : SEXP_FALSE;
+}
+
+sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char* version, const sexp_abi_identifier_t abi) {
+  if (!(sexp_version_compatible(ctx, version, sexp_version)
+        && sexp_abi_compatible(ctx, abi, SEXP_ABI_IDENTIFIER)))
+    return SEXP_ABI_ERROR;
+  sexp_define_foreign(ctx, env, "%delete", 3, sexp_delete);
+  sexp_define_foreign(ctx, env, "%delete-duplicates", 2, sexp_delete_duplicates);
+  sexp_define_foreign(ctx, env, "%lset-union", 2, sexp_lset_union);
+  sexp_define_foreign(ctx, env, "%lset-intersection", 3, sexp_lset_intersection);
+  sexp_define_foreign(ctx, env, "%lset-difference", 3, sexp_lset_difference);
+  return SEXP_VOID;
+}
@@ -9,16 +9,21 @@
         (if (null? sets)
             #t
             (let ((set2 (car sets)))
-              (let lp2 ((ls set1))
-                (if (pair? ls)
-                    (and (member (car ls) set2 eq) (lp2 (cdr ls)))
-                    (lp1 set2 (cdr sets)))))))))
+              (cond
+               ((%lset-difference (%equivalence-code eq) set1 (list set2))
+                => (lambda (diff) (and (null? diff) (lp1 set2 (cdr sets)))))
+               (else
+                (let lp2 ((ls set1))
+                  (if (pair? ls)
+                      (and (member (car ls) set2 eq) (lp2 (cdr ls)))
+                      (lp1 set2 (cdr sets)))))))))))
 
 (define (lset= eq . sets)
   (and (apply lset<= eq sets) (apply lset<= eq (reverse sets))))
 
 (define (lset-adjoin eq set . elts)
-  (lset-union2 eq set elts))
+  (or (%lset-union (%equivalence-code eq) (list set elts))
+      (lset-union2 eq set elts)))
 
 (define (lset-union2 eq a b)
   (if (null? b)
@@ -26,19 +31,25 @@
       (lset-union2 eq (if (member (car b) a eq) a (cons (car b) a)) (cdr b))))
 
 (define (lset-union eq . sets)
-  (reduce (lambda (a b) (lset-union2 eq b a)) '() sets))
+  (or (%lset-union (%equivalence-code eq) sets)
+      (reduce (lambda (a b) (lset-union2 eq b a)) '() sets)))
 
 (define (lset-intersection eq . sets)
-  (reduce (lambda (a b) (filter (lambda (x) (member x a eq)) b)) '() sets))
+  (or (and (pair? sets)
+           (%lset-intersection (%equivalence-code eq) (car sets) (cdr sets)))
+      (reduce (lambda (a b) (filter (lambda (x) (member x a eq)) b)) '() sets)))
 
 (define (lset-diff2 eq a b)
   (remove (lambda (x) (member x a eq)) b))
 
 (define (lset-difference eq . sets)
-  (reduce (lambda (a b) (lset-diff2 eq a b)) '() sets))
+  (or (and (pair? sets)
+           (%lset-difference (%equivalence-code eq) (car sets) (cdr sets)))
+      (reduce (lambda (a b) (lset-diff2 eq a b)) '() sets)))
 
 (define (lset-xor eq . sets)
-  (reduce (lambda (a b) (append (lset-diff2 eq a b) (lset-diff2 eq b a)))
+  (reduce (lambda (a b)
+            (append (lset-difference eq b a) (lset-difference eq a b)))
           '()
           sets))
 
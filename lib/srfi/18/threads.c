@@ -82,6 +82,52 @@ sexp sexp_current_thread (sexp ctx, sexp self, sexp_sint_t n) {
   return ctx;
 }
 
+sexp sexp_thread_priority (sexp ctx, sexp self, sexp_sint_t n, sexp thread) {
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  return sexp_make_fixnum(sexp_context_priority(thread));
+}
+
+sexp sexp_thread_quantum (sexp ctx, sexp self, sexp_sint_t n, sexp thread) {
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  return sexp_make_fixnum(sexp_context_quantum(thread));
+}
+
+sexp sexp_thread_quantum_set (sexp ctx, sexp self, sexp_sint_t n, sexp thread, sexp quantum) {
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, quantum);
+  if (sexp_unbox_fixnum(quantum) < SEXP_MIN_QUANTUM)
+    return sexp_xtype_exception(ctx, self, "quantum too small", quantum);
+  sexp_context_quantum(thread) = sexp_unbox_fixnum(quantum);
+  if (sexp_context_refuel(thread) > 0) /* don't revive terminated threads */
+    sexp_context_refuel(thread) = sexp_context_quantum(thread);
+  return SEXP_VOID;
+}
+
+sexp sexp_thread_instruction_count (sexp ctx, sexp self, sexp_sint_t n, sexp thread) {
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  return sexp_make_unsigned_integer(ctx, sexp_context_steps(thread));
+}
+
+static sexp_uint_t sexp_now_usecs (void) {
+  struct timeval tval;
+  gettimeofday(&tval, NULL);
+  return (sexp_uint_t)tval.tv_sec * 1000000 + tval.tv_usec;
+}
+
+sexp sexp_thread_run_time (sexp ctx, sexp self, sexp_sint_t n, sexp thread) {
+  sexp_uint_t usecs;
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  usecs = sexp_context_usecs(thread);
+  /* include the current slice if we're asking about ourself */
+  if (thread == ctx && sexp_context_resumed(ctx) > 0)
+    usecs += sexp_now_usecs() - sexp_context_resumed(ctx);
+#if SEXP_USE_FLONUMS
+  return sexp_make_flonum(ctx, usecs / 1000000.0);
+#else
+  return sexp_make_unsigned_integer(ctx, usecs / 1000000);
+#endif
+}
+
 sexp sexp_make_thread (sexp ctx, sexp self, sexp_sint_t n, sexp thunk, sexp name) {
   sexp *stack;
   sexp_gc_var1(res);
@@ -109,20 +155,88 @@ sexp sexp_make_thread (sexp ctx, sexp self, sexp_sint_t n, sexp thunk, sexp name
   return res;
 }
 
+/* add a queue cell holding a runnable thread to the run queue, which */
+/* is kept ordered by priority, FIFO within the same priority */
+static void sexp_enqueue_thread (sexp ctx, sexp cell, int frontp) {
+  sexp ls1, ls2, front = sexp_global(ctx, SEXP_G_THREADS_FRONT),
+    back = sexp_global(ctx, SEXP_G_THREADS_BACK);
+  sexp_sint_t priority = sexp_context_priority(sexp_car(cell));
+  sexp_cdr(cell) = SEXP_NULL;
+  if (! sexp_pairp(back)) {        /* init queue */
+    sexp_global(ctx, SEXP_G_THREADS_BACK)
+      = sexp_global(ctx, SEXP_G_THREADS_FRONT) = cell;
+  } else if (frontp && priority >= sexp_context_priority(sexp_car(front))) {
+    sexp_cdr(cell) = front;
+    sexp_global(ctx, SEXP_G_THREADS_FRONT) = cell;
+  } else if (priority <= sexp_context_priority(sexp_car(back))) {
+    sexp_cdr(back) = cell;
+    sexp_global(ctx, SEXP_G_THREADS_BACK) = cell;
+  } else {      /* the back has lower priority, so we always find a spot */
+    for (ls1=SEXP_NULL, ls2=front;
+         sexp_context_priority(sexp_car(ls2)) >= priority;
+         ls1=ls2, ls2=sexp_cdr(ls2))
+      ;
+    sexp_cdr(cell) = ls2;
+    if (ls1 == SEXP_NULL)
+      sexp_global(ctx, SEXP_G_THREADS_FRONT) = cell;
+    else
+      sexp_cdr(ls1) = cell;
+  }
+}
+
+/* pop the queue cell at the front of the run queue, or () if empty */
+static sexp sexp_dequeue_thread (sexp ctx) {
+  sexp cell = sexp_global(ctx, SEXP_G_THREADS_FRONT);
+  if (sexp_pairp(cell)) {
+    sexp_global(ctx, SEXP_G_THREADS_FRONT) = sexp_cdr(cell);
+    if (! sexp_pairp(sexp_cdr(cell)))
+      sexp_global(ctx, SEXP_G_THREADS_BACK) = SEXP_NULL;
+    sexp_cdr(cell) = SEXP_NULL;
+  }
+  return cell;
+}
+
+/* remove the queue cell holding thread from the run queue, returning */
+/* the cell or () if the thread wasn't runnable */
+static sexp sexp_unqueue_thread (sexp ctx, sexp thread) {
+  sexp ls1, ls2;
+  for (ls1=SEXP_NULL, ls2=sexp_global(ctx, SEXP_G_THREADS_FRONT);
+       sexp_pairp(ls2) && sexp_car(ls2) != thread;
+       ls1=ls2, ls2=sexp_cdr(ls2))
+    ;
+  if (sexp_pairp(ls2)) {
+    if (ls1 == SEXP_NULL)
+      sexp_global(ctx, SEXP_G_THREADS_FRONT) = sexp_cdr(ls2);
+    else
+      sexp_cdr(ls1) = sexp_cdr(ls2);
+    if (ls2 == sexp_global(ctx, SEXP_G_THREADS_BACK))
+      sexp_global(ctx, SEXP_G_THREADS_BACK) = ls1;
+    sexp_cdr(ls2) = SEXP_NULL;
+  }
+  return ls2;
+}
+
 sexp sexp_thread_start (sexp ctx, sexp self, sexp_sint_t n, sexp thread) {
   sexp cell;
   sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
   sexp_context_errorp(thread) = 0;
   cell = sexp_cons(ctx, thread, SEXP_NULL);
-  if (sexp_pairp(sexp_global(ctx, SEXP_G_THREADS_BACK))) {
-    sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK)) = cell;
-    sexp_global(ctx, SEXP_G_THREADS_BACK) = cell;
-  } else {            /* init queue */
-    sexp_global(ctx, SEXP_G_THREADS_BACK) = sexp_global(ctx, SEXP_G_THREADS_FRONT) = cell;
-  }
+  sexp_enqueue_thread(ctx, cell, 0);
   return thread;
 }
 
+sexp sexp_thread_priority_set (sexp ctx, sexp self, sexp_sint_t n, sexp thread, sexp priority) {
+  sexp cell;
+  sexp_assert_type(ctx, sexp_contextp, SEXP_CONTEXT, thread);
+  sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, priority);
+  sexp_context_priority(thread) = sexp_unbox_fixnum(priority);
+  /* requeue the thread if it's runnable to keep the queue ordered */
+  cell = sexp_unqueue_thread(ctx, thread);
+  if (sexp_pairp(cell))
+    sexp_enqueue_thread(ctx, cell, 0);
+  return SEXP_VOID;
+}
+
 static int sexp_delete_list (sexp ctx, int global, sexp x) {
   sexp ls1=NULL, ls2=sexp_global(ctx, global);
   for ( ; sexp_pairp(ls2) && sexp_car(ls2) != x; ls1=ls2, ls2=sexp_cdr(ls2))
@@ -274,10 +388,7 @@ sexp sexp_mutex_unlock (sexp ctx, sexp self, sexp_sint_t n, sexp mutex, sexp con
           sexp_global(ctx, SEXP_G_THREADS_PAUSED) = sexp_cdr(ls2);
         else
           sexp_cdr(ls1) = sexp_cdr(ls2);
-        sexp_cdr(ls2) = sexp_global(ctx, SEXP_G_THREADS_FRONT);
-        sexp_global(ctx, SEXP_G_THREADS_FRONT) = ls2;
-        if (! sexp_pairp(sexp_cdr(ls2)))
-          sexp_global(ctx, SEXP_G_THREADS_BACK) = ls2;
+        sexp_enqueue_thread(ctx, ls2, 1);
         sexp_context_waitp(sexp_car(ls2))
           = sexp_context_timeoutp(sexp_car(ls2)) = 0;
         break;
@@ -303,10 +414,7 @@ sexp sexp_condition_variable_signal (sexp ctx, sexp self, sexp_sint_t n, sexp co
         sexp_global(ctx, SEXP_G_THREADS_PAUSED) = sexp_cdr(ls2);
       else
         sexp_cdr(ls1) = sexp_cdr(ls2);
-      sexp_cdr(ls2) = sexp_global(ctx, SEXP_G_THREADS_FRONT);
-      sexp_global(ctx, SEXP_G_THREADS_FRONT) = ls2;
-      if (! sexp_pairp(sexp_cdr(ls2)))
-        sexp_global(ctx, SEXP_G_THREADS_BACK) = ls2;
+      sexp_enqueue_thread(ctx, ls2, 1);
       sexp_context_waitp(sexp_car(ls2)) = sexp_context_timeoutp(sexp_car(ls2)) = 0;
       return SEXP_TRUE;
     }
@@ -422,11 +530,11 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
   struct timeval tval;
   struct pollfd *pfds;
   useconds_t usecs = 0;
+  sexp_uint_t now;
   sexp res, ls1, ls2, evt, runner, paused, front, pollfds;
   sexp_gc_var1(tmp);
   sexp_gc_preserve1(ctx, tmp);
 
-  front  = sexp_global(ctx, SEXP_G_THREADS_FRONT);
   paused = sexp_global(ctx, SEXP_G_THREADS_PAUSED);
 
   /* check signals */
@@ -439,8 +547,6 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
           runner = sexp_make_thread(ctx, self, 2, sexp_cdr(tmp), SEXP_FALSE);
           sexp_global(ctx, SEXP_G_THREADS_SIGNAL_RUNNER) = runner;
           sexp_thread_start(ctx, self, 1, runner);
-          if (!sexp_pairp(front))
-            front = sexp_global(ctx, SEXP_G_THREADS_FRONT);
         }
       }
     } else if (sexp_context_waitp(runner)) { /* wake it if it's sleeping */
@@ -450,6 +556,7 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
   }
 
   /* check blocked fds */
+ check_fds:
   pollfds = sexp_global(ctx, SEXP_G_THREADS_POLL_FDS);
   if (sexp_pollfdsp(ctx, pollfds) && sexp_pollfds_num_fds(pollfds) > 0) {
     pfds = sexp_pollfds_fds(pollfds);
@@ -479,15 +586,8 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
             else
               sexp_cdr(ls1) = sexp_cdr(ls2);
             tmp = sexp_cdr(ls2);
-            sexp_cdr(ls2) = SEXP_NULL;
-            if (sexp_car(ls2) != ctx) {
-              if (! sexp_pairp(sexp_global(ctx, SEXP_G_THREADS_BACK))) {
-                sexp_global(ctx, SEXP_G_THREADS_FRONT) = front = ls2;
-              } else {
-                sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK)) = ls2;
-              }
-              sexp_global(ctx, SEXP_G_THREADS_BACK) = ls2;
-            }
+            if (sexp_car(ls2) != ctx)
+              sexp_enqueue_thread(ctx, ls2, 0);
             ls2 = tmp;
           } else {
             ls1 = ls2;
@@ -513,13 +613,7 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
         else
           sexp_cdr(ls1) = sexp_cdr(ls2);
         tmp = sexp_cdr(ls2);
-        sexp_cdr(ls2) = SEXP_NULL;
-        if (! sexp_pairp(sexp_global(ctx, SEXP_G_THREADS_BACK))) {
-          sexp_global(ctx, SEXP_G_THREADS_FRONT) = front = ls2;
-        } else {
-          sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK)) = ls2;
-        }
-        sexp_global(ctx, SEXP_G_THREADS_BACK) = ls2;
+        sexp_enqueue_thread(ctx, ls2, 0);
         ls2 = tmp;
       } else {
         ls1 = ls2;
@@ -531,49 +625,36 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
   /* check timeouts */
   if (sexp_pairp(paused)) {
     if (gettimeofday(&tval, NULL) == 0) {
-      ls1 = SEXP_NULL;
       ls2 = paused;
       while (sexp_pairp(ls2) && sexp_context_before(sexp_car(ls2), tval)) {
         sexp_context_timeoutp(sexp_car(ls2)) = 1;
         sexp_context_waitp(sexp_car(ls2)) = 0;
         ls1 = ls2;
         ls2 = sexp_cdr(ls2);
+        sexp_enqueue_thread(ctx, ls1, 0);
       }
-      if (sexp_pairp(ls1)) {
-        sexp_cdr(ls1) = SEXP_NULL;
-        if (! sexp_pairp(sexp_global(ctx, SEXP_G_THREADS_BACK))) {
-          sexp_global(ctx, SEXP_G_THREADS_FRONT) = front = paused;
-        } else {
-          sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK)) = paused;
-        }
-        sexp_global(ctx, SEXP_G_THREADS_BACK) = ls1;
-        sexp_global(ctx, SEXP_G_THREADS_PAUSED) = paused = ls2;
-      }
+      sexp_global(ctx, SEXP_G_THREADS_PAUSED) = paused = ls2;
     }
   }
 
   /* dequeue next thread */
+  front = sexp_global(ctx, SEXP_G_THREADS_FRONT);
   if (sexp_pairp(front)) {
     res = sexp_car(front);
     if ((sexp_context_refuel(ctx) <= 0) || sexp_context_waitp(ctx)) {
       /* orig ctx is either terminated or paused */
-      sexp_global(ctx, SEXP_G_THREADS_FRONT) = sexp_cdr(front);
-      if (! sexp_pairp(sexp_cdr(front)))
-        sexp_global(ctx, SEXP_G_THREADS_BACK) = SEXP_NULL;
+      sexp_dequeue_thread(ctx);
       if (sexp_context_refuel(ctx) > 0 && sexp_not(sexp_memq(ctx, ctx, paused)))
         sexp_insert_timed(ctx, ctx, SEXP_FALSE);
       paused = sexp_global(ctx, SEXP_G_THREADS_PAUSED);
+    } else if (sexp_context_priority(ctx) > sexp_context_priority(res)) {
+      /* nothing runnable outranks us, keep going */
+      res = ctx;
     } else {
-      /* swap with front of queue */
-      sexp_car(sexp_global(ctx, SEXP_G_THREADS_FRONT)) = ctx;
-      /* rotate front of queue to back */
-      sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK))
-        = sexp_global(ctx, SEXP_G_THREADS_FRONT);
-      sexp_global(ctx, SEXP_G_THREADS_FRONT)
-        = sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_FRONT));
-      sexp_global(ctx, SEXP_G_THREADS_BACK)
-        = sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK));
-      sexp_cdr(sexp_global(ctx, SEXP_G_THREADS_BACK)) = SEXP_NULL;
+      /* swap with front of queue and requeue by priority */
+      sexp_dequeue_thread(ctx);
+      sexp_car(front) = ctx;
+      sexp_enqueue_thread(ctx, front, 0);
     }
   } else {
     /* no threads to dequeue */
@@ -617,12 +698,37 @@ sexp sexp_scheduler (sexp ctx, sexp self, sexp_sint_t n, sexp root_thread) {
           usecs += sexp_context_timeval(res).tv_usec - tval.tv_usec;
       }
     }
-    /* take a nap to avoid busy looping */
-    usleep(usecs);
+    /* take a nap to avoid busy looping, cut short if a blocked fd */
+    /* becomes ready, in which case we put the thread back and      */
+    /* reschedule so whoever was waiting on the fd can run          */
+    if (usecs > 0 && sexp_pollfdsp(ctx, pollfds)
+        && sexp_pollfds_num_fds(pollfds) > 0) {
+      if (poll(sexp_pollfds_fds(pollfds), sexp_pollfds_num_fds(pollfds),
+               (usecs + 999) / 1000) > 0) {
+        if (sexp_not(sexp_memq(ctx, res, paused)))
+          sexp_insert_timed(ctx, res,
+                            (sexp_context_timeval(res).tv_sec == 0
+                             && sexp_context_timeval(res).tv_usec == 0)
+                            ? SEXP_FALSE : res);
+        paused = sexp_global(ctx, SEXP_G_THREADS_PAUSED);
+        goto check_fds;
+      }
+    } else {
+      usleep(usecs);
+    }
     sexp_context_waitp(res) = 0;
     sexp_context_timeoutp(res) = 1;
   }
 
+  /* charge the time since it was resumed, minus naps, to the old thread */
+  if (res != ctx || usecs > 0) {
+    now = sexp_now_usecs();
+    if (sexp_context_resumed(ctx) > 0
+        && now > sexp_context_resumed(ctx) + usecs)
+      sexp_context_usecs(ctx) += now - sexp_context_resumed(ctx) - usecs;
+    sexp_context_resumed(res) = now;
+  }
+
   sexp_gc_release1(ctx);
   return res;
 }
@@ -668,6 +774,12 @@ sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char
   sexp_define_foreign(ctx, env, "%thread-join!", 2, sexp_thread_join);
   sexp_define_foreign(ctx, env, "%thread-sleep!", 1, sexp_thread_sleep);
   sexp_define_foreign(ctx, env, "thread-name", 1, sexp_thread_name);
+  sexp_define_foreign(ctx, env, "thread-priority", 1, sexp_thread_priority);
+  sexp_define_foreign(ctx, env, "thread-priority-set!", 2, sexp_thread_priority_set);
+  sexp_define_foreign(ctx, env, "thread-quantum", 1, sexp_thread_quantum);
+  sexp_define_foreign(ctx, env, "thread-quantum-set!", 2, sexp_thread_quantum_set);
+  sexp_define_foreign(ctx, env, "thread-instruction-count", 1, sexp_thread_instruction_count);
+  sexp_define_foreign(ctx, env, "thread-run-time", 1, sexp_thread_run_time);
   sexp_define_foreign(ctx, env, "thread-specific", 1, sexp_thread_specific);
   sexp_define_foreign(ctx, env, "thread-specific-set!", 2, sexp_thread_specific_set);
   sexp_define_foreign(ctx, env, "%thread-end-result", 1, sexp_thread_end_result);
@@ -685,6 +797,10 @@ sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char
   sexp_global(ctx, SEXP_G_THREADS_BLOCKER)
     = sexp_make_foreign(ctx, "blocker", 2, 0, "sexp_blocker", (sexp_proc1)sexp_blocker, SEXP_FALSE);
 
+  /* start the clock on the current thread */
+  if (sexp_context_resumed(ctx) == 0)
+    sexp_context_resumed(ctx) = sexp_now_usecs();
+
   /* remember the env to lookup the runner later */
   sexp_global(ctx, SEXP_G_THREADS_SIGNAL_RUNNER) = env;
 
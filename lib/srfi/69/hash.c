@@ -5,234 +5,464 @@
 #include <chibi/eval.h>
 
 #define HASH_DEPTH 5
+#define HASH_BREADTH 16
 #define HASH_BOUND sexp_make_fixnum(SEXP_MAX_FIXNUM)
 
-#define FNV_PRIME 16777619
-#define FNV_OFFSET_BASIS 2166136261uL
+/* Contents are hashed a word at a time with multiply-rotate rounds */
+/* in the style of xxHash, over two independent lanes so that long */
+/* strings keep the multiplier busy. */
 
-#define sexp_hash_table_buckets(x)  sexp_slot_ref(x, 0)
-#define sexp_hash_table_size(x)     sexp_slot_ref(x, 1)
-#define sexp_hash_table_hash_fn(x)  sexp_slot_ref(x, 2)
-#define sexp_hash_table_eq_fn(x)    sexp_slot_ref(x, 3)
+#if SEXP_64_BIT
+#define HASH_PRIME1 ((sexp_uint_t)0x9e3779b185ebca87ULL)
+#define HASH_PRIME2 ((sexp_uint_t)0xc2b2ae3d27d4eb4fULL)
+#define HASH_PRIME3 ((sexp_uint_t)0x165667b19e3779f9ULL)
+#define HASH_ROTATE 31
+#else
+#define HASH_PRIME1 0x9e3779b1UL
+#define HASH_PRIME2 0x85ebca77UL
+#define HASH_PRIME3 0xc2b2ae3dUL
+#define HASH_ROTATE 13
+#endif
+
+#define hash_rotl(x, r) (((x) << (r)) | ((x) >> (sizeof(sexp_uint_t)*8 - (r))))
+
+static sexp_uint_t hash_round (sexp_uint_t acc, sexp_uint_t w) {
+  acc += w * HASH_PRIME2;
+  acc = hash_rotl(acc, HASH_ROTATE);
+  return acc * HASH_PRIME1;
+}
+
+static sexp_uint_t hash_finish (sexp_uint_t acc) {
+#if SEXP_64_BIT
+  acc ^= acc >> 33;
+  acc *= HASH_PRIME2;
+  acc ^= acc >> 29;
+  acc *= HASH_PRIME3;
+  acc ^= acc >> 32;
+#else
+  acc ^= acc >> 15;
+  acc *= HASH_PRIME2;
+  acc ^= acc >> 13;
+  acc *= HASH_PRIME3;
+  acc ^= acc >> 16;
+#endif
+  return acc;
+}
+
+static sexp_uint_t hash_bytes (const char *p, sexp_uint_t len, sexp_uint_t seed) {
+  sexp_uint_t a = seed + HASH_PRIME1, b = seed - HASH_PRIME1, w, w2;
+  const sexp_uint_t n = len;
+  for ( ; len >= 2*sizeof(w); p += 2*sizeof(w), len -= 2*sizeof(w)) {
+    memcpy(&w, p, sizeof(w));
+    memcpy(&w2, p + sizeof(w), sizeof(w));
+    a = hash_round(a, w);
+    b = hash_round(b, w2);
+  }
+  if (len >= sizeof(w)) {
+    memcpy(&w, p, sizeof(w));
+    a = hash_round(a, w);
+    p += sizeof(w); len -= sizeof(w);
+  }
+  if (len > 0) {
+    w = 0;
+    memcpy(&w, p, len);
+    b = hash_round(b, w);
+  }
+  return hash_finish(a ^ hash_rotl(b, 17) ^ (n * HASH_PRIME3));
+}
+
+static sexp_uint_t hash_bytes_ci (const char *p, sexp_uint_t len, sexp_uint_t seed) {
+  char buf[64];
+  sexp_uint_t i, j, acc = seed;
+  for (i=0; i<len; i+=j) {
+    for (j=0; j<sizeof(buf) && i+j<len; j++)
+      buf[j] = sexp_tolower((unsigned char)p[i+j]);
+    acc = hash_bytes(buf, j, acc);
+  }
+  return acc;
+}
 
-#define sexp_hash_resize_check(n, len) (((n)*3) > ((len)>>2))
+/* Hashes are reduced modulo the bound, where a bound of 0 means */
+/* the default, the full fixnum range. */
 
-static sexp_uint_t string_hash (char *str, sexp_uint_t bound) {
-  sexp_uint_t acc = FNV_OFFSET_BASIS;
-  while (*str) {acc *= FNV_PRIME; acc ^= *str++;}
-  return acc % bound;
+#define sexp_check_hash_bound(ctx, self, bound)                         \
+  if (! sexp_fixnump(bound))                                            \
+    return sexp_type_exception(ctx, self, SEXP_FIXNUM, bound);          \
+  else if (sexp_unbox_fixnum(bound) < 0)                                \
+    return sexp_xtype_exception(ctx, self, "negative hash bound", bound)
+
+static sexp sexp_hash_bound (sexp_uint_t h, sexp bound) {
+  if (bound == SEXP_ZERO) bound = HASH_BOUND;
+  return sexp_make_fixnum(h % sexp_unbox_fixnum(bound));
 }
 
 sexp sexp_string_hash (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp bound) {
   if (! sexp_stringp(str))
     return sexp_type_exception(ctx, self, SEXP_STRING, str);
-  else if (! sexp_fixnump(bound))
-    return sexp_type_exception(ctx, self, SEXP_FIXNUM, bound);
-  return sexp_make_fixnum(string_hash(sexp_string_data(str),
-                                      sexp_unbox_fixnum(bound)));
-}
-
-static sexp_uint_t string_ci_hash (char *str, sexp_uint_t bound) {
-  sexp_uint_t acc = FNV_OFFSET_BASIS;
-  while (*str) {acc *= FNV_PRIME; acc ^= sexp_tolower(*str++);}
-  return acc % bound;
+  sexp_check_hash_bound(ctx, self, bound);
+  return sexp_hash_bound(hash_bytes(sexp_string_data(str), sexp_string_size(str), 0), bound);
 }
 
 sexp sexp_string_ci_hash (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp bound) {
   if (! sexp_stringp(str))
     return sexp_type_exception(ctx, self, SEXP_STRING, str);
-  else if (! sexp_fixnump(bound))
-    return sexp_type_exception(ctx, self, SEXP_FIXNUM, bound);
-  return sexp_make_fixnum(string_ci_hash(sexp_string_data(str),
-                                         sexp_unbox_fixnum(bound)));
+  sexp_check_hash_bound(ctx, self, bound);
+  return sexp_hash_bound(hash_bytes_ci(sexp_string_data(str), sexp_string_size(str), 0), bound);
 }
 
-static sexp_uint_t hash_one (sexp ctx, sexp obj, sexp_uint_t bound, sexp_sint_t depth) {
-  sexp_uint_t acc = FNV_OFFSET_BASIS, size;
+/* A structural hash consistent with equal?.  Strings, bytevectors */
+/* and symbols are hashed by their full contents.  Otherwise at most */
+/* HASH_BREADTH slots of each object are followed, to HASH_DEPTH */
+/* levels, so that hashing is bounded even for cyclic structures. */
+static sexp_uint_t hash_one (sexp ctx, sexp obj, sexp_sint_t depth) {
+  sexp_uint_t acc = 0, size;
   sexp_sint_t i, len;
   sexp t, *p;
   char *p0;
  loop:
-  if (obj) {
+  if (! obj) {
+    acc = hash_round(acc, 0);
 #if SEXP_USE_FLONUMS
-    if (sexp_flonump(obj))
-      acc ^= (sexp_sint_t) sexp_flonum_value(obj);
-    else
+  } else if (sexp_flonump(obj)) {
+    double f = sexp_flonum_value(obj);
+    acc = hash_bytes((char*)&f, sizeof(f), acc);
 #endif
-    if (sexp_pointerp(obj)) {
-      if (depth > 0) {
-        t = sexp_object_type(ctx, obj);
-        p = (sexp*) (((char*)obj) + sexp_type_field_base(t));
-        p0 = ((char*)obj) + offsetof(struct sexp_struct, value);
-        if ((sexp)p == obj) p=(sexp*)p0;
-        /* hash trailing non-object data */
-        size = sexp_type_size_of_object(t, obj)-offsetof(struct sexp_struct, value);
-        p0 = ((char*)p + sexp_type_num_slots_of_object(t,obj)*sizeof(sexp));
-        if (((char*)obj + size) > p0)
-          for (i=0; i<(sexp_sint_t)size; i++) {acc *= FNV_PRIME; acc ^= p0[i];}
-        /* hash eq-object slots */
-        len = sexp_type_num_eq_slots_of_object(t, obj);
-        if (len > 0) {
-          depth--;
-          for (i=0; i<len-1; i++) {
-            acc *= FNV_PRIME;
-            acc ^= hash_one(ctx, p[i], 0, depth);
-          }
-          /* tail-recurse on the last value */
-          obj = p[len-1]; goto loop;
-        }
-      } else {
-        acc ^= sexp_pointer_tag(obj);
-      }
-    } else {
-      acc ^= (sexp_uint_t)obj;
+  } else if (! sexp_pointerp(obj)) {
+    acc = hash_round(acc, (sexp_uint_t)obj);
+  } else if (sexp_stringp(obj)) {
+    acc = hash_bytes(sexp_string_data(obj), sexp_string_size(obj), acc);
+  } else if (sexp_bytesp(obj)) {
+    acc = hash_bytes(sexp_bytes_data(obj), sexp_bytes_length(obj), ~acc);
+  } else if (sexp_lsymbolp(obj)) {
+    acc = hash_bytes(sexp_lsymbol_data(obj), sexp_lsymbol_length(obj), acc + HASH_PRIME3);
+#if SEXP_USE_BIGNUMS
+  } else if (sexp_bignump(obj)) {
+    acc = hash_bytes((char*)sexp_bignum_data(obj),
+                     sexp_bignum_hi(obj)*sizeof(sexp_uint_t),
+                     acc + sexp_bignum_sign(obj));
+#endif
+  } else if (depth <= 0) {
+    acc = hash_round(acc, sexp_pointer_tag(obj));
+  } else {
+    acc = hash_round(acc, sexp_pointer_tag(obj));
+    t = sexp_object_type(ctx, obj);
+    p = (sexp*) (((char*)obj) + sexp_type_field_base(t));
+    p0 = ((char*)obj) + offsetof(struct sexp_struct, value);
+    if ((sexp)p == obj) p=(sexp*)p0;
+    /* hash trailing non-object data */
+    p0 = ((char*)p + sexp_type_num_slots_of_object(t,obj)*sizeof(sexp));
+    size = ((char*)obj + sexp_type_size_of_object(t, obj)) - p0;
+    if (((char*)obj + sexp_type_size_of_object(t, obj)) > p0)
+      acc = hash_bytes(p0, size, acc);
+    /* hash eq-object slots */
+    len = sexp_type_num_eq_slots_of_object(t, obj);
+    if (len > 0) {
+      acc = hash_round(acc, len);
+      if (len > HASH_BREADTH) len = HASH_BREADTH;
+      depth--;
+      for (i=0; i<len-1; i++)
+        acc = hash_round(acc, hash_one(ctx, p[i], depth));
+      /* tail-recurse on the last value */
+      obj = p[len-1]; goto loop;
     }
   }
-  return (bound ? acc % bound : acc);
+  return hash_finish(acc);
 }
 
 sexp sexp_hash (sexp ctx, sexp self, sexp_sint_t n, sexp obj, sexp bound) {
-  if (! sexp_exact_integerp(bound))
-    return sexp_type_exception(ctx, self, SEXP_FIXNUM, bound);
-  return sexp_make_fixnum(hash_one(ctx, obj, sexp_unbox_fixnum(bound), HASH_DEPTH));
+  sexp_check_hash_bound(ctx, self, bound);
+  return sexp_hash_bound(hash_one(ctx, obj, HASH_DEPTH), bound);
 }
 
 sexp sexp_hash_by_identity (sexp ctx, sexp self, sexp_sint_t n, sexp obj, sexp bound) {
-  if (! sexp_exact_integerp(bound))
-    return sexp_type_exception(ctx, self, SEXP_FIXNUM, bound);
-  return sexp_make_fixnum((sexp_uint_t)obj % sexp_unbox_fixnum(bound));
+  sexp_check_hash_bound(ctx, self, bound);
+  return sexp_hash_bound(sexp_identity_hash(obj), bound);
+}
+
+/* The record type is defined in Scheme, so check its name once and */
+/* remember the tag it was given. */
+static sexp_tag_t sexp_hash_table_tag = 0;
+
+static int sexp_hash_tablep (sexp ctx, sexp x) {
+  if (! sexp_pointerp(x))
+    return 0;
+  if (sexp_hash_table_tag && sexp_pointer_tag(x) == sexp_hash_table_tag)
+    return 1;
+  if (strcmp(sexp_string_data(sexp_object_type_name(ctx, x)), "Hash-Table") == 0) {
+    sexp_hash_table_tag = sexp_pointer_tag(x);
+    return 1;
+  }
+  return 0;
 }
 
-static sexp sexp_get_bucket (sexp ctx, sexp buckets, sexp hash_fn, sexp obj) {
+/* Tables are open-addressed with Robin Hood probing.  The entries */
+/* vector holds a (hash key value) triple per slot, with the hash */
+/* cached as a fixnum, #f in empty slots, and #t in slots which */
+/* have been deleted.  Deleted slots are never reused or shifted */
+/* over, so that deleting while walking the table is safe, and are */
+/* only cleared out when the table is rebuilt.  When the table */
+/* grows, the old entries are moved over a few slots at a time on */
+/* each insertion of a new key, and looked up until then. */
+
+#define SEXP_HT_MIGRATE_STEP 4
+
+#define sexp_ht_hash(v, i)  (sexp_vector_data(v)[(i)*3])
+#define sexp_ht_key(v, i)   (sexp_vector_data(v)[(i)*3+1])
+#define sexp_ht_value(v, i) (sexp_vector_data(v)[(i)*3+2])
+#define sexp_ht_slots(v)    (sexp_vector_length(v)/3)
+#define sexp_ht_dist(h, i, mask) (((i) - sexp_unbox_fixnum(h)) & (mask))
+
+static sexp_uint_t sexp_ht_mix (sexp_uint_t h) {
+#if SEXP_64_BIT
+  h ^= h >> 33;
+  h *= (sexp_uint_t)0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+#else
+  h ^= h >> 16;
+  h *= 0x85ebca6bUL;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35UL;
+  h ^= h >> 16;
+#endif
+  return h;
+}
+
+/* Tables compare keys with eq? if the equivalence function is 1, */
+/* with equal? if 2, and with string=? if 3, and likewise hash with */
+/* hash-by-identity, hash or string-hash. */
+
+static sexp sexp_ht_hash_key (sexp ctx, sexp self, sexp ht, sexp obj) {
   sexp_gc_var1(args);
-  sexp res;
-  sexp_uint_t len = sexp_vector_length(buckets);
-  if (hash_fn == SEXP_ONE)
-    res = sexp_hash_by_identity(ctx, NULL, 2, obj, sexp_make_fixnum(len));
-  else if (hash_fn == SEXP_TWO)
-    res = sexp_hash(ctx, NULL, 2, obj, sexp_make_fixnum(len));
-  else {
+  sexp res, hash_fn = sexp_hash_table_hash_fn(ht);
+  sexp_uint_t h;
+  if (hash_fn == SEXP_ONE) {
+    h = sexp_identity_hash(obj);
+  } else if (hash_fn == SEXP_TWO && ! sexp_pointerp(obj) && ! sexp_flonump(obj)) {
+    /* immediates are equal? only when eq?, so the mix below is enough */
+    h = (sexp_uint_t)obj;
+  } else if (hash_fn == SEXP_TWO) {
+    h = hash_one(ctx, obj, HASH_DEPTH);
+  } else if (hash_fn == SEXP_THREE) {
+    if (! sexp_stringp(obj))
+      return sexp_type_exception(ctx, self, SEXP_STRING, obj);
+    h = hash_bytes(sexp_string_data(obj), sexp_string_size(obj), 0);
+  } else {
     sexp_gc_preserve1(ctx, args);
-    args = sexp_list2(ctx, obj, sexp_make_fixnum(len));
-    res = sexp_apply(ctx, hash_fn, args);
+    res = sexp_apply2(ctx, hash_fn, obj, HASH_BOUND);
     if (sexp_exceptionp(res)) {
       args = sexp_eval_string(ctx, "(current-error-port)", -1, sexp_context_env(ctx));
       sexp_print_exception(ctx, res, args);
-      res = SEXP_ZERO;
-    } else if ((sexp_uint_t)sexp_unbox_fixnum(res) >= len) {
-      res = SEXP_ZERO;
+      h = 0;
+    } else {
+      h = sexp_fixnump(res) ? sexp_unbox_fixnum(res) : 0;
     }
     sexp_gc_release1(ctx);
   }
+  return sexp_make_fixnum(sexp_ht_mix(h) & SEXP_MAX_FIXNUM);
+}
+
+static sexp sexp_ht_key_equal (sexp ctx, sexp eq_fn, sexp a, sexp b) {
+  sexp res;
+  if (eq_fn == SEXP_ONE) {
+    res = sexp_make_boolean(a == b);
+  } else if (eq_fn == SEXP_TWO) {
+    if (a == b)
+      res = SEXP_TRUE;
+    else if (!sexp_pointerp(a) || !sexp_pointerp(b) || sexp_lsymbolp(a))
+      res = SEXP_FALSE;
+    else
+      res = sexp_equalp(ctx, a, b);
+  } else if (eq_fn == SEXP_THREE) {
+    res = sexp_make_boolean(sexp_string_size(a) == sexp_string_size(b)
+                            && memcmp(sexp_string_data(a), sexp_string_data(b),
+                                      sexp_string_size(a)) == 0);
+  } else {
+    res = sexp_apply2(ctx, eq_fn, a, b);
+  }
   return res;
 }
 
-static sexp sexp_scan_bucket (sexp ctx, sexp ls, sexp obj, sexp eq_fn) {
-  sexp_gc_var1(res);
-  sexp p;
-  res = SEXP_FALSE;
-  if ((eq_fn == SEXP_ONE)
-      || ((eq_fn == SEXP_TWO)
-          && (sexp_pointerp(obj) ?
-              (sexp_pointer_tag(obj) == SEXP_SYMBOL) : ! sexp_fixnump(obj)))) {
-    for (p=ls; sexp_pairp(p); p=sexp_cdr(p)) {
-      if (sexp_caar(p) == obj) {
-        res = p;
+/* returns the slot of key in vec, -1 if not found, or an exception */
+/* raised by the equivalence function in *err */
+static sexp_sint_t sexp_ht_find (sexp ctx, sexp eq_fn, sexp vec, sexp hash, sexp key, sexp *err) {
+  sexp_uint_t i, d, mask;
+  sexp h, res;
+  sexp_gc_var1(v);
+  sexp_gc_preserve1(ctx, v);
+  v = vec;
+  mask = sexp_ht_slots(v) - 1;
+  for (i=sexp_unbox_fixnum(hash) & mask, d=0; ; i=(i+1) & mask, d++) {
+    h = sexp_ht_hash(v, i);
+    if (h == SEXP_FALSE || (h != SEXP_TRUE && sexp_ht_dist(h, i, mask) < d))
+      break;
+    if (h == hash) {
+      res = sexp_ht_key_equal(ctx, eq_fn, key, sexp_ht_key(v, i));
+      if (sexp_exceptionp(res)) {
+        *err = res;
         break;
+      } else if (sexp_truep(res)) {
+        sexp_gc_release1(ctx);
+        return i;
       }
     }
-  } else if (eq_fn == SEXP_TWO) {
-    for (p=ls; sexp_pairp(p); p=sexp_cdr(p)) {
-      if (sexp_truep(sexp_equalp(ctx, sexp_caar(p), obj))) {
-        res = p;
-        break;
-      }
+  }
+  sexp_gc_release1(ctx);
+  return -1;
+}
+
+/* adds a key known to be absent to vec, returning its slot */
+static sexp_uint_t sexp_ht_insert (sexp vec, sexp hash, sexp key, sexp value) {
+  sexp_uint_t i, d, e, mask, res = (sexp_uint_t)-1;
+  sexp tmp;
+  mask = sexp_ht_slots(vec) - 1;
+  for (i=sexp_unbox_fixnum(hash) & mask, d=0; ; i=(i+1) & mask, d++) {
+    if (sexp_ht_hash(vec, i) == SEXP_FALSE) {
+      sexp_ht_hash(vec, i) = hash;
+      sexp_ht_key(vec, i) = key;
+      sexp_ht_value(vec, i) = value;
+      return res == (sexp_uint_t)-1 ? i : res;
     }
-  } else {
-    sexp_gc_preserve1(ctx, res);
-    for (p=ls; sexp_pairp(p); p=sexp_cdr(p)) {
-      res = sexp_list2(ctx, sexp_caar(p), obj);
-      if (sexp_truep(sexp_apply(ctx, eq_fn, res))) {
-        res = p;
-        break;
-      } else {
-        res = SEXP_FALSE;
-      }
+    if (sexp_ht_hash(vec, i) == SEXP_TRUE)
+      continue;
+    e = sexp_ht_dist(sexp_ht_hash(vec, i), i, mask);
+    if (e < d) {
+      /* steal the slot from the richer entry and carry it onwards */
+      tmp = sexp_ht_hash(vec, i); sexp_ht_hash(vec, i) = hash; hash = tmp;
+      tmp = sexp_ht_key(vec, i); sexp_ht_key(vec, i) = key; key = tmp;
+      tmp = sexp_ht_value(vec, i); sexp_ht_value(vec, i) = value; value = tmp;
+      if (res == (sexp_uint_t)-1) res = i;
+      d = e;
     }
-    sexp_gc_release1(ctx);
   }
-  return res;
 }
 
-static void sexp_regrow_hash_table (sexp ctx, sexp ht, sexp oldbuckets, sexp hash_fn) {
-  sexp ls, *oldvec, *newvec;
-  int i, j, oldsize=sexp_vector_length(oldbuckets), newsize=oldsize*2;
-  sexp_gc_var1(newbuckets);
-  sexp_gc_preserve1(ctx, newbuckets);
-  newbuckets = sexp_make_vector(ctx, sexp_make_fixnum(newsize), SEXP_NULL);
-  if (newbuckets) {
-    oldvec = sexp_vector_data(oldbuckets);
-    newvec = sexp_vector_data(newbuckets);
-    for (i=0; i<oldsize; i++) {
-      for (ls=oldvec[i]; sexp_pairp(ls); ls=sexp_cdr(ls)) {
-        j = sexp_unbox_fixnum(sexp_get_bucket(ctx, newbuckets, hash_fn, sexp_caar(ls)));
-        sexp_push(ctx, newvec[j], sexp_car(ls));
-      }
+/* marks slot i of vec as deleted */
+static void sexp_ht_remove (sexp vec, sexp_uint_t i) {
+  sexp_ht_hash(vec, i) = SEXP_TRUE;
+  sexp_ht_key(vec, i) = sexp_ht_value(vec, i) = SEXP_FALSE;
+}
+
+/* moves up to n slots of the old entries into the current ones */
+static void sexp_ht_migrate (sexp ht, sexp_uint_t n) {
+  sexp old = sexp_hash_table_old_entries(ht), vec = sexp_hash_table_entries(ht);
+  sexp_uint_t i, len;
+  if (! sexp_vectorp(old))
+    return;
+  len = sexp_ht_slots(old);
+  for (i=sexp_unbox_fixnum(sexp_hash_table_migrated(ht)); n > 0 && i < len; i++, n--) {
+    if (sexp_fixnump(sexp_ht_hash(old, i))) {
+      sexp_ht_insert(vec, sexp_ht_hash(old, i), sexp_ht_key(old, i),
+                     sexp_ht_value(old, i));
+      sexp_ht_remove(old, i);
     }
-    sexp_hash_table_buckets(ht) = newbuckets;
   }
-  sexp_gc_release1(ctx);
+  if (i < len) {
+    sexp_hash_table_migrated(ht) = sexp_make_fixnum(i);
+  } else {
+    sexp_hash_table_old_entries(ht) = SEXP_FALSE;
+    sexp_hash_table_migrated(ht) = SEXP_ZERO;
+  }
+}
+
+static sexp sexp_ht_lookup (sexp ctx, sexp ht, sexp hash, sexp obj) {
+  sexp err = SEXP_FALSE;
+  sexp_sint_t i;
+  i = sexp_ht_find(ctx, sexp_hash_table_eq_fn(ht), sexp_hash_table_entries(ht), hash, obj, &err);
+  if (i >= 0)
+    return sexp_make_fixnum(i*3+2);
+  if (sexp_vectorp(sexp_hash_table_old_entries(ht)) && ! sexp_exceptionp(err)) {
+    i = sexp_ht_find(ctx, sexp_hash_table_eq_fn(ht), sexp_hash_table_old_entries(ht), hash, obj, &err);
+    if (i >= 0)
+      return sexp_make_fixnum(-(i*3+2)-1);
+  }
+  return err;
+}
+
+/* Returns the index of the value of obj in the entries vector, */
+/* or in the old entries as -index-1 while the table is growing, */
+/* or #f if obj isn't in the table.  Values are fetched in Scheme */
+/* with vector-ref so that they can be anything, even exceptions. */
+sexp sexp_hash_table_index (sexp ctx, sexp self, sexp_sint_t n, sexp ht, sexp obj) {
+  sexp hash;
+  if (! sexp_hash_tablep(ctx, ht))
+    return sexp_xtype_exception(ctx, self, "not a Hash-Table", ht);
+  hash = sexp_ht_hash_key(ctx, self, ht, obj);
+  if (sexp_exceptionp(hash))
+    return hash;
+  return sexp_ht_lookup(ctx, ht, hash, obj);
 }
 
-sexp sexp_hash_table_cell (sexp ctx, sexp self, sexp_sint_t n, sexp ht, sexp obj, sexp createp) {
-  sexp buckets, eq_fn, hash_fn, i;
-  sexp_uint_t size;
-  sexp_gc_var1(res);
-  /* extra check - exact type should be checked by the calling procedure */
-  if (! sexp_pointerp(ht))
+/* As above but adds obj with an unspecified value if not found. */
+sexp sexp_hash_table_insert (sexp ctx, sexp self, sexp_sint_t n, sexp ht, sexp obj) {
+  sexp hash, res;
+  sexp_uint_t size, used, slots;
+  sexp_gc_var1(vec);
+  if (! sexp_hash_tablep(ctx, ht))
     return sexp_xtype_exception(ctx, self, "not a Hash-Table", ht);
-  buckets = sexp_hash_table_buckets(ht);
-  eq_fn = sexp_hash_table_eq_fn(ht);
-  hash_fn = sexp_hash_table_hash_fn(ht);
-  i = sexp_get_bucket(ctx, buckets, hash_fn, obj);
-  res = sexp_scan_bucket(ctx, sexp_vector_ref(buckets, i), obj, eq_fn);
-  if (sexp_truep(res)) {
-    res = sexp_car(res);
-  } else if (sexp_truep(createp)) {
-    sexp_gc_preserve1(ctx, res);
-    size = sexp_unbox_fixnum(sexp_hash_table_size(ht));
-    if (sexp_hash_resize_check(size, sexp_vector_length(buckets))) {
-      sexp_regrow_hash_table(ctx, ht, buckets, hash_fn);
-      buckets = sexp_hash_table_buckets(ht);
-      i = sexp_get_bucket(ctx, buckets, hash_fn, obj);
+  hash = sexp_ht_hash_key(ctx, self, ht, obj);
+  if (sexp_exceptionp(hash))
+    return hash;
+  res = sexp_ht_lookup(ctx, ht, hash, obj);
+  if (res != SEXP_FALSE)
+    return res;
+  size = sexp_unbox_fixnum(sexp_hash_table_size(ht));
+  used = size + sexp_unbox_fixnum(sexp_hash_table_deleted(ht));
+  slots = sexp_ht_slots(sexp_hash_table_entries(ht));
+  if ((used+1)*4 > slots*3) {
+    /* finish any previous growth and start moving to a new vector, */
+    /* twice the size unless it's mostly filled with deleted slots */
+    if ((size+1)*2 > slots)
+      slots *= 2;
+    sexp_gc_preserve1(ctx, vec);
+    vec = sexp_make_vector(ctx, sexp_make_fixnum(slots*3), SEXP_FALSE);
+    if (sexp_exceptionp(vec)) {
+      sexp_gc_release1(ctx);
+      return vec;
     }
-    res = sexp_cons(ctx, obj, createp);
-    sexp_vector_set(buckets, i, sexp_cons(ctx, res, sexp_vector_ref(buckets, i)));
-    sexp_hash_table_size(ht) = sexp_make_fixnum(size+1);
+    sexp_ht_migrate(ht, (sexp_uint_t)-1);
+    sexp_hash_table_old_entries(ht) = sexp_hash_table_entries(ht);
+    sexp_hash_table_migrated(ht) = SEXP_ZERO;
+    sexp_hash_table_entries(ht) = vec;
+    sexp_hash_table_deleted(ht) = SEXP_ZERO;
     sexp_gc_release1(ctx);
   }
-  return res;
+  sexp_ht_migrate(ht, SEXP_HT_MIGRATE_STEP);
+  /* re-read the size, a gc above may have removed weak entries */
+  sexp_hash_table_size(ht) = sexp_fx_add(sexp_hash_table_size(ht), SEXP_ONE);
+  return sexp_make_fixnum(sexp_ht_insert(sexp_hash_table_entries(ht), hash, obj, SEXP_VOID)*3+2);
 }
 
 sexp sexp_hash_table_delete (sexp ctx, sexp self, sexp_sint_t n, sexp ht, sexp obj) {
-  sexp buckets, eq_fn, hash_fn, i, p, res;
-  if (!(sexp_pointerp(ht) && strcmp(sexp_string_data(sexp_object_type_name(ctx, ht)), "Hash-Table") == 0))
-    return sexp_xtype_exception(ctx, self, "not a Hash-Table", ht);
-  buckets = sexp_hash_table_buckets(ht);
-  eq_fn = sexp_hash_table_eq_fn(ht);
-  hash_fn = sexp_hash_table_hash_fn(ht);
-  i = sexp_get_bucket(ctx, buckets, hash_fn, obj);
-  res = sexp_scan_bucket(ctx, sexp_vector_ref(buckets, i), obj, eq_fn);
-  if (sexp_pairp(res)) {
-    sexp_hash_table_size(ht) = sexp_fx_sub(sexp_hash_table_size(ht), SEXP_ONE);
-    if (res == sexp_vector_ref(buckets, i)) {
-      sexp_vector_set(buckets, i, sexp_cdr(res));
+  sexp i = sexp_hash_table_index(ctx, self, n, ht, obj);
+  sexp_sint_t j;
+  if (sexp_fixnump(i)) {
+    j = sexp_unbox_fixnum(i);
+    if (j >= 0) {
+      sexp_ht_remove(sexp_hash_table_entries(ht), j/3);
+      sexp_hash_table_deleted(ht) = sexp_fx_add(sexp_hash_table_deleted(ht), SEXP_ONE);
     } else {
-      for (p=sexp_vector_ref(buckets, i); sexp_cdr(p)!=res; p=sexp_cdr(p))
-        ;
-      sexp_cdr(p) = sexp_cdr(res);
+      sexp_ht_remove(sexp_hash_table_old_entries(ht), (-j-1)/3);
     }
+    sexp_hash_table_size(ht) = sexp_fx_sub(sexp_hash_table_size(ht), SEXP_ONE);
+    i = SEXP_VOID;
   }
+  return sexp_exceptionp(i) ? i : SEXP_VOID;
+}
+
+/* Registers a table with weak keys or values to be cleaned out */
+/* by the gc.  Without weak reference support the table stays strong. */
+sexp sexp_hash_table_register_weak (sexp ctx, sexp self, sexp_sint_t n, sexp ht) {
+#if SEXP_USE_WEAK_REFERENCES
+  sexp ls;
+#endif
+  if (! sexp_hash_tablep(ctx, ht))
+    return sexp_xtype_exception(ctx, self, "not a Hash-Table", ht);
+#if SEXP_USE_WEAK_REFERENCES
+  ls = sexp_cons(ctx, ht, sexp_global(ctx, SEXP_G_WEAK_TABLES));
+  if (sexp_exceptionp(ls))
+    return ls;
+  sexp_global(ctx, SEXP_G_WEAK_TABLES) = ls;
+#endif
   return SEXP_VOID;
 }
 
@@ -245,8 +475,10 @@ sexp sexp_init_library (sexp ctx, sexp self, sexp_sint_t n, sexp env, const char
   sexp_define_foreign_opt(ctx, env, "string-ci-hash", 2, sexp_string_ci_hash, HASH_BOUND);
   sexp_define_foreign_opt(ctx, env, "hash", 2, sexp_hash, HASH_BOUND);
   sexp_define_foreign_opt(ctx, env, "hash-by-identity", 2, sexp_hash_by_identity, HASH_BOUND);
-  sexp_define_foreign(ctx, env, "hash-table-cell", 3, sexp_hash_table_cell);
+  sexp_define_foreign(ctx, env, "%hash-table-index", 2, sexp_hash_table_index);
+  sexp_define_foreign(ctx, env, "%hash-table-insert!", 2, sexp_hash_table_insert);
   sexp_define_foreign(ctx, env, "hash-table-delete!", 2, sexp_hash_table_delete);
+  sexp_define_foreign(ctx, env, "%hash-table-register-weak!", 1, sexp_hash_table_register_weak);
 
   return SEXP_VOID;
 }
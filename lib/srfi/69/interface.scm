@@ -2,32 +2,75 @@
 ;; Copyright (c) 2009-2011 Alex Shinn.  All rights reserved.
 ;; BSD-style license: http://synthcode.com/license.txt
 
-;; the non-exported hash-table-cell is the heart of the implemenation
+;; The tables themselves are implemented in hash.c, where
+;; %hash-table-index and %hash-table-insert! return the index of a
+;; key's value in the entries vector, or in the old entries as a
+;; negative -index-1 while the table is growing.
+
+;; Any arguments after the hash function can request a weak table, as
+;; in SRFI 125: with 'weak-keys or 'weak-values an entry is removed
+;; once its key or value is otherwise unreachable, and with
+;; 'ephemeral-keys the value is only kept alive through its key, so
+;; it may refer back to the key.  The weakness is stored as the sum
+;; of the flags SEXP_WEAK_KEYS, SEXP_WEAK_VALUES and
+;; SEXP_EPHEMERAL_KEYS from sexp.h.
+
+(define (%hash-table-weakness-flags ls)
+  (+ (if (memq 'weak-keys ls) 1 0)
+     (if (memq 'weak-values ls) 2 0)
+     (if (memq 'ephemeral-keys ls) 4 0)))
 
 (define (make-hash-table . o)
   (let* ((eq-fn (if (pair? o) (car o) equal?))
          (hash-fn (if (and (pair? o) (pair? (cdr o)))
                       (car (cdr o))
-                      (if (eq? eq? eq-fn) hash-by-identity hash))))
+                      (cond ((eq? eq? eq-fn) hash-by-identity)
+                            ((eq? string=? eq-fn) string-hash)
+                            (else hash))))
+         (weakness (if (and (pair? o) (pair? (cdr o)))
+                       (%hash-table-weakness-flags (cddr o))
+                       0))
+         (string-keys? (and (eq? eq-fn string=?) (eq? hash-fn string-hash))))
     (cond
      ((not (procedure? eq-fn))
       (error "make-hash-table: bad equivalence function" eq-fn))
      ((not (procedure? hash-fn))
       (error "make-hash-table: bad hash function" hash-fn))
      (else
-      (%make-hash-table
-       (make-vector 23 '())
-       0
-       (if (eq? hash-fn hash-by-identity) 1 (if (eq? hash-fn hash) 2 hash-fn))
-       (if (eq? eq-fn eq?) 1 (if (eq? eq-fn equal?) 2 eq-fn)))))))
+      (let ((table
+             (%make-hash-table
+              (make-vector 48 #f)
+              0
+              (cond ((eq? hash-fn hash-by-identity) 1)
+                    ((eq? hash-fn hash) 2)
+                    (string-keys? 3)
+                    (else hash-fn))
+              (cond ((eq? eq-fn eq?) 1)
+                    ((eq? eq-fn equal?) 2)
+                    (string-keys? 3)
+                    (else eq-fn))
+              #f
+              0
+              0
+              weakness)))
+        (if (positive? weakness)
+            (%hash-table-register-weak! table))
+        table)))))
+
+;; the list of weakness options the table was created with
+(define (hash-table-weakness table)
+  (let ((flags (%hash-table-weakness table)))
+    (append (if (odd? flags) '(weak-keys) '())
+            (if (odd? (quotient flags 2)) '(weak-values) '())
+            (if (>= flags 4) '(ephemeral-keys) '()))))
 
 (define (hash-table-hash-function table)
   (let ((f (%hash-table-hash-function table)))
-    (case f ((1) hash-by-identity) ((2) hash) (else f))))
+    (case f ((1) hash-by-identity) ((2) hash) ((3) string-hash) (else f))))
 
 (define (hash-table-equivalence-function table)
   (let ((f (%hash-table-equivalence-function table)))
-    (case f ((1) eq?) ((2) equal?) (else f))))
+    (case f ((1) eq?) ((2) equal?) ((3) string=?) (else f))))
 
 (define-syntax assert-hash-table
   (syntax-rules ()
@@ -35,57 +78,90 @@
      (if (not (hash-table? obj))
          (error (string-append from ": not a Hash-Table") obj)))))
 
+(define-syntax %hash-table-value
+  (syntax-rules ()
+    ((%hash-table-value table i)
+     (if (< i 0)
+         (vector-ref (hash-table-old-entries table) (- -1 i))
+         (vector-ref (hash-table-entries table) i)))))
+
+(define-syntax %hash-table-value-set!
+  (syntax-rules ()
+    ((%hash-table-value-set! table i value)
+     (if (< i 0)
+         (vector-set! (hash-table-old-entries table) (- -1 i) value)
+         (vector-set! (hash-table-entries table) i value)))))
+
 (define (hash-table-ref table key . o)
   (assert-hash-table "hash-table-ref" table)
-  (let ((cell (hash-table-cell table key #f)))
-    (cond (cell (cdr cell))
+  (let ((i (%hash-table-index table key)))
+    (cond (i (%hash-table-value table i))
           ((pair? o) ((car o)))
           (else (error "hash-table-ref: key not found" key)))))
 
 (define (hash-table-ref/default table key default)
   (assert-hash-table "hash-table-ref/default" table)
-  (let ((cell (hash-table-cell table key #f)))
-    (if cell (cdr cell) default)))
+  (let ((i (%hash-table-index table key)))
+    (if i (%hash-table-value table i) default)))
 
 (define (hash-table-set! table key value)
   (assert-hash-table "hash-table-set!" table)
-  (let ((cell (hash-table-cell table key #t)))
-    (set-cdr! cell value)))
+  (let ((i (%hash-table-insert! table key)))
+    (%hash-table-value-set! table i value)))
 
 (define (hash-table-exists? table key)
   (assert-hash-table "hash-table-exists?" table)
-  (and (hash-table-cell table key #f) #t))
-
-(define hash-table-update!
-  (let ((not-found (cons 'not-found '())))
-    (lambda (table key func . o)
-      (assert-hash-table "hash-table-update!" table)
-      (let ((cell (hash-table-cell table key not-found)))
-        (set-cdr! cell (if (eq? not-found (cdr cell))
-                           (if (pair? o)
-                               (func ((car o)))
-                               (error "hash-table-update!: key not found" key))
-                           (func (cdr cell))))))))
-
-(define hash-table-update!/default
-  (let ((not-found (cons 'not-found '())))
-    (lambda (table key func default)
-      (assert-hash-table "hash-table-update!/default" table)
-      (let ((cell (hash-table-cell table key not-found)))
-        (set-cdr! cell (func (if (eq? not-found (cdr cell)) default (cdr cell))))))))
+  (and (%hash-table-index table key) #t))
+
+;; func may modify the table, so the value is stored in place only if
+;; the key is still at the same index, otherwise it's looked up again
+(define (%hash-table-update! table key func thunk)
+  (let* ((i (%hash-table-index table key))
+         (vec (and i (if (< i 0)
+                         (hash-table-old-entries table)
+                         (hash-table-entries table))))
+         (j (and i (if (< i 0) (- -1 i) i)))
+         (k (and i (vector-ref vec (- j 1))))
+         (value (func (if i (vector-ref vec j) (thunk)))))
+    (if (and i
+             (fixnum? (vector-ref vec (- j 2)))
+             (eq? k (vector-ref vec (- j 1))))
+        (vector-set! vec j value)
+        (let ((i (%hash-table-insert! table key)))
+          (%hash-table-value-set! table i value)))))
+
+(define (hash-table-update! table key func . o)
+  (assert-hash-table "hash-table-update!" table)
+  (%hash-table-update!
+   table key func
+   (lambda ()
+     (if (pair? o)
+         ((car o))
+         (error "hash-table-update!: key not found" key)))))
+
+(define (hash-table-update!/default table key func default)
+  (assert-hash-table "hash-table-update!/default" table)
+  (%hash-table-update! table key func (lambda () default)))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
+(define (%hash-table-fold-entries vec kons acc)
+  (if (vector? vec)
+      (let lp ((i (- (vector-length vec) 3)) (acc acc))
+        (cond
+         ((< i 0) acc)
+         ((fixnum? (vector-ref vec i))
+          (lp (- i 3)
+              (kons (vector-ref vec (+ i 1)) (vector-ref vec (+ i 2)) acc)))
+         (else (lp (- i 3) acc))))
+      acc))
+
 (define (hash-table-fold table kons knil)
   (assert-hash-table "hash-table-fold" table)
-  (let ((vec (hash-table-buckets table)))
-    (let lp1 ((i (- (vector-length vec) 1)) (acc knil))
-      (if (< i 0)
-          acc
-          (let lp2 ((ls (vector-ref vec i)) (acc acc))
-            (if (null? ls)
-                (lp1 (- i 1) acc)
-                (lp2 (cdr ls) (kons (car (car ls)) (cdr (car ls)) acc))))))))
+  (%hash-table-fold-entries
+   (hash-table-old-entries table)
+   kons
+   (%hash-table-fold-entries (hash-table-entries table) kons knil)))
 
 (define (hash-table-walk table proc)
   (hash-table-fold table (lambda (k v a) (proc k v)) #f)
@@ -111,7 +187,9 @@
 
 (define (hash-table-copy table)
   (assert-hash-table "hash-table-copy" table)
-  (let ((res (make-hash-table (hash-table-equivalence-function table)
-                              (hash-table-hash-function table))))
+  (let ((res (apply make-hash-table
+                    (hash-table-equivalence-function table)
+                    (hash-table-hash-function table)
+                    (hash-table-weakness table))))
     (hash-table-merge! res table)
     res))
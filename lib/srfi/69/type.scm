@@ -3,10 +3,14 @@
 ;; BSD-style license: http://synthcode.com/license.txt
 
 (define-record-type Hash-Table
-  (%make-hash-table buckets size hash-fn eq-fn)
+  (%make-hash-table entries size hash-fn eq-fn old-entries migrated deleted weakness)
   hash-table?
-  (buckets hash-table-buckets hash-table-buckets-set!)
-  (size hash-table-size hash-table-size-set!)
+  (entries hash-table-entries)
+  (size hash-table-size)
   (hash-fn %hash-table-hash-function)
-  (eq-fn %hash-table-equivalence-function))
+  (eq-fn %hash-table-equivalence-function)
+  (old-entries hash-table-old-entries)
+  (migrated hash-table-migrated)
+  (deleted hash-table-deleted)
+  (weakness %hash-table-weakness))
 
@@ -30,14 +30,6 @@ static sexp sexp_vector_copy_to_list (sexp ctx, sexp vec, sexp seq) {
   return seq;
 }
 
-static sexp sexp_vector_nreverse (sexp ctx, sexp vec) {
-  int i, j;
-  sexp tmp, *data=sexp_vector_data(vec);
-  for (i=0, j=sexp_vector_length(vec)-1; i<j; i++, j--)
-    swap(tmp, data[i], data[j]);
-  return vec;
-}
-
 static int sexp_basic_comparator (sexp op) {
   if (sexp_not(op))
     return 1;
@@ -163,7 +155,7 @@ static int sexp_object_compare (sexp ctx, sexp a, sexp b) {
       return sexp_isymbol_compare(ctx, a, b);
     else
 #endif
-      res = (sexp_sint_t)a - (sexp_sint_t)b;
+      res = (sexp_sint_t)a < (sexp_sint_t)b ? -1 : 1;
   }
   return res;
 }
@@ -172,153 +164,318 @@ sexp sexp_object_compare_op (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp b)
   return sexp_make_fixnum(sexp_object_compare(ctx, a, b));
 }
 
-/* fast path when using general object-cmp comparator with no key */
-/* TODO: include another fast path when the key is a fixed offset */
-static void sexp_merge_sort (sexp ctx, sexp *vec, sexp *scratch, sexp_sint_t lo, sexp_sint_t hi) {
-  sexp_sint_t mid, i, j, k;
+/* Sorting is done on an array of keys, along with a parallel array */
+/* of the values they were computed from if a key procedure was */
+/* given, so that the key is only called once per element.  Numeric */
+/* keys compared with < or > are radix sorted, and anything else is */
+/* merge sorted, taking advantage of runs already in order. */
+
+#define SEXP_SORT_MIN_RUN 32
+#define SEXP_SORT_MAX_RUNS 128
+#define SEXP_RADIX_SORT_MIN 64
+
+struct sexp_sort_state {
+  sexp ctx, less;
+  sexp *keys, *vals, *kscratch, *vscratch;
+  sexp *err;
+  int basic, dir;
+};
+
+/* Returns true if a sorts strictly before b.  Once the less */
+/* procedure has raised an exception it's remembered and false is */
+/* returned from then on, which still leaves a permutation behind. */
+static int sexp_sort_less (struct sexp_sort_state *s, sexp a, sexp b) {
+  sexp res;
+  if (s->basic)
+    return s->dir * sexp_object_compare(s->ctx, a, b) < 0;
+  if (*s->err != SEXP_FALSE)
+    return 0;
+  res = sexp_apply2(s->ctx, s->less, a, b);
+  if (sexp_exceptionp(res)) {
+    *s->err = res;
+    return 0;
+  }
+  return sexp_truep(res);
+}
+
+/* moves element j of the from arrays to i of the to arrays */
+#define sexp_sort_move(s, tok, tov, i, fromk, fromv, j) \
+  do {                                                  \
+    (tok)[i] = (fromk)[j];                              \
+    if ((s)->vals) (tov)[i] = (fromv)[j];               \
+  } while (0)
+
+static void sexp_sort_reverse (struct sexp_sort_state *s, sexp_sint_t lo, sexp_sint_t hi) {
   sexp tmp;
-  switch (hi - lo) {
-  case 0:
-    scratch[lo] = vec[lo];
-    break;
-  case 2:
-    if (sexp_object_compare(ctx, vec[hi], vec[hi-1]) < 0)
-      swap(tmp, vec[hi], vec[hi-1]);
-    /* ... FALLTHROUGH ... */
-  case 1:
-    if (sexp_object_compare(ctx, vec[lo+1], vec[lo]) < 0) {
-      swap(tmp, vec[lo+1], vec[lo]);
-      if (hi - lo > 1) {
-        if (sexp_object_compare(ctx, vec[lo+2], vec[lo+1]) < 0)
-          swap(tmp, vec[lo+2], vec[lo+1]);
-      }
+  for (hi--; lo < hi; lo++, hi--) {
+    swap(tmp, s->keys[lo], s->keys[hi]);
+    if (s->vals) swap(tmp, s->vals[lo], s->vals[hi]);
+  }
+}
+
+/* sorts [lo, hi) by binary insertion, given that [lo, start) is sorted */
+static void sexp_sort_insertion (struct sexp_sort_state *s, sexp_sint_t lo,
+                                 sexp_sint_t start, sexp_sint_t hi) {
+  sexp_sint_t i, l, r, m;
+  sexp k, v;
+  for (i=start; i<hi; i++) {
+    k = s->keys[i];
+    v = s->vals ? s->vals[i] : SEXP_VOID;
+    /* insert after any equal elements to keep the sort stable */
+    for (l=lo, r=i; l < r; ) {
+      m = l + (r-l)/2;
+      if (sexp_sort_less(s, k, s->keys[m])) r = m; else l = m+1;
     }
-    break;
-  default:                      /* at least 4 elements */
-    mid = (hi+lo)/2;
-    sexp_merge_sort(ctx, vec, scratch, lo, mid);
-    sexp_merge_sort(ctx, vec, scratch, mid+1, hi);
-    for (k=lo, i = lo, j = mid+1; k <= hi; ++k) {
-      if (i > mid) {
-        scratch[k] = vec[j++];
-      } else if (j > hi) {
-        scratch[k] = vec[i++];
-      } else {
-        if (sexp_object_compare(ctx, vec[j], vec[i]) < 0) {
-          scratch[k] = vec[j++];
-        } else {
-          scratch[k] = vec[i++];
-        }
+    if (l < i) {
+      memmove(s->keys+l+1, s->keys+l, (i-l)*sizeof(sexp));
+      s->keys[l] = k;
+      if (s->vals) {
+        memmove(s->vals+l+1, s->vals+l, (i-l)*sizeof(sexp));
+        s->vals[l] = v;
       }
     }
-    memcpy(vec + lo, scratch + lo, (hi-lo+1) * sizeof(sexp));
   }
 }
 
-#define if_is_less(i, j)                                                \
-  a = (sexp_truep(key) ? (sexp_car(args1) = vec[i], sexp_apply(ctx, key, args1)) : vec[i]);       \
-  if (sexp_exceptionp(a)) {res=a; goto done;}                           \
-  b = (sexp_truep(key) ? (sexp_car(args1) = vec[j], sexp_apply(ctx, key, args1)) : vec[j]); \
-  if (sexp_exceptionp(b)) {res=b; goto done;}                           \
-  sexp_car(args2) = a;                                                  \
-  sexp_car(args1) = b;                                                  \
-  res = sexp_apply(ctx, less, args2);                                   \
-  if (sexp_exceptionp(res)) goto done;                                  \
-  if (sexp_truep(res))
-
-static sexp sexp_merge_sort_less (sexp ctx, sexp *vec, sexp *scratch,
-                                  sexp_sint_t lo, sexp_sint_t hi,
-                                  sexp less, sexp key) {
-  sexp_sint_t mid, i, j, k;
-  sexp args1;
-  sexp_gc_var5(a, b, tmp, args2, res);
-  sexp_gc_preserve5(ctx, a, b, tmp, args2, res);
-  args2 = sexp_list2(ctx, SEXP_VOID, SEXP_VOID);
-  args1 = sexp_cdr(args2);
-  switch (hi - lo) {
-  case 0:
-    res = SEXP_VOID;
-    scratch[lo] = vec[lo];
-    break;
-  case 2:
-    if_is_less (hi, hi-1)
-      swap(tmp, vec[hi], vec[hi-1]);
-    /* ... FALLTHROUGH ... */
-  case 1:
-    if_is_less (lo+1, lo) {
-      swap(tmp, vec[lo+1], vec[lo]);
-      if (hi - lo > 1) {
-        if_is_less (lo+2, lo+1)
-          swap(tmp, vec[lo+2], vec[lo+1]);
-      }
+/* returns the end of the run starting at lo, reversing it if it */
+/* was strictly descending */
+static sexp_sint_t sexp_sort_count_run (struct sexp_sort_state *s, sexp_sint_t lo, sexp_sint_t hi) {
+  sexp_sint_t i = lo + 1;
+  if (i >= hi)
+    return hi;
+  if (sexp_sort_less(s, s->keys[i], s->keys[lo])) {
+    for (i++; i < hi && sexp_sort_less(s, s->keys[i], s->keys[i-1]); i++)
+      ;
+    sexp_sort_reverse(s, lo, i);
+  } else {
+    for (i++; i < hi && ! sexp_sort_less(s, s->keys[i], s->keys[i-1]); i++)
+      ;
+  }
+  return i;
+}
+
+/* merges the sorted runs [lo, mid) and [mid, hi) */
+static void sexp_sort_merge (struct sexp_sort_state *s, sexp_sint_t lo,
+                             sexp_sint_t mid, sexp_sint_t hi) {
+  sexp_sint_t i, j, k, n;
+  /* nothing to do if the runs are already in order */
+  if (! sexp_sort_less(s, s->keys[mid], s->keys[mid-1]))
+    return;
+  n = mid - lo;
+  for (i=0; i<n; i++)
+    sexp_sort_move(s, s->kscratch, s->vscratch, i, s->keys, s->vals, lo+i);
+  for (i=0, j=mid, k=lo; i < n && j < hi; k++) {
+    if (sexp_sort_less(s, s->keys[j], s->kscratch[i])) {
+      sexp_sort_move(s, s->keys, s->vals, k, s->keys, s->vals, j);
+      j++;
+    } else {
+      sexp_sort_move(s, s->keys, s->vals, k, s->kscratch, s->vscratch, i);
+      i++;
     }
-    break;
-  default:                      /* at least 4 elements */
-    mid = (hi+lo)/2;
-    res = sexp_merge_sort_less(ctx, vec, scratch, lo, mid, less, key);
-    if (sexp_exceptionp(res))
-      goto done;
-    res = sexp_merge_sort_less(ctx, vec, scratch, mid+1, hi, less, key);
-    if (sexp_exceptionp(res))
-      goto done;
-    for (k=lo, i = lo, j = mid+1; k <= hi; ++k) {
-      if (i > mid) {
-        scratch[k] = vec[j++];
-      } else if (j > hi) {
-        scratch[k] = vec[i++];
-      } else {
-        if_is_less (j, i) {
-          scratch[k] = vec[j++];
+  }
+  for ( ; i < n; i++, k++)
+    sexp_sort_move(s, s->keys, s->vals, k, s->kscratch, s->vscratch, i);
+}
+
+static sexp_sint_t sexp_sort_min_run (sexp_sint_t n) {
+  sexp_sint_t r = 0;
+  while (n >= SEXP_SORT_MIN_RUN) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+/* A simplified Timsort: natural runs are extended to a minimum */
+/* length by insertion sort and pushed on a stack, merging adjacent */
+/* runs to keep their lengths decreasing geometrically. */
+static void sexp_sort_runs (struct sexp_sort_state *s, sexp_sint_t len) {
+  sexp_sint_t base[SEXP_SORT_MAX_RUNS], size[SEXP_SORT_MAX_RUNS];
+  sexp_sint_t lo, end, min_run, n = 0, i;
+  min_run = sexp_sort_min_run(len);
+  for (lo=0; lo < len; lo=end) {
+    end = sexp_sort_count_run(s, lo, len);
+    if (end - lo < min_run) {
+      i = end;
+      end = (lo + min_run < len) ? lo + min_run : len;
+      sexp_sort_insertion(s, lo, i, end);
+    }
+    base[n] = lo; size[n] = end - lo; n++;
+    while (n > 1) {
+      if ((n > 2 && size[n-3] <= size[n-2] + size[n-1])
+          || (n > 3 && size[n-4] <= size[n-3] + size[n-2])) {
+        if (size[n-3] < size[n-1]) {
+          sexp_sort_merge(s, base[n-3], base[n-2], base[n-2] + size[n-2]);
+          size[n-3] += size[n-2];
+          base[n-2] = base[n-1]; size[n-2] = size[n-1];
         } else {
-          scratch[k] = vec[i++];
+          sexp_sort_merge(s, base[n-2], base[n-1], base[n-1] + size[n-1]);
+          size[n-2] += size[n-1];
         }
+        n--;
+      } else if (size[n-2] <= size[n-1]) {
+        sexp_sort_merge(s, base[n-2], base[n-1], base[n-1] + size[n-1]);
+        size[n-2] += size[n-1];
+        n--;
+      } else {
+        break;
       }
     }
-    memcpy(vec + lo, scratch + lo, (hi-lo+1) * sizeof(sexp));
   }
- done:
-  sexp_gc_release5(ctx);
-  return res;
+  for ( ; n > 1; n--) {
+    sexp_sort_merge(s, base[n-2], base[n-1], base[n-1] + size[n-1]);
+    size[n-2] += size[n-1];
+  }
+}
+
+/* Maps fixnum or flonum keys to unsigned integers in the same */
+/* order, or returns 0 if some key is neither, or the keys are */
+/* mixed or NaN.  Negative zero is mapped along with zero so that */
+/* they stay in their original order.  Sets *sortedp if the keys */
+/* are already in order. */
+static int sexp_sort_radix_keys (struct sexp_sort_state *s, sexp_uint_t *u,
+                                 sexp_sint_t len, int *sortedp) {
+  sexp_sint_t i;
+  sexp_uint_t sign = ((sexp_uint_t)1) << (sizeof(sexp_uint_t)*8 - 1);
+#if SEXP_USE_FLONUMS
+  double f;
+  if (sexp_flonump(s->keys[0]) && sizeof(double) == sizeof(sexp_uint_t)) {
+    for (i=0; i<len; i++) {
+      if (! sexp_flonump(s->keys[i]))
+        return 0;
+      f = sexp_flonum_value(s->keys[i]);
+      if (f != f)
+        return 0;
+      if (f == 0.0) f = 0.0;
+      memcpy(&u[i], &f, sizeof(f));
+      u[i] = (u[i] & sign) ? ~u[i] : u[i] | sign;
+      if (s->dir < 0) u[i] = ~u[i];
+      if (i > 0 && u[i] < u[i-1]) *sortedp = 0;
+    }
+    return 1;
+  }
+#endif
+  for (i=0; i<len; i++) {
+    if (! sexp_fixnump(s->keys[i]))
+      return 0;
+    u[i] = ((sexp_uint_t)sexp_unbox_fixnum(s->keys[i])) ^ sign;
+    if (s->dir < 0) u[i] = ~u[i];
+    if (i > 0 && u[i] < u[i-1]) *sortedp = 0;
+  }
+  return 1;
+}
+
+/* Stable LSD radix sort a byte at a time, skipping bytes which are */
+/* the same for every key.  The unsigned keys are in u with room for */
+/* another len in u2, and the elements are moved along with them. */
+static void sexp_sort_radix (struct sexp_sort_state *s, sexp_uint_t *u, sexp_uint_t *u2, sexp_sint_t len) {
+  sexp_uint_t counts[sizeof(sexp_uint_t)][256], sum, tmp, *ut;
+  sexp_sint_t i, b, shift;
+  sexp *from = s->vals ? s->vals : s->keys, *to = s->vscratch, *t;
+  memset(counts, 0, sizeof(counts));
+  for (i=0; i<len; i++)
+    for (b=0; b<(sexp_sint_t)sizeof(sexp_uint_t); b++)
+      counts[b][(u[i] >> (b*8)) & 0xFF]++;
+  for (b=0; b<(sexp_sint_t)sizeof(sexp_uint_t); b++) {
+    shift = b*8;
+    if (counts[b][(u[0] >> shift) & 0xFF] == (sexp_uint_t)len)
+      continue;
+    for (i=0, sum=0; i<256; i++) {
+      tmp = counts[b][i];
+      counts[b][i] = sum;
+      sum += tmp;
+    }
+    for (i=0; i<len; i++) {
+      tmp = counts[b][(u[i] >> shift) & 0xFF]++;
+      u2[tmp] = u[i];
+      to[tmp] = from[i];
+    }
+    ut = u; u = u2; u2 = ut;
+    t = from; from = to; to = t;
+  }
+  if (from != (s->vals ? s->vals : s->keys))
+    memcpy(s->vals ? s->vals : s->keys, from, len*sizeof(sexp));
 }
 
 sexp sexp_sort_x (sexp ctx, sexp self, sexp_sint_t n, sexp seq,
                          sexp less, sexp key) {
-  sexp_sint_t len;
-  sexp res;
-  sexp_gc_var2(vec, scratch);
+  sexp_sint_t i, len;
+  int sortedp = 1;
+  struct sexp_sort_state s;
+  sexp_gc_var6(vec, keys, kscratch, vscratch, radix, res);
 
   if (sexp_nullp(seq)) return seq;
 
-  sexp_gc_preserve2(ctx, vec, scratch);
+  sexp_gc_preserve6(ctx, vec, keys, kscratch, vscratch, radix, res);
 
   vec = (sexp_truep(sexp_listp(ctx, seq)) ? sexp_list_to_vector(ctx, seq) : seq);
+  res = SEXP_FALSE;
 
   if (! sexp_vectorp(vec)) {
     res = sexp_type_exception(ctx, self, SEXP_VECTOR, vec);
-  } else {
-    scratch = sexp_make_vector(ctx, sexp_make_fixnum(sexp_vector_length(vec)), SEXP_VOID);
-    len = sexp_vector_length(vec);
-    if (sexp_not(key) && sexp_basic_comparator(less)) {
-      sexp_merge_sort(ctx, sexp_vector_data(vec), sexp_vector_data(scratch),
-                      0, len-1);
-      if (sexp_opcodep(less) && sexp_opcode_inverse(less))
-        sexp_vector_nreverse(ctx, vec);
-      res = vec;
-    } else if (! (sexp_procedurep(less) || sexp_opcodep(less))) {
-      res = sexp_type_exception(ctx, self, SEXP_PROCEDURE, less);
-    } else if (! (sexp_procedurep(key) || sexp_opcodep(key) || sexp_not(key))) {
-      res = sexp_type_exception(ctx, self, SEXP_PROCEDURE, key);
+  } else if (! (sexp_procedurep(less) || sexp_opcodep(less) || sexp_not(less))) {
+    res = sexp_type_exception(ctx, self, SEXP_PROCEDURE, less);
+  } else if (! (sexp_procedurep(key) || sexp_opcodep(key) || sexp_not(key))) {
+    res = sexp_type_exception(ctx, self, SEXP_PROCEDURE, key);
+  } else if ((len = sexp_vector_length(vec)) > 1) {
+    /* decorate with the keys */
+    if (sexp_truep(key)) {
+      keys = sexp_make_vector(ctx, sexp_make_fixnum(len), SEXP_VOID);
+      for (i=0; i<len && ! sexp_exceptionp(keys); i++) {
+        res = sexp_apply1(ctx, key, sexp_vector_data(vec)[i]);
+        if (sexp_exceptionp(res))
+          keys = res;
+        else
+          sexp_vector_data(keys)[i] = res;
+      }
+      res = SEXP_FALSE;
     } else {
-      res = sexp_merge_sort_less(ctx, sexp_vector_data(vec),
-                                 sexp_vector_data(scratch),
-                                 0, len-1, less, key);
+      keys = vec;
+    }
+    if (sexp_exceptionp(keys)) {
+      res = keys;
+    } else {
+      s.ctx = ctx;
+      s.less = less;
+      s.err = &res;
+      s.basic = sexp_basic_comparator(less);
+      s.dir = (sexp_opcodep(less) && sexp_opcode_inverse(less)) ? -1 : 1;
+      s.keys = sexp_vector_data(keys);
+      s.vals = (keys == vec) ? NULL : sexp_vector_data(vec);
+      if (s.basic && len >= SEXP_RADIX_SORT_MIN)
+        radix = sexp_make_bytes(ctx, sexp_make_fixnum(2*len*sizeof(sexp_uint_t)), SEXP_ZERO);
+      if (sexp_bytesp(radix)
+          && sexp_sort_radix_keys(&s, (sexp_uint_t*)sexp_bytes_data(radix), len, &sortedp)) {
+        if (! sortedp) {
+          vscratch = sexp_make_vector(ctx, sexp_make_fixnum(len), SEXP_VOID);
+          if (sexp_exceptionp(vscratch)) {
+            res = vscratch;
+          } else {
+            s.vscratch = sexp_vector_data(vscratch);
+            sexp_sort_radix(&s, (sexp_uint_t*)sexp_bytes_data(radix),
+                            (sexp_uint_t*)sexp_bytes_data(radix) + len, len);
+          }
+        }
+      } else {
+        radix = SEXP_FALSE;
+        vscratch = sexp_make_vector(ctx, sexp_make_fixnum(len), SEXP_VOID);
+        kscratch = (s.vals && ! sexp_exceptionp(vscratch))
+          ? sexp_make_vector(ctx, sexp_make_fixnum(len), SEXP_VOID) : vscratch;
+        if (sexp_exceptionp(kscratch)) {
+          res = kscratch;
+        } else {
+          s.kscratch = sexp_vector_data(kscratch);
+          s.vscratch = sexp_vector_data(vscratch);
+          sexp_sort_runs(&s, len);
+        }
+      }
     }
   }
 
-  if (sexp_pairp(seq) && ! sexp_exceptionp(res))
-    res = sexp_vector_copy_to_list(ctx, vec, seq);
+  if (! sexp_exceptionp(res))
+    res = sexp_pairp(seq) ? sexp_vector_copy_to_list(ctx, vec, seq) : vec;
 
-  sexp_gc_release2(ctx);
+  sexp_gc_release6(ctx);
   return res;
 }
 
@@ -10,11 +10,18 @@ struct sexp_huff_entry {
   unsigned short bits;
 };
 
+#if SEXP_USE_MMAP_PORTS
+#include <sys/mman.h>
+#endif
+
 #if SEXP_USE_HUFF_SYMS
 #include "chibi/sexp-hufftabs.h"
 #include "chibi/sexp-huff.h"
 #endif
 
+/* powers of ten for flonum printing and parsing */
+#include "chibi/sexp-pow10tab.h"
+
 static int sexp_initialized_p = 0;
 
 static const char sexp_separators[] = {
@@ -42,12 +49,33 @@ static int is_precision_indicator(int c) {
     || c=='l' || c=='L' || c=='s' || c=='S';
 }
 
+/* character classes for the reader's scans over the port buffer */
+#define SEXP_CC_SEPARATOR 1
+#define SEXP_CC_SPACE     2
+#define SEXP_CC_DIGIT     4
+#define SEXP_CC_ESCAPE    8
+
+static const unsigned char sexp_char_classes[256] = {
+  /* 1  2  3  4  5  6  7  8  9  a  b  c  d  e  f         */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 1, 3, 3, 0, 0, /* x0_ */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* x1_ */
+  3, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, /* x2_ */
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 1, 0, 0, 0, 0, /* x3_ */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* x4_ */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 8, 1, 0, 0, /* x5_ */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* x6_ */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, /* x7_ */
+  /* utf8 bytes are all symbol constituents */
+};
+
+#define sexp_char_class(c) (sexp_char_classes[(unsigned char)(c)])
+
 int sexp_is_separator(int c) {
   return 0<c && c<0x80 && sexp_separators[c];
 }
 
 #if SEXP_USE_GLOBAL_SYMBOLS
-sexp sexp_symbol_table[SEXP_SYMBOL_TABLE_SIZE];
+sexp sexp_symbol_table, sexp_symbol_table_count;
 #endif
 
 #if ! SEXP_USE_UNSAFE_PUSH
@@ -161,6 +189,12 @@ sexp sexp_finalize_port (sexp ctx, sexp self, sexp_sint_t n, sexp port) {
     if (sexp_port_stream(port) && ! sexp_port_no_closep(port))
       /* close the stream */
       fclose(sexp_port_stream(port));
+#if SEXP_USE_MMAP_PORTS
+    if (sexp_port_mmappedp(port)) {
+      munmap(sexp_port_buf(port), sexp_port_size(port));
+      sexp_port_mmappedp(port) = 0;
+    }
+#endif
     sexp_port_offset(port) = 0;
     sexp_port_size(port) = 0;
   }
@@ -187,7 +221,7 @@ static struct sexp_type_struct _sexp_type_specs[] = {
 #if SEXP_USE_PACKED_STRINGS
   {SEXP_STRING, 0, 0, 0, 0, 0, sexp_sizeof(string)+1, sexp_offsetof(string, length), 1, 0, 0, 0, 0, 0, 0, (sexp)"String", SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, NULL, NULL, NULL, NULL},
 #else
-  {SEXP_STRING, sexp_offsetof(string, bytes), 1, 1, 0, 0, sexp_sizeof(string), 0, 0, 0, 0, 0, 0, 0, 0, (sexp)"String", SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, NULL, NULL, NULL, NULL},
+  {SEXP_STRING, sexp_offsetof(string, bytes), 1, 1+SEXP_USE_STRING_INDEX_TABLE, 0, 0, sexp_sizeof(string), 0, 0, 0, 0, 0, 0, 0, 0, (sexp)"String", SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, NULL, NULL, NULL, NULL},
 #endif
   {SEXP_VECTOR, sexp_offsetof(vector, data), 0, 0, sexp_offsetof(vector, length), 1, sexp_sizeof(vector), sexp_offsetof(vector, length), sizeof(sexp), 0, 0, 0, 0, 0, 0, (sexp)"Vector", SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, NULL, NULL, NULL, NULL},
   {SEXP_FLONUM, 0, 0, 0, 0, 0, sexp_sizeof(flonum), 0, 0, 0, 0, 0, 0, 0, 0, (sexp)"Flonum", SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, SEXP_FALSE, NULL, NULL, NULL, NULL},
@@ -431,7 +465,8 @@ void sexp_init_context_globals (sexp ctx) {
   sexp_context_globals(ctx)
     = sexp_make_vector(ctx, sexp_make_fixnum(SEXP_G_NUM_GLOBALS), SEXP_VOID);
 #if ! SEXP_USE_GLOBAL_SYMBOLS
-  sexp_global(ctx, SEXP_G_SYMBOLS) = sexp_make_vector(ctx, sexp_make_fixnum(SEXP_SYMBOL_TABLE_SIZE), SEXP_NULL);
+  sexp_global(ctx, SEXP_G_SYMBOLS) = sexp_make_vector(ctx, sexp_make_fixnum(SEXP_INIT_SYMBOL_TABLE_SIZE), SEXP_FALSE);
+  sexp_global(ctx, SEXP_G_NUM_SYMBOLS) = SEXP_ZERO;
 #endif
   sexp_global(ctx, SEXP_G_STRICT_P) = SEXP_FALSE;
 #if SEXP_USE_FOLD_CASE_SYMS
@@ -442,6 +477,7 @@ void sexp_init_context_globals (sexp ctx) {
 #endif
 #if SEXP_USE_WEAK_REFERENCES
   sexp_global(ctx, SEXP_G_WEAK_OBJECTS_PRESENT) = SEXP_FALSE;
+  sexp_global(ctx, SEXP_G_WEAK_TABLES) = SEXP_NULL;
   sexp_global(ctx, SEXP_G_FILE_DESCRIPTORS) = SEXP_FALSE;
   sexp_global(ctx, SEXP_G_NUM_FILE_DESCRIPTORS) = SEXP_ZERO;
 #endif
@@ -547,6 +583,11 @@ sexp sexp_make_context (sexp ctx, size_t size, size_t max_size) {
   sexp_context_errorp(res) = 0;
   sexp_context_event(res) = SEXP_FALSE;
   sexp_context_refuel(res) = SEXP_DEFAULT_QUANTUM;
+  sexp_context_quantum(res) = SEXP_DEFAULT_QUANTUM;
+  sexp_context_priority(res) = 0;
+  sexp_context_steps(res) = 0;
+  sexp_context_usecs(res) = 0;
+  sexp_context_resumed(res) = 0;
 #endif
 #if SEXP_USE_DL
   sexp_context_dl(res) = ctx ? sexp_context_dl(ctx) : SEXP_FALSE;
@@ -956,6 +997,37 @@ sexp sexp_equalp_op (sexp ctx, sexp self, sexp_sint_t n, sexp a, sexp b) {
                                  sexp_make_fixnum(SEXP_DEFAULT_EQUAL_BOUND))));
 }
 
+static sexp_uint_t sexp_mix_bits (sexp_uint_t h) {
+#if SEXP_64_BIT
+  h ^= h >> 33;
+  h *= (sexp_uint_t)0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+#else
+  h ^= h >> 16;
+  h *= 0x85ebca6bUL;
+  h ^= h >> 13;
+#endif
+  return h;
+}
+
+/* Hash for eq? tables.  Heap objects are given a hash the first time */
+/* they're asked for one, derived from their address then but kept in */
+/* the header, so it doesn't change if the object is later moved. */
+/* The stored bits are mixed again so the result spans the full word. */
+sexp_uint_t sexp_identity_hash (sexp x) {
+#if SEXP_USE_HEADER_HASH
+  sexp_uint_t h;
+  if (sexp_pointerp(x)) {
+    if (! sexp_pointer_hash(x)) {
+      h = sexp_mix_bits((sexp_uint_t)x) & ((1uL<<SEXP_HEADER_HASH_BITS)-1);
+      sexp_pointer_hash(x) = h ? h : 1;
+    }
+    return sexp_mix_bits(sexp_pointer_hash(x));
+  }
+#endif
+  return sexp_mix_bits((sexp_uint_t)x);
+}
+
 /********************* strings, symbols, vectors **********************/
 
 sexp sexp_flonump_op (sexp ctx, sexp self, sexp_sint_t n, sexp x) {
@@ -1017,14 +1089,83 @@ int sexp_utf8_char_byte_count (int c) {
   return 4;
 }
 
+/* steps over chars like the indexing functions, so invalid strings */
+/* have a length consistent with string-ref */
 sexp_uint_t sexp_string_utf8_length (unsigned char *p, long len) {
   unsigned char *q = p+len;
-  sexp_uint_t i;
-  for (i=0; p<q; i++)
-    p += sexp_utf8_initial_byte_count(*p);
+  sexp_uint_t i, k;
+  for (i=0; p<q; i++) {
+    if (*p < 0x80) {
+      k = sexp_utf8_ascii_prefix_length(p, q-p);
+      p += k;
+      i += k-1;
+    } else {
+      p += sexp_utf8_initial_byte_count(*p);
+    }
+  }
+  return i;
+}
+
+/* The scanning loops below avoid early exits within a block so that */
+/* the compiler can vectorize them. */
+
+/* count the bytes that don't continue a multi-byte char, which unlike */
+/* the above can be summed over arbitrary pieces of a string */
+sexp_uint_t sexp_utf8_lead_byte_count (const unsigned char *p, sexp_uint_t len) {
+  sexp_uint_t i, res = 0;
+  for (i=0; i<len; i++)
+    res += ((p[i] & 0xC0) != 0x80);
+  return res;
+}
+
+sexp_uint_t sexp_utf8_ascii_prefix_length (const unsigned char *p, sexp_uint_t len) {
+  sexp_uint_t i, j;
+  unsigned char acc;
+  for (i=0; i+SEXP_UTF8_BLOCK_SIZE <= len; i+=SEXP_UTF8_BLOCK_SIZE) {
+    for (j=0, acc=0; j<SEXP_UTF8_BLOCK_SIZE; j++)
+      acc |= p[i+j];
+    if (acc & 0x80) break;
+  }
+  while (i<len && p[i]<0x80)
+    i++;
   return i;
 }
 
+sexp_uint_t sexp_utf8_count_byte (const unsigned char *p, sexp_uint_t len, int c) {
+  sexp_uint_t i, res = 0;
+  for (i=0; i<len; i++)
+    res += (p[i] == c);
+  return res;
+}
+
+/* returns the offset of the first invalid sequence, or len if valid */
+sexp_uint_t sexp_utf8_validate (const unsigned char *p, sexp_uint_t len) {
+  sexp_uint_t i = 0, j, n;
+  int c;
+  while (i < len) {
+    c = p[i];
+    if (c < 0x80) {
+      i += sexp_utf8_ascii_prefix_length(p+i, len-i);
+      continue;
+    }
+    if (c < 0xC2 || c > 0xF4)
+      return i;
+    n = sexp_utf8_initial_byte_count(c);
+    if (i+n > len)
+      return i;
+    /* reject overlong forms, surrogates and chars past #x10FFFF */
+    c = (c == 0xE0 ? p[i+1] >= 0xA0 : c == 0xED ? p[i+1] < 0xA0
+         : c == 0xF0 ? p[i+1] >= 0x90 : c == 0xF4 ? p[i+1] < 0x90 : 1);
+    if (!c)
+      return i;
+    for (j=1; j<n; j++)
+      if ((p[i+j] & 0xC0) != 0x80)
+        return i;
+    i += n;
+  }
+  return len;
+}
+
 char* sexp_string_utf8_prev (unsigned char *p) {
   while ((*--p)>>6 == 2)
     ;
@@ -1056,14 +1197,87 @@ void sexp_utf8_encode_char (unsigned char* p, int len, int c) {
   }
 }
 
+#if SEXP_USE_STRING_INDEX_TABLE
+
+/* Returns the index table for str, building it on first use.  Small */
+/* strings don't get a table and return #f unless already known to be */
+/* ASCII. */
+static sexp sexp_string_index_lookup (sexp ctx, sexp str) {
+  sexp_uint_t i, j, size, *tab;
+  unsigned char *p;
+  sexp res = sexp_string_index_table(str);
+  sexp_gc_var1(tmp);
+  size = sexp_string_size(str);
+  if (res != SEXP_FALSE || size < SEXP_STRING_INDEX_TABLE_MIN_SIZE)
+    return res;
+  p = (unsigned char*)sexp_string_data(str);
+  i = sexp_utf8_ascii_prefix_length(p, size);
+  if (i == size)
+    return sexp_string_index_table(str) = SEXP_TRUE;
+  sexp_gc_preserve1(ctx, tmp);
+  tmp = str;
+  res = sexp_make_bytes(ctx, sexp_make_fixnum((size/SEXP_STRING_INDEX_TABLE_CHUNK_SIZE + 2) * sizeof(sexp_uint_t)), SEXP_VOID);
+  if (!sexp_exceptionp(res)) {
+    /* the ASCII prefix can be skipped directly */
+    tab = (sexp_uint_t*)sexp_bytes_data(res);
+    p = (unsigned char*)sexp_string_data(str);
+    for (j=0; j<=i; j+=SEXP_STRING_INDEX_TABLE_CHUNK_SIZE)
+      tab[1+j/SEXP_STRING_INDEX_TABLE_CHUNK_SIZE] = j;
+    for (j=i-i%SEXP_STRING_INDEX_TABLE_CHUNK_SIZE, i=j; i<size; j++) {
+      if (j % SEXP_STRING_INDEX_TABLE_CHUNK_SIZE == 0)
+        tab[1+j/SEXP_STRING_INDEX_TABLE_CHUNK_SIZE] = i;
+      i += sexp_utf8_initial_byte_count(p[i]);
+    }
+    tab[0] = j;
+    sexp_string_index_table(str) = res;
+  } else {
+    res = SEXP_FALSE;
+  }
+  sexp_gc_release1(ctx);
+  return res;
+}
+
+sexp_uint_t sexp_string_index_length (sexp ctx, sexp str) {
+  sexp tab = sexp_string_index_lookup(ctx, str);
+  if (tab == SEXP_TRUE)
+    return sexp_string_size(str);
+  else if (sexp_bytesp(tab))
+    return ((sexp_uint_t*)sexp_bytes_data(tab))[0];
+  return sexp_string_utf8_length((unsigned char*)sexp_string_data(str), sexp_string_size(str));
+}
+
+#endif
+
 sexp sexp_string_index_to_cursor (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp index) {
   sexp_sint_t i, j, limit;
   unsigned char *p;
+#if SEXP_USE_STRING_INDEX_TABLE
+  sexp tab;
+  sexp_uint_t *v;
+#endif
   sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, str);
   sexp_assert_type(ctx, sexp_fixnump, SEXP_FIXNUM, index);
-  p = (unsigned char*)sexp_string_data(str);
+  i = sexp_unbox_fixnum(index);
   limit = sexp_string_size(str);
-  for (j=0, i=sexp_unbox_fixnum(index); i>0 && j<limit; i--)
+  j = 0;
+#if SEXP_USE_STRING_INDEX_TABLE
+  tab = sexp_string_index_lookup(ctx, str);
+  if (tab == SEXP_TRUE) {
+    if (i < 0 || i > limit)
+      return sexp_user_exception(ctx, self, "string-index->cursor: index out of range", index);
+    return sexp_make_string_cursor(i);
+  } else if (sexp_bytesp(tab)) {
+    v = (sexp_uint_t*)sexp_bytes_data(tab);
+    if (i < 0 || i > (sexp_sint_t)v[0])
+      return sexp_user_exception(ctx, self, "string-index->cursor: index out of range", index);
+    if (i == (sexp_sint_t)v[0])
+      return sexp_make_string_cursor(limit);
+    j = v[1 + i/SEXP_STRING_INDEX_TABLE_CHUNK_SIZE];
+    i %= SEXP_STRING_INDEX_TABLE_CHUNK_SIZE;
+  }
+#endif
+  p = (unsigned char*)sexp_string_data(str);
+  for ( ; i>0 && j<limit; i--)
     j += sexp_utf8_initial_byte_count(p[j]);
   if (i != 0)
     return sexp_user_exception(ctx, self, "string-index->cursor: index out of range", index);
@@ -1072,10 +1286,34 @@ sexp sexp_string_index_to_cursor (sexp ctx, sexp self, sexp_sint_t n, sexp str,
 
 sexp sexp_string_cursor_to_index (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp offset) {
   sexp_sint_t off = sexp_unbox_string_cursor(offset);
+#if SEXP_USE_STRING_INDEX_TABLE
+  sexp tab;
+  sexp_uint_t *v, lo, hi, mid;
+#endif
   sexp_assert_type(ctx, sexp_stringp, SEXP_STRING, str);
   sexp_assert_type(ctx, sexp_string_cursorp, SEXP_STRING_CURSOR, offset);
   if (off < 0 || off > (sexp_sint_t)sexp_string_size(str))
     return sexp_user_exception(ctx, self, "string-cursor->index: offset out of range", offset);
+#if SEXP_USE_STRING_INDEX_TABLE
+  tab = sexp_string_index_lookup(ctx, str);
+  if (tab == SEXP_TRUE) {
+    return sexp_make_fixnum(off);
+  } else if (sexp_bytesp(tab)) {
+    /* find the last recorded char at or before off */
+    v = (sexp_uint_t*)sexp_bytes_data(tab);
+    lo = 0;
+    hi = (v[0] - 1) / SEXP_STRING_INDEX_TABLE_CHUNK_SIZE;
+    while (lo < hi) {
+      mid = (lo + hi + 1) / 2;
+      if (v[1+mid] <= (sexp_uint_t)off)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+    return sexp_make_fixnum(lo * SEXP_STRING_INDEX_TABLE_CHUNK_SIZE
+                            + sexp_string_utf8_length((unsigned char*)sexp_string_data(str) + v[1+lo], off - v[1+lo]));
+  }
+#endif
   return sexp_make_fixnum(sexp_string_utf8_length((unsigned char*)sexp_string_data(str), off));
 }
 
@@ -1118,6 +1356,11 @@ sexp sexp_make_string_op (sexp ctx, sexp self, sexp_sint_t n, sexp len, sexp ch)
   sexp_string_bytes(s) = b;
   sexp_string_offset(s) = 0;
   sexp_string_size(s) = sexp_bytes_length(b);
+#if SEXP_USE_STRING_INDEX_TABLE
+  /* a string filled with an ASCII char is known to be ASCII */
+  sexp_string_index_table(s)
+    = (sexp_fixnump(i) && sexp_unbox_fixnum(i) < 0x80) ? SEXP_TRUE : SEXP_FALSE;
+#endif
   sexp_gc_release2(ctx);
   return s;
 #endif
@@ -1153,6 +1396,10 @@ sexp sexp_substring_op (sexp ctx, sexp self, sexp_sint_t n, sexp str, sexp start
          sexp_string_data(str)+sexp_unbox_string_cursor(start),
          sexp_string_size(res));
   sexp_string_data(res)[sexp_string_size(res)] = '\0';
+#if SEXP_USE_STRING_INDEX_TABLE
+  if (sexp_string_index_table(str) == SEXP_TRUE)
+    sexp_string_index_table(res) = SEXP_TRUE;
+#endif
   return res;
 }
 
@@ -1172,6 +1419,7 @@ sexp sexp_subbytes_op (sexp ctx, sexp self, sexp_sint_t n, sexp vec, sexp start,
   sexp_string_bytes(str) = vec;
   sexp_string_offset(str) = 0;
   sexp_string_size(str) = sexp_bytes_length(vec);
+  sexp_string_index_invalidate(str);
 #endif
   res = sexp_substring_op(ctx, self, n, str, sexp_fixnum_to_string_cursor(start), sexp_fixnum_to_string_cursor(end));
   if (!sexp_exceptionp(res))
@@ -1198,14 +1446,24 @@ sexp sexp_string_concatenate_op (sexp ctx, sexp self, sexp_sint_t n, sexp str_ls
   sexp res, ls;
   sexp_uint_t len=0, i=0, sep_len=0;
   char *p, *csep=NULL;
+#if SEXP_USE_STRING_INDEX_TABLE
+  int asciip = 1;
+#endif
   for (ls=str_ls; sexp_pairp(ls); ls=sexp_cdr(ls), i++)
     if (! sexp_stringp(sexp_car(ls)))
       return sexp_type_exception(ctx, self, SEXP_STRING, sexp_car(ls));
-    else
+    else {
       len += sexp_string_size(sexp_car(ls));
+#if SEXP_USE_STRING_INDEX_TABLE
+      asciip &= (sexp_string_index_table(sexp_car(ls)) == SEXP_TRUE);
+#endif
+    }
   if ((i > 0) && sexp_stringp(sep) && ((sep_len=sexp_string_size(sep)) > 0)) {
     csep = sexp_string_data(sep);
     len += sep_len*(i-1);
+#if SEXP_USE_STRING_INDEX_TABLE
+    asciip &= (sexp_string_index_table(sep) == SEXP_TRUE);
+#endif
   }
   res = sexp_make_string(ctx, sexp_make_fixnum(len), SEXP_VOID);
   p = sexp_string_data(res);
@@ -1219,6 +1477,10 @@ sexp sexp_string_concatenate_op (sexp ctx, sexp self, sexp_sint_t n, sexp str_ls
     }
   }
   *p = '\0';
+#if SEXP_USE_STRING_INDEX_TABLE
+  if (asciip)
+    sexp_string_index_table(res) = SEXP_TRUE;
+#endif
   return res;
 }
 
@@ -1235,24 +1497,56 @@ static sexp_uint_t sexp_string_hash(const char *str, sexp_sint_t len,
 
 #endif
 
+/* Rehashes the live symbols into a new table with at most half of */
+/* its slots used, also clearing out the slots of collected symbols. */
+static sexp sexp_resize_symbol_table (sexp ctx) {
+  sexp_uint_t i, j, live=0, size, mask, old_size;
+  sexp *old, *data, x;
+  sexp_gc_var1(table);
+  old_size = (sexp_vectorp(sexp_context_symbols(ctx))
+              ? sexp_vector_length(sexp_context_symbols(ctx)) : 0);
+  old = old_size ? sexp_vector_data(sexp_context_symbols(ctx)) : NULL;
+  for (i=0; i<old_size; i++)
+    if (sexp_lsymbolp(old[i]))
+      live++;
+  for (size=SEXP_INIT_SYMBOL_TABLE_SIZE; live*2 >= size; size*=2)
+    ;
+  sexp_gc_preserve1(ctx, table);
+  table = sexp_make_vector(ctx, sexp_make_fixnum(size), SEXP_FALSE);
+  if (!sexp_exceptionp(table)) {
+    /* the allocation may have collected more symbols */
+    old = sexp_vector_data(sexp_context_symbols(ctx));
+    data = sexp_vector_data(table);
+    mask = size - 1;
+    for (i=live=0; i<old_size; i++) {
+      if (sexp_lsymbolp(x = old[i])) {
+        for (j=sexp_lsymbol_hash(x) & mask; data[j] != SEXP_FALSE; j=(j+1) & mask)
+          ;
+        data[j] = x;
+        live++;
+      }
+    }
+    sexp_context_symbols(ctx) = table;
+    sexp_context_num_symbols(ctx) = sexp_make_fixnum(live);
+  }
+  sexp_gc_release1(ctx);
+  return table;
+}
+
 sexp sexp_intern(sexp ctx, const char *str, sexp_sint_t len) {
 #if SEXP_USE_HUFF_SYMS
   struct sexp_huff_entry he;
-  sexp_sint_t space, newbits;
+  sexp_sint_t space, newbits, i=0, res=0;
+  const char *p=str;
   char c;
 #endif
-  sexp ls, tmp;
+  sexp_uint_t hash=0, j, mask, slot;
+  sexp *data, tmp;
   sexp_gc_var1(sym);
-  sexp_sint_t bucket=0;
-#if (SEXP_USE_HASH_SYMS || SEXP_USE_HUFF_SYMS)
-  sexp_sint_t i=0, res=FNV_OFFSET_BASIS;
-  const char *p=str;
-#endif
 
   if (len < 0) len = strlen(str);
 
 #if SEXP_USE_HUFF_SYMS
-  res = 0;
   space = SEXP_IMMEDIATE_BITS;
   if (len == 0 || sexp_isdigit(p[0])
       || ((p[0] == '+' || p[0] == '-') && len > 1))
@@ -1273,22 +1567,51 @@ sexp sexp_intern(sexp ctx, const char *str, sexp_sint_t len) {
  normal_intern:
 #endif
 #if SEXP_USE_HASH_SYMS
-  bucket = (sexp_string_hash(p, len-i, res) % SEXP_SYMBOL_TABLE_SIZE);
+  hash = sexp_string_hash(str, len, FNV_OFFSET_BASIS);
 #endif
-  for (ls=sexp_context_symbols(ctx)[bucket]; sexp_pairp(ls); ls=sexp_cdr(ls))
-    if ((sexp_lsymbol_length(tmp=sexp_car(ls)) == len)
-        && ! strncmp(str, sexp_lsymbol_data(tmp), len))
-      return sexp_car(ls);
+  if (! sexp_vectorp(sexp_context_symbols(ctx))) {
+    tmp = sexp_resize_symbol_table(ctx);
+    if (sexp_exceptionp(tmp)) return tmp;
+  }
+
+  /* linear probing, stopping at the first empty slot */
+  data = sexp_vector_data(sexp_context_symbols(ctx));
+  mask = sexp_vector_length(sexp_context_symbols(ctx)) - 1;
+  for (j=hash & mask, slot=mask+1; (tmp=data[j]) != SEXP_FALSE; j=(j+1) & mask) {
+    if (! sexp_lsymbolp(tmp)) {
+      if (slot > mask) slot = j;
+    } else if (sexp_lsymbol_hash(tmp) == hash
+               && sexp_lsymbol_length(tmp) == (sexp_uint_t)len
+               && ! memcmp(str, sexp_lsymbol_data(tmp), len)) {
+      sexp_lsymbol_newp(tmp) = 1;
+      return tmp;
+    }
+  }
 
   /* not found, make a new symbol */
   sexp_gc_preserve1(ctx, sym);
-  sym = sexp_c_string(ctx, str, len);
-  if (sexp_exceptionp(sym)) return sym;
-#if ! SEXP_USE_PACKED_STRINGS
-  sym = sexp_string_bytes(sym);
-#endif
-  sexp_pointer_tag(sym) = SEXP_SYMBOL;
-  sexp_push(ctx, sexp_context_symbols(ctx)[bucket], sym);
+  sym = sexp_alloc_tagged(ctx, sexp_sizeof(symbol)+len+1, SEXP_SYMBOL);
+  if (sexp_exceptionp(sym)) {
+    sexp_gc_release1(ctx);
+    return sym;
+  }
+  sexp_lsymbol_length(sym) = len;
+  sexp_lsymbol_hash(sym) = hash;
+  sexp_lsymbol_newp(sym) = 1;
+  memcpy(sexp_lsymbol_data(sym), str, len);
+  sexp_lsymbol_data(sym)[len] = '\0';
+
+  /* reuse the first collected symbol's slot if we passed one, */
+  /* otherwise fill the empty one, growing the table past 3/4 full */
+  if (slot <= mask) {
+    data[slot] = sym;
+  } else {
+    data[j] = sym;
+    sexp_context_num_symbols(ctx)
+      = sexp_fx_add(sexp_context_num_symbols(ctx), SEXP_ONE);
+    if (sexp_unbox_fixnum(sexp_context_num_symbols(ctx)) * 4 > (mask + 1) * 3)
+      sexp_resize_symbol_table(ctx);
+  }
   sexp_gc_release1(ctx);
   return sym;
 }
@@ -1345,7 +1668,7 @@ int sexp_buffered_read_char (sexp ctx, sexp p) {
   } else if (!sexp_port_openp(p)) {
     return EOF;
   } else if (sexp_port_stream(p)) {
-    res = fread(sexp_port_buf(p), 1, SEXP_PORT_BUFFER_SIZE, sexp_port_stream(p));
+    res = fread(sexp_port_buf(p), 1, sexp_port_capacity(p), sexp_port_stream(p));
     if (res >= 0) {
       sexp_port_offset(p) = 0;
       sexp_port_size(p) = res;
@@ -1353,7 +1676,7 @@ int sexp_buffered_read_char (sexp ctx, sexp p) {
              ? ((unsigned char*)sexp_port_buf(p))[sexp_port_offset(p)++] : EOF);
     }
   } else if (sexp_filenop(sexp_port_fd(p))) {
-    res = read(sexp_port_fileno(p), sexp_port_buf(p), SEXP_PORT_BUFFER_SIZE);
+    res = read(sexp_port_fileno(p), sexp_port_buf(p), sexp_port_capacity(p));
     if (res >= 0) {
       sexp_port_offset(p) = 0;
       sexp_port_size(p) = res;
@@ -1362,10 +1685,13 @@ int sexp_buffered_read_char (sexp ctx, sexp p) {
     }
   } else if (sexp_port_customp(p)) {
     sexp_gc_preserve2(ctx, tmp, origbytes);
+    sexp_string_index_invalidate(sexp_port_buffer(p));
     tmp = sexp_list2(ctx, SEXP_ZERO, sexp_make_fixnum(SEXP_PORT_BUFFER_SIZE));
     origbytes = sexp_port_binaryp(p) && !SEXP_USE_PACKED_STRINGS ? sexp_string_bytes(sexp_port_buffer(p)) : sexp_port_buffer(p);
     tmp = sexp_cons(ctx, origbytes, tmp);
-    tmp = sexp_apply(ctx, sexp_port_reader(p), tmp);
+    tmp = sexp_apply_callback(ctx, sexp_port_reader(p), tmp);
+    if (sexp_exceptionp(tmp))
+      sexp_vector_set(sexp_port_cookie(p), SEXP_ZERO, tmp);
     if (sexp_fixnump(tmp) && sexp_unbox_fixnum(tmp) > 0) {
       sexp_port_offset(p) = 0;
       sexp_port_size(p) = sexp_unbox_fixnum(tmp);
@@ -1396,16 +1722,62 @@ int sexp_buffered_write_char (sexp ctx, int c, sexp p) {
   return 0;
 }
 
+#if SEXP_USE_VECTORED_IO
+/* Writes the buffered output followed by str with a single writev, */
+/* then any remainder of str directly, returning the number of bytes */
+/* of str written.  A short tail is left in the buffer. */
+static int sexp_buffered_writev (sexp ctx, const char *str,
+                                 sexp_uint_t len, sexp p) {
+  struct iovec iov[2];
+  long res, off = sexp_port_offset(p);
+  sexp_uint_t written = 0;
+  while (off > 0) {
+    iov[0].iov_base = sexp_port_buf(p);
+    iov[0].iov_len = off;
+    iov[1].iov_base = (void*)str;
+    iov[1].iov_len = len;
+    res = writev(sexp_port_fileno(p), iov, 2);
+    if (res <= 0)
+      return 0;
+    if (res < off) {
+      memmove(sexp_port_buf(p), sexp_port_buf(p) + res, off - res);
+      off -= res;
+    } else {
+      written = res - off;
+      off = 0;
+    }
+    sexp_port_offset(p) = off;
+  }
+  while (written < len) {
+    if (len - written < sexp_port_size(p)) {
+      memcpy(sexp_port_buf(p), str + written, len - written);
+      sexp_port_offset(p) = len - written;
+      written = len;
+    } else if ((res = write(sexp_port_fileno(p), str + written, len - written)) > 0) {
+      written += res;
+    } else {
+      break;
+    }
+  }
+  return written;
+}
+#endif
+
 int sexp_buffered_write_string_n (sexp ctx, const char *str,
                                   sexp_uint_t len, sexp p) {
   int diff, res, written=0;
+#if SEXP_USE_VECTORED_IO
+  if (sexp_port_offset(p)+len >= sexp_port_size(p) && !sexp_port_stream(p)
+      && sexp_filenop(sexp_port_fd(p)) && sexp_port_openp(p))
+    return sexp_buffered_writev(ctx, str, len, p);
+#endif
   while (sexp_port_offset(p)+len >= sexp_port_size(p)) {
     diff = sexp_port_size(p) - sexp_port_offset(p);
     memcpy(sexp_port_buf(p)+sexp_port_offset(p), str, diff);
     sexp_port_offset(p) = sexp_port_size(p);
     if ((res = sexp_buffered_flush(ctx, p, 0)))
       return written + diff;
-    written += sexp_port_size(p);
+    written += diff;
     str += diff;
     len -= diff;
   }
@@ -1418,8 +1790,16 @@ int sexp_buffered_write_string (sexp ctx, const char *str, sexp p) {
   return sexp_buffered_write_string_n(ctx, str, strlen(str), p);
 }
 
+/* Returns and clears the exception raised by a custom port's */
+/* procedures, which can't be raised from inside them. */
+sexp sexp_port_take_exception (sexp p) {
+  sexp res = sexp_port_exception(p);
+  sexp_vector_set(sexp_port_cookie(p), SEXP_ZERO, SEXP_FALSE);
+  return res;
+}
+
 int sexp_buffered_flush (sexp ctx, sexp p, int forcep) {
-  long res = 0, off;
+  long res = 0, off, len;
   sexp_gc_var1(tmp);
   if (!sexp_oportp(p) || (!forcep && !sexp_port_openp(p)))
     return -1;
@@ -1447,17 +1827,41 @@ int sexp_buffered_flush (sexp ctx, sexp p, int forcep) {
   } else if (sexp_port_offset(p) > 0) {
     sexp_gc_preserve1(ctx, tmp);
     if (sexp_port_customp(p)) {   /* custom port */
+      sexp_string_index_invalidate(sexp_port_buffer(p));
       tmp = sexp_list2(ctx, SEXP_ZERO, sexp_make_fixnum(sexp_port_offset(p)));
       tmp = sexp_cons(ctx, sexp_port_binaryp(p) ? sexp_string_bytes(sexp_port_buffer(p)) : sexp_port_buffer(p), tmp);
-      tmp = sexp_apply(ctx, sexp_port_writer(p), tmp);
-      res = (sexp_fixnump(tmp) && sexp_unbox_fixnum(tmp) > 0) ? 0 : -1;
-    } else {                      /* string port */
-      tmp = sexp_c_string(ctx, sexp_port_buf(p), off);
-      if (tmp && sexp_stringp(tmp)) {
-        sexp_push(ctx, sexp_cdr(sexp_port_cookie(p)), tmp);
+      tmp = sexp_apply_callback(ctx, sexp_port_writer(p), tmp);
+      if (sexp_exceptionp(tmp))
+        sexp_vector_set(sexp_port_cookie(p), SEXP_ZERO, tmp);
+      if (sexp_fixnump(tmp) && sexp_unbox_fixnum(tmp) > 0) {
+        /* keep anything the writer didn't accept for the next flush */
+        res = sexp_unbox_fixnum(tmp);
+        if (res < off)
+          memmove(sexp_port_buf(p), sexp_port_buf(p) + res, off - res);
+        sexp_port_offset(p) = (res < off) ? off - res : 0;
+        res = 0;
+      } else {
+        res = -1;
+      }
+    } else if (off < (long)sexp_port_size(p) - 1) {
+      res = 0;                    /* string port with room left */
+    } else {                      /* full string port */
+      /* keep the full buffer as a (bytes . used) chunk and continue */
+      /* in one twice as large */
+      len = sexp_port_size(p) * 2;
+      if (len > SEXP_STRING_PORT_MAX_CHUNK_SIZE)
+        len = SEXP_STRING_PORT_MAX_CHUNK_SIZE;
+      tmp = sexp_cons(ctx, sexp_car(sexp_port_cookie(p)), sexp_make_fixnum(off));
+      sexp_push(ctx, sexp_cdr(sexp_port_cookie(p)), tmp);
+      tmp = sexp_make_bytes(ctx, sexp_make_fixnum(len), SEXP_VOID);
+      if (sexp_bytesp(tmp)) {
+        sexp_car(sexp_port_cookie(p)) = tmp;
+        sexp_port_buf(p) = sexp_bytes_data(tmp);
+        sexp_port_size(p) = len;
         sexp_port_offset(p) = 0;
         res = 0;
       } else {
+        sexp_cdr(sexp_port_cookie(p)) = sexp_cddr(sexp_port_cookie(p));
         res = -1;
       }
     }
@@ -1500,29 +1904,54 @@ sexp sexp_open_output_string_op (sexp ctx, sexp self, sexp_sint_t n) {
   return res;
 }
 
+static int sexp_output_string_portp (sexp out) {
+  sexp ls;
+  if (!(sexp_pairp(sexp_port_cookie(out))
+        && sexp_bytesp(sexp_car(sexp_port_cookie(out)))))
+    return 0;
+  for (ls = sexp_cdr(sexp_port_cookie(out)); sexp_pairp(ls); ls = sexp_cdr(ls))
+    if (!(sexp_pairp(sexp_car(ls)) && sexp_bytesp(sexp_caar(ls))))
+      return 0;
+  return sexp_nullp(ls);
+}
+
 sexp sexp_get_output_string_op (sexp ctx, sexp self, sexp_sint_t n, sexp out) {
-  sexp res;
-  sexp_gc_var3(ls, rev, tmp);
+  sexp res, ls;
+  sexp_uint_t len;
+  char *p;
   sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
   if (!sexp_port_openp(out))
     return sexp_xtype_exception(ctx, self, "output port is closed", out);
-  sexp_gc_preserve3(ctx, ls, rev, tmp);
-  if (sexp_port_offset(out) > 0) {
-    tmp = sexp_c_string(ctx, sexp_port_buf(out), sexp_port_offset(out));
-    rev = sexp_cons(ctx, tmp, sexp_cdr(sexp_port_cookie(out)));
-  } else {
-    rev = sexp_cdr(sexp_port_cookie(out));
-  }
-  ls = sexp_reverse(ctx, rev);
-  res = SEXP_FALSE;
-  for (tmp = ls; sexp_pairp(tmp); tmp = sexp_cdr(tmp))
-    if (!sexp_stringp(sexp_car(tmp)))
-      res = sexp_xtype_exception(ctx, self, "not an output string port", out);
-  if (!sexp_nullp(tmp))
-    res = sexp_xtype_exception(ctx, self, "not an output string port", out);
-  if (!sexp_exceptionp(res))
-    res = sexp_string_concatenate(ctx, ls, SEXP_FALSE);
-  sexp_gc_release3(ctx);
+  if (!sexp_output_string_portp(out))
+    return sexp_xtype_exception(ctx, self, "not an output string port", out);
+  len = sexp_port_offset(out);
+  for (ls = sexp_cdr(sexp_port_cookie(out)); sexp_pairp(ls); ls = sexp_cdr(ls))
+    len += sexp_unbox_fixnum(sexp_cdar(ls));
+  res = sexp_make_string(ctx, sexp_make_fixnum(len), SEXP_VOID);
+  if (sexp_exceptionp(res)) return res;
+  /* the chunks are newest first, so fill in from the end */
+  p = sexp_string_data(res) + len;
+  *p = '\0';
+  p -= sexp_port_offset(out);
+  memcpy(p, sexp_port_buf(out), sexp_port_offset(out));
+  for (ls = sexp_cdr(sexp_port_cookie(out)); sexp_pairp(ls); ls = sexp_cdr(ls)) {
+    p -= sexp_unbox_fixnum(sexp_cdar(ls));
+    memcpy(p, sexp_bytes_data(sexp_caar(ls)), sexp_unbox_fixnum(sexp_cdar(ls)));
+  }
+  return res;
+}
+
+sexp sexp_output_string_chunks (sexp ctx, sexp self, sexp out) {
+  sexp_gc_var2(res, tmp);
+  sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
+  if (!sexp_output_string_portp(out))
+    return sexp_xtype_exception(ctx, self, "not an output string port", out);
+  sexp_gc_preserve2(ctx, res, tmp);
+  tmp = sexp_cons(ctx, sexp_car(sexp_port_cookie(out)),
+                  sexp_make_fixnum(sexp_port_offset(out)));
+  res = sexp_cons(ctx, tmp, sexp_cdr(sexp_port_cookie(out)));
+  res = sexp_reverse(ctx, res);
+  sexp_gc_release2(ctx);
   return res;
 }
 
@@ -1663,6 +2092,7 @@ sexp sexp_make_input_port (sexp ctx, FILE* in, sexp name) {
   sexp_port_no_closep(p) = 0;
   sexp_port_sourcep(p) = 0;
   sexp_port_blockedp(p) = 0;
+  sexp_port_mmappedp(p) = 0;
 #if SEXP_USE_FOLD_CASE_SYMS
   sexp_port_fold_casep(p) = sexp_truep(sexp_global(ctx, SEXP_G_FOLD_CASE_P));
 #endif
@@ -1782,6 +2212,66 @@ void sexp_maybe_unblock_port (sexp ctx, sexp port) {
     fcntl(sexp_port_fileno(port), F_SETFL, sexp_port_flags(port));
   }
 }
+
+/* A non-blocking buffered descriptor port can hold a partial read in */
+/* its buffer and rewind to yield, instead of blocking the whole VM. */
+int sexp_port_nonblockingp (sexp ctx, sexp in) {
+  if (!sexp_port_buf(in) || sexp_port_stream(in)
+      || !sexp_stringp(sexp_port_cookie(in))
+      || !sexp_filenop(sexp_port_fd(in)) || sexp_port_fileno(in) < 0
+      || sexp_port_blockedp(in))
+    return 0;
+  if (sexp_port_flags(in) == SEXP_PORT_UNKNOWN_FLAGS)
+    sexp_port_flags(in) = fcntl(sexp_port_fileno(in), F_GETFL);
+  return (sexp_port_flags(in) & O_NONBLOCK) != 0;
+}
+
+/* Reads more input into the buffer of such a port, keeping everything */
+/* from *mark on (moved to the start of the buffer, updating *mark) */
+/* and growing the buffer when full.  Returns as read(2) does, waiting */
+/* for input if there are no other threads to yield to. */
+sexp_sint_t sexp_extend_port_buffer (sexp ctx, sexp in, sexp_uint_t *mark) {
+  sexp_uint_t keep, cap;
+  sexp_sint_t res;
+  struct pollfd pfd;
+  sexp_gc_var1(str);
+  if (*mark > 0) {
+    keep = sexp_port_size(in) - *mark;
+    memmove(sexp_port_buf(in), sexp_port_buf(in) + *mark, keep);
+    sexp_port_offset(in) -= *mark;
+    sexp_port_size(in) = keep;
+    *mark = 0;
+  }
+  keep = sexp_port_size(in);
+  cap = sexp_string_size(sexp_port_cookie(in));
+  if (keep >= cap) {
+    sexp_gc_preserve1(ctx, str);
+    str = sexp_make_string(ctx, sexp_make_fixnum(cap * 2), SEXP_VOID);
+    if (sexp_exceptionp(str)) {
+      sexp_gc_release1(ctx);
+      errno = ENOMEM;
+      return -1;
+    }
+    memcpy(sexp_string_data(str), sexp_port_buf(in), keep);
+    sexp_port_cookie(in) = str;
+    sexp_port_buf(in) = sexp_string_data(str);
+    sexp_port_size(in) = keep;
+    cap *= 2;
+    sexp_gc_release1(ctx);
+  }
+  while ((res = read(sexp_port_fileno(in), sexp_port_buf(in) + keep, cap - keep)) < 0
+         && (errno == EINTR
+             || (errno == EAGAIN
+                 && !sexp_applicablep(sexp_global(ctx, SEXP_G_THREADS_BLOCKER))))) {
+    if (errno == EAGAIN) {
+      pfd.fd = sexp_port_fileno(in);
+      pfd.events = POLLIN;
+      poll(&pfd, 1, -1);
+    }
+  }
+  if (res > 0) sexp_port_size(in) += res;
+  return res;
+}
 #endif
 
 #if SEXP_USE_GREEN_THREADS
@@ -1827,6 +2317,295 @@ sexp sexp_char_ready_p (sexp ctx, sexp self, sexp_sint_t n, sexp in) {
 
 #define NUMBUF_LEN 32
 
+/* Decimal conversion of doubles.  Printing finds the shortest digit */
+/* string which reads back to the same double (Giulietti's Schubfach */
+/* algorithm), and parsing rounds correctly, both using the table of */
+/* 126-bit approximations of powers of ten in sexp-pow10tab.h.  Digit */
+/* strings whose rounding can't be decided from the table fall back */
+/* to strtod. */
+
+#define SEXP_MASK63 0x7FFFFFFFFFFFFFFFuLL
+#define SEXP_DOUBLE_MANT_BITS 52
+#define SEXP_DOUBLE_C_MIN (1uLL<<SEXP_DOUBLE_MANT_BITS)
+#define SEXP_DOUBLE_Q_MIN (-1074)
+#define SEXP_DOUBLE_C_TINY 3
+
+/* floor(log10(2^q)), floor(log10(3/4 * 2^q)) and floor(log2(10^e)) */
+#define sexp_flog10_pow2(q) ((int)(((long long)(q)*661971961083LL)>>41))
+#define sexp_flog10_three_quarters_pow2(q) \
+  ((int)(((long long)(q)*661971961083LL - 274743187321LL)>>41))
+#define sexp_flog2_pow10(e) ((int)(((long long)(e)*913124641741LL)>>38))
+
+union sexp_double_bits {
+  double d;
+  unsigned long long u;
+};
+
+/* the high 64 bits of a*b, storing the low 64 bits in *lo */
+static unsigned long long sexp_mul_hi64 (unsigned long long a,
+                                         unsigned long long b,
+                                         unsigned long long *lo) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a * b;
+  *lo = (unsigned long long)p;
+  return (unsigned long long)(p >> 64);
+#else
+  unsigned long long a0 = a & 0xFFFFFFFFuLL, a1 = a >> 32,
+    b0 = b & 0xFFFFFFFFuLL, b1 = b >> 32, p00, p01, p10, mid;
+  p00 = a0 * b0; p01 = a0 * b1; p10 = a1 * b0;
+  mid = (p00 >> 32) + (p01 & 0xFFFFFFFFuLL) + (p10 & 0xFFFFFFFFuLL);
+  *lo = (mid << 32) | (p00 & 0xFFFFFFFFuLL);
+  return a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+static int sexp_clz64 (unsigned long long x) {
+#ifdef __GNUC__
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+  for ( ; ! (x & (1uLL<<63)); x <<= 1) n++;
+  return n;
+#endif
+}
+
+#if SEXP_USE_FLONUMS && ! SEXP_USE_IMMEDIATE_FLONUMS
+
+/* cp * g / 2^127 rounded to odd, for g = g1*2^63 + g0 */
+static unsigned long long sexp_pow10_rop (unsigned long long g1,
+                                          unsigned long long g0,
+                                          unsigned long long cp) {
+  unsigned long long x1, y0, y1, z, tmp;
+  x1 = sexp_mul_hi64(g0, cp, &tmp);
+  y1 = sexp_mul_hi64(g1, cp, &y0);
+  z = (y0 >> 1) + x1;
+  return (y1 + (z >> 63)) | (((z & SEXP_MASK63) + SEXP_MASK63) >> 63);
+}
+
+/* the shortest decimal f*10^e in the rounding interval of c*2^q */
+static void sexp_to_decimal (int q, unsigned long long c, int dk,
+                             unsigned long long *f, int *e) {
+  unsigned long long out = c & 1, cb = c << 2, cbr = cb + 2, cbl,
+    g1, g0, vb, vbl, vbr, s, t, sp10, tp10, tmp;
+  int k, h, upin, wpin, uin, win;
+  long long cmp;
+  if (c != SEXP_DOUBLE_C_MIN || q == SEXP_DOUBLE_Q_MIN) {
+    cbl = cb - 2;
+    k = sexp_flog10_pow2(q);
+  } else {
+    cbl = cb - 1;
+    k = sexp_flog10_three_quarters_pow2(q);
+  }
+  h = q + sexp_flog2_pow10(-k) + 2;
+  g1 = sexp_pow10_tab[-k - SEXP_POW10_MIN][0];
+  g0 = sexp_pow10_tab[-k - SEXP_POW10_MIN][1];
+  vb = sexp_pow10_rop(g1, g0, cb << h);
+  vbl = sexp_pow10_rop(g1, g0, cbl << h);
+  vbr = sexp_pow10_rop(g1, g0, cbr << h);
+  s = vb >> 2;
+  *e = k + dk;
+  if (s >= 10) {
+    /* try the shorter candidates 10*(s/10) and 10*(s/10)+10 */
+    sp10 = 10 * sexp_mul_hi64(s, 115292150460684698uLL << 4, &tmp);
+    tp10 = sp10 + 10;
+    upin = vbl + out <= sp10 << 2;
+    wpin = (tp10 << 2) + out <= vbr;
+    if (upin != wpin) {
+      *f = upin ? sp10 : tp10;
+      return;
+    }
+  }
+  t = s + 1;
+  uin = vbl + out <= s << 2;
+  win = (t << 2) + out <= vbr;
+  if (uin != win) {
+    *f = uin ? s : t;
+  } else {
+    /* both s and t are in range, pick the closer or the even one */
+    cmp = (long long)(vb - ((s + t) << 1));
+    *f = (cmp < 0 || (cmp == 0 && ! (s & 1))) ? s : t;
+  }
+}
+
+/* write the finite double f to buf, returning the length */
+static int sexp_flonum_to_string (double f, char *buf) {
+  union sexp_double_bits x;
+  unsigned long long t, c, d;
+  int mq, bq, e, n, i, len = 0;
+  char digits[24];
+  x.d = f;
+  if (x.u >> 63) {
+    buf[len++] = '-';
+    x.u &= ~(1uLL<<63);
+  }
+  if (x.u == 0) {
+    strcpy(buf+len, "0.0");
+    return len + 3;
+  }
+  t = x.u & (SEXP_DOUBLE_C_MIN - 1);
+  bq = (int)(x.u >> SEXP_DOUBLE_MANT_BITS);
+  if (bq == 0x7FF) {
+    return len + snprintf(buf+len, 16, "%g", x.d);
+  } else if (bq != 0) {
+    mq = 1075 - bq;
+    c = SEXP_DOUBLE_C_MIN | t;
+    if (0 < mq && mq < 53 && ((c >> mq) << mq) == c) {
+      /* small integers are their own shortest representation */
+      d = c >> mq;
+      e = 0;
+    } else {
+      sexp_to_decimal(-mq, c, 0, &d, &e);
+    }
+  } else if (t < SEXP_DOUBLE_C_TINY) {
+    sexp_to_decimal(SEXP_DOUBLE_Q_MIN, 10 * t, -1, &d, &e);
+  } else {
+    sexp_to_decimal(SEXP_DOUBLE_Q_MIN, t, 0, &d, &e);
+  }
+  for ( ; d % 10 == 0; d /= 10) e++;
+  for (n = 0; d > 0; d /= 10) digits[n++] = '0' + d % 10;
+  /* digits are in reverse, the value is 0.d1d2...dn * 10^(e+n) */
+  e += n - 1;
+  if (e < -4 || e >= 15) {
+    /* scientific notation in the format of %g */
+    buf[len++] = digits[n-1];
+    if (n > 1) {
+      buf[len++] = '.';
+      for (i = n-2; i >= 0; i--) buf[len++] = digits[i];
+    }
+    buf[len++] = 'e';
+    buf[len++] = (e < 0 ? '-' : '+');
+    len += snprintf(buf+len, 16, "%02d", e < 0 ? -e : e);
+  } else if (e < 0) {
+    buf[len++] = '0';
+    buf[len++] = '.';
+    for (i = e+1; i < 0; i++) buf[len++] = '0';
+    for (i = n-1; i >= 0; i--) buf[len++] = digits[i];
+    buf[len] = '\0';
+  } else {
+    for (i = n-1; i >= n-1-e; i--) buf[len++] = (i >= 0 ? digits[i] : '0');
+    buf[len++] = '.';
+    if (i < 0) buf[len++] = '0';
+    for ( ; i >= 0; i--) buf[len++] = digits[i];
+    buf[len] = '\0';
+  }
+  return len;
+}
+
+#endif
+
+/* exact powers of ten for the fast parsing path */
+static const double sexp_exact_pow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* round the 192-bit p2:p1:p0 * 2^r to a 53-bit significand m and */
+/* binary exponent, with m*2^(*e-52) the rounded value */
+static unsigned long long sexp_round_to_double (unsigned long long p2,
+                                                unsigned long long p1,
+                                                unsigned long long p0,
+                                                int r, int *e) {
+  unsigned long long m;
+  int lz;
+  if (p2 == 0) {
+    /* the products below are always at least 2^124 */
+    p2 = p1; p1 = p0; p0 = 0; r -= 64;
+  }
+  lz = sexp_clz64(p2);
+  if (lz > 0) {
+    p2 = (p2 << lz) | (p1 >> (64 - lz));
+    p1 = (p1 << lz) | (p0 >> (64 - lz));
+    p0 <<= lz;
+  }
+  *e = 191 - lz + r;
+  m = p2 >> 11;
+  if ((p2 & 0x400) && ((m & 1) || (p2 & 0x3FF) || p1 || p0)) {
+    if (++m == (1uLL<<53)) {
+      m >>= 1;
+      (*e)++;
+    }
+  }
+  return m;
+}
+
+/* w*g as a 192-bit number, for g = g1*2^63 + g0 */
+static void sexp_mul_pow10 (unsigned long long w, unsigned long long g1,
+                            unsigned long long g0, unsigned long long *p) {
+  unsigned long long hi = g1 >> 1, lo = (g1 << 63) | g0, h0, l0, h1, l1;
+  h0 = sexp_mul_hi64(w, lo, &l0);
+  h1 = sexp_mul_hi64(w, hi, &l1);
+  p[0] = l0;
+  p[1] = l1 + h0;
+  p[2] = h1 + (p[1] < h0);
+}
+
+/* the double nearest to w*10^q, where truncp indicates nonzero digits */
+/* were dropped after w, or 0 if this can't be decided from the table */
+static int sexp_pow10_to_double (unsigned long long w, int truncp, long q,
+                                 double *res) {
+  union sexp_double_bits x;
+  unsigned long long g1, g0, lo[3], hi[3], m_lo, m_hi;
+  int r, e_lo, e_hi;
+  if (w == 0) {
+    *res = 0.0;
+    return 1;
+  }
+  if (! truncp && w <= (1uLL<<53) && q >= -22 && q <= 22) {
+    *res = (q < 0 ? (double)w / sexp_exact_pow10[-q]
+            : (double)w * sexp_exact_pow10[q]);
+    return 1;
+  }
+  if (q < SEXP_POW10_MIN) {
+    *res = 0.0;
+    return 1;
+  }
+  if (q > SEXP_POW10_MAX) {
+    *res = HUGE_VAL;
+    return 1;
+  }
+  /* the true value lies strictly between w*(g-1) and (w+truncp)*g */
+  /* times 2^r, and it rounds to the same double if both bounds do */
+  g1 = sexp_pow10_tab[q - SEXP_POW10_MIN][0];
+  g0 = sexp_pow10_tab[q - SEXP_POW10_MIN][1];
+  r = sexp_flog2_pow10(q) - 125;
+  sexp_mul_pow10(w + truncp, g1, g0, hi);
+  if (g0 == 0)
+    sexp_mul_pow10(w, g1 - 1, SEXP_MASK63, lo);
+  else
+    sexp_mul_pow10(w, g1, g0 - 1, lo);
+  m_lo = sexp_round_to_double(lo[2], lo[1], lo[0], r, &e_lo);
+  m_hi = sexp_round_to_double(hi[2], hi[1], hi[0], r, &e_hi);
+  if (m_lo != m_hi || e_lo != e_hi || e_lo < -1022 || e_lo > 1023)
+    return 0;
+  x.u = ((unsigned long long)(e_lo + 1023) << SEXP_DOUBLE_MANT_BITS)
+    | (m_lo & (SEXP_DOUBLE_C_MIN - 1));
+  *res = x.d;
+  return 1;
+}
+
+/* the double nearest to the decimal digits[0..n) * 10^exp, where */
+/* digits has room for at least 24 more chars */
+static double sexp_decimal_to_double (char *digits, int n, long exp) {
+  unsigned long long w = 0;
+  int i, truncp = 0;
+  double res;
+  for ( ; n > 0 && *digits == '0'; digits++, n--)
+    ;
+  for (i = 0; i < n && i < 19; i++)
+    w = w * 10 + (digits[i] - '0');
+  for ( ; i < n; i++)
+    if (digits[i] != '0') {
+      truncp = 1;
+      break;
+    }
+  if (exp < -100000) exp = -100000;
+  else if (exp > 100000) exp = 100000;
+  if (sexp_pow10_to_double(w, truncp, exp + (n > 19 ? n - 19 : 0), &res))
+    return res;
+  snprintf(digits+n, 24, "e%ld", exp);
+  return strtod(digits, NULL);
+}
+
 static struct {const char* name; char ch;} sexp_char_names[] = {
   {"newline", '\n'},
   {"return", '\r'},
@@ -1908,12 +2687,7 @@ sexp sexp_write_one (sexp ctx, sexp obj, sexp out) {
         strcpy(numbuf+1, isinf(f) ? "inf.0" : "nan.0");
       } else
 #endif
-      {
-        i = snprintf(numbuf, NUMBUF_LEN, "%.15g", f);
-        if (!strchr(numbuf, '.') && !strchr(numbuf, 'e')) {
-          numbuf[i++] = '.'; numbuf[i++] = '0'; numbuf[i++] = '\0';
-        }
-      }
+        sexp_flonum_to_string(f, numbuf);
       sexp_write_string(ctx, numbuf, out);
       break;
 #endif
@@ -2197,6 +2971,8 @@ sexp sexp_flush_output_op (sexp ctx, sexp self, sexp_sint_t n, sexp out) {
   int res;
   sexp_assert_type(ctx, sexp_oportp, SEXP_OPORT, out);
   res = sexp_flush_forced(ctx, out);
+  if (sexp_port_exceptionp(out))
+    return sexp_port_take_exception(out);
   if (res == EOF) {
 #if SEXP_USE_GREEN_THREADS
     if (sexp_port_stream(out) && ferror(sexp_port_stream(out)) && (errno == EAGAIN))
@@ -2216,9 +2992,21 @@ sexp sexp_read_string (sexp ctx, sexp in, int sentinel) {
   int c, i=0;
   sexp_sint_t size=INIT_STRING_BUFFER_SIZE;
   char initbuf[INIT_STRING_BUFFER_SIZE];
-  char *buf=initbuf, *tmp;
+  char *buf=initbuf, *tmp, *start, *end;
   sexp res = SEXP_FALSE;
 
+  /* if the whole string is buffered without escapes, copy it directly */
+  if (sexp_port_buf(in) && sexp_port_offset(in) < sexp_port_size(in)) {
+    start = sexp_port_buf(in) + sexp_port_offset(in);
+    end = memchr(start, sentinel, sexp_port_size(in) - sexp_port_offset(in));
+    if (end && !memchr(start, '\\', end - start)) {
+      for (tmp = start; (tmp = memchr(tmp, '\n', end - tmp)); tmp++)
+        sexp_port_line(in)++;
+      sexp_port_offset(in) += end - start + 1;
+      return sexp_c_string(ctx, start, end - start);
+    }
+  }
+
   for (c = sexp_read_char(ctx, in); c != sentinel; c = sexp_read_char(ctx, in)) {
     if (c == '\\') {
       c = sexp_read_char(ctx, in);
@@ -2294,13 +3082,31 @@ sexp sexp_read_string (sexp ctx, sexp in, int sentinel) {
 sexp sexp_read_symbol (sexp ctx, sexp in, int init, int internp) {
   int c, i=0, size=INIT_STRING_BUFFER_SIZE;
   char initbuf[INIT_STRING_BUFFER_SIZE];
-  char *buf=initbuf, *tmp;
+  char *buf=initbuf, *tmp, *end;
   sexp res=SEXP_VOID;
 #if SEXP_USE_FOLD_CASE_SYMS
   int foldp = sexp_port_fold_casep(in);
   init = (foldp ? sexp_tolower(init) : init);
+#else
+  int foldp = 0;
 #endif
 
+  /* if init was just read and the rest of the token is buffered */
+  /* without escapes, intern it in place */
+  if (!foldp && init != EOF && sexp_port_buf(in) && sexp_port_offset(in) > 0
+      && sexp_port_buf(in)[sexp_port_offset(in)-1] == (char)init) {
+    tmp = sexp_port_buf(in) + sexp_port_offset(in) - 1;
+    end = sexp_port_buf(in) + sexp_port_size(in);
+    for (i = 1; tmp + i < end; i++)
+      if (sexp_char_class(tmp[i]) & (SEXP_CC_SEPARATOR|SEXP_CC_ESCAPE))
+        break;
+    if (tmp + i < end && tmp[i] != '\\') {
+      sexp_port_offset(in) += i - 1;
+      return internp ? sexp_intern(ctx, tmp, i) : sexp_c_string(ctx, tmp, i);
+    }
+    i = 0;
+  }
+
   if (init != EOF)
     buf[i++] = init;
 
@@ -2427,21 +3233,42 @@ sexp sexp_read_polar_tail (sexp ctx, sexp in, sexp magnitude) {
 #endif
 #endif
 
-sexp sexp_read_float_tail (sexp ctx, sexp in, double whole, int negp) {
-  int c, c2;
+/* Reads the fraction and exponent of a decimal whose whole part is */
+/* the n digits in whole times 10^exp. */
+sexp sexp_read_decimal_tail (sexp ctx, sexp in, const char *whole,
+                             int n, long exp, int negp) {
+  int c, c2, sticky=0;
+  char digits[SEXP_MAX_DECIMAL_DIGITS+32];
   sexp exponent=SEXP_VOID;
-  double val=0.0, scale=0.1, e=0.0;
+  double val, e=0.0;
   sexp_gc_var1(res);
   sexp_gc_preserve1(ctx, res);
-  for (c=sexp_read_char(ctx, in); sexp_isdigit(c);
-       c=sexp_read_char(ctx, in), scale*=0.1)
-    val += digit_value(c)*scale;
+  memcpy(digits, whole, n);
+  for ( ; exp > 0 && n < SEXP_MAX_DECIMAL_DIGITS; exp--)
+    digits[n++] = '0';
+  for (c=sexp_read_char(ctx, in); sexp_isdigit(c); c=sexp_read_char(ctx, in)) {
+    if (n < SEXP_MAX_DECIMAL_DIGITS) {
+      digits[n++] = c;
+      exp--;
+    } else if (c != '0') {
+      sticky = 1;
+    }
+  }
 #if SEXP_USE_PLACEHOLDER_DIGITS
-  for (; c==SEXP_PLACEHOLDER_DIGIT; c=sexp_read_char(ctx, in), scale*=0.1)
-    val += sexp_placeholder_digit_value(10)*scale;
+  for (; c==SEXP_PLACEHOLDER_DIGIT; c=sexp_read_char(ctx, in)) {
+    if (n < SEXP_MAX_DECIMAL_DIGITS) {
+      digits[n++] = '0' + sexp_placeholder_digit_value(10);
+      exp--;
+    } else {
+      sticky = 1;
+    }
+  }
 #endif
-  val += whole;
-  if (negp) val *= -1;
+  /* beyond the maximum digits only whether any are nonzero matters */
+  if (sticky) {
+    digits[n++] = '1';
+    exp--;
+  }
   if (is_precision_indicator(c)) {
     c2 = sexp_read_char(ctx, in);
     if (c2 != '+') sexp_push_char(ctx, c2, in);
@@ -2458,19 +3285,22 @@ sexp sexp_read_float_tail (sexp ctx, sexp in, double whole, int negp) {
 #endif
     e = (sexp_fixnump(exponent) ? sexp_unbox_fixnum(exponent)
          : sexp_flonump(exponent) ? sexp_flonum_value(exponent) : 0.0);
+    if (e > 1e6) e = 1e6;
+    else if (e < -1e6) e = -1e6;
+  }
+  val = sexp_decimal_to_double(digits, n, exp + (long)e);
+  if (negp) val *= -1;
 #if SEXP_USE_COMPLEX
-    if (sexp_complexp(res)) {
-      if (sexp_complex_real(res) == SEXP_ZERO) {
-        sexp_complex_imag(res) = sexp_make_flonum(ctx, val * pow(10, e));
-      } else {
-        sexp_complex_real(res) = sexp_make_flonum(ctx, val * pow(10, e));
-      }
-      sexp_gc_release1(ctx);
-      return res;
+  if (is_precision_indicator(c) && sexp_complexp(res)) {
+    if (sexp_complex_real(res) == SEXP_ZERO) {
+      sexp_complex_imag(res) = sexp_make_flonum(ctx, val);
+    } else {
+      sexp_complex_real(res) = sexp_make_flonum(ctx, val);
     }
-#endif
+    sexp_gc_release1(ctx);
+    return res;
   }
-  if (e != 0.0) val *= pow(10, e);
+#endif
 #if SEXP_USE_FLONUMS
   res = sexp_make_flonum(ctx, val);
 #else
@@ -2493,6 +3323,25 @@ sexp sexp_read_float_tail (sexp ctx, sexp in, double whole, int negp) {
   return res;
 }
 
+sexp sexp_read_float_tail (sexp ctx, sexp in, double whole, int negp) {
+  char digits[SEXP_MAX_DECIMAL_DIGITS+32];
+  int n;
+  long exp = 0;
+  whole = fabs(whole);
+  if (isinf(whole)) {
+    n = 1; digits[0] = '1'; exp = 400;
+  } else if (whole == floor(whole)) {
+    n = snprintf(digits, SEXP_MAX_DECIMAL_DIGITS, "%.0f", whole);
+  } else {
+    /* a fractional whole part, only from placeholder digits */
+    n = snprintf(digits, SEXP_MAX_DECIMAL_DIGITS, "%.17e", whole);
+    exp = strtol(digits+20, NULL, 10) - 17;
+    memmove(digits+1, digits+2, 17);
+    n = 18;
+  }
+  return sexp_read_decimal_tail(ctx, in, digits, n, exp, negp);
+}
+
 #if SEXP_USE_RATIOS
 sexp sexp_make_ratio (sexp ctx, sexp num, sexp den) {
   sexp res = sexp_alloc_type(ctx, ratio, SEXP_RATIO);
@@ -2502,7 +3351,6 @@ sexp sexp_make_ratio (sexp ctx, sexp num, sexp den) {
 }
 
 sexp sexp_ratio_normalize (sexp ctx, sexp rat, sexp in) {
-  sexp tmp;
   sexp_gc_var2(num, den);
   num = sexp_ratio_numerator(rat), den = sexp_ratio_denominator(rat);
   if (den == SEXP_ZERO)
@@ -2510,13 +3358,10 @@ sexp sexp_ratio_normalize (sexp ctx, sexp rat, sexp in) {
   else if (num == SEXP_ZERO)
     return SEXP_ZERO;
   sexp_gc_preserve2(ctx, num, den);
-  while (den != SEXP_ZERO) {
-    tmp = sexp_remainder(ctx, num, den);
-    if (sexp_exceptionp(tmp)) {
-      sexp_gc_release2(ctx);
-      return tmp;
-    }
-    num = den, den = tmp;
+  num = sexp_gcd(ctx, num, den);
+  if (sexp_exceptionp(num)) {
+    sexp_gc_release2(ctx);
+    return num;
   }
   sexp_ratio_denominator(rat)
     = den = sexp_quotient(ctx, sexp_ratio_denominator(rat), num);
@@ -2537,6 +3382,7 @@ sexp sexp_ratio_normalize (sexp ctx, sexp rat, sexp in) {
 sexp sexp_read_number (sexp ctx, sexp in, int base, int exactp) {
   sexp_sint_t val = 0, tmp = -1;
   int c, digit, negativep = 0;
+  char digits[24];
 #if SEXP_USE_PLACEHOLDER_DIGITS
   double whole = 0.0, scale = 0.1;
 #endif
@@ -2626,7 +3472,10 @@ sexp sexp_read_number (sexp ctx, sexp in, int base, int exactp) {
     if (base != 10)
       return sexp_read_error(ctx, "found non-base 10 float", SEXP_NULL, in);
     if (c!='.') sexp_push_char(ctx, c, in);
-    return sexp_read_float_tail(ctx, in, val, negativep);
+    for (digit=sizeof(digits); val > 0 || digit == sizeof(digits); val /= 10)
+      digits[--digit] = '0' + val % 10;
+    return sexp_read_decimal_tail(ctx, in, digits+digit,
+                                  sizeof(digits)-digit, 0, negativep);
   } else if (c=='/') {
     sexp_gc_preserve2(ctx, res, den);
     den = sexp_read_number(ctx, in, base, exactp);
@@ -2727,6 +3576,42 @@ static int sexp_peek_char(sexp ctx, sexp in) {
 
 sexp sexp_read_one (sexp ctx, sexp in, sexp *shares);
 
+/* Reads the rest of a decimal fixnum directly from the port buffer, */
+/* returning false without consuming anything unless the token is a */
+/* plain fixnum ending within the buffer. */
+static int sexp_read_buffered_fixnum (sexp in, sexp_sint_t val, int negp, sexp *res) {
+  unsigned char *p, *end;
+  if (!sexp_port_buf(in)) return 0;
+  p = (unsigned char*)sexp_port_buf(in) + sexp_port_offset(in);
+  end = (unsigned char*)sexp_port_buf(in) + sexp_port_size(in);
+  for ( ; p < end && (sexp_char_class(*p) & SEXP_CC_DIGIT); p++) {
+    if (val > (SEXP_MAX_FIXNUM - 9) / 10) return 0;
+    val = val * 10 + (*p - '0');
+  }
+  if (p >= end || !(sexp_char_class(*p) & SEXP_CC_SEPARATOR)) return 0;
+  sexp_port_offset(in) = (char*)p - sexp_port_buf(in);
+  *res = sexp_make_fixnum(negp ? -val : val);
+  return 1;
+}
+
+/* Skips whitespace and complete line comments in the port buffer. */
+static void sexp_skip_buffered_space (sexp in) {
+  char *p, *q, *end;
+  p = sexp_port_buf(in) + sexp_port_offset(in);
+  end = sexp_port_buf(in) + sexp_port_size(in);
+  while (p < end) {
+    if (sexp_char_class(*p) & SEXP_CC_SPACE) {
+      if (*p++ == '\n') sexp_port_line(in)++;
+    } else if (*p == ';' && (q = memchr(p, '\n', end - p))) {
+      sexp_port_line(in)++;
+      p = q + 1;
+    } else {
+      break;
+    }
+  }
+  sexp_port_offset(in) = p - sexp_port_buf(in);
+}
+
 sexp sexp_read_raw (sexp ctx, sexp in, sexp *shares) {
   char *str;
   int c1, c2, line;
@@ -2735,6 +3620,8 @@ sexp sexp_read_raw (sexp ctx, sexp in, sexp *shares) {
   sexp_gc_preserve2(ctx, res, tmp);
 
  scan_loop:
+  if (sexp_port_buf(in))
+    sexp_skip_buffered_space(in);
   switch (c1 = sexp_read_char(ctx, in)) {
   case EOF:
     res = SEXP_EOF;
@@ -3156,6 +4043,9 @@ sexp sexp_read_raw (sexp ctx, sexp in, sexp *shares) {
   case '+':
   case '-':
     c2 = sexp_read_char(ctx, in);
+    if (sexp_isdigit(c2)
+        && sexp_read_buffered_fixnum(in, c2 - '0', c1 == '-', &res))
+      break;
     if ((c2 == '.' && sexp_isdigit(sexp_peek_char(ctx, in)))
         || sexp_isdigit(c2)) {
       sexp_push_char(ctx, c2, in);
@@ -3244,6 +4134,8 @@ sexp sexp_read_raw (sexp ctx, sexp in, sexp *shares) {
     break;
   case '0': case '1': case '2': case '3': case '4':
   case '5': case '6': case '7': case '8': case '9':
+    if (sexp_read_buffered_fixnum(in, c1 - '0', 0, &res))
+      break;
     sexp_push_char(ctx, c1, in);
     res = sexp_read_number(ctx, in, 10, 0);
     break;
@@ -3278,6 +4170,8 @@ sexp sexp_read_op (sexp ctx, sexp self, sexp_sint_t n, sexp in) {
   sexp_check_block_port(ctx, in, 0);
   sexp_gc_preserve1(ctx, shares);
   res = sexp_read_one(ctx, in, &shares);
+  if (sexp_port_exceptionp(in))
+    res = sexp_port_take_exception(in);
 #if SEXP_USE_READER_LABELS
   if (!sexp_exceptionp(res) && sexp_vectorp(shares)) {
     res = sexp_fill_reader_labels(ctx, res, shares, 1);  /* mark=1 */
@@ -3347,9 +4241,6 @@ sexp sexp_symbol_to_string_op (sexp ctx, sexp self, sexp_sint_t n, sexp sym) {
 }
 
 void sexp_init (void) {
-#if SEXP_USE_GLOBAL_SYMBOLS
-  int i;
-#endif
   if (! sexp_initialized_p) {
     sexp_initialized_p = 1;
 #if SEXP_USE_BOEHM
@@ -3362,8 +4253,8 @@ void sexp_init (void) {
     sexp_gc_init();
 #endif
 #if SEXP_USE_GLOBAL_SYMBOLS
-    for (i=0; i<SEXP_SYMBOL_TABLE_SIZE; i++)
-      sexp_symbol_table[i] = SEXP_NULL;
+    sexp_symbol_table = SEXP_FALSE;
+    sexp_symbol_table_count = SEXP_ZERO;
 #endif
   }
 }
@@ -26,12 +26,14 @@
         (rename (chibi math prime-test) (run-tests run-prime-tests))
         ;;(rename (chibi memoize-test) (run-tests run-memoize-tests))
         (rename (chibi mime-test) (run-tests run-mime-tests))
+        (rename (chibi net server-test) (run-tests run-net-server-tests))
         (rename (chibi numeric-test) (run-tests run-numeric-tests))
         (rename (chibi parse-test) (run-tests run-parse-tests))
         (rename (chibi pathname-test) (run-tests run-pathname-tests))
         (rename (chibi process-test) (run-tests run-process-tests))
         (rename (chibi regexp-test) (run-tests run-regexp-tests))
         (rename (chibi scribble-test) (run-tests run-scribble-tests))
+        (rename (chibi serialize-test) (run-tests run-serialize-tests))
         (rename (chibi show-test) (run-tests run-show-tests))
         (rename (chibi string-test) (run-tests run-string-tests))
         (rename (chibi system-test) (run-tests run-system-tests))
@@ -39,6 +41,7 @@
         ;;(rename (chibi term ansi-test) (run-tests run-term-ansi-tests))
         (rename (chibi uri-test) (run-tests run-uri-tests))
         ;;(rename (chibi weak-test) (run-tests run-weak-tests))
+        (rename (chibi zlib-test) (run-tests run-zlib-tests))
         )
 
 (test-begin "libraries")
@@ -63,6 +66,7 @@
 (run-match-tests)
 (run-md5-tests)
 (run-mime-tests)
+(run-net-server-tests)
 (run-numeric-tests)
 (run-parse-tests)
 (run-pathname-tests)
@@ -71,11 +75,13 @@
 (run-regexp-tests)
 (run-rsa-tests)
 (run-scribble-tests)
+(run-serialize-tests)
 (run-string-tests)
 (run-sha2-tests)
 (run-show-tests)
 (run-system-tests)
 (run-tar-tests)
 (run-uri-tests)
+(run-zlib-tests)
 
 (test-end)
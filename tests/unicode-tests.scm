@@ -42,6 +42,31 @@
         (string-fill! s #\字)
         s))
 
+(let ((s (string-append (make-string 300 #\a) "日本語" (make-string 300 #\z))))
+  (test 603 (string-length s))
+  (test #\a (string-ref s 299))
+  (test #\日 (string-ref s 300))
+  (test #\語 (string-ref s 302))
+  (test #\z (string-ref s 303))
+  (test #\z (string-ref s 602))
+  (test "a日本語z" (substring s 299 304))
+  (string-set! s 301 #\-)
+  (test #\- (string-ref s 301))
+  (test #\語 (string-ref s 302))
+  (string-set! s 0 #\字)
+  (test 603 (string-length s))
+  (test #\字 (string-ref s 0))
+  (test #\日 (string-ref s 300))
+  (test #\z (string-ref s 602)))
+
+(let ((s (make-string 1000 #\a)))
+  (test #\a (string-ref s 999))
+  (string-set! s 500 #\λ)
+  (test 1000 (string-length s))
+  (test #\λ (string-ref s 500))
+  (test #\a (string-ref s 999))
+  (test "aλa" (substring s 499 502)))
+
 (cond-expand (modules (import (chibi loop))) (else #f))
 
 (test "in-string"
@@ -0,0 +1,68 @@
+#!/usr/bin/env chibi-scheme
+
+;; Generate the table of powers of ten used for flonum printing and
+;; parsing in sexp.c.
+;;
+;; Usage:
+;;   generate-pow10-table.scm > include/chibi/sexp-pow10tab.h
+;;
+;; For each e in [-343, 324] we write 10^e = beta * 2^r, where r is
+;; chosen so that 2^125 <= beta < 2^126, as the 126-bit integer
+;; g = floor(beta) + 1, split into its high and low 63 bits.
+
+(import (chibi))
+
+;; the number of bits in the positive integer n
+(define (integer-length n)
+  (let lp ((k 0) (m 1))
+    (if (> m n) k (lp (+ k 1) (* m 2)))))
+
+(define min-e -343)
+(define max-e 324)
+
+;; floor(log2(10^e))
+(define (floor-log2-pow10 e)
+  (if (>= e 0)
+      (- (integer-length (expt 10 e)) 1)
+      (- (integer-length (expt 10 (- e))))))
+
+(define (pow10-g e)
+  (let ((r (- (floor-log2-pow10 e) 125)))
+    (+ 1 (if (>= e 0)
+             (if (>= r 0)
+                 (quotient (expt 10 e) (expt 2 r))
+                 (* (expt 10 e) (expt 2 (- r))))
+             (quotient (expt 2 (- r)) (expt 10 (- e)))))))
+
+(define (write-hex n)
+  (let ((s (number->string n 16)))
+    (display "0x")
+    (display (make-string (- 16 (string-length s)) #\0))
+    (display s)
+    (display "uLL")))
+
+(display "/* auto-generated by tools/generate-pow10-table.scm */\n\n")
+(display "#define SEXP_POW10_MIN ")
+(write min-e)
+(newline)
+(display "#define SEXP_POW10_MAX ")
+(write max-e)
+(newline)
+(newline)
+(display "static const unsigned long long sexp_pow10_tab[][2] = {\n")
+(let lp ((e min-e))
+  (cond
+   ((<= e max-e)
+    (let ((g (pow10-g e)))
+      (if (not (and (>= g (expt 2 125)) (< g (expt 2 126))))
+          (error "power of ten out of range" e))
+      (display "  {")
+      (write-hex (quotient g (expt 2 63)))
+      (display ", ")
+      (write-hex (remainder g (expt 2 63)))
+      (display (if (< e max-e) "}," "}"))
+      (display "  /* ")
+      (write e)
+      (display " */\n")
+      (lp (+ e 1))))))
+(display "};\n")
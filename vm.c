@@ -111,7 +111,7 @@ static void sexp_inc_context_depth(sexp ctx, sexp_sint_t off) {
 
 static void bytecode_preserve (sexp ctx, sexp obj) {
   sexp ls = sexp_bytecode_literals(sexp_context_bc(ctx));
-  if (sexp_pointerp(obj) && !sexp_symbolp(obj)
+  if (sexp_pointerp(obj)
       && sexp_not(sexp_memq(ctx, obj, ls)))
     sexp_push(ctx, sexp_bytecode_literals(sexp_context_bc(ctx)), obj);
 }
@@ -900,13 +900,18 @@ static int sexp_check_type(sexp ctx, sexp a, sexp b) {
 }
 
 #if SEXP_USE_GREEN_THREADS
+/* give up the rest of the time slice, charging only the fuel used */
+#define sexp_yield_fuel()                                   \
+  (sexp_context_steps(ctx) += (fuel < sexp_context_refuel(ctx) \
+                               ? sexp_context_refuel(ctx) - fuel : 0), \
+   fuel = 0)
 #define sexp_fcall_return(x, i)                             \
   if (sexp_exceptionp(x)) {                                 \
     if (x == sexp_global(ctx, SEXP_G_IO_BLOCK_ERROR)) {     \
-      fuel = 0; ip--; goto loop;                            \
+      sexp_yield_fuel(); ip--; goto loop;                   \
     } else if (x == sexp_global(ctx, SEXP_G_IO_BLOCK_ONCE_ERROR)) { \
       stack[top-i+1] = SEXP_ZERO;                                   \
-      fuel = 0; ip--; goto loop;                            \
+      sexp_yield_fuel(); ip--; goto loop;                   \
     } else {                                                \
       top -= i;                                             \
       _ARG1 = x;                                            \
@@ -1031,6 +1036,18 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
  loop:
 #if SEXP_USE_GREEN_THREADS
   if (--fuel <= 0) {
+    if (fuel == 0) {
+      /* used the whole slice - if other threads are waiting, shrink */
+      /* the next slice so CPU hogs don't add latency to the rest */
+      sexp_context_steps(ctx) += sexp_context_refuel(ctx);
+      if (sexp_pairp(sexp_global(ctx, SEXP_G_THREADS_FRONT))
+          && sexp_context_refuel(ctx) > SEXP_MIN_QUANTUM)
+        sexp_context_refuel(ctx) = sexp_context_refuel(ctx)/2 > SEXP_MIN_QUANTUM
+          ? sexp_context_refuel(ctx)/2 : SEXP_MIN_QUANTUM;
+    } else if (sexp_context_refuel(ctx) > 0) {
+      /* yielded voluntarily, give it back a full slice */
+      sexp_context_refuel(ctx) = sexp_context_quantum(ctx);
+    }
     tmp1 = sexp_global(ctx, SEXP_G_THREADS_SCHEDULER);
     if (sexp_applicablep(tmp1) && sexp_not(sexp_global(ctx, SEXP_G_ATOMIC_P))) {
       /* save thread */
@@ -1492,7 +1509,12 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
   case SEXP_OP_STRING_LENGTH:
     if (! sexp_stringp(_ARG1))
       sexp_raise("string-length: not a string", sexp_list1(ctx, _ARG1));
+#if SEXP_USE_STRING_INDEX_TABLE
+    sexp_context_top(ctx) = top;
+    _ARG1 = sexp_make_fixnum(sexp_string_index_length(ctx, _ARG1));
+#else
     _ARG1 = sexp_make_fixnum(sexp_string_length(_ARG1));
+#endif
     break;
   case SEXP_OP_MAKE_PROCEDURE:
     sexp_context_top(ctx) = top;
@@ -1999,7 +2021,7 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
           sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), _ARG2, SEXP_FALSE);
         else
           sexp_poll_output(ctx, _ARG2);
-        fuel = 0;
+        sexp_yield_fuel();
         ip--;      /* try again */
         goto loop;
       } else
@@ -2049,7 +2071,7 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
         sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), _ARG3, SEXP_FALSE);
       else
         sexp_poll_output(ctx, _ARG3);
-      fuel = 0;
+      sexp_yield_fuel();
       ip--;      /* try again */
       goto loop;
     }
@@ -2074,6 +2096,8 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
     if (i == EOF) {
       if (!sexp_port_openp(_ARG1))
         sexp_raise("peek-char: port is closed", _ARG1);
+      else if (sexp_port_exceptionp(_ARG1))
+        _ARG1 = sexp_port_take_exception(_ARG1);
       else
 #if SEXP_USE_GREEN_THREADS
       if ((sexp_port_stream(_ARG1) ? ferror(sexp_port_stream(_ARG1)) : 1)
@@ -2084,7 +2108,7 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
           sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), _ARG1, SEXP_FALSE);
         else
           sexp_poll_input(ctx, _ARG1);
-        fuel = 0;
+        sexp_yield_fuel();
         ip--;      /* try again */
       } else
 #endif
@@ -2106,6 +2130,8 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
     if (i == EOF) {
       if (!sexp_port_openp(_ARG1))
         sexp_raise("read-char: port is closed", _ARG1);
+      else if (sexp_port_exceptionp(_ARG1))
+        _ARG1 = sexp_port_take_exception(_ARG1);
       else
 #if SEXP_USE_GREEN_THREADS
       if ((sexp_port_stream(_ARG1) ? ferror(sexp_port_stream(_ARG1)) : 1)
@@ -2115,7 +2141,7 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
           sexp_apply2(ctx, sexp_global(ctx, SEXP_G_THREADS_BLOCKER), _ARG1, SEXP_FALSE);
         else
           sexp_poll_input(ctx, _ARG1);
-        fuel = 0;
+        sexp_yield_fuel();
         ip--;      /* try again */
       } else
 #endif
@@ -2128,7 +2154,7 @@ sexp sexp_apply (sexp ctx, sexp proc, sexp args) {
     break;
   case SEXP_OP_YIELD:
 #if SEXP_USE_GREEN_THREADS
-    fuel = 0;
+    sexp_yield_fuel();
 #endif
     break;
   case SEXP_OP_FORCE:
@@ -2252,4 +2278,42 @@ sexp sexp_apply_no_err_handler (sexp ctx, sexp proc, sexp args) {
   return res;
 }
 
+/* For calling back into scheme from C code which a continuation */
+/* can't unwind, such as a custom port.  Handlers installed outside */
+/* are hidden so that exceptions are returned to the caller, but */
+/* unlike the above other parameters are kept. */
+sexp sexp_apply_callback (sexp ctx, sexp proc, sexp args) {
+  sexp res, err_cell = sexp_global(ctx, SEXP_G_ERR_HANDLER);
+#if SEXP_USE_GREEN_THREADS
+  char errorp = sexp_context_errorp(ctx);
+#endif
+  sexp_gc_var2(handler, params);
+  sexp_gc_preserve2(ctx, handler, params);
+#if SEXP_USE_GREEN_THREADS
+  params = sexp_context_params(ctx);
+  handler = sexp_cons(ctx, err_cell, SEXP_FALSE);
+  if (sexp_exceptionp(handler)) {
+    res = handler;
+  } else {
+    sexp_context_params(ctx) = sexp_cons(ctx, handler, params);
+    sexp_context_errorp(ctx) = 0;
+    res = sexp_exceptionp(sexp_context_params(ctx)) ? sexp_context_params(ctx)
+      : sexp_apply(ctx, proc, args);
+    /* a raised non-exception object is returned like a value */
+    if (sexp_context_errorp(ctx) && !sexp_exceptionp(res))
+      res = sexp_user_exception(ctx, proc, "exception raised in callback", res);
+    sexp_context_errorp(ctx) = errorp;
+    sexp_context_params(ctx) = params;
+  }
+#else
+  err_cell = sexp_opcodep(err_cell) ? sexp_opcode_data(err_cell) : SEXP_FALSE;
+  handler = sexp_pairp(err_cell) ? sexp_cdr(err_cell) : SEXP_FALSE;
+  if (sexp_pairp(err_cell)) sexp_cdr(err_cell) = SEXP_FALSE;
+  res = sexp_apply(ctx, proc, args);
+  if (sexp_pairp(err_cell)) sexp_cdr(err_cell) = handler;
+#endif
+  sexp_gc_release2(ctx);
+  return res;
+}
+
 #endif